@@ -0,0 +1,135 @@
+#version 460 core
+
+layout (local_size_x = 64) in;
+
+struct DrawRecord {
+    mat4 modelMatrix;
+    vec4 boundsMin;
+    vec4 boundsMax;
+    uint indexCount;
+    uint firstIndex;
+    int baseVertex;
+    uint flags;
+};
+
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout(std430) readonly buffer recordBlock {
+    DrawRecord records[];
+};
+
+layout(std430) writeonly buffer commandBlock {
+    DrawCommand commands[];
+};
+
+layout(std430) writeonly buffer remapBlock {
+    uint remap[];
+};
+
+layout(std430) buffer countBlock {
+    uint drawCount;
+};
+
+uniform uint recordCount;
+uniform uint requiredFlags;
+
+uniform mat4 viewProjection;
+uniform mat4 previousViewProjection;
+
+uniform bool occlusionCulling;
+uniform sampler2D depthPyramid; //farthest depth of last frame
+uniform vec2 pyramidSize;
+uniform int pyramidLevels;
+
+vec3 getCorner(vec3 boundsMin, vec3 boundsMax, int index) {
+    return vec3((index & 1) != 0 ? boundsMax.x : boundsMin.x, (index & 2) != 0 ? boundsMax.y : boundsMin.y, (index & 4) != 0 ? boundsMax.z : boundsMin.z);
+}
+
+bool isInsideFrustum(vec3 boundsMin, vec3 boundsMax) {
+    //the box is outside if all corners lie outside of the same clip plane
+    uint outsideAll = 63u;
+
+    for(int i = 0; i < 8; i++) {
+        vec4 clipPos = viewProjection * vec4(getCorner(boundsMin, boundsMax, i), 1.0f);
+        uint outside = 0u;
+
+        if(clipPos.x < -clipPos.w) outside |= 1u;
+        if(clipPos.x > clipPos.w) outside |= 2u;
+        if(clipPos.y < -clipPos.w) outside |= 4u;
+        if(clipPos.y > clipPos.w) outside |= 8u;
+        if(clipPos.z < -clipPos.w) outside |= 16u;
+        if(clipPos.z > clipPos.w) outside |= 32u;
+
+        outsideAll &= outside;
+    }
+
+    return outsideAll == 0u;
+}
+
+bool isOccluded(vec3 boundsMin, vec3 boundsMax) {
+    //project the box with last frame's matrix, since the depth pyramid was built with it
+    vec2 minUV = vec2(1.0f);
+    vec2 maxUV = vec2(0.0f);
+    float minDepth = 1.0f;
+
+    for(int i = 0; i < 8; i++) {
+        vec4 clipPos = previousViewProjection * vec4(getCorner(boundsMin, boundsMax, i), 1.0f);
+
+        if(clipPos.z < -clipPos.w) return false; //intersects the near plane
+
+        vec3 ndc = clipPos.xyz / clipPos.w;
+
+        minUV = min(minUV, ndc.xy * 0.5f + 0.5f);
+        maxUV = max(maxUV, ndc.xy * 0.5f + 0.5f);
+        minDepth = min(minDepth, ndc.z * 0.5f + 0.5f);
+    }
+
+    minUV = clamp(minUV, 0.0f, 1.0f);
+    maxUV = clamp(maxUV, 0.0f, 1.0f);
+
+    //pick the mip level at which the box covers at most 2x2 texels
+    vec2 size = (maxUV - minUV) * pyramidSize;
+    int level = clamp(int(ceil(log2(max(max(size.x, size.y), 1.0f)))), 0, pyramidLevels - 1);
+
+    ivec2 levelSize = textureSize(depthPyramid, level);
+    ivec2 minTexel = clamp(ivec2(minUV * vec2(levelSize)), ivec2(0), levelSize - 1);
+    ivec2 maxTexel = clamp(ivec2(maxUV * vec2(levelSize)), ivec2(0), levelSize - 1);
+
+    float maxDepth = 0.0f;
+
+    for(int y = minTexel.y; y <= maxTexel.y; y++) {
+        for(int x = minTexel.x; x <= maxTexel.x; x++) {
+            maxDepth = max(maxDepth, texelFetch(depthPyramid, ivec2(x, y), level).r);
+        }
+    }
+
+    return minDepth > maxDepth;
+}
+
+void main() {
+    uint id = gl_GlobalInvocationID.x;
+    if(id >= recordCount) return;
+
+    DrawRecord record = records[id];
+
+    if((record.flags & requiredFlags) != requiredFlags) return;
+    if(!isInsideFrustum(record.boundsMin.xyz, record.boundsMax.xyz)) return;
+    if(occlusionCulling && isOccluded(record.boundsMin.xyz, record.boundsMax.xyz)) return;
+
+    //append the draw command, the remap buffer lets the vertex shader find the record again
+    uint index = atomicAdd(drawCount, 1u);
+
+    commands[index].count = record.indexCount;
+    commands[index].instanceCount = 1u;
+    commands[index].firstIndex = record.firstIndex;
+    commands[index].baseVertex = record.baseVertex;
+    commands[index].baseInstance = 0u;
+
+    remap[index] = id;
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#version 460 core
+
+layout (local_size_x = 8, local_size_y = 8) in;
+
+layout (r32f, binding = 0) writeonly uniform image2D outputDepth;
+
+uniform sampler2D inputDepth;
+uniform int inputLevel; //-1 copies the depth buffer into the first level
+uniform vec2 outputSize;
+
+void main() {
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = ivec2(outputSize);
+    if(texel.x >= size.x || texel.y >= size.y) return;
+
+    if(inputLevel < 0) {
+        imageStore(outputDepth, texel, vec4(texelFetch(inputDepth, texel, 0).r));
+        return;
+    }
+
+    //keep the farthest depth of the covered texels, odd sizes fold the last row/column into the border texels
+    ivec2 inputSize = textureSize(inputDepth, inputLevel);
+    ivec2 start = texel * 2;
+    ivec2 end = min(start + ivec2(1) + ivec2(equal(texel, size - 1)) * (inputSize & 1), inputSize - 1);
+
+    float depth = 0.0f;
+
+    for(int y = start.y; y <= end.y; y++) {
+        for(int x = start.x; x <= end.x; x++) {
+            depth = max(depth, texelFetch(inputDepth, ivec2(x, y), inputLevel).r);
+        }
+    }
+
+    imageStore(outputDepth, texel, vec4(depth));
+}
\ No newline at end of file
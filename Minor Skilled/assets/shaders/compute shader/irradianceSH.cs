@@ -0,0 +1,88 @@
+#version 460 core
+
+const float PI = 3.14159265359f;
+
+layout (local_size_x = 64) in;
+
+layout (std430, binding = 7) writeonly buffer irradianceBlock {
+    vec4 coefficients[9];
+};
+
+uniform samplerCube environmentMap;
+uniform float lod; //level of the environment map that is projected
+uniform int sampleSize; //texels per face side on that level
+
+shared vec3 sums[64][9];
+
+vec3 GetDirection(int face, vec2 uv);
+
+void main() {
+    uint index = gl_LocalInvocationIndex;
+    int faceTexels = sampleSize * sampleSize;
+
+    vec3 sh[9];
+
+    for(int i = 0; i < 9; i++) {
+        sh[i] = vec3(0.0f);
+    }
+
+    //project every texel of the cubemap onto the l2 spherical harmonics basis, weighted by the solid angle it covers
+    for(int i = int(index); i < faceTexels * 6; i += 64) {
+        int face = i / faceTexels;
+        int texel = i % faceTexels;
+
+        vec2 uv = (vec2(texel % sampleSize, texel / sampleSize) + 0.5f) / float(sampleSize) * 2.0f - 1.0f;
+        float solidAngle = 4.0f / (float(faceTexels) * pow(1.0f + dot(uv, uv), 1.5f));
+
+        vec3 n = normalize(GetDirection(face, uv));
+        vec3 radiance = textureLod(environmentMap, n, lod).rgb * solidAngle;
+
+        sh[0] += radiance * 0.282095f;
+        sh[1] += radiance * 0.488603f * n.y;
+        sh[2] += radiance * 0.488603f * n.z;
+        sh[3] += radiance * 0.488603f * n.x;
+        sh[4] += radiance * 1.092548f * n.x * n.y;
+        sh[5] += radiance * 1.092548f * n.y * n.z;
+        sh[6] += radiance * 0.315392f * (3.0f * n.z * n.z - 1.0f);
+        sh[7] += radiance * 1.092548f * n.x * n.z;
+        sh[8] += radiance * 0.546274f * (n.x * n.x - n.y * n.y);
+    }
+
+    for(int i = 0; i < 9; i++) {
+        sums[index][i] = sh[i];
+    }
+
+    barrier();
+
+    //sum up the results of the whole work group
+    for(uint stride = 32; stride > 0; stride >>= 1) {
+        if(index < stride) {
+            for(int i = 0; i < 9; i++) {
+                sums[index][i] += sums[index + stride][i];
+            }
+        }
+
+        barrier();
+    }
+
+    if(index != 0) return;
+
+    //convolve with the cosine lobe (pi, 2pi/3 and pi/4 per band) and divide by pi, so the result is used like the old irradiance maps
+    float bands[9] = float[] (1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f);
+
+    for(int i = 0; i < 9; i++) {
+        coefficients[i] = vec4(sums[0][i] * bands[i], 0.0f);
+    }
+}
+
+vec3 GetDirection(int face, vec2 uv) {
+    //cubemap face orientations as defined by opengl
+    switch(face) {
+        case 0: return vec3(1.0f, -uv.y, -uv.x);
+        case 1: return vec3(-1.0f, -uv.y, uv.x);
+        case 2: return vec3(uv.x, 1.0f, uv.y);
+        case 3: return vec3(uv.x, -1.0f, -uv.y);
+        case 4: return vec3(uv.x, -uv.y, 1.0f);
+        default: return vec3(-uv.x, -uv.y, -1.0f);
+    }
+}
\ No newline at end of file
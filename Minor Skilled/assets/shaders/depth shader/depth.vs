@@ -1,6 +1,8 @@
 #version 460 core
 
-layout (location = 0) in vec3 aVertex;
+layout (location = 0) in vec4 aVertex; //quantized for compressed vertices
+layout (location = 6) in vec4 aPositionScale; //per mesh dequantization, w is 1 for compressed vertices
+layout (location = 7) in vec3 aPositionOffset;
 
 layout (std140) uniform matricesBlock {
     mat4 viewMatrix;
@@ -12,5 +14,7 @@ layout (std140) uniform matricesBlock {
 uniform mat4 modelMatrix;
 
 void main() {
-    gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(aVertex, 1.0f);
+    vec3 vertex = aVertex.xyz * aPositionScale.xyz + aPositionOffset; //dequantize compressed positions
+
+    gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(vertex, 1.0f);
 }
\ No newline at end of file
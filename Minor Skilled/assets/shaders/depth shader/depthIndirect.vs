@@ -0,0 +1,34 @@
+#version 460 core
+
+layout (location = 0) in vec3 aVertex;
+
+struct DrawRecord {
+    mat4 modelMatrix;
+    vec4 boundsMin;
+    vec4 boundsMax;
+    uint indexCount;
+    uint firstIndex;
+    int baseVertex;
+    uint flags;
+};
+
+layout (std140) uniform matricesBlock {
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    mat4 previousViewProjectionMatrix;
+    mat4 lightSpaceMatrix;
+};
+
+layout(std430) readonly buffer recordBlock {
+    DrawRecord records[];
+};
+
+layout(std430) readonly buffer remapBlock {
+    uint remap[];
+};
+
+void main() {
+    mat4 modelMatrix = records[remap[gl_DrawID]].modelMatrix; //the culling shader wrote one command per visible record
+
+    gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(aVertex, 1.0f);
+}
\ No newline at end of file
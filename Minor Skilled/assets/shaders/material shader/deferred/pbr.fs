@@ -41,18 +41,35 @@ layout (std140) uniform dataBlock {
 uniform Material material;
 uniform float maxReflectionLod;
 
-uniform samplerCube irradianceMap;
-uniform samplerCube prefilterMap;
+//reflection probes
+struct ReflectionProbe {
+    vec4 position; //w is 1 for box projected probes
+    vec4 extents; //half size of the influence box
+    vec4 irradiance[9]; //l2 spherical harmonics of the diffuse irradiance
+};
+
+layout (std140) uniform probesBlock {
+    ReflectionProbe probes[16];
+    int probeCount;
+    vec4 volumeMin; //first probe of the irradiance volume, w is 1 if the volume is used
+    vec4 volumeSpacing;
+};
+
+uniform samplerCubeArray prefilterMaps;
+uniform int primaryProbe; //-1 if there is none
+uniform int secondaryProbe;
+uniform float probeBlend;
 
 layout (location = 0) out vec3 gPosition;
 layout (location = 1) out vec3 gNormal;
 layout (location = 2) out vec3 gAlbedo;
 layout (location = 3) out vec2 gEmissionSpec;
 layout (location = 4) out vec3 gMetalRoughAO;
-layout (location = 5) out vec3 gIrradiance;
-layout (location = 6) out vec3 gPrefilter;
-layout (location = 7) out vec3 gReflectance;
+layout (location = 5) out vec3 gPrefilter;
+layout (location = 6) out vec3 gReflectance;
 
+vec3 SampleProbes(samplerCubeArray maps, vec3 direction, float lod, bool boxProjection);
+vec3 GetProbeDirection(vec3 direction, int probe);
 vec3 GetNormal(vec2 texCoord);
 vec2 ParallaxMapping();
 
@@ -93,16 +110,15 @@ void main() {
     gMetalRoughAO.g = roughness;
     gMetalRoughAO.b = texture(material.ao, texCoord).r;
 
-    gIrradiance.rgb = texture(irradianceMap, normal).rgb;
-
-    gPrefilter.rgb = textureLod(prefilterMap, R, roughness * maxReflectionLod).rgb;
+    gPrefilter.rgb = SampleProbes(prefilterMaps, R, roughness * maxReflectionLod, true);
 
     gReflectance.rgb = material.F0.rgb;
 }
 
 vec3 GetNormal(vec2 texCoord) {
-    vec3 normal = texture(material.normal, texCoord).rgb; //range [0, 1]
-    normal = normalize(normal * 2.0f - 1.0f); //bring to range [-1, 1]
+    vec3 normal;
+    normal.xy = texture(material.normal, texCoord).rg * 2.0f - 1.0f; //bring to range [-1, 1]
+    normal.z = sqrt(max(1.0f - dot(normal.xy, normal.xy), 0.0f)); //bc5 normal maps only store x and y
     normal = normalize(fs_in.TBN * normal); //transform normal from tangent to view space 
 
     if(material.flipNormals) normal.y = -normal.y;
@@ -154,4 +170,36 @@ vec2 ParallaxMapping() {
     vec2 finalTexCoords = prevTexCoords * weight + currentTexCoords * (1.0f - weight);
 
     return finalTexCoords;
+}
+
+vec3 SampleProbes(samplerCubeArray maps, vec3 direction, float lod, bool boxProjection) {
+    if(primaryProbe < 0) return vec3(0.0f);
+
+    vec3 primaryDirection = boxProjection ? GetProbeDirection(direction, primaryProbe) : direction;
+    vec3 color = textureLod(maps, vec4(primaryDirection, primaryProbe), lod).rgb;
+
+    //objects between two probes fade from one to the other
+    if(probeBlend > 0.0f) {
+        vec3 secondaryDirection = boxProjection ? GetProbeDirection(direction, secondaryProbe) : direction;
+        color = mix(color, textureLod(maps, vec4(secondaryDirection, secondaryProbe), lod).rgb, probeBlend);
+    }
+
+    return color;
+}
+
+vec3 GetProbeDirection(vec3 direction, int probe) {
+    if(probes[probe].position.w == 0.0f) return direction;
+
+    //intersect the ray with the influence box and look up the hit point as seen from the probe
+    vec3 boxMin = probes[probe].position.xyz - probes[probe].extents.xyz;
+    vec3 boxMax = probes[probe].position.xyz + probes[probe].extents.xyz;
+
+    vec3 first = (boxMax - fs_in.fragPosWorld) / direction;
+    vec3 second = (boxMin - fs_in.fragPosWorld) / direction;
+    vec3 furthest = max(first, second);
+    float distance = min(min(furthest.x, furthest.y), furthest.z);
+
+    if(distance <= 0.0f) return direction; //outside of the box
+
+    return fs_in.fragPosWorld + direction * distance - probes[probe].position.xyz;
 }
\ No newline at end of file
@@ -1,8 +1,11 @@
 #version 460 core
 
-layout (location = 0) in vec3 aVertex;
+layout (location = 0) in vec4 aVertex; //quantized for compressed vertices
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aUV;
+layout (location = 5) in vec4 aPackedFrame; //octahedral normal and tangent of compressed vertices
+layout (location = 6) in vec4 aPositionScale; //per mesh dequantization, w is 1 for compressed vertices
+layout (location = 7) in vec3 aPositionOffset;
 
 layout (std140) uniform matricesBlock {
     mat4 viewMatrix;
@@ -20,13 +23,30 @@ out VS_OUT {
     vec4 lightSpaceFragPos;
 } vs_out;
 
+vec3 DecodeOctahedral(vec2 encoded) {
+    vec3 direction = vec3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+
+    //fold the lower hemisphere back out of the corners of the square
+    if(direction.z < 0.0f) direction.xy = (1.0f - abs(direction.yx)) * vec2(direction.x >= 0.0f ? 1.0f : -1.0f, direction.y >= 0.0f ? 1.0f : -1.0f);
+
+    return normalize(direction);
+}
+
 void main() {
+    //decode the vertex layout of the mesh
+    vec3 vertex = aVertex.xyz * aPositionScale.xyz + aPositionOffset;
+    vec3 normal = aNormal;
+
+    if(aPositionScale.w > 0.5f) {
+        normal = DecodeOctahedral(aPackedFrame.xy);
+    }
+
     mat3 normalMatrix = transpose(inverse(mat3(modelMatrix))); //fix normals non uniform scaling
 
-    vs_out.fragPos = vec3(modelMatrix * vec4(aVertex, 1.0f));
-    vs_out.fragNormal = normalMatrix * aNormal; //Note: the normal matrix has no translation
+    vs_out.fragPos = vec3(modelMatrix * vec4(vertex, 1.0f));
+    vs_out.fragNormal = normalMatrix * normal; //Note: the normal matrix has no translation
 
-    vs_out.lightSpaceFragPos = lightSpaceMatrix * modelMatrix * vec4(aVertex, 1.0f);
+    vs_out.lightSpaceFragPos = lightSpaceMatrix * modelMatrix * vec4(vertex, 1.0f);
 
-    gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(aVertex, 1.0f);
+    gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(vertex, 1.0f);
 }
\ No newline at end of file
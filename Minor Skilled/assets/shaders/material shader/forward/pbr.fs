@@ -90,8 +90,24 @@ layout(std430) buffer lightsBlock {
 uniform Material material;
 
 //IBL
-uniform samplerCube irradianceMap;
-uniform samplerCube prefilterMap;
+struct ReflectionProbe {
+    vec4 position; //w is 1 for box projected probes
+    vec4 extents; //half size of the influence box
+    vec4 irradiance[9]; //l2 spherical harmonics of the diffuse irradiance
+};
+
+layout (std140) uniform probesBlock {
+    ReflectionProbe probes[16];
+    int probeCount;
+    vec4 volumeMin; //first probe of the irradiance volume, w is 1 if the volume is used
+    vec4 volumeSpacing;
+};
+
+uniform sampler3D irradianceVolume[3]; //one texture per color channel
+uniform samplerCubeArray prefilterMaps;
+uniform int primaryProbe; //-1 if there is none
+uniform int secondaryProbe;
+uniform float probeBlend;
 uniform sampler2D brdfLUT;
 uniform float maxReflectionLod;
 
@@ -114,6 +130,12 @@ float CalculateShadow(vec3 normal);
 float CalculateCubemapShadow(vec3 normal, vec3 fragPos, int index);
 
 //helper functions
+vec3 SampleProbes(samplerCubeArray maps, vec3 direction, float lod, bool boxProjection);
+vec3 GetProbeDirection(vec3 direction, int probe);
+vec3 GetProbeIrradiance(vec3 normal);
+vec3 GetIrradiance(int probe, vec3 normal);
+bool InsideVolume(vec3 fragPos);
+vec3 GetVolumeIrradiance(vec3 fragPos, vec3 normal);
 vec3 GetNormal(vec2 texCoord);
 vec2 ParallaxMapping();
 vec3 CalculateBrightColor(vec3 color);
@@ -206,12 +228,12 @@ void main() {
     vec3 kD = 1.0f - kS;
     kD *= 1.0f - metallic;
 
-    //sample from the irradiance map for the diffuse
-    vec3 irradiance = texture(irradianceMap, N).rgb;
+    //evaluate the irradiance volume for the diffuse, or the probes outside of it
+    vec3 irradiance = InsideVolume(fs_in.fragPosWorld) ? GetVolumeIrradiance(fs_in.fragPosWorld, N) : GetProbeIrradiance(N);
     vec3 diffuse = irradiance * albedo;
 
     //sample from the prefilter map and the BRDF lut and combine the results
-    vec3 prefilteredColor = textureLod(prefilterMap, R, roughness * maxReflectionLod).rgb;
+    vec3 prefilteredColor = SampleProbes(prefilterMaps, R, roughness * maxReflectionLod, true);
     vec2 brdf = texture(brdfLUT, vec2(max(dot(N, V), 0.0f), roughness)).rg;
     vec3 specular = prefilteredColor * (F * brdf.x + brdf.y);
 
@@ -357,8 +379,9 @@ float CalculateCubemapShadow(vec3 normal, vec3 fragPos, int index) {
 //helper functions
 vec3 GetNormal(vec2 texCoord) {
     //take the normal from the normal map and transform it to world space
-    vec3 normal = texture(material.normal, texCoord).rgb; //range [0, 1]
-    normal = normalize(normal * 2.0f - 1.0f); //bring to range [-1, 1]
+    vec3 normal;
+    normal.xy = texture(material.normal, texCoord).rg * 2.0f - 1.0f; //bring to range [-1, 1]
+    normal.z = sqrt(max(1.0f - dot(normal.xy, normal.xy), 0.0f)); //bc5 normal maps only store x and y
     normal = normalize(fs_in.TBN * normal); //transform normal from tangent to world space
 
     if(material.flipNormals) normal.y = -normal.y;
@@ -511,4 +534,89 @@ vec3 CalculateSpotLight(Light light, vec3 V, vec3 N, vec3 F0, vec3 albedo, float
 
     //add to total outgoing radiance Lo
     return (kD * albedo / PI + specular) * radiance * NdotL * spotlightIntensity; //no need to multiply with kS, since it's already included in the BRDF
+}
+
+vec3 SampleProbes(samplerCubeArray maps, vec3 direction, float lod, bool boxProjection) {
+    if(primaryProbe < 0) return vec3(0.0f);
+
+    vec3 primaryDirection = boxProjection ? GetProbeDirection(direction, primaryProbe) : direction;
+    vec3 color = textureLod(maps, vec4(primaryDirection, primaryProbe), lod).rgb;
+
+    //objects between two probes fade from one to the other
+    if(probeBlend > 0.0f) {
+        vec3 secondaryDirection = boxProjection ? GetProbeDirection(direction, secondaryProbe) : direction;
+        color = mix(color, textureLod(maps, vec4(secondaryDirection, secondaryProbe), lod).rgb, probeBlend);
+    }
+
+    return color;
+}
+
+vec3 GetProbeDirection(vec3 direction, int probe) {
+    if(probes[probe].position.w == 0.0f) return direction;
+
+    //intersect the ray with the influence box and look up the hit point as seen from the probe
+    vec3 boxMin = probes[probe].position.xyz - probes[probe].extents.xyz;
+    vec3 boxMax = probes[probe].position.xyz + probes[probe].extents.xyz;
+
+    vec3 first = (boxMax - fs_in.fragPosWorld) / direction;
+    vec3 second = (boxMin - fs_in.fragPosWorld) / direction;
+    vec3 furthest = max(first, second);
+    float distance = min(min(furthest.x, furthest.y), furthest.z);
+
+    if(distance <= 0.0f) return direction; //outside of the box
+
+    return fs_in.fragPosWorld + direction * distance - probes[probe].position.xyz;
+}
+
+vec3 GetProbeIrradiance(vec3 normal) {
+    if(primaryProbe < 0) return vec3(0.0f);
+
+    vec3 irradiance = GetIrradiance(primaryProbe, normal);
+    if(probeBlend > 0.0f) irradiance = mix(irradiance, GetIrradiance(secondaryProbe, normal), probeBlend);
+
+    return irradiance;
+}
+
+vec3 GetIrradiance(int probe, vec3 normal) {
+    //evaluate the spherical harmonics, the cosine lobe is already convolved into them
+    vec3 n = normalize(normal);
+    ReflectionProbe p = probes[probe];
+
+    vec3 irradiance = p.irradiance[0].rgb * 0.282095f;
+    irradiance += p.irradiance[1].rgb * 0.488603f * n.y;
+    irradiance += p.irradiance[2].rgb * 0.488603f * n.z;
+    irradiance += p.irradiance[3].rgb * 0.488603f * n.x;
+    irradiance += p.irradiance[4].rgb * 1.092548f * n.x * n.y;
+    irradiance += p.irradiance[5].rgb * 1.092548f * n.y * n.z;
+    irradiance += p.irradiance[6].rgb * 0.315392f * (3.0f * n.z * n.z - 1.0f);
+    irradiance += p.irradiance[7].rgb * 1.092548f * n.x * n.z;
+    irradiance += p.irradiance[8].rgb * 0.546274f * (n.x * n.x - n.y * n.y);
+
+    return max(irradiance, 0.0f);
+}
+
+bool InsideVolume(vec3 fragPos) {
+    if(volumeMin.w < 0.5f) return false;
+
+    vec3 cell = (fragPos - volumeMin.xyz) / volumeSpacing.xyz;
+    vec3 size = vec3(textureSize(irradianceVolume[0], 0));
+
+    return all(greaterThanEqual(cell, vec3(0.0f))) && all(lessThanEqual(cell, size - 1.0f));
+}
+
+vec3 GetVolumeIrradiance(vec3 fragPos, vec3 normal) {
+    //trilinear interpolation between the eight surrounding grid probes, the texel centers sit on the probes
+    vec3 size = vec3(textureSize(irradianceVolume[0], 0));
+    vec3 uvw = ((fragPos - volumeMin.xyz) / volumeSpacing.xyz + 0.5f) / size;
+
+    //the l1 harmonics of each color channel are stored in one texture, the cosine lobe is already convolved into them
+    vec3 n = normalize(normal);
+    vec4 basis = vec4(0.282095f, 0.488603f * n.y, 0.488603f * n.z, 0.488603f * n.x);
+
+    vec3 irradiance;
+    irradiance.r = dot(texture(irradianceVolume[0], uvw), basis);
+    irradiance.g = dot(texture(irradianceVolume[1], uvw), basis);
+    irradiance.b = dot(texture(irradianceVolume[2], uvw), basis);
+
+    return max(irradiance, 0.0f);
 }
\ No newline at end of file
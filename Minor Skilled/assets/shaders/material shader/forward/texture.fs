@@ -88,7 +88,24 @@ layout(std430) buffer lightsBlock {
 
 uniform Material material;
 
-uniform samplerCube environmentMap;
+//reflection probes
+struct ReflectionProbe {
+    vec4 position; //w is 1 for box projected probes
+    vec4 extents; //half size of the influence box
+    vec4 irradiance[9]; //l2 spherical harmonics of the diffuse irradiance
+};
+
+layout (std140) uniform probesBlock {
+    ReflectionProbe probes[16];
+    int probeCount;
+    vec4 volumeMin; //first probe of the irradiance volume, w is 1 if the volume is used
+    vec4 volumeSpacing;
+};
+
+uniform samplerCubeArray environmentMaps;
+uniform int primaryProbe; //-1 if there is none
+uniform int secondaryProbe;
+uniform float probeBlend;
 uniform sampler2D shadowMap;
 uniform samplerCube shadowCubemaps[5];
 
@@ -96,6 +113,8 @@ layout (location = 0) out vec4 fragColor;
 layout (location = 1) out vec3 brightColor;
 
 float GetSpecular(vec2 texCoord);
+vec3 SampleProbes(samplerCubeArray maps, vec3 direction, float lod, bool boxProjection);
+vec3 GetProbeDirection(vec3 direction, int probe);
 vec3 GetNormal(vec2 texCoord);
 vec3 GetReflection(vec3 normal, vec2 texCoord, out bool hasReflection);
 vec2 ParallaxMapping();
@@ -201,8 +220,8 @@ vec3 GetNormal(vec2 texCoord) {
     vec3 normal;
 
     if(material.hasNormal) {
-        normal = texture(material.normal, texCoord).rgb; //range [0, 1]
-        normal = normalize(normal * 2.0f - 1.0f); //bring to range [-1, 1]
+        normal.xy = texture(material.normal, texCoord).rg * 2.0f - 1.0f; //bring to range [-1, 1]
+        normal.z = sqrt(max(1.0f - dot(normal.xy, normal.xy), 0.0f)); //bc5 normal maps only store x and y
         normal = normalize(fs_in.TBN * normal); //transform normal from tangent to world space
 
         if(material.flipNormals) normal.y = -normal.y;
@@ -238,8 +257,8 @@ vec3 GetReflection(vec3 normal, vec2 texCoord, out bool hasReflection) {
         R = reflect(I, normalize(normal));
     }
 
-    //sample from dynamic environment map
-    return texture(environmentMap, R).rgb;
+    //sample from the reflection probes around the object
+    return SampleProbes(environmentMaps, R, 0.0f, true);
 }
 
 vec2 ParallaxMapping() {
@@ -443,4 +462,36 @@ vec3 CalculateBrightColor(vec3 color) {
     //return the color if it was bright enough, otherwise return black
     if(brightness > 1.0f) return color;
     else return vec3(0.0f);
+}
+
+vec3 SampleProbes(samplerCubeArray maps, vec3 direction, float lod, bool boxProjection) {
+    if(primaryProbe < 0) return vec3(0.0f);
+
+    vec3 primaryDirection = boxProjection ? GetProbeDirection(direction, primaryProbe) : direction;
+    vec3 color = textureLod(maps, vec4(primaryDirection, primaryProbe), lod).rgb;
+
+    //objects between two probes fade from one to the other
+    if(probeBlend > 0.0f) {
+        vec3 secondaryDirection = boxProjection ? GetProbeDirection(direction, secondaryProbe) : direction;
+        color = mix(color, textureLod(maps, vec4(secondaryDirection, secondaryProbe), lod).rgb, probeBlend);
+    }
+
+    return color;
+}
+
+vec3 GetProbeDirection(vec3 direction, int probe) {
+    if(probes[probe].position.w == 0.0f) return direction;
+
+    //intersect the ray with the influence box and look up the hit point as seen from the probe
+    vec3 boxMin = probes[probe].position.xyz - probes[probe].extents.xyz;
+    vec3 boxMax = probes[probe].position.xyz + probes[probe].extents.xyz;
+
+    vec3 first = (boxMax - fs_in.fragPosWorld) / direction;
+    vec3 second = (boxMin - fs_in.fragPosWorld) / direction;
+    vec3 furthest = max(first, second);
+    float distance = min(min(furthest.x, furthest.y), furthest.z);
+
+    if(distance <= 0.0f) return direction; //outside of the box
+
+    return fs_in.fragPosWorld + direction * distance - probes[probe].position.xyz;
 }
\ No newline at end of file
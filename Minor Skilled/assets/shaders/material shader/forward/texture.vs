@@ -1,9 +1,13 @@
 #version 460 core
 
-layout (location = 0) in vec3 aVertex;
+layout (location = 0) in vec4 aVertex; //quantized for compressed vertices, w holds the bitangent sign
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aUV;
 layout (location = 3) in vec3 aTangent;
+layout (location = 4) in vec3 aBitangent;
+layout (location = 5) in vec4 aPackedFrame; //octahedral normal and tangent of compressed vertices
+layout (location = 6) in vec4 aPositionScale; //per mesh dequantization, w is 1 for compressed vertices
+layout (location = 7) in vec3 aPositionOffset;
 
 layout (std140) uniform matricesBlock {
     mat4 viewMatrix;
@@ -25,22 +29,43 @@ out VS_OUT {
     vec4 lightSpaceFragPos;
 } vs_out;
 
+vec3 DecodeOctahedral(vec2 encoded) {
+    vec3 direction = vec3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+
+    //fold the lower hemisphere back out of the corners of the square
+    if(direction.z < 0.0f) direction.xy = (1.0f - abs(direction.yx)) * vec2(direction.x >= 0.0f ? 1.0f : -1.0f, direction.y >= 0.0f ? 1.0f : -1.0f);
+
+    return normalize(direction);
+}
+
 void main() {
+    //decode the vertex layout of the mesh
+    vec3 vertex = aVertex.xyz * aPositionScale.xyz + aPositionOffset;
+    vec3 normal = aNormal;
+    vec3 tangent = aTangent;
+    float bitangentSign = (dot(cross(aNormal, aTangent), aBitangent) < 0.0f) ? -1.0f : 1.0f;
+
+    if(aPositionScale.w > 0.5f) {
+        normal = DecodeOctahedral(aPackedFrame.xy);
+        tangent = DecodeOctahedral(aPackedFrame.zw);
+        bitangentSign = aVertex.w * 2.0f - 1.0f;
+    }
+
     mat3 normalMatrix = transpose(inverse(mat3(modelMatrix))); //fix normals in non uniform scaling
 
-    vs_out.fragPosWorld = vec3(modelMatrix * vec4(aVertex, 1.0f));
-    vs_out.fragPosView = vec3(viewMatrix * modelMatrix * vec4(aVertex, 1.0f));
-    vs_out.fragNormal = normalMatrix * aNormal;
+    vs_out.fragPosWorld = vec3(modelMatrix * vec4(vertex, 1.0f));
+    vs_out.fragPosView = vec3(viewMatrix * modelMatrix * vec4(vertex, 1.0f));
+    vs_out.fragNormal = normalMatrix * normal;
     vs_out.texCoord = aUV;
 
     //construct TBN matrix
-    vec3 T = normalize(normalMatrix * aTangent);
-    vec3 N = normalize(normalMatrix * aNormal);
+    vec3 T = normalize(normalMatrix * tangent);
+    vec3 N = normalize(normalMatrix * normal);
     T = normalize(T - dot(T, N) * N); //re-orthogonalize with gram-schmidt process
-    vec3 B = cross(N, T); 
+    vec3 B = cross(N, T) * bitangentSign; //handedness of mirrored uvs
     vs_out.TBN = mat3(T, B, N);
 
-    vs_out.lightSpaceFragPos = lightSpaceMatrix * modelMatrix * vec4(aVertex, 1.0f);
+    vs_out.lightSpaceFragPos = lightSpaceMatrix * modelMatrix * vec4(vertex, 1.0f);
 
-    gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(aVertex, 1.0f);
+    gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(vertex, 1.0f);
 }
\ No newline at end of file
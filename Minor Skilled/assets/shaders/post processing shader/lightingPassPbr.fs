@@ -60,6 +60,20 @@ layout(std430) buffer lightsBlock {
     Light lights[];
 };
 
+//reflection probes
+struct ReflectionProbe {
+    vec4 position; //w is 1 for box projected probes
+    vec4 extents; //half size of the influence box
+    vec4 irradiance[9]; //l2 spherical harmonics of the diffuse irradiance
+};
+
+layout (std140) uniform probesBlock {
+    ReflectionProbe probes[16];
+    int probeCount;
+    vec4 volumeMin; //first probe of the irradiance volume, w is 1 if the volume is used
+    vec4 volumeSpacing;
+};
+
 uniform bool useSSAO;
 
 uniform sampler2D gPosition;
@@ -67,12 +81,12 @@ uniform sampler2D gNormal;
 uniform sampler2D gAlbedo;
 uniform sampler2D gEmissionSpec;
 uniform sampler2D gMetalRoughAO;
-uniform sampler2D gIrradiance;
 uniform sampler2D gPrefilter;
 uniform sampler2D gReflectance;
 
 uniform sampler2D ssao;
 uniform sampler2D brdfLUT;
+uniform sampler3D irradianceVolume[3]; //one texture per color channel
 uniform sampler2D shadowMap;
 uniform samplerCube shadowCubemaps[5];
 
@@ -92,6 +106,10 @@ float CalculateCubemapShadow(vec3 normal, vec3 fragPos, int index);
 
 //helper functions
 vec3 CalculateBrightColor(vec3 color);
+vec3 GetProbeIrradiance(vec3 fragPos, vec3 normal);
+vec3 GetIrradiance(int probe, vec3 normal);
+bool InsideVolume(vec3 fragPos);
+vec3 GetVolumeIrradiance(vec3 fragPos, vec3 normal);
 
 //lighting
 vec3 CalculateDirectionalLight(Light light, vec3 V, vec3 N, vec3 F0, vec3 albedo, float roughness, float metallic);
@@ -161,8 +179,8 @@ void main() {
     vec3 kD = 1.0f - kS; //refraction strength
     kD *= 1.0f - metallic;
 
-    //sample from the irradiance map for the diffuse
-    vec3 irradiance = texture(gIrradiance, texCoord).rgb;
+    //evaluate the irradiance volume for the diffuse, or the probes around the fragment outside of it
+    vec3 irradiance = InsideVolume(worldFragPos) ? GetVolumeIrradiance(worldFragPos, N) : GetProbeIrradiance(worldFragPos, N);
     vec3 diffuse = irradiance * albedo;
 
     //sample from the prefilter map and the BRDF lut and combine the results
@@ -409,4 +427,90 @@ vec3 CalculateSpotLight(Light light, vec3 fragPos, vec3 V, vec3 N, vec3 F0, vec3
 
     //add to total outgoing radiance Lo
     return (kD * albedo / PI + specular) * radiance * NdotL * spotlightIntensity; //no need to multiply with kS, since it's already included in the BRDF
+}
+
+vec3 GetProbeIrradiance(vec3 fragPos, vec3 normal) {
+    //blend the two probes with the highest influence, it falls from 1 at the probe to 0 at the border of its box
+    int primaryProbe = -1;
+    int secondaryProbe = -1;
+    float primaryWeight = 0.0f;
+    float secondaryWeight = 0.0f;
+
+    int nearestProbe = -1;
+    float nearestDistance = 1e30f;
+
+    for(int i = 0; i < probeCount; i++) {
+        vec3 offset = abs(fragPos - probes[i].position.xyz) / max(probes[i].extents.xyz, vec3(0.001f));
+        float weight = 1.0f - max(offset.x, max(offset.y, offset.z));
+
+        if(weight > primaryWeight) {
+            secondaryProbe = primaryProbe;
+            secondaryWeight = primaryWeight;
+
+            primaryProbe = i;
+            primaryWeight = weight;
+        } else if(weight > secondaryWeight) {
+            secondaryProbe = i;
+            secondaryWeight = weight;
+        }
+
+        vec3 toProbe = fragPos - probes[i].position.xyz;
+        float distance = dot(toProbe, toProbe);
+
+        if(distance < nearestDistance) {
+            nearestProbe = i;
+            nearestDistance = distance;
+        }
+    }
+
+    if(primaryProbe < 0) return (nearestProbe < 0) ? vec3(0.0f) : GetIrradiance(nearestProbe, normal); //outside of every influence box
+
+    vec3 irradiance = GetIrradiance(primaryProbe, normal);
+    if(secondaryProbe >= 0) irradiance = mix(irradiance, GetIrradiance(secondaryProbe, normal), secondaryWeight / (primaryWeight + secondaryWeight));
+
+    return irradiance;
+}
+
+vec3 GetIrradiance(int probe, vec3 normal) {
+    //evaluate the spherical harmonics, the cosine lobe is already convolved into them
+    vec3 n = normalize(normal);
+    ReflectionProbe p = probes[probe];
+
+    vec3 irradiance = p.irradiance[0].rgb * 0.282095f;
+    irradiance += p.irradiance[1].rgb * 0.488603f * n.y;
+    irradiance += p.irradiance[2].rgb * 0.488603f * n.z;
+    irradiance += p.irradiance[3].rgb * 0.488603f * n.x;
+    irradiance += p.irradiance[4].rgb * 1.092548f * n.x * n.y;
+    irradiance += p.irradiance[5].rgb * 1.092548f * n.y * n.z;
+    irradiance += p.irradiance[6].rgb * 0.315392f * (3.0f * n.z * n.z - 1.0f);
+    irradiance += p.irradiance[7].rgb * 1.092548f * n.x * n.z;
+    irradiance += p.irradiance[8].rgb * 0.546274f * (n.x * n.x - n.y * n.y);
+
+    return max(irradiance, 0.0f);
+}
+
+bool InsideVolume(vec3 fragPos) {
+    if(volumeMin.w < 0.5f) return false;
+
+    vec3 cell = (fragPos - volumeMin.xyz) / volumeSpacing.xyz;
+    vec3 size = vec3(textureSize(irradianceVolume[0], 0));
+
+    return all(greaterThanEqual(cell, vec3(0.0f))) && all(lessThanEqual(cell, size - 1.0f));
+}
+
+vec3 GetVolumeIrradiance(vec3 fragPos, vec3 normal) {
+    //trilinear interpolation between the eight surrounding grid probes, the texel centers sit on the probes
+    vec3 size = vec3(textureSize(irradianceVolume[0], 0));
+    vec3 uvw = ((fragPos - volumeMin.xyz) / volumeSpacing.xyz + 0.5f) / size;
+
+    //the l1 harmonics of each color channel are stored in one texture, the cosine lobe is already convolved into them
+    vec3 n = normalize(normal);
+    vec4 basis = vec4(0.282095f, 0.488603f * n.y, 0.488603f * n.z, 0.488603f * n.x);
+
+    vec3 irradiance;
+    irradiance.r = dot(texture(irradianceVolume[0], uvw), basis);
+    irradiance.g = dot(texture(irradianceVolume[1], uvw), basis);
+    irradiance.b = dot(texture(irradianceVolume[2], uvw), basis);
+
+    return max(irradiance, 0.0f);
 }
\ No newline at end of file
@@ -1,10 +1,11 @@
 #version 460 core
 
 const float PI = 3.14159265359f;
-const uint SAMPLES = 1024u;
 
 in vec2 texCoord;
 
+uniform int sampleCount; //matches the cpu integration the lookup texture is cooked with
+
 out vec2 fragColor;
 
 float RadicalInverse_VdC(uint bits);
@@ -88,9 +89,11 @@ vec2 IntegrateBRDF(float NdotV, float roughness) {
 
     vec3 N = vec3(0.0f, 0.0f, 1.0f);
     
-    for(uint i = 0u; i < SAMPLES; i++) {
+    uint samples = uint(sampleCount);
+
+    for(uint i = 0u; i < samples; i++) {
         //generates a sample vector biased towards the preferred alignment direction (importance sampling)
-        vec2 Xi = Hammersley(i, SAMPLES);
+        vec2 Xi = Hammersley(i, samples);
         vec3 H = ImportanceSampleGGX(Xi, N, roughness);
         vec3 L = normalize(2.0f * dot(V, H) * H - V);
 
@@ -108,8 +111,8 @@ vec2 IntegrateBRDF(float NdotV, float roughness) {
         }
     }
 
-    A /= float(SAMPLES);
-    B /= float(SAMPLES);
+    A /= float(samples);
+    B /= float(samples);
     
     return vec2(A, B);
 }
\ No newline at end of file
@@ -4,16 +4,19 @@
 #include "../Scenes/DemoScene1.h"
 #include "../Scenes/DemoScene2.h"
 #include "../Scenes/DemoScene3.h"
+#include "../Scenes/BinaryScene.h"
 
 #include "../Engine/SceneManager.h"
 
+#include "../Utility/Filepath.h"
+
 int main() {
 	SceneManager* sceneManager = new SceneManager();
 
-	//add all scenes to the manager
-	sceneManager->addScene(new DemoScene1());
-	sceneManager->addScene(new DemoScene2());
-	sceneManager->addScene(new DemoScene3());
+	//add all scenes to the manager, the demo scenes are only built in code until their scene files exist
+	sceneManager->addScene(new BinaryScene(Filepath::ScenePath + "demo1.scene", new DemoScene1()));
+	sceneManager->addScene(new BinaryScene(Filepath::ScenePath + "demo2.scene", new DemoScene2()));
+	sceneManager->addScene(new BinaryScene(Filepath::ScenePath + "demo3.scene", new DemoScene3()));
 
 	//initialize manager with scene 0
 	sceneManager->initialize(0);
@@ -3,13 +3,15 @@
 #include "../Engine/Material.h"
 #include "../Engine/Model.h"
 #include "../Engine/Node.h"
+#include "../Engine/AssetManager.h"
 
-RenderComponent::RenderComponent(Model * model, Material * material):Component(ComponentType::Render), model(model), material(material) {
+RenderComponent::RenderComponent(Model * model, Material * material):Component(ComponentType::Render), model(model), material(material), lodLevel(0) {
+	AssetManager::Retain(model); //models can be shared between render components
 }
 
 RenderComponent::~RenderComponent() {
 	delete material;
-	delete model;
+	AssetManager::Release(model);
 }
 
 void RenderComponent::update() {
@@ -15,6 +15,8 @@ class RenderComponent : public Component {
 		Model* model;
 		Material* material;
 
+		unsigned int lodLevel; //detail level selected for the main camera
+
 		virtual void update();
 
 };
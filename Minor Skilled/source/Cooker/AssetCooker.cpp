@@ -0,0 +1,254 @@
+#include "AssetCooker.h"
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "../Engine/Window.h"
+#include "../Engine/Renderer.h"
+#include "../Engine/Model.h"
+#include "../Engine/Texture.h"
+#include "../Engine/JobSystem.h"
+#include "../Engine/Uploader.h"
+#include "../Engine/MeshCache.h"
+#include "../Engine/TextureCache.h"
+#include "../Engine/EnvironmentCache.h"
+
+#include "../Utility/Filepath.h"
+#include "../Utility/MappedFile.h"
+#include "../Utility/Math.h"
+#include "../Utility/RenderSettings.h"
+
+const std::string AssetCooker::_ManifestName = "cook.manifest";
+
+AssetCooker::AssetCooker(std::string assetPath) : _assetPath(assetPath), _renderer(nullptr), _manifest(_HashSettings()) {
+	JobSystem::Initialize();
+
+	_window = new Window(1, 1, 0, 0, "GraphX Asset Cooker", false);
+	Uploader::Initialize(); //needs the context of the window
+
+	Filepath::MakeDirectory(Filepath::CachePath);
+	_manifest.load(Filepath::CachePath + _ManifestName);
+}
+
+AssetCooker::~AssetCooker() {
+	delete _renderer;
+
+	Uploader::Shutdown();
+	delete _window;
+
+	JobSystem::Shutdown();
+}
+
+unsigned int AssetCooker::cook(bool force) {
+	std::vector<std::string> files;
+	Filepath::ListFiles(_assetPath, files);
+	std::sort(files.begin(), files.end());
+
+	//find the inputs whose content, dependencies or outputs changed since the last cook
+	std::vector<CookRecord> records;
+	std::vector<AssetKind> kinds;
+	unsigned int upToDate = 0;
+
+	for(unsigned int i = 0; i < files.size(); i++) {
+		AssetKind kind = _GetKind(files[i]);
+		if(kind == AssetKind::None) continue;
+
+		CookRecord record;
+		record.path = files[i];
+
+		if(!_HashFile(record.path, record.hash)) continue;
+
+		_getDependencies(record, kind);
+		_getOutputs(record, kind);
+
+		if(!force && _manifest.isUpToDate(record)) {
+			upToDate++;
+			continue;
+		}
+
+		//the engine caches would accept outputs that are still valid for the source file, remove them to really cook again
+		for(unsigned int j = 0; j < record.outputs.size(); j++) {
+			std::remove(record.outputs[j].c_str());
+		}
+
+		records.push_back(record);
+		kinds.push_back(kind);
+	}
+
+	//inputs that were deleted do not need to be tracked anymore
+	std::vector<std::string> paths = _manifest.getPaths();
+
+	for(unsigned int i = 0; i < paths.size(); i++) {
+		if(!std::binary_search(files.begin(), files.end(), paths[i])) _manifest.remove(paths[i]);
+	}
+
+	std::cout << "Cooking " << records.size() << " assets, " << upToDate << " up to date" << std::endl;
+
+	//textures only need the cpu, they are decoded and compressed on the workers while the main thread imports the models
+	std::vector<char> cooked(records.size(), 0);
+	JobCounter textureCounter;
+
+	for(unsigned int i = 0; i < records.size(); i++) {
+		if(kinds[i] != AssetKind::Texture) continue;
+
+		std::string path = records[i].path;
+		bool sRGB = !_IsLinear(path);
+		char* result = &cooked[i];
+
+		JobSystem::Schedule([path, sRGB, result]() {
+			CompressedImage image;
+			*result = Texture::CookTexture(path, sRGB, image) ? 1 : 0;
+		}, &textureCounter);
+	}
+
+	//mesh buffers and the skybox conversion need the context
+	for(unsigned int i = 0; i < records.size(); i++) {
+		if(kinds[i] == AssetKind::Model) cooked[i] = _cookModel(records[i].path) ? 1 : 0;
+		else if(kinds[i] == AssetKind::Skybox) cooked[i] = _cookSkybox(records[i].path) ? 1 : 0;
+	}
+
+	JobSystem::Wait(&textureCounter);
+
+	//only successful cooks are recorded, failed inputs are tried again next time
+	unsigned int failed = 0;
+
+	for(unsigned int i = 0; i < records.size(); i++) {
+		if(cooked[i]) {
+			std::cout << "Cooked " + records[i].path << std::endl;
+			_manifest.update(records[i]);
+		} else {
+			std::cout << "ERROR: Unable to cook " + records[i].path << std::endl;
+			_manifest.remove(records[i].path);
+			failed++;
+		}
+	}
+
+	_manifest.write(Filepath::CachePath + _ManifestName);
+
+	return failed;
+}
+
+void AssetCooker::_getDependencies(CookRecord& record, AssetKind kind) {
+	std::vector<std::string> dependencies;
+
+	if(kind == AssetKind::Model) {
+		//material libraries of wavefront files are read by the import as well
+		std::string extension = record.path.substr(record.path.find_last_of('.') + 1);
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+		if(extension == "obj") {
+			std::ifstream file(record.path);
+			std::string directory = record.path.substr(0, record.path.find_last_of('/') + 1);
+			std::string line;
+
+			while(std::getline(file, line)) {
+				if(line.compare(0, 7, "mtllib ") != 0) continue;
+
+				std::string name = line.substr(7);
+				name.erase(name.find_last_not_of(" \t\r") + 1);
+
+				dependencies.push_back(directory + name);
+			}
+		}
+	} else if(kind == AssetKind::Skybox) {
+		//the conversion renders with these shaders
+		dependencies.push_back(Filepath::ShaderPath + "skybox shader/cube.vs");
+		dependencies.push_back(Filepath::ShaderPath + "skybox shader/equiToCube.fs");
+	}
+
+	for(unsigned int i = 0; i < dependencies.size(); i++) {
+		unsigned long long hash = 0; //missing dependencies are recorded too, so their creation triggers a cook
+
+		_HashFile(dependencies[i], hash);
+		record.dependencies.push_back(std::make_pair(dependencies[i], hash));
+	}
+}
+
+void AssetCooker::_getOutputs(CookRecord& record, AssetKind kind) {
+	if(kind == AssetKind::Model) record.outputs.push_back(MeshCache::GetCachePath(record.path));
+	else if(kind == AssetKind::Texture) record.outputs.push_back(TextureCache::GetCachePath(record.path, !_IsLinear(record.path)));
+	else if(kind == AssetKind::Skybox) record.outputs.push_back(EnvironmentCache::GetCachePath(record.path));
+}
+
+bool AssetCooker::_cookModel(std::string path) {
+	//the import writes the mesh cache on its own
+	Model* model = Model::LoadModel(path);
+	if(model == nullptr) return false;
+
+	delete model;
+
+	unsigned long long modificationTime, fileSize;
+	return Filepath::GetFileStats(MeshCache::GetCachePath(path), modificationTime, fileSize);
+}
+
+bool AssetCooker::_cookSkybox(std::string path) {
+	Texture* equirectangular = Texture::LoadHDR(path);
+	if(equirectangular == nullptr) return false;
+
+	if(_renderer == nullptr) _renderer = new Renderer(nullptr);
+
+	Texture* skybox = _renderer->convertEquiToCube(equirectangular); //deletes the equirectangular texture
+	EnvironmentCache::Write(path, skybox, RenderSettings::SkyboxWidth);
+
+	delete skybox;
+
+	unsigned long long modificationTime, fileSize;
+	return Filepath::GetFileStats(EnvironmentCache::GetCachePath(path), modificationTime, fileSize);
+}
+
+AssetCooker::AssetKind AssetCooker::_GetKind(std::string path) {
+	//the caches and shaders are no inputs
+	if(path.compare(0, Filepath::CachePath.size(), Filepath::CachePath) == 0) return AssetKind::None;
+	if(path.compare(0, Filepath::ShaderPath.size(), Filepath::ShaderPath) == 0) return AssetKind::None;
+
+	std::string extension = path.substr(path.find_last_of('.') + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+	if(extension == "hdr") return AssetKind::Skybox;
+	if(path.compare(0, Filepath::SkyboxPath.size(), Filepath::SkyboxPath) == 0) return AssetKind::None; //cubemap faces are loaded as they are
+
+	if(extension == "obj" || extension == "fbx" || extension == "dae" || extension == "3ds" || extension == "blend") return AssetKind::Model;
+	if(extension == "png" || extension == "jpg" || extension == "jpeg" || extension == "tga" || extension == "bmp") return AssetKind::Texture;
+
+	return AssetKind::None;
+}
+
+bool AssetCooker::_IsLinear(std::string path) {
+	//the scenes pick the color space per material slot, the cooker guesses it from the usual names of data textures
+	std::string name = path.substr(path.find_last_of('/') + 1);
+	std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+	const char* linearNames[] = { "normal", "nrm", "_n.", "_s.", "spec", "gloss", "rough", "metal", "_ao", "occlusion", "height", "displacement" };
+
+	for(unsigned int i = 0; i < sizeof(linearNames) / sizeof(linearNames[0]); i++) {
+		if(name.find(linearNames[i]) != std::string::npos) return true;
+	}
+
+	return false;
+}
+
+bool AssetCooker::_HashFile(std::string path, unsigned long long& hash) {
+	MappedFile file(path);
+	if(!file.isOpen()) return false;
+
+	hash = file.getHash();
+	return true;
+}
+
+unsigned long long AssetCooker::_HashSettings() {
+	//settings the cooked files depend on, changing them cooks everything again
+	//a new cache version makes the loaders reject the old files, so it has to cook them again as well
+	unsigned int settings[] = {
+		RenderSettings::SkyboxWidth, RenderSettings::SkyboxHeight,
+		MeshCache::GetVersion(), TextureCache::GetVersion(), EnvironmentCache::GetVersion()
+	};
+
+	return Math::Hash(settings, sizeof(settings));
+}
\ No newline at end of file
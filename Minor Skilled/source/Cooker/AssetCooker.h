@@ -0,0 +1,49 @@
+#ifndef ASSETCOOKER_H
+#define ASSETCOOKER_H
+
+#include <string>
+#include <vector>
+
+#include "../Cooker/CookManifest.h"
+
+class Window;
+class Renderer;
+
+//writes the runtime caches of an asset directory ahead of time, the engine loads them instead of the source files
+class AssetCooker {
+	public:
+		AssetCooker(std::string assetPath);
+		~AssetCooker();
+
+		unsigned int cook(bool force); //returns the number of inputs that failed
+
+	private:
+		enum class AssetKind {
+			None,
+			Model,
+			Texture,
+			Skybox
+		};
+
+		static const std::string _ManifestName;
+
+		std::string _assetPath;
+
+		Window* _window; //invisible, only provides the context for the mesh buffers and the skybox conversion
+		Renderer* _renderer; //created for the first skybox
+
+		CookManifest _manifest;
+
+		void _getDependencies(CookRecord& record, AssetKind kind);
+		void _getOutputs(CookRecord& record, AssetKind kind);
+
+		bool _cookModel(std::string path);
+		bool _cookSkybox(std::string path);
+
+		static AssetKind _GetKind(std::string path);
+		static bool _IsLinear(std::string path);
+		static bool _HashFile(std::string path, unsigned long long& hash);
+		static unsigned long long _HashSettings();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include "CookManifest.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <cctype>
+
+#include "../Utility/Filepath.h"
+
+const unsigned int CookManifest::_Version = 1; //increase whenever one of the caches changes its layout
+
+CookManifest::CookManifest(unsigned long long settingsHash): _settingsHash(settingsHash) {
+}
+
+bool CookManifest::load(std::string path) {
+	std::ifstream file(path);
+	if(!file.is_open()) return false;
+
+	//one tab separated entry per line, dependencies and outputs belong to the asset above them
+	std::string line;
+	CookRecord* record = nullptr;
+	bool versioned = false;
+
+	while(std::getline(file, line)) {
+		std::vector<std::string> fields;
+		std::stringstream stream(line);
+		std::string field;
+
+		while(std::getline(stream, field, '\t')) {
+			fields.push_back(field);
+		}
+
+		if(fields.size() < 2) continue;
+
+		//a broken line (e.g. after an interrupted copy or a hand edit) makes the whole manifest stale, everything is cooked again
+		unsigned long long value = 0;
+
+		if(fields[0] == "version") {
+			unsigned long long settingsHash = 0;
+			bool valid = _ParseHex(fields[1], value) && (fields.size() < 3 || _ParseHex(fields[2], settingsHash));
+
+			if(!valid || value != _Version || settingsHash != _settingsHash) {
+				_records.clear();
+				return false;
+			}
+
+			versioned = true;
+		} else if(!versioned) {
+			_records.clear();
+			return false;
+		} else if(fields[0] == "asset" && fields.size() == 3) {
+			if(!_ParseHex(fields[2], value)) {
+				_records.clear();
+				return false;
+			}
+
+			record = &_records[fields[1]];
+			record->path = fields[1];
+			record->hash = value;
+		} else if(fields[0] == "dependency" && fields.size() == 3 && record != nullptr) {
+			if(!_ParseHex(fields[2], value)) {
+				_records.clear();
+				return false;
+			}
+
+			record->dependencies.push_back(std::make_pair(fields[1], value));
+		} else if(fields[0] == "output" && record != nullptr) {
+			record->outputs.push_back(fields[1]);
+		}
+	}
+
+	return true;
+}
+
+bool CookManifest::write(std::string path) {
+	//write into a temporary file first, so an interrupted write never leaves a broken manifest behind
+	std::string tempPath = path + ".tmp";
+	std::ofstream file(tempPath, std::ios::trunc);
+
+	if(!file.is_open()) {
+		std::cout << "ERROR: Unable to write the cook manifest " + path << std::endl;
+		return false;
+	}
+
+	file << std::hex;
+	file << "version\t" << _Version << "\t" << _settingsHash << "\n";
+
+	for(auto it = _records.begin(); it != _records.end(); it++) {
+		CookRecord& record = it->second;
+		file << "asset\t" << record.path << "\t" << record.hash << "\n";
+
+		for(unsigned int i = 0; i < record.dependencies.size(); i++) {
+			file << "dependency\t" << record.dependencies[i].first << "\t" << record.dependencies[i].second << "\n";
+		}
+
+		for(unsigned int i = 0; i < record.outputs.size(); i++) {
+			file << "output\t" << record.outputs[i] << "\n";
+		}
+	}
+
+	file.close();
+
+	if(file.fail()) {
+		std::cout << "ERROR: Unable to write the cook manifest " + path << std::endl;
+		std::remove(tempPath.c_str());
+		return false;
+	}
+
+	std::remove(path.c_str());
+	std::rename(tempPath.c_str(), path.c_str());
+
+	return true;
+}
+
+bool CookManifest::isUpToDate(const CookRecord& record) {
+	auto it = _records.find(record.path);
+	if(it == _records.end()) return false;
+
+	CookRecord& cooked = it->second;
+	if(cooked.hash != record.hash || cooked.dependencies != record.dependencies) return false;
+
+	//deleted cache files are cooked again
+	for(unsigned int i = 0; i < cooked.outputs.size(); i++) {
+		unsigned long long modificationTime, fileSize;
+		if(!Filepath::GetFileStats(cooked.outputs[i], modificationTime, fileSize)) return false;
+	}
+
+	return true;
+}
+
+void CookManifest::update(const CookRecord& record) {
+	_records[record.path] = record;
+}
+
+void CookManifest::remove(std::string path) {
+	_records.erase(path);
+}
+
+std::vector<std::string> CookManifest::getPaths() {
+	std::vector<std::string> paths;
+	paths.reserve(_records.size());
+
+	for(auto it = _records.begin(); it != _records.end(); it++) {
+		paths.push_back(it->first);
+	}
+
+	return paths;
+}
+
+bool CookManifest::_ParseHex(const std::string& text, unsigned long long& value) {
+	//strtoull would also skip whitespace and accept a sign
+	if(text.empty() || !std::isxdigit((unsigned char)text[0])) return false;
+
+	char* end = nullptr;
+	errno = 0;
+	value = std::strtoull(text.c_str(), &end, 16);
+
+	return errno == 0 && end == text.c_str() + text.size();
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef COOKMANIFEST_H
+#define COOKMANIFEST_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+//content hashes of every cooked input and the files it depends on, an input is only cooked again when one of them changes
+struct CookRecord {
+	std::string path;
+	unsigned long long hash;
+
+	std::vector<std::pair<std::string, unsigned long long>> dependencies; //path and content hash
+	std::vector<std::string> outputs; //cache files written for the input
+};
+
+class CookManifest {
+	public:
+		CookManifest(unsigned long long settingsHash); //records made with other settings are dropped on load
+
+		bool load(std::string path);
+		bool write(std::string path);
+
+		bool isUpToDate(const CookRecord& record); //same hashes and all outputs still exist
+		void update(const CookRecord& record);
+		void remove(std::string path);
+
+		std::vector<std::string> getPaths();
+
+	private:
+		static const unsigned int _Version;
+
+		unsigned long long _settingsHash;
+		std::map<std::string, CookRecord> _records; //sorted, keeps the manifest diffable
+
+		static bool _ParseHex(const std::string& text, unsigned long long& value); //false unless the whole text is a hex number
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include <iostream>
+#include <string>
+
+#include "../Cooker/AssetCooker.h"
+
+#include "../Utility/Filepath.h"
+
+//usage: AssetCooker [asset directory] [--force], run from the project directory like the engine
+int main(int argc, char* argv[]) {
+	std::string assetPath = "assets/";
+	bool force = false;
+
+	for(int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+
+		if(argument == "--force") force = true;
+		else assetPath = argument;
+	}
+
+	std::cout << "---Cooking " + assetPath + "---" << std::endl;
+
+	AssetCooker* cooker = new AssetCooker(assetPath);
+	unsigned int failed = cooker->cook(force);
+	delete cooker;
+
+	std::cout << "---Cooking finished, " << failed << " failed---" << std::endl;
+
+	return failed > 0 ? 1 : 0;
+}
\ No newline at end of file
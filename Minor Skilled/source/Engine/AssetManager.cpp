@@ -0,0 +1,204 @@
+#include "AssetManager.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+#include "../Engine/Model.h"
+#include "../Engine/Texture.h"
+
+#include "../Utility/Filepath.h"
+
+std::unordered_map<std::string, AssetManager::Asset*> AssetManager::_Assets;
+std::unordered_map<const void*, AssetManager::Asset*> AssetManager::_Owners;
+
+Model* AssetManager::LoadModel(std::string path) {
+	std::string key = "model:" + Filepath::GetCanonicalPath(path);
+
+	Asset* asset = _Find(key);
+	if(asset != nullptr) return asset->model;
+
+	Model* model = Model::LoadModelAsync(path); //imported on the workers, see Model::UpdateLoads
+
+	return _Register(key, model, nullptr)->model;
+}
+
+Texture* AssetManager::LoadTexture(std::string path, TextureFilter filter, bool sRGB) {
+	//the same image loaded with different options results in a different texture
+	std::string key = "texture:" + Filepath::GetCanonicalPath(path) + "|filter=" + std::to_string((int)filter) + "|srgb=" + std::to_string((int)sRGB);
+
+	Asset* asset = _Find(key);
+	if(asset != nullptr) return asset->texture;
+
+	Texture* texture = Texture::LoadTextureAsync(path, filter, sRGB); //decoded on the workers, see Texture::FinishLoads
+
+	asset = _Register(key, nullptr, texture);
+	asset->filter = filter;
+	asset->sRGB = sRGB;
+
+	return asset->texture;
+}
+
+void AssetManager::Retain(Model* model) {
+	_Retain(model, model, nullptr);
+}
+
+void AssetManager::Retain(Texture* texture) {
+	_Retain(texture, nullptr, texture);
+}
+
+void AssetManager::Release(Model* model) {
+	_Release(model);
+}
+
+void AssetManager::Release(Texture* texture) {
+	_Release(texture);
+}
+
+bool AssetManager::GetTextureOptions(Texture* texture, TextureFilter& filter, bool& sRGB) {
+	auto it = _Owners.find(texture);
+	if(it == _Owners.end() || it->second->key.empty()) return false;
+
+	filter = it->second->filter;
+	sRGB = it->second->sRGB;
+
+	return true;
+}
+
+void AssetManager::PurgeUnused() {
+	//registered assets without owners are kept until here, so the next scene can pick them up again
+	std::vector<Asset*> unused;
+
+	for(auto it = _Assets.begin(); it != _Assets.end(); it++) {
+		if(it->second->references == 0) unused.push_back(it->second);
+	}
+
+	for(unsigned int i = 0; i < unused.size(); i++) {
+		_Delete(unused[i]);
+	}
+}
+
+void AssetManager::Clear() {
+	std::vector<Asset*> assets;
+
+	for(auto it = _Owners.begin(); it != _Owners.end(); it++) {
+		assets.push_back(it->second);
+	}
+
+	for(unsigned int i = 0; i < assets.size(); i++) {
+		_Delete(assets[i]);
+	}
+}
+
+std::vector<AssetInfo> AssetManager::GetAssetInfos() {
+	std::vector<AssetInfo> infos;
+
+	for(auto it = _Owners.begin(); it != _Owners.end(); it++) {
+		AssetInfo info;
+		info.key = it->second->key.empty() ? "unregistered" : it->second->key;
+		info.references = it->second->references;
+		info.memory = _GetMemory(it->second);
+
+		infos.push_back(info);
+	}
+
+	//largest first
+	std::sort(infos.begin(), infos.end(), [](const AssetInfo& a, const AssetInfo& b) { return a.memory > b.memory; });
+
+	return infos;
+}
+
+unsigned long long AssetManager::GetResidentMemory() {
+	unsigned long long memory = 0;
+
+	for(auto it = _Owners.begin(); it != _Owners.end(); it++) {
+		memory += _GetMemory(it->second);
+	}
+
+	return memory;
+}
+
+void AssetManager::PrintReport() {
+	std::vector<AssetInfo> infos = GetAssetInfos();
+	unsigned long long totalMemory = 0;
+
+	std::cout << "Resident assets:" << std::endl;
+
+	for(unsigned int i = 0; i < infos.size(); i++) {
+		std::cout << std::setw(10) << infos[i].memory / 1024 << " KB  " << std::setw(3) << infos[i].references << " refs  " << infos[i].key << std::endl;
+		totalMemory += infos[i].memory;
+	}
+
+	std::cout << infos.size() << " assets, " << totalMemory / (1024 * 1024) << " MB" << std::endl;
+}
+
+AssetManager::Asset* AssetManager::_Find(std::string key) {
+	auto it = _Assets.find(key);
+	if(it == _Assets.end()) return nullptr;
+
+	return it->second;
+}
+
+AssetManager::Asset* AssetManager::_Register(std::string key, Model* model, Texture* texture) {
+	Asset* asset = new Asset();
+	asset->key = key;
+	asset->model = model;
+	asset->texture = texture;
+	asset->references = 0; //the first owner retains it
+	asset->filter = TextureFilter::Repeat;
+	asset->sRGB = false;
+
+	if(!key.empty()) _Assets[key] = asset;
+
+	if(model != nullptr) _Owners[model] = asset;
+	else _Owners[texture] = asset;
+
+	return asset;
+}
+
+void AssetManager::_Retain(const void* pointer, Model* model, Texture* texture) {
+	if(pointer == nullptr) return;
+
+	//assets created without the registry are tracked from their first owner on, so they can still be shared safely
+	auto it = _Owners.find(pointer);
+	Asset* asset = (it != _Owners.end()) ? it->second : _Register("", model, texture);
+
+	asset->references++;
+}
+
+void AssetManager::_Release(const void* pointer) {
+	if(pointer == nullptr) return;
+
+	auto it = _Owners.find(pointer);
+
+	if(it == _Owners.end()) {
+		std::cout << "ERROR: Released an asset which was never retained" << std::endl;
+		return;
+	}
+
+	Asset* asset = it->second;
+
+	if(asset->references > 0) asset->references--;
+
+	//unregistered assets cannot be found by path again, so there is no reason to keep them
+	if(asset->references == 0 && asset->key.empty()) _Delete(asset);
+}
+
+void AssetManager::_Delete(Asset* asset) {
+	if(!asset->key.empty()) _Assets.erase(asset->key);
+
+	if(asset->model != nullptr) {
+		_Owners.erase(asset->model);
+		delete asset->model;
+	} else {
+		_Owners.erase(asset->texture);
+		delete asset->texture;
+	}
+
+	delete asset;
+}
+
+unsigned long long AssetManager::_GetMemory(Asset* asset) {
+	if(asset->model != nullptr) return asset->model->getMemorySize();
+	else return asset->texture->getMemorySize();
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#ifndef ASSETMANAGER_H
+#define ASSETMANAGER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "../Utility/TextureFilter.h"
+
+class Model;
+class Texture;
+
+struct AssetInfo {
+	std::string key;
+	unsigned int references;
+	unsigned long long memory; //resident gpu memory in bytes
+};
+
+//registry of shared models and textures, the same file with the same import options is only loaded once
+class AssetManager {
+	public:
+		static Model* LoadModel(std::string path);
+		static Texture* LoadTexture(std::string path, TextureFilter filter = TextureFilter::Repeat, bool sRGB = false);
+
+		//owners like render components and materials keep assets alive through these
+		static void Retain(Model* model);
+		static void Retain(Texture* texture);
+		static void Release(Model* model);
+		static void Release(Texture* texture);
+
+		//options a registered texture was loaded with, false for textures created outside of the registry
+		static bool GetTextureOptions(Texture* texture, TextureFilter& filter, bool& sRGB);
+
+		static void PurgeUnused();
+		static void Clear();
+
+		static std::vector<AssetInfo> GetAssetInfos();
+		static unsigned long long GetResidentMemory();
+		static void PrintReport();
+
+	private:
+		struct Asset {
+			std::string key; //empty for assets that were not loaded through the registry
+			Model* model;
+			Texture* texture;
+			unsigned int references;
+
+			TextureFilter filter;
+			bool sRGB;
+		};
+
+		static std::unordered_map<std::string, Asset*> _Assets;
+		static std::unordered_map<const void*, Asset*> _Owners; //asset of every tracked model and texture
+
+		static Asset* _Find(std::string key);
+		static Asset* _Register(std::string key, Model* model, Texture* texture);
+		static void _Retain(const void* pointer, Model* model, Texture* texture);
+		static void _Release(const void* pointer);
+		static void _Delete(Asset* asset);
+		static unsigned long long _GetMemory(Asset* asset);
+};
+
+#endif
\ No newline at end of file
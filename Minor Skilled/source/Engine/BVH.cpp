@@ -0,0 +1,377 @@
+#include "BVH.h"
+
+#include <algorithm>
+#include <queue>
+#include <limits>
+
+#include "../Engine/Node.h"
+
+#include "../Utility/Frustum.h"
+
+const unsigned int BVH::_MaxLeafItems = 4;
+const float BVH::_RebuildThreshold = 1.5f; //rebuild as soon as the refitted tree got 50% worse than the fresh one
+
+BVH::BVH(): _buildCost(0.0f) {
+}
+
+BVH::~BVH() {
+}
+
+void BVH::update(std::vector<Node*>& items, std::vector<AABB>& bounds) {
+	_itemBounds = bounds;
+
+	//rebuild if the set of items changed, otherwise refit the existing tree to the new bounds
+	if(items != _items) {
+		_items = items;
+		_build();
+		return;
+	}
+
+	if(_treeNodes.empty()) return;
+
+	float cost = _refit();
+
+	if(cost > _buildCost * _RebuildThreshold) _build(); //objects moved too much, the tree quality degraded
+}
+
+void BVH::clear() {
+	_treeNodes.clear();
+	_items.clear();
+	_itemBounds.clear();
+	_itemOrder.clear();
+
+	_buildCost = 0.0f;
+}
+
+unsigned int BVH::getItemCount() {
+	return _items.size();
+}
+
+AABB BVH::getBounds() {
+	if(_treeNodes.empty()) return AABB();
+
+	return _treeNodes[0].bounds;
+}
+
+void BVH::queryFrustum(const Frustum& frustum, std::vector<Node*>& result) {
+	if(_treeNodes.empty()) return;
+
+	std::vector<unsigned int> stack;
+	stack.push_back(0);
+
+	while(!stack.empty()) {
+		unsigned int nodeIndex = stack.back();
+		stack.pop_back();
+
+		TreeNode& treeNode = _treeNodes[nodeIndex];
+
+		if(!frustum.intersects(treeNode.bounds)) continue;
+
+		if(frustum.contains(treeNode.bounds)) {
+			_collectItems(nodeIndex, result); //no need to test anything below this node
+			continue;
+		}
+
+		if(treeNode.itemCount > 0) {
+			for(unsigned int i = 0; i < treeNode.itemCount; i++) {
+				unsigned int item = _itemOrder[treeNode.firstItem + i];
+
+				if(frustum.intersects(_itemBounds[item])) result.push_back(_items[item]);
+			}
+		} else {
+			stack.push_back(treeNode.left);
+			stack.push_back(treeNode.left + 1);
+		}
+	}
+}
+
+void BVH::querySphere(glm::vec3 center, float radius, std::vector<Node*>& result) {
+	if(_treeNodes.empty()) return;
+
+	std::vector<unsigned int> stack;
+	stack.push_back(0);
+
+	while(!stack.empty()) {
+		unsigned int nodeIndex = stack.back();
+		stack.pop_back();
+
+		TreeNode& treeNode = _treeNodes[nodeIndex];
+
+		if(!treeNode.bounds.intersectsSphere(center, radius)) continue;
+
+		if(treeNode.itemCount > 0) {
+			for(unsigned int i = 0; i < treeNode.itemCount; i++) {
+				unsigned int item = _itemOrder[treeNode.firstItem + i];
+
+				if(_itemBounds[item].intersectsSphere(center, radius)) result.push_back(_items[item]);
+			}
+		} else {
+			stack.push_back(treeNode.left);
+			stack.push_back(treeNode.left + 1);
+		}
+	}
+}
+
+void BVH::queryNearest(glm::vec3 point, unsigned int count, std::vector<Node*>& result) {
+	if(_treeNodes.empty() || count == 0) return;
+
+	//best first search, nodes are visited in order of their distance to the point
+	typedef std::pair<float, unsigned int> Entry;
+
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> nodeQueue;
+	std::priority_queue<Entry> nearestItems; //max heap, the farthest of the current candidates is on top
+
+	nodeQueue.push(Entry(_treeNodes[0].bounds.getDistance2(point), 0));
+
+	while(!nodeQueue.empty()) {
+		Entry entry = nodeQueue.top();
+		nodeQueue.pop();
+
+		if(nearestItems.size() == count && entry.first > nearestItems.top().first) break; //every remaining node is farther away
+
+		TreeNode& treeNode = _treeNodes[entry.second];
+
+		if(treeNode.itemCount > 0) {
+			for(unsigned int i = 0; i < treeNode.itemCount; i++) {
+				unsigned int item = _itemOrder[treeNode.firstItem + i];
+				float distance = _itemBounds[item].getDistance2(point);
+
+				if(nearestItems.size() < count) {
+					nearestItems.push(Entry(distance, item));
+				} else if(distance < nearestItems.top().first) {
+					nearestItems.pop();
+					nearestItems.push(Entry(distance, item));
+				}
+			}
+		} else {
+			nodeQueue.push(Entry(_treeNodes[treeNode.left].bounds.getDistance2(point), treeNode.left));
+			nodeQueue.push(Entry(_treeNodes[treeNode.left + 1].bounds.getDistance2(point), treeNode.left + 1));
+		}
+	}
+
+	//closest item first
+	unsigned int start = result.size();
+	result.resize(start + nearestItems.size());
+
+	for(unsigned int i = result.size(); i > start; i--) {
+		result[i - 1] = _items[nearestItems.top().second];
+		nearestItems.pop();
+	}
+}
+
+Node* BVH::raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance, float& distance) {
+	if(_treeNodes.empty()) return nullptr;
+
+	glm::vec3 inverseDirection = 1.0f / direction;
+
+	Node* closestItem = nullptr;
+	float closestDistance = maxDistance;
+	float hitDistance;
+
+	std::vector<unsigned int> stack;
+	stack.push_back(0);
+
+	while(!stack.empty()) {
+		unsigned int nodeIndex = stack.back();
+		stack.pop_back();
+
+		TreeNode& treeNode = _treeNodes[nodeIndex];
+
+		if(!treeNode.bounds.intersectsRay(origin, inverseDirection, closestDistance, hitDistance)) continue;
+
+		if(treeNode.itemCount > 0) {
+			for(unsigned int i = 0; i < treeNode.itemCount; i++) {
+				unsigned int item = _itemOrder[treeNode.firstItem + i];
+
+				if(_itemBounds[item].intersectsRay(origin, inverseDirection, closestDistance, hitDistance)) {
+					closestItem = _items[item];
+					closestDistance = hitDistance;
+				}
+			}
+		} else {
+			stack.push_back(treeNode.left);
+			stack.push_back(treeNode.left + 1);
+		}
+	}
+
+	distance = closestDistance;
+	return closestItem;
+}
+
+void BVH::_build() {
+	_treeNodes.clear();
+	_itemOrder.resize(_items.size());
+
+	for(unsigned int i = 0; i < _itemOrder.size(); i++) {
+		_itemOrder[i] = i;
+	}
+
+	if(_items.empty()) {
+		_buildCost = 0.0f;
+		return;
+	}
+
+	_treeNodes.reserve(2 * _items.size());
+	_treeNodes.push_back(TreeNode());
+
+	_buildRecursive(0, 0, _items.size());
+
+	_buildCost = _refit();
+}
+
+void BVH::_buildRecursive(unsigned int nodeIndex, unsigned int first, unsigned int count) {
+	AABB bounds;
+	AABB centroidBounds;
+
+	for(unsigned int i = 0; i < count; i++) {
+		AABB& itemBounds = _itemBounds[_itemOrder[first + i]];
+
+		bounds.expand(itemBounds);
+		centroidBounds.expand(itemBounds.getCenter());
+	}
+
+	_treeNodes[nodeIndex].bounds = bounds;
+	_treeNodes[nodeIndex].firstItem = first;
+	_treeNodes[nodeIndex].itemCount = count;
+	_treeNodes[nodeIndex].left = 0;
+
+	if(count <= 1) return;
+
+	//find the cheapest binned split over all three axes
+	float leafCost = (float)count;
+	float bestCost = std::numeric_limits<float>::max();
+	int bestAxis = -1;
+	unsigned int bestSplit = 0;
+
+	glm::vec3 centroidExtents = centroidBounds.max - centroidBounds.min;
+	float parentArea = bounds.getSurfaceArea();
+
+	if(parentArea <= 0.0f) parentArea = 1.0f; //degenerate boxes (e.g. point lights), every split costs the same
+
+	for(int axis = 0; axis < 3; axis++) {
+		if(centroidExtents[axis] <= 0.0f) continue;
+
+		AABB binBounds[_BinCount];
+		unsigned int binCounts[_BinCount] = {0};
+		float binScale = _BinCount / centroidExtents[axis];
+
+		for(unsigned int i = 0; i < count; i++) {
+			AABB& itemBounds = _itemBounds[_itemOrder[first + i]];
+			unsigned int bin = std::min((unsigned int)((itemBounds.getCenter()[axis] - centroidBounds.min[axis]) * binScale), _BinCount - 1);
+
+			binBounds[bin].expand(itemBounds);
+			binCounts[bin]++;
+		}
+
+		//sweep from the right to get the cost of every right side
+		float rightAreas[_BinCount];
+		unsigned int rightCounts[_BinCount];
+		AABB rightBounds;
+		unsigned int rightCount = 0;
+
+		for(unsigned int i = _BinCount - 1; i > 0; i--) {
+			rightBounds.expand(binBounds[i]);
+			rightCount += binCounts[i];
+
+			rightAreas[i] = rightBounds.getSurfaceArea();
+			rightCounts[i] = rightCount;
+		}
+
+		AABB leftBounds;
+		unsigned int leftCount = 0;
+
+		for(unsigned int i = 1; i < _BinCount; i++) {
+			leftBounds.expand(binBounds[i - 1]);
+			leftCount += binCounts[i - 1];
+
+			if(leftCount == 0 || rightCounts[i] == 0) continue;
+
+			float cost = 1.0f + (leftBounds.getSurfaceArea() * leftCount + rightAreas[i] * rightCounts[i]) / parentArea;
+
+			if(cost < bestCost) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = i;
+			}
+		}
+	}
+
+	unsigned int leftCount;
+
+	if(bestAxis == -1) {
+		if(count <= _MaxLeafItems) return;
+
+		leftCount = count / 2; //all centroids are identical, split in the middle
+	} else {
+		if(bestCost >= leafCost && count <= _MaxLeafItems) return; //splitting does not pay off
+
+		float binScale = _BinCount / centroidExtents[bestAxis];
+		float minimum = centroidBounds.min[bestAxis];
+
+		std::vector<unsigned int>::iterator middle = std::partition(_itemOrder.begin() + first, _itemOrder.begin() + first + count, [&](unsigned int item) {
+			unsigned int bin = std::min((unsigned int)((_itemBounds[item].getCenter()[bestAxis] - minimum) * binScale), _BinCount - 1);
+			return bin < bestSplit;
+		});
+
+		leftCount = middle - (_itemOrder.begin() + first);
+	}
+
+	//children are always allocated as a pair after their parent, which keeps the refit a single backwards sweep
+	unsigned int left = _treeNodes.size();
+
+	_treeNodes.push_back(TreeNode());
+	_treeNodes.push_back(TreeNode());
+
+	_treeNodes[nodeIndex].left = left;
+	_treeNodes[nodeIndex].itemCount = 0;
+
+	_buildRecursive(left, first, leftCount);
+	_buildRecursive(left + 1, first + leftCount, count - leftCount);
+}
+
+float BVH::_refit() {
+	//children are stored behind their parents, so a backwards sweep updates bottom up
+	for(unsigned int i = _treeNodes.size(); i > 0; i--) {
+		TreeNode& treeNode = _treeNodes[i - 1];
+		AABB bounds;
+
+		if(treeNode.itemCount > 0) {
+			for(unsigned int j = 0; j < treeNode.itemCount; j++) {
+				bounds.expand(_itemBounds[_itemOrder[treeNode.firstItem + j]]);
+			}
+		} else {
+			bounds.expand(_treeNodes[treeNode.left].bounds);
+			bounds.expand(_treeNodes[treeNode.left + 1].bounds);
+		}
+
+		treeNode.bounds = bounds;
+	}
+
+	//surface area heuristic cost of the whole tree
+	float rootArea = _treeNodes[0].bounds.getSurfaceArea();
+	if(rootArea <= 0.0f) return 0.0f;
+
+	float cost = 0.0f;
+
+	for(unsigned int i = 0; i < _treeNodes.size(); i++) {
+		TreeNode& treeNode = _treeNodes[i];
+		float area = treeNode.bounds.getSurfaceArea() / rootArea;
+
+		cost += (treeNode.itemCount > 0) ? area * treeNode.itemCount : area;
+	}
+
+	return cost;
+}
+
+void BVH::_collectItems(unsigned int nodeIndex, std::vector<Node*>& result) {
+	TreeNode& treeNode = _treeNodes[nodeIndex];
+
+	if(treeNode.itemCount > 0) {
+		for(unsigned int i = 0; i < treeNode.itemCount; i++) {
+			result.push_back(_items[_itemOrder[treeNode.firstItem + i]]);
+		}
+	} else {
+		_collectItems(treeNode.left, result);
+		_collectItems(treeNode.left + 1, result);
+	}
+}
\ No newline at end of file
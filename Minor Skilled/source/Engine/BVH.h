@@ -0,0 +1,56 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../Utility/AABB.h"
+
+class Node;
+class Frustum;
+
+//bounding volume hierarchy over scene nodes, built with the surface area heuristic and refitted every frame
+class BVH {
+	public:
+		BVH();
+		~BVH();
+
+		void update(std::vector<Node*>& items, std::vector<AABB>& bounds);
+		void clear();
+
+		unsigned int getItemCount();
+		AABB getBounds();
+
+		void queryFrustum(const Frustum& frustum, std::vector<Node*>& result);
+		void querySphere(glm::vec3 center, float radius, std::vector<Node*>& result);
+		void queryNearest(glm::vec3 point, unsigned int count, std::vector<Node*>& result);
+		Node* raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance, float& distance);
+
+	private:
+		struct TreeNode {
+			AABB bounds;
+			unsigned int left; //the right child is always stored at left + 1
+			unsigned int firstItem;
+			unsigned int itemCount; //leaf if greater than 0
+		};
+
+		static const unsigned int _BinCount = 16; //in the class, it sizes the bin arrays on the stack
+		static const unsigned int _MaxLeafItems;
+		static const float _RebuildThreshold;
+
+		std::vector<TreeNode> _treeNodes;
+		std::vector<Node*> _items;
+		std::vector<AABB> _itemBounds;
+		std::vector<unsigned int> _itemOrder; //leaves index into this list
+
+		float _buildCost;
+
+		void _build();
+		void _buildRecursive(unsigned int nodeIndex, unsigned int first, unsigned int count);
+		float _refit();
+
+		void _collectItems(unsigned int nodeIndex, std::vector<Node*>& result);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "BrdfLUT.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "../Engine/Texture.h"
+
+#include "../Utility/Filepath.h"
+#include "../Utility/MappedFile.h"
+#include "../Utility/BrdfIntegrator.h"
+#include "../Utility/Math.h"
+
+const char BrdfLUT::_Magic[4] = { 'G', 'X', 'B', 'L' };
+const unsigned int BrdfLUT::_Version = 1; //increase whenever the layout or the integration changes
+
+Texture* BrdfLUT::Load(unsigned int size, unsigned int sampleCount) {
+	std::string path = Filepath::GetCachePath("brdf", ".lut");
+	std::vector<unsigned short> halves;
+
+	if(!_Read(path, size, sampleCount, halves)) {
+		std::vector<float> lut;
+		BrdfIntegrator::Integrate(size, sampleCount, lut);
+
+		halves.resize(lut.size());
+		Math::FloatToHalf(&lut[0], &halves[0], lut.size());
+
+		_Write(path, size, sampleCount, halves);
+	}
+
+	//rg16f, the rows of two half floats are always 4 byte aligned
+	return new Texture(GL_TEXTURE_2D, GL_RG16F, size, size, GL_RG, GL_HALF_FLOAT, GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, &halves[0], false);
+}
+
+bool BrdfLUT::_Read(std::string path, unsigned int size, unsigned int sampleCount, std::vector<unsigned short>& halves) {
+	MappedFile file(path);
+	if(!file.isOpen() || file.getSize() < sizeof(Header)) return false;
+
+	const Header* header = (const Header*)file.getData();
+
+	if(std::memcmp(header->magic, _Magic, sizeof(_Magic)) != 0 || header->version != _Version) return false;
+	if(header->size != size || header->sampleCount != sampleCount) return false; //parameters changed, integrate again
+
+	unsigned long long count = (unsigned long long)size * size * 2;
+	if(file.getSize() - sizeof(Header) < count * sizeof(unsigned short)) return false;
+
+	const unsigned short* data = (const unsigned short*)(file.getData() + sizeof(Header));
+	halves.assign(data, data + count);
+
+	return true;
+}
+
+void BrdfLUT::_Write(std::string path, unsigned int size, unsigned int sampleCount, std::vector<unsigned short>& halves) {
+	Header header;
+	std::memset(&header, 0, sizeof(Header));
+
+	std::memcpy(header.magic, _Magic, sizeof(_Magic));
+	header.version = _Version;
+	header.size = size;
+	header.sampleCount = sampleCount;
+
+	//write into a temporary file first, so an interrupted write never leaves a broken lut behind
+	std::string tempPath = path + ".tmp";
+	std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+
+	if(!file.is_open()) {
+		std::cout << "ERROR: Unable to write the brdf lut " + path << std::endl;
+		return;
+	}
+
+	file.write((const char*)&header, sizeof(Header));
+	file.write((const char*)&halves[0], halves.size() * sizeof(unsigned short));
+	file.close();
+
+	if(file.fail()) {
+		std::cout << "ERROR: Unable to write the brdf lut " + path << std::endl;
+		std::remove(tempPath.c_str());
+		return;
+	}
+
+	std::remove(path.c_str());
+	std::rename(tempPath.c_str(), path.c_str());
+}
\ No newline at end of file
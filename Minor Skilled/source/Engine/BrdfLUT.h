@@ -0,0 +1,29 @@
+#ifndef BRDFLUT_H
+#define BRDFLUT_H
+
+#include <string>
+#include <vector>
+
+class Texture;
+
+//split sum lookup texture, integrated on the cpu once per set of parameters and loaded from the cache afterwards
+class BrdfLUT {
+	public:
+		static Texture* Load(unsigned int size, unsigned int sampleCount); //integrates and writes the lut first if there is none for these parameters
+
+	private:
+		static const char _Magic[4];
+		static const unsigned int _Version;
+
+		struct Header {
+			char magic[4];
+			unsigned int version;
+			unsigned int size;
+			unsigned int sampleCount;
+		};
+
+		static bool _Read(std::string path, unsigned int size, unsigned int sampleCount, std::vector<unsigned short>& halves);
+		static void _Write(std::string path, unsigned int size, unsigned int sampleCount, std::vector<unsigned short>& halves);
+};
+
+#endif
\ No newline at end of file
@@ -16,12 +16,12 @@ void Buffer::bind() {
 	glBindBuffer(_target, _id);
 }
 
-void Buffer::allocateMemory(unsigned int memory) {
-	glBufferData(_target, memory, NULL, GL_STATIC_DRAW); //allocate memory but buffer nothing
+void Buffer::allocateMemory(unsigned int memory, GLenum usage) {
+	glBufferData(_target, memory, NULL, usage); //allocate memory but buffer nothing
 }
 
-void Buffer::bufferData(const void* data, unsigned int memory) {
-	glBufferData(_target, memory, data, GL_STATIC_DRAW);
+void Buffer::bufferData(const void* data, unsigned int memory, GLenum usage) {
+	glBufferData(_target, memory, data, usage);
 }
 
 void Buffer::bufferSubData(unsigned int offset, unsigned int memory, const void* data) {
@@ -32,6 +32,14 @@ void Buffer::bindBufferRange(unsigned int index, unsigned int memory) {
 	glBindBufferRange(_target, index, _id, 0, memory); //attach buffer to binding point
 }
 
+void Buffer::bindBufferBase(unsigned int index) {
+	glBindBufferBase(_target, index, _id); //attach the whole buffer to binding point
+}
+
+void Buffer::bindTo(GLenum target) {
+	glBindBuffer(target, _id); //bind to a different target, e.g. a storage buffer as indirect draw buffer
+}
+
 void Buffer::Unbind(GLenum target) {
 	glBindBuffer(target, 0);
 }
\ No newline at end of file
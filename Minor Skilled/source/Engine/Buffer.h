@@ -17,10 +17,12 @@ class Buffer {
 
 		void bind();
 
-		void allocateMemory(unsigned int memory);
-		void bufferData(const void* data, unsigned int memory);
+		void allocateMemory(unsigned int memory, GLenum usage = GL_STATIC_DRAW);
+		void bufferData(const void* data, unsigned int memory, GLenum usage = GL_STATIC_DRAW);
 		void bufferSubData(unsigned int offset, unsigned int memory, const void * data);
 		void bindBufferRange(unsigned int index, unsigned int memory);
+		void bindBufferBase(unsigned int index);
+		void bindTo(GLenum target);
 
 		static void Unbind(GLenum target);
 
@@ -0,0 +1,165 @@
+#include "EnvironmentCache.h"
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+#include <cstddef>
+#include <algorithm>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "../Engine/Texture.h"
+
+#include "../Utility/Filepath.h"
+#include "../Utility/MappedFile.h"
+
+const char EnvironmentCache::_Magic[4] = { 'G', 'X', 'E', 'C' };
+const unsigned int EnvironmentCache::_Version = 1; //increase whenever the layout of the cache or the conversion changes
+const std::string EnvironmentCache::_Extension = ".envcache";
+
+Texture* EnvironmentCache::Load(std::string path, unsigned int faceSize) {
+	unsigned long long sourceTime;
+	unsigned long long sourceSize;
+
+	if(!Filepath::GetFileStats(path, sourceTime, sourceSize)) return nullptr;
+
+	MappedFile cache(GetCachePath(path));
+	if(!cache.isOpen() || cache.getSize() < sizeof(Header)) return nullptr;
+
+	const unsigned char* data = cache.getData();
+	const Header* header = (const Header*)data;
+
+	if(std::memcmp(header->magic, _Magic, sizeof(_Magic)) != 0 || header->version != _Version) return nullptr;
+	if(header->faceSize != faceSize || header->levels != _GetLevelCount(faceSize)) return nullptr;
+	if(header->sourceSize != sourceSize) return nullptr;
+
+	bool touched = header->sourceTime != sourceTime;
+
+	if(touched) {
+		//the timestamp changed (e.g. after a checkout), the cache is still valid if the contents are the same
+		MappedFile source(path);
+		if(!source.isOpen() || source.getHash() != header->sourceHash) return nullptr;
+	}
+
+	//make sure every face of every level is inside of the file
+	unsigned long long size = sizeof(Header);
+
+	for(unsigned int level = 0; level < header->levels; level++) {
+		size += 6 * _GetLevelSize(faceSize, level);
+	}
+
+	if(size > cache.getSize()) return nullptr;
+
+	//upload the half floats straight from the mapping, the levels are stored largest first with all six faces each
+	Texture* cubemap = new Texture(GL_TEXTURE_CUBE_MAP);
+	cubemap->bind();
+	cubemap->filepath = path;
+
+	const unsigned char* faceData = data + sizeof(Header);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 2); //rows of the smallest levels are not 4 byte aligned
+
+	for(unsigned int level = 0; level < header->levels; level++) {
+		unsigned int levelSize = std::max(faceSize >> level, 1u);
+
+		for(unsigned int i = 0; i < 6; i++) {
+			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, level, GL_RGB16F, levelSize, levelSize, 0, GL_RGB, GL_HALF_FLOAT, faceData);
+			faceData += _GetLevelSize(faceSize, level);
+		}
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, header->levels - 1);
+	cubemap->filter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE);
+
+	//store the new timestamp, so the next load does not hash the source again
+	if(touched) {
+		cache.close();
+		Filepath::PatchFile(GetCachePath(path), offsetof(Header, sourceTime), &sourceTime, sizeof(sourceTime));
+	}
+
+	return cubemap;
+}
+
+void EnvironmentCache::Write(std::string path, Texture* cubemap, unsigned int faceSize) {
+	Header header;
+	std::memset(&header, 0, sizeof(Header));
+
+	if(!Filepath::GetFileStats(path, header.sourceTime, header.sourceSize)) return;
+
+	MappedFile source(path);
+	if(!source.isOpen()) return;
+
+	std::memcpy(header.magic, _Magic, sizeof(_Magic));
+	header.version = _Version;
+	header.faceSize = faceSize;
+	header.levels = _GetLevelCount(faceSize);
+	header.sourceHash = source.getHash();
+
+	//write into a temporary file first, so an interrupted write never leaves a broken cache behind
+	std::string cachePath = GetCachePath(path);
+	std::string tempPath = cachePath + ".tmp";
+
+	std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+
+	if(!file.is_open()) {
+		std::cout << "ERROR: Unable to write the environment cache " + cachePath << std::endl;
+		return;
+	}
+
+	file.write((const char*)&header, sizeof(Header));
+
+	//read the converted faces back as half floats, this only happens once per source image
+	std::vector<unsigned char> faceData(_GetLevelSize(faceSize, 0));
+
+	cubemap->bind();
+	glPixelStorei(GL_PACK_ALIGNMENT, 2);
+
+	for(unsigned int level = 0; level < header.levels; level++) {
+		for(unsigned int i = 0; i < 6; i++) {
+			glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, level, GL_RGB, GL_HALF_FLOAT, &faceData[0]);
+			file.write((const char*)&faceData[0], _GetLevelSize(faceSize, level));
+		}
+	}
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+	file.close();
+
+	if(file.fail()) {
+		std::cout << "ERROR: Unable to write the environment cache " + cachePath << std::endl;
+		std::remove(tempPath.c_str());
+		return;
+	}
+
+	std::remove(cachePath.c_str());
+	std::rename(tempPath.c_str(), cachePath.c_str());
+}
+
+std::string EnvironmentCache::GetCachePath(std::string path) {
+	return Filepath::GetCachePath(path, _Extension);
+}
+
+unsigned int EnvironmentCache::GetVersion() {
+	return _Version;
+}
+
+unsigned long long EnvironmentCache::_GetLevelSize(unsigned int faceSize, unsigned int level) {
+	unsigned long long levelSize = std::max(faceSize >> level, 1u);
+
+	return levelSize * levelSize * 3 * sizeof(unsigned short); //rgb half floats
+}
+
+unsigned int EnvironmentCache::_GetLevelCount(unsigned int faceSize) {
+	unsigned int levels = 1;
+
+	while((faceSize >> levels) > 0) {
+		levels++;
+	}
+
+	return levels;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef ENVIRONMENTCACHE_H
+#define ENVIRONMENTCACHE_H
+
+#include <string>
+
+class Texture;
+
+//half float copy of skyboxes converted from equirectangular images, loading it skips the hdr decode and the cubemap conversion
+class EnvironmentCache {
+	public:
+		static Texture* Load(std::string path, unsigned int faceSize);
+		static void Write(std::string path, Texture* cubemap, unsigned int faceSize);
+
+		static std::string GetCachePath(std::string path);
+		static unsigned int GetVersion();
+
+	private:
+		static const char _Magic[4];
+		static const unsigned int _Version;
+		static const std::string _Extension;
+
+		struct Header {
+			char magic[4];
+			unsigned int version;
+			unsigned int faceSize; //the cache is rebuilt when the skybox resolution changes
+			unsigned int levels;
+
+			//source file state at the time of the conversion
+			unsigned long long sourceTime;
+			unsigned long long sourceSize;
+			unsigned long long sourceHash;
+		};
+
+		static unsigned long long _GetLevelSize(unsigned int faceSize, unsigned int level); //size of a single face
+		static unsigned int _GetLevelCount(unsigned int faceSize);
+};
+
+#endif
\ No newline at end of file
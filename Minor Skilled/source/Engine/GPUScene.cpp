@@ -0,0 +1,434 @@
+#include "GPUScene.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <cmath>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "../Engine/Mesh.h"
+#include "../Engine/Model.h"
+#include "../Engine/Material.h"
+#include "../Engine/Shader.h"
+#include "../Engine/Texture.h"
+#include "../Engine/VertexArray.h"
+#include "../Engine/Buffer.h"
+
+#include "../Components/RenderComponent.h"
+
+#include "../Utility/AABB.h"
+#include "../Utility/Filepath.h"
+#include "../Utility/MaterialType.h"
+#include "../Utility/RenderSettings.h"
+
+const unsigned int GPUScene::DepthPass = 1 << 0;
+const unsigned int GPUScene::ShadowPass = 1 << 1;
+
+const unsigned int GPUScene::_CommandSize = 5 * sizeof(unsigned int); //count, instanceCount, firstIndex, baseVertex, baseInstance
+
+GPUScene::GPUScene(): _poolVertexCount(0), _recordCapacity(0), _depthPyramid(nullptr), _pyramidWidth(0), _pyramidHeight(0), _pyramidLevels(0), _pyramidValid(false) {
+	//compute shaders
+	_cullingShader = new Shader(Filepath::ShaderPath + "compute shader/culling.cs");
+
+	_cullingShader->use();
+	_cullingShader->setInt("depthPyramid", 0);
+
+	_cullingShader->setShaderStorageBlockBinding("recordBlock", 3); //set shader storage block "records" to binding point 3
+	_cullingShader->setShaderStorageBlockBinding("commandBlock", 4); //set shader storage block "commands" to binding point 4
+	_cullingShader->setShaderStorageBlockBinding("remapBlock", 5); //set shader storage block "remap" to binding point 5
+	_cullingShader->setShaderStorageBlockBinding("countBlock", 6); //set shader storage block "count" to binding point 6
+
+	_depthPyramidShader = new Shader(Filepath::ShaderPath + "compute shader/depthPyramid.cs");
+
+	_depthPyramidShader->use();
+	_depthPyramidShader->setInt("inputDepth", 0);
+
+	//geometry pool, only positions are needed by the depth only passes
+	_VAO = new VertexArray();
+	_VBO = new Buffer(GL_ARRAY_BUFFER);
+	_EBO = new Buffer(GL_ELEMENT_ARRAY_BUFFER);
+
+	_VAO->bind();
+	_VBO->bind();
+	_EBO->bind();
+	_VAO->setAttribute(0, 3, GL_FLOAT, sizeof(glm::vec3), (void*)0);
+	VertexArray::Unbind();
+
+	//SSBOs
+	_recordSSBO = new Buffer(GL_SHADER_STORAGE_BUFFER);
+	_commandSSBO = new Buffer(GL_SHADER_STORAGE_BUFFER);
+	_remapSSBO = new Buffer(GL_SHADER_STORAGE_BUFFER);
+	_countSSBO = new Buffer(GL_SHADER_STORAGE_BUFFER);
+
+	_countSSBO->bind();
+	_countSSBO->allocateMemory(sizeof(unsigned int), GL_DYNAMIC_DRAW);
+	Buffer::Unbind(GL_SHADER_STORAGE_BUFFER);
+}
+
+GPUScene::~GPUScene() {
+	delete _cullingShader;
+	delete _depthPyramidShader;
+
+	delete _VAO;
+	delete _VBO;
+	delete _EBO;
+
+	delete _recordSSBO;
+	delete _commandSSBO;
+	delete _remapSSBO;
+	delete _countSSBO;
+
+	delete _depthPyramid;
+}
+
+void GPUScene::update(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents) {
+	//the records are only laid out again when render components were added or removed or a model finished loading
+	if(_layoutChanged(renderComponents)) _buildLayout(renderComponents);
+
+	//rewrite the records of moved objects and of objects whose material filter changed
+	for(unsigned int i = 0; i < _instances.size(); i++) {
+		Instance& instance = _instances[i];
+		unsigned int flags = _getFlags(instance.renderComponent);
+
+		if(instance.modelMatrix == renderComponents[i].second && instance.flags == flags) continue;
+
+		instance.modelMatrix = renderComponents[i].second;
+		instance.flags = flags;
+
+		_writeRecords(instance);
+	}
+
+	_uploadRecords();
+}
+
+void GPUScene::cull(const glm::mat4& viewProjection, const glm::mat4& previousViewProjection, unsigned int requiredFlags, bool occlusionCulling) {
+	if(_records.empty()) return;
+
+	//reset the draw count, the culling shader appends the visible records
+	unsigned int drawCount = 0;
+
+	_countSSBO->bind();
+	_countSSBO->bufferSubData(0, sizeof(unsigned int), &drawCount);
+	Buffer::Unbind(GL_SHADER_STORAGE_BUFFER);
+
+	_recordSSBO->bindBufferBase(3);
+	_commandSSBO->bindBufferBase(4);
+	_remapSSBO->bindBufferBase(5);
+	_countSSBO->bindBufferBase(6);
+
+	//only test against the depth pyramid if it exists, it is missing in the first frame and after resizing
+	occlusionCulling = occlusionCulling && _pyramidValid;
+
+	_cullingShader->use();
+	_cullingShader->setUint("recordCount", _records.size());
+	_cullingShader->setUint("requiredFlags", requiredFlags);
+	_cullingShader->setMat4("viewProjection", viewProjection);
+	_cullingShader->setMat4("previousViewProjection", previousViewProjection);
+	_cullingShader->setBool("occlusionCulling", occlusionCulling);
+
+	if(occlusionCulling) {
+		_cullingShader->setVec2("pyramidSize", glm::vec2(_pyramidWidth, _pyramidHeight));
+		_cullingShader->setInt("pyramidLevels", _pyramidLevels);
+
+		Texture::SetActiveUnit(0);
+		_depthPyramid->bind();
+	}
+
+	_cullingShader->dispatch((_records.size() + 63) / 64);
+
+	//the indirect draw reads the commands and the vertex shader the remap buffer
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GPUScene::draw() {
+	if(_records.empty()) return;
+
+	//the bound shader fetches the model matrices through the remap buffer
+	_recordSSBO->bindBufferBase(3);
+	_remapSSBO->bindBufferBase(5);
+
+	_VAO->bind();
+	_commandSSBO->bindTo(GL_DRAW_INDIRECT_BUFFER);
+	_countSSBO->bindTo(GL_PARAMETER_BUFFER);
+
+	glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, 0, 0, _records.size(), 0);
+
+	Buffer::Unbind(GL_DRAW_INDIRECT_BUFFER);
+	Buffer::Unbind(GL_PARAMETER_BUFFER);
+	VertexArray::Unbind();
+}
+
+void GPUScene::buildDepthPyramid(Texture* depthBuffer, unsigned int width, unsigned int height) {
+	if(width != _pyramidWidth || height != _pyramidHeight || _depthPyramid == nullptr) _createDepthPyramid(width, height);
+
+	_depthPyramidShader->use();
+	Texture::SetActiveUnit(0);
+
+	unsigned int levelWidth = width;
+	unsigned int levelHeight = height;
+
+	for(unsigned int i = 0; i < _pyramidLevels; i++) {
+		//the first level is a copy of the depth buffer, every other level keeps the farthest depth of the level above
+		if(i == 0) {
+			depthBuffer->bind();
+			_depthPyramidShader->setInt("inputLevel", -1);
+		} else {
+			_depthPyramid->bind();
+			_depthPyramidShader->setInt("inputLevel", i - 1);
+		}
+
+		_depthPyramidShader->setVec2("outputSize", (float)levelWidth, (float)levelHeight);
+
+		glBindImageTexture(0, _depthPyramid->getID(), i, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		_depthPyramidShader->dispatch((levelWidth + 7) / 8, (levelHeight + 7) / 8);
+
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT); //the next level reads this one
+
+		levelWidth = std::max(levelWidth / 2, 1u);
+		levelHeight = std::max(levelHeight / 2, 1u);
+	}
+
+	glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+	Texture::Unbind(GL_TEXTURE_2D);
+
+	_pyramidValid = true;
+}
+
+void GPUScene::invalidateDepthPyramid() {
+	_pyramidValid = false; //the pyramid no longer matches the previous frame
+}
+
+unsigned int GPUScene::getRecordCount() {
+	return _records.size();
+}
+
+unsigned int GPUScene::getPoolVertexCount() {
+	return _poolVertexCount;
+}
+
+bool GPUScene::_layoutChanged(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents) {
+	if(renderComponents.size() != _instances.size()) return true;
+
+	for(unsigned int i = 0; i < renderComponents.size(); i++) {
+		Instance& instance = _instances[i];
+		RenderComponent* renderComponent = renderComponents[i].first;
+
+		if(renderComponent != instance.renderComponent || renderComponent->model != instance.model) return true;
+		if(renderComponent->model != nullptr && renderComponent->model->getMeshes().size() != instance.meshCount) return true; //loaded in the background
+	}
+
+	return false;
+}
+
+void GPUScene::_buildLayout(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents) {
+	//collect the meshes of the scene, the pool only gets rebuilt if they changed (e.g. after loading a scene)
+	std::vector<Mesh*> meshes;
+	std::unordered_set<Mesh*> collected;
+
+	for(unsigned int i = 0; i < renderComponents.size(); i++) {
+		if(renderComponents[i].first->model == nullptr) continue;
+
+		std::vector<Mesh*>& modelMeshes = renderComponents[i].first->model->getMeshes();
+
+		for(unsigned int j = 0; j < modelMeshes.size(); j++) {
+			if(collected.insert(modelMeshes[j]).second) meshes.push_back(modelMeshes[j]);
+		}
+	}
+
+	if(_poolChanged(meshes)) _buildGeometryPool(meshes);
+
+	//every mesh instance keeps its record, objects the current passes skip just have no flags set
+	_instances.resize(renderComponents.size());
+	unsigned int recordCount = 0;
+
+	for(unsigned int i = 0; i < renderComponents.size(); i++) {
+		Instance& instance = _instances[i];
+		instance.renderComponent = renderComponents[i].first;
+		instance.model = instance.renderComponent->model;
+		instance.meshCount = (instance.model != nullptr) ? instance.model->getMeshes().size() : 0;
+		instance.modelMatrix = renderComponents[i].second;
+		instance.flags = _getFlags(instance.renderComponent);
+		instance.firstRecord = recordCount;
+
+		recordCount += instance.meshCount;
+	}
+
+	_records.resize(recordCount);
+	_dirtyRecords.assign(recordCount, false);
+
+	for(unsigned int i = 0; i < _instances.size(); i++) {
+		_writeRecords(_instances[i]);
+	}
+
+	_reserveRecords(recordCount);
+}
+
+unsigned int GPUScene::_getFlags(RenderComponent* renderComponent) {
+	Material* material = renderComponent->material;
+	MaterialType materialType = material->getMaterialType();
+
+	//same material filter as the cpu driven depth and shadow passes
+	unsigned int flags = DepthPass | ShadowPass;
+
+	if(RenderSettings::IsEnabled(RenderSettings::Deferred)) {
+		bool pbr = RenderSettings::IsEnabled(RenderSettings::PBR);
+
+		if(pbr && materialType != MaterialType::PBR) flags = 0; //skip non-pbr materials in pbr mode in deferred mode
+		else if(!pbr && materialType == MaterialType::PBR) flags = 0; //skip pbr material in non-pbr mode in deferred mode
+	}
+
+	if(!material->getCastsShadows()) flags &= ~ShadowPass;
+
+	return flags;
+}
+
+void GPUScene::_writeRecords(Instance& instance) {
+	if(instance.meshCount == 0) return;
+
+	std::vector<Mesh*>& modelMeshes = instance.model->getMeshes();
+
+	for(unsigned int i = 0; i < instance.meshCount; i++) {
+		MeshRange& range = _meshRanges[modelMeshes[i]];
+		AABB bounds = modelMeshes[i]->getBounds().transform(instance.modelMatrix);
+
+		DrawRecord& record = _records[instance.firstRecord + i];
+		record.modelMatrix = instance.modelMatrix;
+		record.boundsMin = glm::vec4(bounds.min, 1.0f);
+		record.boundsMax = glm::vec4(bounds.max, 1.0f);
+		record.indexCount = range.indexCount;
+		record.firstIndex = range.firstIndex;
+		record.baseVertex = range.baseVertex;
+		record.flags = instance.flags;
+
+		_dirtyRecords[instance.firstRecord + i] = true;
+	}
+}
+
+void GPUScene::_uploadRecords() {
+	//upload each run of consecutive changed records with a single call
+	unsigned int start = 0;
+
+	_recordSSBO->bind();
+
+	while(start < _records.size()) {
+		if(!_dirtyRecords[start]) {
+			start++;
+			continue;
+		}
+
+		unsigned int end = start;
+
+		while(end < _records.size() && _dirtyRecords[end]) {
+			_dirtyRecords[end] = false;
+			end++;
+		}
+
+		_recordSSBO->bufferSubData(start * sizeof(DrawRecord), (end - start) * sizeof(DrawRecord), &_records[start]);
+		start = end;
+	}
+
+	Buffer::Unbind(GL_SHADER_STORAGE_BUFFER);
+}
+
+bool GPUScene::_poolChanged(std::vector<Mesh*>& meshes) {
+	if(meshes.size() != _meshes.size()) return true;
+
+	for(unsigned int i = 0; i < meshes.size(); i++) {
+		if(meshes[i] != _meshes[i]) return true;
+
+		//a new mesh could have been allocated at the address of a deleted one
+		MeshRange& range = _meshRanges[meshes[i]];
+		if(range.vertexCount != meshes[i]->getVertices().size() || range.indexCount != meshes[i]->getIndices().size()) return true;
+	}
+
+	return false;
+}
+
+void GPUScene::_buildGeometryPool(std::vector<Mesh*>& meshes) {
+	_meshes = meshes;
+	_meshRanges.clear();
+
+	std::vector<glm::vec3> positions;
+	std::vector<unsigned int> indices;
+
+	for(unsigned int i = 0; i < meshes.size(); i++) {
+		std::vector<Vertex>& vertices = meshes[i]->getVertices();
+		std::vector<unsigned int>& meshIndices = meshes[i]->getIndices();
+
+		//indices stay relative to the mesh, the draw commands add the base vertex
+		MeshRange range;
+		range.firstIndex = indices.size();
+		range.indexCount = meshIndices.size();
+		range.baseVertex = positions.size();
+		range.vertexCount = vertices.size();
+
+		_meshRanges[meshes[i]] = range;
+
+		for(unsigned int j = 0; j < vertices.size(); j++) {
+			positions.push_back(vertices[j].position);
+		}
+
+		indices.insert(indices.end(), meshIndices.begin(), meshIndices.end());
+	}
+
+	_poolVertexCount = positions.size();
+
+	if(positions.empty() || indices.empty()) return;
+
+	_VAO->bind();
+
+	_VBO->bind();
+	_VBO->bufferData(&positions[0], positions.size() * sizeof(glm::vec3));
+
+	_EBO->bind();
+	_EBO->bufferData(&indices[0], indices.size() * sizeof(unsigned int));
+
+	VertexArray::Unbind();
+}
+
+void GPUScene::_reserveRecords(unsigned int recordCount) {
+	if(recordCount <= _recordCapacity || recordCount == 0) return;
+
+	//grow with some headroom to avoid reallocating every time an object gets added
+	_recordCapacity = std::max(recordCount, _recordCapacity * 2);
+
+	_recordSSBO->bind();
+	_recordSSBO->allocateMemory(_recordCapacity * sizeof(DrawRecord), GL_DYNAMIC_DRAW);
+
+	_commandSSBO->bind();
+	_commandSSBO->allocateMemory(_recordCapacity * _CommandSize, GL_DYNAMIC_COPY);
+
+	_remapSSBO->bind();
+	_remapSSBO->allocateMemory(_recordCapacity * sizeof(unsigned int), GL_DYNAMIC_COPY);
+
+	Buffer::Unbind(GL_SHADER_STORAGE_BUFFER);
+}
+
+void GPUScene::_createDepthPyramid(unsigned int width, unsigned int height) {
+	delete _depthPyramid;
+
+	_pyramidWidth = width;
+	_pyramidHeight = height;
+	_pyramidLevels = (unsigned int)std::floor(std::log2((float)std::max(width, height))) + 1;
+	_pyramidValid = false;
+
+	//allocate every mip level, image load/store needs a complete texture
+	_depthPyramid = new Texture(GL_TEXTURE_2D);
+	_depthPyramid->bind();
+
+	unsigned int levelWidth = width;
+	unsigned int levelHeight = height;
+
+	for(unsigned int i = 0; i < _pyramidLevels; i++) {
+		glTexImage2D(GL_TEXTURE_2D, i, GL_R32F, levelWidth, levelHeight, 0, GL_RED, GL_FLOAT, NULL);
+
+		levelWidth = std::max(levelWidth / 2, 1u);
+		levelHeight = std::max(levelHeight / 2, 1u);
+	}
+
+	_depthPyramid->filter(GL_NEAREST_MIPMAP_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, _pyramidLevels - 1);
+
+	Texture::Unbind(GL_TEXTURE_2D);
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#ifndef GPUSCENE_H
+#define GPUSCENE_H
+
+#include <vector>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+class Mesh;
+class Model;
+class Shader;
+class Texture;
+class VertexArray;
+class Buffer;
+class RenderComponent;
+
+//keeps the scene's draw records on the gpu, culls them in a compute shader and renders the survivors with a single indirect draw call
+class GPUScene {
+	public:
+		GPUScene();
+		~GPUScene();
+
+		//record flags, a pass only draws records which have all of its required flags set
+		static const unsigned int DepthPass;
+		static const unsigned int ShadowPass;
+
+		void update(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents);
+		void cull(const glm::mat4& viewProjection, const glm::mat4& previousViewProjection, unsigned int requiredFlags, bool occlusionCulling);
+		void draw();
+
+		void buildDepthPyramid(Texture* depthBuffer, unsigned int width, unsigned int height);
+		void invalidateDepthPyramid();
+
+		unsigned int getRecordCount();
+		unsigned int getPoolVertexCount();
+
+	private:
+		//matches the std430 layout of the DrawRecord struct in the shaders
+		struct DrawRecord {
+			glm::mat4 modelMatrix;
+			glm::vec4 boundsMin;
+			glm::vec4 boundsMax;
+			unsigned int indexCount;
+			unsigned int firstIndex;
+			int baseVertex;
+			unsigned int flags;
+		};
+
+		struct MeshRange {
+			unsigned int firstIndex;
+			unsigned int indexCount;
+			int baseVertex;
+			unsigned int vertexCount;
+		};
+
+		//one per render component, it owns a fixed range of records with one record per mesh
+		struct Instance {
+			RenderComponent* renderComponent;
+			Model* model;
+			unsigned int meshCount;
+			glm::mat4 modelMatrix;
+			unsigned int flags;
+			unsigned int firstRecord;
+		};
+
+		static const unsigned int _CommandSize;
+
+		Shader* _cullingShader;
+		Shader* _depthPyramidShader;
+
+		//shared geometry pool with the positions of all meshes
+		VertexArray* _VAO;
+		Buffer* _VBO;
+		Buffer* _EBO;
+
+		std::vector<Mesh*> _meshes;
+		std::unordered_map<Mesh*, MeshRange> _meshRanges;
+		unsigned int _poolVertexCount;
+
+		//SSBOs
+		Buffer* _recordSSBO;
+		Buffer* _commandSSBO;
+		Buffer* _remapSSBO;
+		Buffer* _countSSBO;
+
+		//kept between frames, only the records of changed instances are written and uploaded again
+		std::vector<Instance> _instances;
+		std::vector<DrawRecord> _records;
+		std::vector<bool> _dirtyRecords;
+		unsigned int _recordCapacity;
+
+		//hierarchical depth of the last frame
+		Texture* _depthPyramid;
+		unsigned int _pyramidWidth;
+		unsigned int _pyramidHeight;
+		unsigned int _pyramidLevels;
+		bool _pyramidValid;
+
+		bool _layoutChanged(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents);
+		void _buildLayout(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents);
+		unsigned int _getFlags(RenderComponent* renderComponent);
+		void _writeRecords(Instance& instance);
+		void _uploadRecords();
+
+		bool _poolChanged(std::vector<Mesh*>& meshes);
+		void _buildGeometryPool(std::vector<Mesh*>& meshes);
+		void _reserveRecords(unsigned int recordCount);
+		void _createDepthPyramid(unsigned int width, unsigned int height);
+};
+
+#endif
\ No newline at end of file
@@ -1,13 +0,0 @@
-#ifndef IBLMAPS_H
-#define IBLMAPS_H
-
-class Texture;
-
-struct IBLMaps {
-	public:
-		Texture* environmentMap;
-		Texture* irradianceMap;
-		Texture* prefilterMap;
-};
-
-#endif
\ No newline at end of file
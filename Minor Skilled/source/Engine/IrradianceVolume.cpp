@@ -0,0 +1,195 @@
+#include "IrradianceVolume.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "../Engine/Texture.h"
+
+IrradianceVolume::IrradianceVolume(const AABB& bounds, float spacing, unsigned int maxSize) : _dirtyCount(0) {
+	//one probe every spacing units along each axis including both borders, stretched if the grid would get too large
+	glm::vec3 extents = bounds.max - bounds.min;
+
+	for(unsigned int i = 0; i < 3; i++) {
+		_size[i] = std::min((int)std::ceil(extents[i] / std::max(spacing, 0.001f)) + 1, (int)maxSize);
+		_size[i] = std::max(_size[i], 2); //trilinear filtering needs two probes on every axis
+
+		_spacing[i] = std::max(extents[i] / (float)(_size[i] - 1), 0.001f);
+	}
+
+	_min = bounds.min;
+
+	_coefficients.assign(getProbeCount() * 12, 0.0f);
+	_dirty.assign(getProbeCount(), false);
+
+	//one rgba texture per color channel, each texel holds the four l1 coefficients of that channel
+	for(unsigned int i = 0; i < 3; i++) {
+		_textures[i] = new Texture(GL_TEXTURE_3D);
+		_textures[i]->bind();
+
+		glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA16F, _size.x, _size.y, _size.z, 0, GL_RGBA, GL_FLOAT, NULL);
+		_textures[i]->filter(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE);
+	}
+}
+
+IrradianceVolume::~IrradianceVolume() {
+	finishProjections(); //the workers write into the coefficients
+
+	for(unsigned int i = 0; i < 3; i++) {
+		delete _textures[i];
+	}
+}
+
+glm::ivec3 IrradianceVolume::getSize() {
+	return _size;
+}
+
+glm::vec3 IrradianceVolume::getMin() {
+	return _min;
+}
+
+glm::vec3 IrradianceVolume::getSpacing() {
+	return _spacing;
+}
+
+unsigned int IrradianceVolume::getProbeCount() {
+	return _size.x * _size.y * _size.z;
+}
+
+glm::vec3 IrradianceVolume::getProbePosition(unsigned int probe) {
+	glm::ivec3 cell(probe % _size.x, (probe / _size.x) % _size.y, probe / (_size.x * _size.y));
+
+	return _min + glm::vec3(cell) * _spacing;
+}
+
+void IrradianceVolume::project(unsigned int probe, std::vector<float>& faces, unsigned int faceSize) {
+	float* coefficients = &_coefficients[probe * 12];
+
+	JobSystem::Schedule([faces, faceSize, coefficients]() {
+		_Project(faces, faceSize, coefficients);
+	}, &_projectionCounter);
+}
+
+bool IrradianceVolume::isProjecting() {
+	return _projectionCounter.pending > 0;
+}
+
+void IrradianceVolume::finishProjections() {
+	JobSystem::Wait(&_projectionCounter);
+}
+
+std::vector<float>& IrradianceVolume::getCoefficients() {
+	return _coefficients;
+}
+
+void IrradianceVolume::upload() {
+	unsigned int probeCount = getProbeCount();
+	std::vector<float> channel(probeCount * 4);
+
+	for(unsigned int i = 0; i < 3; i++) {
+		for(unsigned int j = 0; j < probeCount; j++) {
+			std::copy(&_coefficients[j * 12 + i * 4], &_coefficients[j * 12 + i * 4 + 4], &channel[j * 4]);
+		}
+
+		_textures[i]->bind();
+		glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, _size.x, _size.y, _size.z, GL_RGBA, GL_FLOAT, &channel[0]);
+	}
+}
+
+void IrradianceVolume::uploadProbe(unsigned int probe) {
+	glm::ivec3 cell(probe % _size.x, (probe / _size.x) % _size.y, probe / (_size.x * _size.y));
+
+	for(unsigned int i = 0; i < 3; i++) {
+		_textures[i]->bind();
+		glTexSubImage3D(GL_TEXTURE_3D, 0, cell.x, cell.y, cell.z, 1, 1, 1, GL_RGBA, GL_FLOAT, &_coefficients[probe * 12 + i * 4]);
+	}
+}
+
+void IrradianceVolume::markDirty(const AABB& bounds) {
+	//every probe within one cell of the bounds sees the change
+	glm::ivec3 first = glm::ivec3(glm::floor((bounds.min - _min) / _spacing));
+	glm::ivec3 last = glm::ivec3(glm::ceil((bounds.max - _min) / _spacing));
+
+	first = glm::clamp(first, glm::ivec3(0), _size - 1);
+	last = glm::clamp(last, glm::ivec3(0), _size - 1);
+
+	for(int z = first.z; z <= last.z; z++) {
+		for(int y = first.y; y <= last.y; y++) {
+			for(int x = first.x; x <= last.x; x++) {
+				unsigned int probe = x + (y + z * _size.y) * _size.x;
+				if(_dirty[probe]) continue;
+
+				_dirty[probe] = true;
+				_dirtyCount++;
+			}
+		}
+	}
+}
+
+int IrradianceVolume::popDirtyProbe() {
+	if(_dirtyCount == 0) return -1;
+
+	for(unsigned int i = 0; i < _dirty.size(); i++) {
+		if(!_dirty[i]) continue;
+
+		_dirty[i] = false;
+		_dirtyCount--;
+		return i;
+	}
+
+	return -1;
+}
+
+void IrradianceVolume::bind(unsigned int firstUnit) {
+	for(unsigned int i = 0; i < 3; i++) {
+		Texture::SetActiveUnit(firstUnit + i);
+		_textures[i]->bind();
+	}
+}
+
+void IrradianceVolume::_Project(const std::vector<float>& faces, unsigned int faceSize, float* coefficients) {
+	glm::vec3 sh[4] = { glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f) };
+
+	//project every texel onto the l1 spherical harmonics basis, weighted by the solid angle it covers
+	for(unsigned int face = 0; face < 6; face++) {
+		for(unsigned int y = 0; y < faceSize; y++) {
+			for(unsigned int x = 0; x < faceSize; x++) {
+				float u = ((float)x + 0.5f) / (float)faceSize * 2.0f - 1.0f;
+				float v = ((float)y + 0.5f) / (float)faceSize * 2.0f - 1.0f;
+				float solidAngle = 4.0f / ((float)(faceSize * faceSize) * std::pow(1.0f + u * u + v * v, 1.5f));
+
+				const float* pixel = &faces[((face * faceSize + y) * faceSize + x) * 3];
+				glm::vec3 radiance = glm::vec3(pixel[0], pixel[1], pixel[2]) * solidAngle;
+				glm::vec3 n = glm::normalize(_GetDirection(face, u, v));
+
+				sh[0] += radiance * 0.282095f;
+				sh[1] += radiance * 0.488603f * n.y;
+				sh[2] += radiance * 0.488603f * n.z;
+				sh[3] += radiance * 0.488603f * n.x;
+			}
+		}
+	}
+
+	//convolve with the cosine lobe and divide by pi like the reflection probe harmonics, then store the channels separately
+	float bands[4] = { 1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f };
+
+	for(unsigned int i = 0; i < 4; i++) {
+		coefficients[i] = sh[i].r * bands[i];
+		coefficients[4 + i] = sh[i].g * bands[i];
+		coefficients[8 + i] = sh[i].b * bands[i];
+	}
+}
+
+glm::vec3 IrradianceVolume::_GetDirection(unsigned int face, float u, float v) {
+	//cubemap face orientations as defined by opengl
+	switch(face) {
+		case 0: return glm::vec3(1.0f, -v, -u);
+		case 1: return glm::vec3(-1.0f, -v, u);
+		case 2: return glm::vec3(u, 1.0f, v);
+		case 3: return glm::vec3(u, -1.0f, -v);
+		case 4: return glm::vec3(u, -v, 1.0f);
+		default: return glm::vec3(-u, -v, -1.0f);
+	}
+}
\ No newline at end of file
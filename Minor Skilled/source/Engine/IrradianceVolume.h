@@ -0,0 +1,57 @@
+#ifndef IRRADIANCEVOLUME_H
+#define IRRADIANCEVOLUME_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../Engine/JobSystem.h"
+
+#include "../Utility/AABB.h"
+
+class Texture;
+
+//grid of l1 spherical harmonics irradiance probes over the scene, one 3d texture per color channel sampled trilinearly
+class IrradianceVolume {
+	public:
+		IrradianceVolume(const AABB& bounds, float spacing, unsigned int maxSize);
+		~IrradianceVolume();
+
+		glm::ivec3 getSize();
+		glm::vec3 getMin(); //position of the first probe
+		glm::vec3 getSpacing();
+
+		unsigned int getProbeCount();
+		glm::vec3 getProbePosition(unsigned int probe);
+
+		//faces are the rgb float pixels of a captured cubemap in face order, projected on a worker thread
+		void project(unsigned int probe, std::vector<float>& faces, unsigned int faceSize);
+		bool isProjecting();
+		void finishProjections();
+
+		std::vector<float>& getCoefficients(); //12 floats per probe, the coefficients of red, green and blue
+		void upload(); //whole grid, after a bake or a cache load
+		void uploadProbe(unsigned int probe);
+
+		void markDirty(const AABB& bounds);
+		int popDirtyProbe(); //-1 if none
+
+		void bind(unsigned int firstUnit);
+
+	private:
+		glm::ivec3 _size;
+		glm::vec3 _min;
+		glm::vec3 _spacing;
+
+		std::vector<float> _coefficients;
+		std::vector<bool> _dirty;
+		unsigned int _dirtyCount;
+
+		Texture* _textures[3];
+		JobCounter _projectionCounter;
+
+		static void _Project(const std::vector<float>& faces, unsigned int faceSize, float* coefficients);
+		static glm::vec3 _GetDirection(unsigned int face, float u, float v);
+};
+
+#endif
\ No newline at end of file
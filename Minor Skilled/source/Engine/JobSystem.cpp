@@ -0,0 +1,189 @@
+#include "JobSystem.h"
+
+#include <iostream>
+#include <string>
+
+std::vector<std::thread> JobSystem::_Workers;
+std::vector<JobSystem::JobQueue*> JobSystem::_Queues;
+
+std::atomic<bool> JobSystem::_Running(false);
+std::atomic<unsigned int> JobSystem::_QueuedJobs(0);
+std::atomic<unsigned int> JobSystem::_NextQueue(0);
+
+std::mutex JobSystem::_SleepMutex;
+std::condition_variable JobSystem::_WakeCondition;
+
+thread_local unsigned int JobSystem::_ThreadIndex = 0;
+
+void JobSystem::Initialize(unsigned int workerCount) {
+	if(_Running) return;
+
+	//leave one hardware thread for the main thread by default
+	if(workerCount == 0) {
+		unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		workerCount = (hardwareThreads > 1) ? hardwareThreads - 1 : 1;
+	}
+
+	_Running = true;
+	_ThreadIndex = 0;
+
+	for(unsigned int i = 0; i <= workerCount; i++) {
+		_Queues.push_back(new JobQueue());
+	}
+
+	for(unsigned int i = 1; i <= workerCount; i++) {
+		_Workers.push_back(std::thread(&JobSystem::_WorkerLoop, i));
+	}
+
+	std::cout << "Job system started with " + std::to_string(workerCount) + " worker threads" << std::endl;
+}
+
+void JobSystem::Shutdown() {
+	if(!_Running) return;
+
+	//wake up all sleeping workers so they can leave their loop
+	{
+		std::lock_guard<std::mutex> lock(_SleepMutex);
+		_Running = false;
+	}
+
+	_WakeCondition.notify_all();
+
+	for(unsigned int i = 0; i < _Workers.size(); i++) {
+		_Workers[i].join();
+	}
+
+	for(unsigned int i = 0; i < _Queues.size(); i++) {
+		delete _Queues[i];
+	}
+
+	_Workers.clear();
+	_Queues.clear();
+	_QueuedJobs = 0;
+}
+
+unsigned int JobSystem::GetThreadCount() {
+	return (_Queues.empty()) ? 1 : _Queues.size();
+}
+
+unsigned int JobSystem::GetThreadIndex() {
+	return _ThreadIndex;
+}
+
+void JobSystem::Schedule(std::function<void()> job, JobCounter* counter) {
+	Job newJob;
+	newJob.function = job;
+	newJob.counter = counter;
+
+	//run the job directly if there are no workers
+	if(_Queues.empty()) {
+		newJob.function();
+		return;
+	}
+
+	if(counter != nullptr) counter->pending++;
+
+	//push onto the back of the calling thread's deque, other threads steal from the front
+	JobQueue* queue = _Queues[_ThreadIndex];
+
+	{
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		queue->jobs.push_back(newJob);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_SleepMutex);
+		_QueuedJobs++;
+	}
+
+	_WakeCondition.notify_one();
+}
+
+void JobSystem::Wait(JobCounter* counter) {
+	//help out with pending jobs instead of blocking the waiting thread
+	while(counter->pending > 0) {
+		if(!_ExecuteNext(_ThreadIndex)) std::this_thread::yield();
+	}
+}
+
+void JobSystem::ParallelFor(unsigned int count, unsigned int batchSize, std::function<void(unsigned int start, unsigned int end)> job) {
+	if(count == 0) return;
+	if(batchSize == 0) batchSize = 1;
+
+	JobCounter counter;
+
+	for(unsigned int start = 0; start < count; start += batchSize) {
+		unsigned int end = (start + batchSize < count) ? start + batchSize : count;
+
+		Schedule([&job, start, end]() { job(start, end); }, &counter);
+	}
+
+	Wait(&counter);
+}
+
+void JobSystem::_WorkerLoop(unsigned int threadIndex) {
+	_ThreadIndex = threadIndex;
+
+	while(_Running) {
+		if(_ExecuteNext(threadIndex)) continue;
+
+		//sleep until new jobs get scheduled
+		std::unique_lock<std::mutex> lock(_SleepMutex);
+		_WakeCondition.wait(lock, []() { return _QueuedJobs > 0 || !_Running; });
+	}
+}
+
+bool JobSystem::_ExecuteNext(unsigned int threadIndex) {
+	Job job;
+
+	if(_Pop(threadIndex, job) || _Steal(threadIndex, job)) {
+		_Execute(job);
+		return true;
+	}
+
+	return false;
+}
+
+bool JobSystem::_Pop(unsigned int threadIndex, Job& job) {
+	JobQueue* queue = _Queues[threadIndex];
+	std::lock_guard<std::mutex> lock(queue->mutex);
+
+	if(queue->jobs.empty()) return false;
+
+	//newest job first to stay cache friendly
+	job = queue->jobs.back();
+	queue->jobs.pop_back();
+	_QueuedJobs--;
+
+	return true;
+}
+
+bool JobSystem::_Steal(unsigned int threadIndex, Job& job) {
+	unsigned int queueCount = _Queues.size();
+	unsigned int offset = _NextQueue++; //spread the thieves over different victims
+
+	for(unsigned int i = 0; i < queueCount; i++) {
+		unsigned int victim = (offset + i) % queueCount;
+		if(victim == threadIndex) continue;
+
+		JobQueue* queue = _Queues[victim];
+		std::lock_guard<std::mutex> lock(queue->mutex);
+
+		if(queue->jobs.empty()) continue;
+
+		//oldest job first, it usually holds the most remaining work
+		job = queue->jobs.front();
+		queue->jobs.pop_front();
+		_QueuedJobs--;
+
+		return true;
+	}
+
+	return false;
+}
+
+void JobSystem::_Execute(Job& job) {
+	job.function();
+
+	if(job.counter != nullptr) job.counter->pending--;
+}
\ No newline at end of file
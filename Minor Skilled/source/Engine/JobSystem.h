@@ -0,0 +1,61 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+//counts the unfinished jobs of a batch, used to wait for their completion
+struct JobCounter {
+	JobCounter(): pending(0) {}
+
+	std::atomic<unsigned int> pending;
+};
+
+class JobSystem {
+	public:
+		static void Initialize(unsigned int workerCount = 0);
+		static void Shutdown();
+
+		static unsigned int GetThreadCount();
+		static unsigned int GetThreadIndex();
+
+		static void Schedule(std::function<void()> job, JobCounter* counter = nullptr);
+		static void Wait(JobCounter* counter);
+		static void ParallelFor(unsigned int count, unsigned int batchSize, std::function<void(unsigned int start, unsigned int end)> job);
+
+	private:
+		struct Job {
+			std::function<void()> function;
+			JobCounter* counter;
+		};
+
+		struct JobQueue {
+			std::deque<Job> jobs;
+			std::mutex mutex;
+		};
+
+		static std::vector<std::thread> _Workers;
+		static std::vector<JobQueue*> _Queues; //one deque per thread, index 0 belongs to the main thread
+
+		static std::atomic<bool> _Running;
+		static std::atomic<unsigned int> _QueuedJobs;
+		static std::atomic<unsigned int> _NextQueue;
+
+		static std::mutex _SleepMutex;
+		static std::condition_variable _WakeCondition;
+
+		static thread_local unsigned int _ThreadIndex;
+
+		static void _WorkerLoop(unsigned int threadIndex);
+		static bool _ExecuteNext(unsigned int threadIndex);
+		static bool _Pop(unsigned int threadIndex, Job& job);
+		static bool _Steal(unsigned int threadIndex, Job& job);
+		static void _Execute(Job& job);
+};
+
+#endif
\ No newline at end of file
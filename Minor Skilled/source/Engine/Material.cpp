@@ -1,5 +1,11 @@
 #include "Material.h"
 
+#include "../Engine/Shader.h"
+
+int Material::_PrimaryProbe = -1;
+int Material::_SecondaryProbe = -1;
+float Material::_ProbeBlend = 0.0f;
+
 Material::~Material() {
 }
 
@@ -23,5 +29,21 @@ bool& Material::getCastsShadows() {
 	return _castsShadows;
 }
 
+void Material::getTextures(std::vector<Texture*>& /*textures*/) {
+	//materials without textures have nothing to add
+}
+
+void Material::SetReflectionProbes(int primaryProbe, int secondaryProbe, float probeBlend) {
+	_PrimaryProbe = primaryProbe;
+	_SecondaryProbe = secondaryProbe;
+	_ProbeBlend = probeBlend;
+}
+
 Material::Material(MaterialType materialType, BlendMode blendMode, bool castsShadows): _materialType(materialType), _blendMode(blendMode), _castsShadows(castsShadows) {
 }
+
+void Material::_setReflectionProbes(Shader* shader) {
+	shader->setInt("primaryProbe", _PrimaryProbe);
+	shader->setInt("secondaryProbe", _SecondaryProbe);
+	shader->setFloat("probeBlend", _ProbeBlend);
+}
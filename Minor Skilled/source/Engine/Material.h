@@ -10,6 +10,7 @@
 
 class Shader;
 class LightComponent;
+class Texture;
 
 class Material {
 	public:
@@ -22,10 +23,15 @@ class Material {
 		void setCastsShadows(bool value);
 		bool& getCastsShadows();
 
+		virtual void getTextures(std::vector<Texture*>& textures);
+
 		virtual void drawSimple(Shader* shader) = 0;
 		virtual void drawForward(glm::mat4& modelMatrix) = 0;
 		virtual void drawDeferred(glm::mat4& modelMatrix) = 0;
 
+		//reflection probes sampled by the following draws, set by the renderer per object
+		static void SetReflectionProbes(int primaryProbe, int secondaryProbe, float probeBlend);
+
 	protected:
 		Material(MaterialType materialType, BlendMode blendMode, bool castsShadows);
 
@@ -33,7 +39,12 @@ class Material {
 		BlendMode _blendMode;
 		bool _castsShadows;
 
+		static int _PrimaryProbe;
+		static int _SecondaryProbe;
+		static float _ProbeBlend;
+
 		virtual void _initShader() = 0;
+		void _setReflectionProbes(Shader* shader);
 
 };
 
@@ -1,57 +1,352 @@
 #include "Mesh.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <glm/gtc/packing.hpp>
+
 #include "../Engine/VertexArray.h"
 #include "../Engine/Buffer.h"
+#include "../Engine/Uploader.h"
 
-Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices):_vertices(vertices), _indices(indices) {
-	_setupMesh();
+#include "../Utility/RenderSettings.h"
+
+Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<std::vector<unsigned int>> lods):_vertices(vertices), _indices(indices), _lods(lods),
+ _compressed(false), _pendingUploads(0), _VAO(nullptr), _positionVAO(nullptr), _VBO(nullptr), _positionVBO(nullptr), _EBO(nullptr) {
+	//local space bounds used for culling
+	for(unsigned int i = 0; i < _vertices.size(); i++) {
+		_bounds.expand(_vertices[i].position);
+	}
+
+	//store all detail levels back to back in the element buffer
+	_indexSize = GetIndexSize(_vertices.size());
+
+	std::vector<unsigned int> lodIndices(_indices);
+
+	_lodOffsets.push_back(0);
+	_lodCounts.push_back(_indices.size());
+
+	for(unsigned int i = 0; i < _lods.size(); i++) {
+		_lodOffsets.push_back(lodIndices.size());
+		_lodCounts.push_back(_lods[i].size());
+
+		lodIndices.insert(lodIndices.end(), _lods[i].begin(), _lods[i].end());
+	}
+
+	_computeUvDensity();
+
+	if(_indexSize == sizeof(unsigned short)) {
+		//every index fits into 16 bits, which halves the size of the element buffer
+		std::vector<unsigned short> shortIndices(lodIndices.begin(), lodIndices.end());
+		_elementData.assign((const unsigned char*)shortIndices.data(), (const unsigned char*)(shortIndices.data() + shortIndices.size()));
+	} else {
+		_elementData.assign((const unsigned char*)lodIndices.data(), (const unsigned char*)(lodIndices.data() + lodIndices.size()));
+	}
+}
+
+Mesh::Mesh(const Vertex* vertices, unsigned int vertexCount, const void* indices, unsigned int indexSize, std::vector<unsigned int>& lodOffsets, std::vector<unsigned int>& lodCounts, AABB& bounds):
+ _vertices(vertices, vertices + vertexCount), _lodOffsets(lodOffsets), _lodCounts(lodCounts), _bounds(bounds), _indexSize(indexSize),
+ _compressed(false), _pendingUploads(0), _VAO(nullptr), _positionVAO(nullptr), _VBO(nullptr), _positionVBO(nullptr), _EBO(nullptr) {
+	//the index data already contains all levels in element buffer layout, keep a 32 bit copy of each level for cpu side users
+	const unsigned short* shortIndices = (const unsigned short*)indices;
+	const unsigned int* intIndices = (const unsigned int*)indices;
+
+	for(unsigned int i = 0; i < lodCounts.size(); i++) {
+		std::vector<unsigned int> lodIndices;
+
+		if(_indexSize == sizeof(unsigned short)) lodIndices.assign(shortIndices + lodOffsets[i], shortIndices + lodOffsets[i] + lodCounts[i]);
+		else lodIndices.assign(intIndices + lodOffsets[i], intIndices + lodOffsets[i] + lodCounts[i]);
+
+		if(i == 0) _indices.swap(lodIndices);
+		else _lods.push_back(lodIndices);
+	}
+
+	_computeUvDensity();
+
+	//the source memory is usually a mapping which is closed before the buffers are created
+	unsigned int indexCount = lodOffsets.back() + lodCounts.back();
+	_elementData.assign((const unsigned char*)indices, (const unsigned char*)indices + indexCount * _indexSize);
 }
 
 Mesh::~Mesh() {
+	if(_pendingUploads > 0) Uploader::Flush(); //the copies still target these buffers
+
 	delete _VAO;
+	delete _positionVAO;
 	delete _VBO;
+	delete _positionVBO;
 	delete _EBO;
 }
 
-void Mesh::draw() {
-	_VAO->bind();
+void Mesh::setup() {
+	if(_VAO != nullptr) return;
 
-	_VAO->drawElements(GL_TRIANGLES, _indices.size(), GL_UNSIGNED_INT, 0);
-	VertexArray::Unbind();
+	_setupMesh();
+}
+
+bool Mesh::isSetup() {
+	return _VAO != nullptr;
+}
+
+bool Mesh::isResident() {
+	return _VAO != nullptr && _pendingUploads == 0;
+}
+
+void Mesh::draw(unsigned int lod) {
+	_draw(_VAO, lod);
+}
+
+void Mesh::drawPositions(unsigned int lod) {
+	_draw(_positionVAO, lod);
+}
+
+AABB& Mesh::getBounds() {
+	return _bounds;
+}
+
+std::vector<Vertex>& Mesh::getVertices() {
+	return _vertices;
+}
+
+std::vector<unsigned int>& Mesh::getIndices() {
+	return _indices;
+}
+
+unsigned int Mesh::getTriangleCount() {
+	return _indices.size() / 3;
+}
+
+unsigned int Mesh::getLodCount() {
+	return _lods.size() + 1;
+}
+
+std::vector<unsigned int>& Mesh::getLodIndices(unsigned int lod) {
+	if(lod == 0 || _lods.empty()) return _indices;
+
+	return _lods[std::min(lod, (unsigned int)_lods.size()) - 1];
+}
+
+std::vector<unsigned int>& Mesh::getLodOffsets() {
+	return _lodOffsets;
+}
+
+std::vector<unsigned int>& Mesh::getLodCounts() {
+	return _lodCounts;
+}
+
+unsigned int Mesh::getIndexSize() {
+	return _indexSize;
+}
+
+unsigned int Mesh::getVertexSize() {
+	return _compressed ? sizeof(PackedVertex) : sizeof(Vertex);
+}
+
+unsigned long long Mesh::getMemorySize() {
+	//vertex buffer, position stream and the element buffer with all detail levels
+	unsigned long long positionSize = _compressed ? 4 * sizeof(unsigned short) : sizeof(glm::vec3);
+	unsigned long long indexCount = _lodOffsets.back() + _lodCounts.back();
+
+	return _vertices.size() * (getVertexSize() + positionSize) + indexCount * _indexSize;
+}
+
+float Mesh::getUvDensity() {
+	return _uvDensity;
+}
+
+unsigned int Mesh::GetIndexSize(unsigned int vertexCount) {
+	return (vertexCount <= 65536) ? sizeof(unsigned short) : sizeof(unsigned int);
+}
+
+void Mesh::_computeUvDensity() {
+	//used by the texture streaming to estimate how many texels end up on a screen pixel
+	float uvArea = 0.0f;
+	float surfaceArea = 0.0f;
+
+	for(unsigned int i = 0; i + 2 < _indices.size(); i += 3) {
+		Vertex& v0 = _vertices[_indices[i]];
+		Vertex& v1 = _vertices[_indices[i + 1]];
+		Vertex& v2 = _vertices[_indices[i + 2]];
+
+		glm::vec2 uvEdge1 = v1.uv - v0.uv;
+		glm::vec2 uvEdge2 = v2.uv - v0.uv;
+
+		uvArea += std::abs(uvEdge1.x * uvEdge2.y - uvEdge2.x * uvEdge1.y) * 0.5f;
+		surfaceArea += glm::length(glm::cross(v1.position - v0.position, v2.position - v0.position)) * 0.5f;
+	}
+
+	_uvDensity = (surfaceArea > 0.0f) ? uvArea / surfaceArea : 0.0f;
 }
 
 void Mesh::_setupMesh() {
 	//generate vertex array and buffer objects
 	_VAO = new VertexArray();
+	_positionVAO = new VertexArray();
 	_VBO = new Buffer(GL_ARRAY_BUFFER);
+	_positionVBO = new Buffer(GL_ARRAY_BUFFER);
 	_EBO = new Buffer(GL_ELEMENT_ARRAY_BUFFER);
 
-	//buffer data
-	_VAO->bind(); //bind, so it can store all configurations done from here
-
-	_VBO->bind();
-	_VBO->bufferData(&_vertices[0], _vertices.size() * sizeof(Vertex)); //fill the vertex buffer object with vertex data
+	//both vertex arrays share the element buffer
+	_VAO->bind();
+	_upload(_EBO, &_elementData[0], _elementData.size()); //fill the element bufer with index data
+	std::vector<unsigned char>().swap(_elementData); //copied into the staging ring
 
+	_positionVAO->bind();
 	_EBO->bind();
-	_EBO->bufferData(&_indices[0], _indices.size() * sizeof(unsigned int)); //fill the element bufer with index data
 
-	//vertex positions
-	_VAO->setAttribute(0, 3, GL_FLOAT, sizeof(Vertex), (void*)0);
+	VertexArray::Unbind(); //unbind
+
+	_setupVertexBuffers(RenderSettings::IsEnabled(RenderSettings::CompressedVertices));
+}
+
+void Mesh::_setupVertexBuffers(bool compressed) {
+	_compressed = compressed;
+
+	if(_compressed) {
+		//quantize the positions to the bounds and encode the tangent frame, the shaders decode it again
+		std::vector<PackedVertex> packedVertices(_vertices.size());
+		std::vector<unsigned short> positions(_vertices.size() * 4);
+
+		glm::vec3 extent = _bounds.max - _bounds.min;
+
+		for(unsigned int i = 0; i < _vertices.size(); i++) {
+			Vertex& vertex = _vertices[i];
+			PackedVertex& packedVertex = packedVertices[i];
+
+			for(unsigned int j = 0; j < 3; j++) {
+				float position = (extent[j] > 0.0f) ? (vertex.position[j] - _bounds.min[j]) / extent[j] : 0.0f;
+				packedVertex.position[j] = (unsigned short)(glm::clamp(position, 0.0f, 1.0f) * 65535.0f + 0.5f);
+			}
+
+			//the bitangent only needs its handedness, the shaders reconstruct it from the normal and tangent
+			packedVertex.position[3] = (glm::dot(glm::cross(vertex.normal, vertex.tangent), vertex.bitangent) < 0.0f) ? 0 : 65535;
+
+			glm::vec2 normal = _EncodeOctahedral(vertex.normal);
+			glm::vec2 tangent = _EncodeOctahedral(vertex.tangent);
+
+			packedVertex.frame[0] = (short)glm::packSnorm1x16(normal.x);
+			packedVertex.frame[1] = (short)glm::packSnorm1x16(normal.y);
+			packedVertex.frame[2] = (short)glm::packSnorm1x16(tangent.x);
+			packedVertex.frame[3] = (short)glm::packSnorm1x16(tangent.y);
+
+			packedVertex.uv[0] = glm::packHalf1x16(vertex.uv.x);
+			packedVertex.uv[1] = glm::packHalf1x16(vertex.uv.y);
+
+			std::copy(packedVertex.position, packedVertex.position + 4, &positions[i * 4]);
+		}
+
+		_VAO->bind();
+		_upload(_VBO, &packedVertices[0], packedVertices.size() * sizeof(PackedVertex));
+
+		//vertex positions, normalized to [0, 1]
+		_VAO->setAttribute(0, 4, GL_UNSIGNED_SHORT, sizeof(PackedVertex), (void*)offsetof(PackedVertex, position), true);
+
+		//vertex uvs
+		_VAO->setAttribute(2, 2, GL_HALF_FLOAT, sizeof(PackedVertex), (void*)offsetof(PackedVertex, uv));
 
-	//vertex normals
-	_VAO->setAttribute(1, 3, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+		//octahedral normal and tangent, normalized to [-1, 1]
+		_VAO->setAttribute(5, 4, GL_SHORT, sizeof(PackedVertex), (void*)offsetof(PackedVertex, frame), true);
 
-	//vertex uvs
-	_VAO->setAttribute(2, 2, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, uv));
+		_VAO->disableAttribute(1);
+		_VAO->disableAttribute(3);
+		_VAO->disableAttribute(4);
 
-	//vertex tangent
-	_VAO->setAttribute(3, 3, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, tangent));
+		//position only stream
+		_positionVAO->bind();
+		_upload(_positionVBO, &positions[0], positions.size() * sizeof(unsigned short));
+		_positionVAO->setAttribute(0, 4, GL_UNSIGNED_SHORT, 4 * sizeof(unsigned short), (void*)0, true);
+	} else {
+		std::vector<glm::vec3> positions(_vertices.size());
 
-	//vertex bitangent
-	_VAO->setAttribute(4, 3, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, bitangent));
+		for(unsigned int i = 0; i < _vertices.size(); i++) {
+			positions[i] = _vertices[i].position;
+		}
+
+		_VAO->bind(); //bind, so it can store all configurations done from here
+		_upload(_VBO, &_vertices[0], _vertices.size() * sizeof(Vertex)); //fill the vertex buffer object with vertex data
+
+		//vertex positions
+		_VAO->setAttribute(0, 3, GL_FLOAT, sizeof(Vertex), (void*)0);
+
+		//vertex normals
+		_VAO->setAttribute(1, 3, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+
+		//vertex uvs
+		_VAO->setAttribute(2, 2, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, uv));
+
+		//vertex tangent
+		_VAO->setAttribute(3, 3, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, tangent));
+
+		//vertex bitangent
+		_VAO->setAttribute(4, 3, GL_FLOAT, sizeof(Vertex), (void*)offsetof(Vertex, bitangent));
+
+		_VAO->disableAttribute(5);
+
+		//position only stream
+		_positionVAO->bind();
+		_upload(_positionVBO, &positions[0], positions.size() * sizeof(glm::vec3));
+		_positionVAO->setAttribute(0, 3, GL_FLOAT, sizeof(glm::vec3), (void*)0);
+	}
 
 	VertexArray::Unbind(); //unbind
+}
+
+void Mesh::_upload(Buffer* buffer, const void* data, unsigned int size) {
+	//only allocate the storage here, the data is copied over from the staging ring once the uploader gets to it
+	buffer->bind();
+	buffer->allocateMemory(size);
+
+	_pendingUploads++;
+	Uploader::UploadBuffer(buffer, data, size, [this]() { _pendingUploads--; });
+}
+
+void Mesh::_draw(VertexArray* vertexArray, unsigned int lod) {
+	if(_VAO == nullptr || _pendingUploads > 0) return; //not set up or streamed in yet, the layout can only change once the copies finished
+
+	if(lod >= _lodCounts.size()) lod = _lodCounts.size() - 1; //use the coarsest level this mesh has
+
+	//switch the vertex layout when the setting changed, the vertices are still around on the cpu
+	bool compressed = RenderSettings::IsEnabled(RenderSettings::CompressedVertices);
+
+	if(compressed != _compressed) {
+		_setupVertexBuffers(compressed);
+		if(_pendingUploads > 0) return; //the new buffers are only allocated, their vertices are copied in by the uploader
+	}
+
+	//the dequantization is constant per mesh, so it is passed as generic vertex attributes instead of a uniform in every shader
+	if(_compressed) {
+		glm::vec3 extent = _bounds.max - _bounds.min;
+
+		glVertexAttrib4f(6, extent.x, extent.y, extent.z, 1.0f);
+		glVertexAttrib3f(7, _bounds.min.x, _bounds.min.y, _bounds.min.z);
+	} else {
+		glVertexAttrib4f(6, 1.0f, 1.0f, 1.0f, 0.0f);
+		glVertexAttrib3f(7, 0.0f, 0.0f, 0.0f);
+	}
+
+	vertexArray->bind();
+
+	GLenum indexType = (_indexSize == sizeof(unsigned short)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	vertexArray->drawElements(GL_TRIANGLES, _lodCounts[lod], indexType, (void*)((size_t)_lodOffsets[lod] * _indexSize));
+	VertexArray::Unbind();
+}
+
+glm::vec2 Mesh::_EncodeOctahedral(glm::vec3 direction) {
+	//project onto the octahedron and unfold the lower half into the corners of the square
+	float length = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+	if(length == 0.0f) return glm::vec2(0.0f); //missing normals or tangents
+
+	direction /= length;
+
+	glm::vec2 encoded(direction.x, direction.y);
+
+	if(direction.z < 0.0f) {
+		encoded.x = (1.0f - std::abs(direction.y)) * (direction.x >= 0.0f ? 1.0f : -1.0f);
+		encoded.y = (1.0f - std::abs(direction.x)) * (direction.y >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	return encoded;
 }
\ No newline at end of file
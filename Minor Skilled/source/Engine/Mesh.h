@@ -9,25 +9,73 @@
 
 #include "../Engine/Vertex.h"
 
+#include "../Utility/AABB.h"
+
 class VertexArray;
 class Buffer;
 
 class Mesh {
 	public:
-		Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices);
+		Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<std::vector<unsigned int>> lods = std::vector<std::vector<unsigned int>>());
+		Mesh(const Vertex* vertices, unsigned int vertexCount, const void* indices, unsigned int indexSize, std::vector<unsigned int>& lodOffsets, std::vector<unsigned int>& lodCounts, AABB& bounds); //indices of all levels back to back, e.g. from the mesh cache
 		~Mesh();
 
-		void draw();
+		//the constructors only prepare the data and can run on any thread, the buffers are created here on the main thread
+		void setup();
+		bool isSetup();
+		bool isResident(); //set up and all buffers copied in by the uploader
+
+		void draw(unsigned int lod = 0);
+		void drawPositions(unsigned int lod = 0); //position only stream for depth and shadow passes
+
+		AABB& getBounds();
+		std::vector<Vertex>& getVertices();
+		std::vector<unsigned int>& getIndices();
+		unsigned int getTriangleCount();
+
+		unsigned int getLodCount();
+		std::vector<unsigned int>& getLodIndices(unsigned int lod);
+		std::vector<unsigned int>& getLodOffsets();
+		std::vector<unsigned int>& getLodCounts();
+
+		unsigned int getIndexSize();
+		unsigned int getVertexSize();
+		unsigned long long getMemorySize();
+		float getUvDensity();
+
+		static unsigned int GetIndexSize(unsigned int vertexCount);
 
 	private:
 		std::vector<Vertex> _vertices;
 		std::vector<unsigned int> _indices;
+		std::vector<std::vector<unsigned int>> _lods; //simplified index lists, the full resolution indices are level 0
+
+		//ranges of each level inside of the element buffer
+		std::vector<unsigned int> _lodOffsets;
+		std::vector<unsigned int> _lodCounts;
+
+		std::vector<unsigned char> _elementData; //element buffer contents until the mesh is set up
+
+		AABB _bounds;
+
+		unsigned int _indexSize; //bytes per index in the element buffer
+		bool _compressed; //layout of the vertex buffers, either Vertex or PackedVertex
+		unsigned int _pendingUploads; //buffers still streaming in through the uploader
+		float _uvDensity; //texture coordinate area per local space surface area
 
 		VertexArray* _VAO;
+		VertexArray* _positionVAO;
 		Buffer* _VBO;
+		Buffer* _positionVBO;
 		Buffer* _EBO;
 
+		void _computeUvDensity();
 		void _setupMesh();
+		void _setupVertexBuffers(bool compressed);
+		void _upload(Buffer* buffer, const void* data, unsigned int size);
+		void _draw(VertexArray* vertexArray, unsigned int lod);
+
+		static glm::vec2 _EncodeOctahedral(glm::vec3 direction);
 
 };
 
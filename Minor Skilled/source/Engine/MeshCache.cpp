@@ -0,0 +1,240 @@
+#include "MeshCache.h"
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+#include <cstddef>
+
+#include "../Engine/Model.h"
+#include "../Engine/Mesh.h"
+#include "../Engine/Vertex.h"
+
+#include "../Utility/AABB.h"
+#include "../Utility/Filepath.h"
+#include "../Utility/MappedFile.h"
+
+const char MeshCache::_Magic[4] = { 'G', 'X', 'M', 'C' };
+const unsigned int MeshCache::_Version = 2; //increase whenever the layout of the cache or the import changes
+const std::string MeshCache::_Extension = ".meshcache";
+
+Model* MeshCache::Load(std::string path) {
+	unsigned long long sourceTime;
+	unsigned long long sourceSize;
+
+	if(!Filepath::GetFileStats(path, sourceTime, sourceSize)) return nullptr;
+
+	MappedFile cache(GetCachePath(path));
+	if(!cache.isOpen() || cache.getSize() < sizeof(Header)) return nullptr;
+
+	const unsigned char* data = cache.getData();
+	const Header* header = (const Header*)data;
+
+	if(std::memcmp(header->magic, _Magic, sizeof(_Magic)) != 0 || header->version != _Version || header->vertexSize != sizeof(Vertex)) return nullptr;
+	if(header->sourceSize != sourceSize) return nullptr;
+
+	bool touched = header->sourceTime != sourceTime;
+
+	if(touched) {
+		//the timestamp changed (e.g. after a checkout), the cache is still valid if the contents are the same
+		MappedFile source(path);
+		if(!source.isOpen() || source.getHash() != header->sourceHash) return nullptr;
+	}
+
+	//make sure the whole table and all blobs are inside of the file before touching them
+	unsigned long long tableEnd = sizeof(Header) + (unsigned long long)header->meshCount * sizeof(MeshEntry);
+	if(tableEnd > cache.getSize()) return nullptr;
+
+	const MeshEntry* entries = (const MeshEntry*)(data + sizeof(Header));
+
+	for(unsigned int i = 0; i < header->meshCount; i++) {
+		const MeshEntry& entry = entries[i];
+
+		if(entry.vertexCount == 0 || entry.lodCount == 0 || entry.lodCount > _MaxLods) return nullptr;
+		if(entry.indexSize != sizeof(unsigned short) && entry.indexSize != sizeof(unsigned int)) return nullptr;
+		if(entry.vertexOffset > cache.getSize() || entry.indexOffset > cache.getSize()) return nullptr;
+		if(entry.vertexOffset + (unsigned long long)entry.vertexCount * sizeof(Vertex) > cache.getSize()) return nullptr;
+		if(entry.indexOffset + (unsigned long long)entry.indexCount * entry.indexSize > cache.getSize()) return nullptr;
+		if((unsigned long long)entry.lodOffsets[entry.lodCount - 1] + entry.lodCounts[entry.lodCount - 1] != entry.indexCount) return nullptr;
+
+		//every level has to be inside of the index blob and every index has to point at a vertex of its mesh
+		for(unsigned int j = 0; j < entry.lodCount; j++) {
+			if((unsigned long long)entry.lodOffsets[j] + entry.lodCounts[j] > entry.indexCount) return nullptr;
+		}
+
+		const unsigned char* indices = data + entry.indexOffset;
+
+		for(unsigned int j = 0; j < entry.indexCount; j++) {
+			unsigned int index = (entry.indexSize == sizeof(unsigned short)) ? ((const unsigned short*)indices)[j] : ((const unsigned int*)indices)[j];
+			if(index >= entry.vertexCount) return nullptr;
+		}
+	}
+
+	//upload every mesh straight from the mapping
+	Model* model = new Model();
+	model->filepath = path;
+
+	for(unsigned int i = 0; i < header->meshCount; i++) {
+		const MeshEntry& entry = entries[i];
+
+		std::vector<unsigned int> lodOffsets(entry.lodOffsets, entry.lodOffsets + entry.lodCount);
+		std::vector<unsigned int> lodCounts(entry.lodCounts, entry.lodCounts + entry.lodCount);
+
+		AABB bounds;
+		bounds.min = glm::vec3(entry.boundsMin[0], entry.boundsMin[1], entry.boundsMin[2]);
+		bounds.max = glm::vec3(entry.boundsMax[0], entry.boundsMax[1], entry.boundsMax[2]);
+
+		const Vertex* vertices = (const Vertex*)(data + entry.vertexOffset);
+		const void* indices = data + entry.indexOffset;
+
+		model->_meshes.push_back(new Mesh(vertices, entry.vertexCount, indices, entry.indexSize, lodOffsets, lodCounts, bounds));
+	}
+
+	model->_bounds.min = glm::vec3(header->boundsMin[0], header->boundsMin[1], header->boundsMin[2]);
+	model->_bounds.max = glm::vec3(header->boundsMax[0], header->boundsMax[1], header->boundsMax[2]);
+
+	//store the new timestamp, so the next load does not hash the source again
+	if(touched) {
+		cache.close();
+		Filepath::PatchFile(GetCachePath(path), offsetof(Header, sourceTime), &sourceTime, sizeof(sourceTime));
+	}
+
+	return model;
+}
+
+void MeshCache::Write(Model* model, std::string path) {
+	Header header;
+	std::memset(&header, 0, sizeof(Header));
+
+	if(!Filepath::GetFileStats(path, header.sourceTime, header.sourceSize)) return;
+
+	MappedFile source(path);
+	if(!source.isOpen()) return;
+
+	std::memcpy(header.magic, _Magic, sizeof(_Magic));
+	header.version = _Version;
+	header.vertexSize = sizeof(Vertex);
+	header.sourceHash = source.getHash();
+
+	std::vector<Mesh*>& meshes = model->getMeshes();
+	header.meshCount = meshes.size();
+
+	if(meshes.empty()) return;
+
+	AABB& modelBounds = model->getBounds();
+
+	for(unsigned int i = 0; i < 3; i++) {
+		header.boundsMin[i] = modelBounds.min[i];
+		header.boundsMax[i] = modelBounds.max[i];
+	}
+
+	//lay out the blobs behind the mesh table, aligned so they can be used in place
+	std::vector<MeshEntry> entries(meshes.size());
+	unsigned long long offset = _Align(sizeof(Header) + meshes.size() * sizeof(MeshEntry));
+
+	for(unsigned int i = 0; i < meshes.size(); i++) {
+		MeshEntry& entry = entries[i];
+		std::memset(&entry, 0, sizeof(MeshEntry));
+
+		std::vector<unsigned int>& lodOffsets = meshes[i]->getLodOffsets();
+		std::vector<unsigned int>& lodCounts = meshes[i]->getLodCounts();
+
+		if(lodCounts.size() > _MaxLods) {
+			std::cout << "ERROR: Too many detail levels to cache " + path << std::endl;
+			return;
+		}
+
+		entry.vertexCount = meshes[i]->getVertices().size();
+		entry.indexCount = lodOffsets.back() + lodCounts.back();
+		entry.indexSize = meshes[i]->getIndexSize();
+		entry.lodCount = lodCounts.size();
+
+		for(unsigned int j = 0; j < lodCounts.size(); j++) {
+			entry.lodOffsets[j] = lodOffsets[j];
+			entry.lodCounts[j] = lodCounts[j];
+		}
+
+		AABB& bounds = meshes[i]->getBounds();
+
+		for(unsigned int j = 0; j < 3; j++) {
+			entry.boundsMin[j] = bounds.min[j];
+			entry.boundsMax[j] = bounds.max[j];
+		}
+
+		entry.vertexOffset = offset;
+		offset = _Align(offset + entry.vertexCount * sizeof(Vertex));
+
+		entry.indexOffset = offset;
+		offset = _Align(offset + entry.indexCount * entry.indexSize);
+	}
+
+	//write into a temporary file first, so an interrupted write never leaves a broken cache behind
+	std::string cachePath = GetCachePath(path);
+	std::string tempPath = cachePath + ".tmp";
+
+	std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+
+	if(!file.is_open()) {
+		std::cout << "ERROR: Unable to write the mesh cache " + cachePath << std::endl;
+		return;
+	}
+
+	const char padding[16] = { 0 };
+	unsigned long long position = 0;
+
+	file.write((const char*)&header, sizeof(Header));
+	file.write((const char*)&entries[0], entries.size() * sizeof(MeshEntry));
+	position = sizeof(Header) + entries.size() * sizeof(MeshEntry);
+
+	for(unsigned int i = 0; i < meshes.size(); i++) {
+		std::vector<Vertex>& vertices = meshes[i]->getVertices();
+
+		file.write(padding, entries[i].vertexOffset - position);
+		file.write((const char*)&vertices[0], vertices.size() * sizeof(Vertex));
+		position = entries[i].vertexOffset + vertices.size() * sizeof(Vertex);
+
+		//the levels are stored back to back, just like in the element buffer
+		file.write(padding, entries[i].indexOffset - position);
+		position = entries[i].indexOffset;
+
+		for(unsigned int j = 0; j < entries[i].lodCount; j++) {
+			std::vector<unsigned int>& indices = meshes[i]->getLodIndices(j);
+
+			if(indices.empty()) continue;
+
+			//store the indices with the same width as the element buffer
+			if(entries[i].indexSize == sizeof(unsigned short)) {
+				std::vector<unsigned short> shortIndices(indices.begin(), indices.end());
+				file.write((const char*)&shortIndices[0], shortIndices.size() * sizeof(unsigned short));
+			} else {
+				file.write((const char*)&indices[0], indices.size() * sizeof(unsigned int));
+			}
+
+			position += indices.size() * entries[i].indexSize;
+		}
+	}
+
+	file.close();
+
+	if(file.fail()) {
+		std::cout << "ERROR: Unable to write the mesh cache " + cachePath << std::endl;
+		std::remove(tempPath.c_str());
+		return;
+	}
+
+	std::remove(cachePath.c_str());
+	std::rename(tempPath.c_str(), cachePath.c_str());
+}
+
+std::string MeshCache::GetCachePath(std::string path) {
+	return Filepath::GetCachePath(path, _Extension);
+}
+
+unsigned int MeshCache::GetVersion() {
+	return _Version;
+}
+
+unsigned long long MeshCache::_Align(unsigned long long offset) {
+	return (offset + 15) & ~15ull;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include <string>
+
+class Model;
+
+//binary copy of imported models in gpu layout, loading it skips assimp, the tangent generation and the lod simplification
+class MeshCache {
+	public:
+		static Model* Load(std::string path);
+		static void Write(Model* model, std::string path);
+
+		static std::string GetCachePath(std::string path);
+		static unsigned int GetVersion();
+
+	private:
+		static const unsigned int _MaxLods = 8;
+
+		static const char _Magic[4];
+		static const unsigned int _Version;
+		static const std::string _Extension;
+
+		struct Header {
+			char magic[4];
+			unsigned int version;
+			unsigned int vertexSize; //detects changes to the vertex layout
+			unsigned int meshCount;
+
+			//source file state at the time of the import
+			unsigned long long sourceTime;
+			unsigned long long sourceSize;
+			unsigned long long sourceHash;
+
+			float boundsMin[3];
+			float boundsMax[3];
+		};
+
+		struct MeshEntry {
+			unsigned long long vertexOffset;
+			unsigned long long indexOffset;
+			unsigned int vertexCount;
+			unsigned int indexCount; //indices of all detail levels
+			unsigned int indexSize; //2 or 4 bytes, matching the element buffer
+
+			unsigned int lodCount;
+			unsigned int lodOffsets[_MaxLods];
+			unsigned int lodCounts[_MaxLods];
+
+			float boundsMin[3];
+			float boundsMax[3];
+		};
+
+		static unsigned long long _Align(unsigned long long offset);
+};
+
+#endif
\ No newline at end of file
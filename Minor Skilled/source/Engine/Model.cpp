@@ -1,32 +1,170 @@
 #include "Model.h"
 
 #include <iostream>
+#include <algorithm>
+#include <climits>
 
 #include "../Engine/Mesh.h"
 #include "../Engine/Vertex.h"
+#include "../Engine/MeshCache.h"
 
-Model::Model() {
+#include "../Utility/MeshSimplifier.h"
+#include "../Utility/MeshOptimizer.h"
+
+const unsigned int Model::_MaxSetupsPerUpdate = 8;
+
+JobCounter Model::_LoadCounter;
+std::vector<std::pair<Model*, Model*>> Model::_Imported;
+std::vector<Model*> Model::_Pending;
+std::mutex Model::_Mutex;
+
+Model::Model(): _loading(false) {
 }
 
 Model::~Model() {
+	//the import still refers to this model
+	if(_loading) {
+		JobSystem::Wait(&_LoadCounter);
+		_AdoptImports();
+	}
+
+	_Pending.erase(std::remove(_Pending.begin(), _Pending.end(), this), _Pending.end());
+
 	for(unsigned int i = 0; i < _meshes.size(); i++) {
 		delete _meshes[i];
 	}
 }
 
-void Model::draw() {
+void Model::draw(unsigned int lod) {
 	for(unsigned int i = 0; i < _meshes.size(); i++) {
-		_meshes[i]->draw();
+		_meshes[i]->draw(lod);
 	}
 }
 
+void Model::drawPositions(unsigned int lod) {
+	for(unsigned int i = 0; i < _meshes.size(); i++) {
+		_meshes[i]->drawPositions(lod);
+	}
+}
+
+AABB& Model::getBounds() {
+	return _bounds;
+}
+
+std::vector<Mesh*>& Model::getMeshes() {
+	return _meshes;
+}
+
+unsigned int Model::getTriangleCount() {
+	unsigned int triangleCount = 0;
+
+	for(unsigned int i = 0; i < _meshes.size(); i++) {
+		triangleCount += _meshes[i]->getTriangleCount();
+	}
+
+	return triangleCount;
+}
+
+unsigned int Model::getLodCount() {
+	unsigned int lodCount = 1;
+
+	//meshes with fewer levels keep drawing their coarsest one
+	for(unsigned int i = 0; i < _meshes.size(); i++) {
+		lodCount = std::max(lodCount, _meshes[i]->getLodCount());
+	}
+
+	return lodCount;
+}
+
+unsigned long long Model::getMemorySize() {
+	unsigned long long memory = 0;
+
+	for(unsigned int i = 0; i < _meshes.size(); i++) {
+		memory += _meshes[i]->getMemorySize();
+	}
+
+	return memory;
+}
+
+bool Model::isLoaded() {
+	if(_loading) return false;
+
+	for(unsigned int i = 0; i < _meshes.size(); i++) {
+		if(!_meshes[i]->isResident()) return false;
+	}
+
+	return true;
+}
+
+float Model::getUvDensity() {
+	//the densest mesh decides, so no part of the model gets blurry
+	float uvDensity = 0.0f;
+
+	for(unsigned int i = 0; i < _meshes.size(); i++) {
+		uvDensity = std::max(uvDensity, _meshes[i]->getUvDensity());
+	}
+
+	return uvDensity;
+}
+
 Model* Model::LoadModel(std::string path) {
+	Model* model = _Import(path);
+	if(model == nullptr) return nullptr;
+
+	for(unsigned int i = 0; i < model->_meshes.size(); i++) {
+		model->_meshes[i]->setup();
+	}
+
+	return model;
+}
+
+Model* Model::LoadModelAsync(std::string path) {
+	//the model object exists right away, so render components can hold on to it while it is imported on a worker
 	Model* model = new Model();
+	model->filepath = path;
+	model->_loading = true;
+
+	JobSystem::Schedule([model, path]() {
+		Model* imported = _Import(path); //keeps the model empty if it fails
+
+		std::lock_guard<std::mutex> lock(_Mutex);
+		_Imported.push_back(std::make_pair(model, imported));
+	}, &_LoadCounter);
+
+	return model;
+}
+
+void Model::UpdateLoads() {
+	_AdoptImports();
+	_SetupMeshes(_MaxSetupsPerUpdate);
+}
+
+void Model::FinishLoads() {
+	//the main thread helps importing, the uploads are finished with Uploader::Flush
+	JobSystem::Wait(&_LoadCounter);
+
+	_AdoptImports();
+	_SetupMeshes(UINT_MAX);
+}
+
+bool Model::IsLoading() {
+	std::lock_guard<std::mutex> lock(_Mutex);
+
+	return _LoadCounter.pending > 0 || !_Imported.empty() || !_Pending.empty();
+}
+
+Model* Model::_Import(std::string path) {
+	//skip the import if there is an up to date binary copy of the model
+	Model* model = MeshCache::Load(path);
+	if(model != nullptr) return model;
+
+	model = new Model();
 
 	model->filepath = path;
 
 	Assimp::Importer importer;
-	const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+	//the simplifier needs shared vertices to find the edges between triangles, without them every vertex would be on a border
+	const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
 
 	if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
 		std::cout << "ERROR::ASSIMP::" << importer.GetErrorString() << std::endl;
@@ -36,9 +174,55 @@ Model* Model::LoadModel(std::string path) {
 
 	_ProcessNode(scene->mRootNode, scene, model);
 
+	//combine the bounds of all meshes
+	for(unsigned int i = 0; i < model->_meshes.size(); i++) {
+		model->_bounds.expand(model->_meshes[i]->getBounds());
+	}
+
+	MeshCache::Write(model, path);
+
 	return model;
 }
 
+void Model::_AdoptImports() {
+	std::vector<std::pair<Model*, Model*>> imported;
+
+	{
+		std::lock_guard<std::mutex> lock(_Mutex);
+		imported.swap(_Imported);
+	}
+
+	for(unsigned int i = 0; i < imported.size(); i++) {
+		Model* model = imported[i].first;
+		model->_loading = false;
+
+		if(imported[i].second == nullptr) continue;
+
+		model->_meshes.swap(imported[i].second->_meshes);
+		model->_bounds = imported[i].second->_bounds;
+
+		delete imported[i].second;
+
+		_Pending.push_back(model);
+	}
+}
+
+void Model::_SetupMeshes(unsigned int budget) {
+	//finish the models in the order they were imported
+	while(!_Pending.empty() && budget > 0) {
+		std::vector<Mesh*>& meshes = _Pending.front()->_meshes;
+
+		for(unsigned int i = 0; i < meshes.size() && budget > 0; i++) {
+			if(meshes[i]->isSetup()) continue;
+
+			meshes[i]->setup();
+			budget--;
+		}
+
+		if(budget > 0 || meshes.empty() || meshes.back()->isSetup()) _Pending.erase(_Pending.begin());
+	}
+}
+
 void Model::_ProcessNode(aiNode* node, const aiScene* scene, Model* model) {
 	//process all meshes of the node
 	for(unsigned int i = 0; i < node->mNumMeshes; i++) {
@@ -120,5 +304,35 @@ Mesh* Model::_ProcessMesh(aiMesh* mesh, const aiScene* scene) {
 		for(unsigned int j = 0; j < face.mNumIndices; j++) newIndices.push_back(face.mIndices[j]);
 	}
 
-	return new Mesh(newVertices, newIndices);
+	//only triangle lists can be optimized and simplified
+	std::vector<std::vector<unsigned int>> lods;
+
+	if(newIndices.size() % 3 != 0 || newIndices.empty()) return new Mesh(newVertices, newIndices, lods);
+
+	unsigned int vertexCountBefore = newVertices.size();
+	float acmrBefore = MeshOptimizer::GetAcmr(newIndices, newVertices.size());
+
+	//merge duplicated vertices first, so the cache can actually reuse them
+	MeshOptimizer::WeldVertices(newVertices, newIndices);
+
+	//reorder the triangles for the post transform cache and sort the resulting clusters to reduce overdraw
+	MeshOptimizer::OptimizeOverdraw(newVertices, newIndices);
+
+	//generate the detail levels at import time and order them for the cache as well
+	lods = MeshSimplifier::GenerateLods(newVertices, newIndices);
+
+	for(unsigned int i = 0; i < lods.size(); i++) {
+		MeshOptimizer::OptimizeVertexCache(lods[i], newVertices.size());
+	}
+
+	//store the vertices in the order the full resolution mesh uses them
+	MeshOptimizer::OptimizeVertexFetch(newVertices, newIndices, lods);
+
+	//memory of the full resolution level, indices fit into 16 bits whenever the mesh is small enough
+	unsigned int bytesBefore = vertexCountBefore * sizeof(Vertex) + newIndices.size() * sizeof(unsigned int);
+	unsigned int bytesAfter = newVertices.size() * sizeof(Vertex) + newIndices.size() * Mesh::GetIndexSize(newVertices.size());
+
+	std::cout << "Optimized mesh " << mesh->mName.C_Str() << ": " << vertexCountBefore << " -> " << newVertices.size() << " vertices, ACMR " << acmrBefore << " -> " << MeshOptimizer::GetAcmr(newIndices, newVertices.size()) << ", " << bytesBefore << " -> " << bytesAfter << " bytes" << std::endl;
+
+	return new Mesh(newVertices, newIndices, lods);
 }
\ No newline at end of file
@@ -3,11 +3,16 @@
 
 #include <string>
 #include <vector>
+#include <mutex>
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include "../Engine/JobSystem.h"
+
+#include "../Utility/AABB.h"
+
 class Mesh;
 
 class Model {
@@ -17,14 +22,46 @@ class Model {
 		std::string filepath;
 
 		static Model* LoadModel(std::string path);
+		static Model* LoadModelAsync(std::string path); //returns an empty model which is filled in once imported, see UpdateLoads
+
+		//main thread only, moves finished imports into their models and creates the buffers of a few meshes per call
+		static void UpdateLoads();
+		static void FinishLoads();
+		static bool IsLoading();
 
-		void draw();
+		void draw(unsigned int lod = 0);
+		void drawPositions(unsigned int lod = 0);
+
+		AABB& getBounds();
+		std::vector<Mesh*>& getMeshes();
+		unsigned int getTriangleCount();
+		unsigned int getLodCount();
+		unsigned long long getMemorySize();
+		bool isLoaded(); //main thread only, imported and every mesh resident
+		float getUvDensity();
 
 	private:
+		friend class MeshCache;
+
 		Model();
 		
 		std::vector<Mesh*> _meshes;
 
+		AABB _bounds;
+
+		bool _loading; //the import of this model is still in flight
+
+		static const unsigned int _MaxSetupsPerUpdate; //meshes whose buffers are created per update
+
+		static JobCounter _LoadCounter;
+		static std::vector<std::pair<Model*, Model*>> _Imported; //empty model and its import, added by the loading workers
+		static std::vector<Model*> _Pending; //models with meshes that are not set up yet
+		static std::mutex _Mutex;
+
+		static Model* _Import(std::string path); //any thread, the meshes are not set up
+		static void _AdoptImports();
+		static void _SetupMeshes(unsigned int budget);
+
 		static void _ProcessNode(aiNode* node, const aiScene* scene, Model* model);
 		static Mesh* _ProcessMesh(aiMesh* mesh, const aiScene* scene);
 };
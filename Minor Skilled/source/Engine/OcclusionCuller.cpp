@@ -0,0 +1,323 @@
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <emmintrin.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "../Engine/Node.h"
+#include "../Engine/Transform.h"
+#include "../Engine/Model.h"
+#include "../Engine/Mesh.h"
+#include "../Engine/Material.h"
+#include "../Engine/JobSystem.h"
+
+#include "../Components/RenderComponent.h"
+
+#include "../Utility/AABB.h"
+#include "../Utility/ComponentType.h"
+#include "../Utility/RenderSettings.h"
+
+const unsigned int OcclusionCuller::_TileSize = 8;
+const unsigned int OcclusionCuller::_BandHeight = 16; //rows rasterized by one job, multiple of the tile size
+
+OcclusionCuller::OcclusionCuller(): _occluderCount(0), _culledCount(0) {
+	_width = RenderSettings::OcclusionBufferWidth;
+	_height = RenderSettings::OcclusionBufferHeight;
+	_tilesX = _width / _TileSize;
+	_tilesY = _height / _TileSize;
+
+	_depthBuffer.resize(_width * _height, 1.0f);
+	_tileDepth.resize(_tilesX * _tilesY, 1.0f);
+}
+
+OcclusionCuller::~OcclusionCuller() {
+}
+
+void OcclusionCuller::cull(std::vector<Node*>& renderables, const glm::mat4& viewProjection) {
+	_viewProjection = viewProjection;
+
+	//opaque low poly models are used as occluders
+	std::vector<std::pair<RenderComponent*, glm::mat4>> occluders;
+	RenderComponent* renderComponent;
+
+	for(unsigned int i = 0; i < renderables.size(); i++) {
+		renderComponent = (RenderComponent*)renderables[i]->getComponent(ComponentType::Render);
+
+		if(renderComponent->model == nullptr || renderComponent->material == nullptr) continue;
+		if(renderComponent->material->getBlendMode() != BlendMode::Opaque) continue;
+		if(renderComponent->model->getTriangleCount() > RenderSettings::OccluderMaxTriangles) continue;
+
+		occluders.push_back(std::pair<RenderComponent*, glm::mat4>(renderComponent, renderables[i]->getTransform()->worldTransform));
+	}
+
+	_occluderCount = occluders.size();
+
+	//transform the occluders into screen space
+	_occluderTriangles.resize(occluders.size());
+
+	JobSystem::ParallelFor(occluders.size(), 8, [&](unsigned int start, unsigned int end) {
+		for(unsigned int i = start; i < end; i++) {
+			_transformOccluder(occluders[i].first, occluders[i].second, _occluderTriangles[i]);
+		}
+	});
+
+	//every job owns a horizontal band of the depth buffer, so no synchronization is needed while rasterizing
+	unsigned int bandCount = (_height + _BandHeight - 1) / _BandHeight;
+
+	JobSystem::ParallelFor(bandCount, 1, [&](unsigned int start, unsigned int end) {
+		for(unsigned int i = start; i < end; i++) {
+			_rasterizeBand(i);
+		}
+	});
+
+	//test the bounding boxes against the depth buffer
+	std::vector<unsigned char> visible(renderables.size());
+
+	JobSystem::ParallelFor(renderables.size(), 64, [&](unsigned int start, unsigned int end) {
+		for(unsigned int i = start; i < end; i++) {
+			RenderComponent* component = (RenderComponent*)renderables[i]->getComponent(ComponentType::Render);
+
+			if(component->model == nullptr) {
+				visible[i] = 1;
+				continue;
+			}
+
+			visible[i] = _isVisible(component->model->getBounds().transform(renderables[i]->getTransform()->worldTransform)) ? 1 : 0;
+		}
+	});
+
+	//remove the hidden objects while keeping the order
+	unsigned int visibleCount = 0;
+
+	for(unsigned int i = 0; i < renderables.size(); i++) {
+		if(visible[i]) renderables[visibleCount++] = renderables[i];
+	}
+
+	_culledCount = renderables.size() - visibleCount;
+	renderables.resize(visibleCount);
+}
+
+unsigned int OcclusionCuller::getOccluderCount() {
+	return _occluderCount;
+}
+
+unsigned int OcclusionCuller::getCulledCount() {
+	return _culledCount;
+}
+
+void OcclusionCuller::_transformOccluder(RenderComponent* renderComponent, const glm::mat4& modelMatrix, std::vector<glm::vec3>& triangles) {
+	triangles.clear();
+
+	glm::mat4 modelViewProjection = _viewProjection * modelMatrix;
+	std::vector<Mesh*>& meshes = renderComponent->model->getMeshes();
+	std::vector<glm::vec4> clipPositions;
+
+	for(unsigned int i = 0; i < meshes.size(); i++) {
+		std::vector<Vertex>& vertices = meshes[i]->getVertices();
+		std::vector<unsigned int>& indices = meshes[i]->getIndices();
+
+		clipPositions.resize(vertices.size());
+
+		for(unsigned int j = 0; j < vertices.size(); j++) {
+			clipPositions[j] = modelViewProjection * glm::vec4(vertices[j].position, 1.0f);
+		}
+
+		for(unsigned int j = 0; j + 2 < indices.size(); j += 3) {
+			glm::vec4 clipPos[3] = {clipPositions[indices[j]], clipPositions[indices[j + 1]], clipPositions[indices[j + 2]]};
+
+			//drop triangles crossing the near plane instead of clipping them, which only makes the culling more conservative
+			if(clipPos[0].z < -clipPos[0].w || clipPos[1].z < -clipPos[1].w || clipPos[2].z < -clipPos[2].w) continue;
+
+			for(unsigned int k = 0; k < 3; k++) {
+				glm::vec3 ndc = glm::vec3(clipPos[k]) / clipPos[k].w;
+
+				triangles.push_back(glm::vec3((ndc.x * 0.5f + 0.5f) * _width, (ndc.y * 0.5f + 0.5f) * _height, ndc.z * 0.5f + 0.5f));
+			}
+		}
+	}
+}
+
+void OcclusionCuller::_rasterizeBand(unsigned int band) {
+	int bandStart = band * _BandHeight;
+	int bandEnd = std::min(bandStart + (int)_BandHeight, (int)_height);
+
+	//clear the rows of the band to the far plane
+	std::fill(_depthBuffer.begin() + bandStart * _width, _depthBuffer.begin() + bandEnd * _width, 1.0f);
+
+	for(unsigned int i = 0; i < _occluderTriangles.size(); i++) {
+		std::vector<glm::vec3>& triangles = _occluderTriangles[i];
+
+		for(unsigned int j = 0; j + 2 < triangles.size(); j += 3) {
+			_rasterizeTriangle(triangles[j], triangles[j + 1], triangles[j + 2], bandStart, bandEnd);
+		}
+	}
+
+	//build the coarse level by storing the farthest depth of every tile
+	for(unsigned int tileY = bandStart / _TileSize; tileY < bandEnd / _TileSize; tileY++) {
+		for(unsigned int tileX = 0; tileX < _tilesX; tileX++) {
+			__m128 maxDepth = _mm_setzero_ps();
+
+			for(unsigned int y = tileY * _TileSize; y < (tileY + 1) * _TileSize; y++) {
+				float* row = &_depthBuffer[y * _width + tileX * _TileSize];
+
+				maxDepth = _mm_max_ps(maxDepth, _mm_loadu_ps(row));
+				maxDepth = _mm_max_ps(maxDepth, _mm_loadu_ps(row + 4));
+			}
+
+			maxDepth = _mm_max_ps(maxDepth, _mm_shuffle_ps(maxDepth, maxDepth, _MM_SHUFFLE(1, 0, 3, 2)));
+			maxDepth = _mm_max_ps(maxDepth, _mm_shuffle_ps(maxDepth, maxDepth, _MM_SHUFFLE(2, 3, 0, 1)));
+
+			_tileDepth[tileY * _tilesX + tileX] = _mm_cvtss_f32(maxDepth);
+		}
+	}
+}
+
+void OcclusionCuller::_rasterizeTriangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2, int bandStart, int bandEnd) {
+	//bounding rectangle clipped to the band
+	int minY = std::max((int)std::floor(std::min(v0.y, std::min(v1.y, v2.y))), bandStart);
+	int maxY = std::min((int)std::ceil(std::max(v0.y, std::max(v1.y, v2.y))), bandEnd - 1);
+
+	if(minY > maxY) return;
+
+	int minX = std::max((int)std::floor(std::min(v0.x, std::min(v1.x, v2.x))), 0);
+	int maxX = std::min((int)std::ceil(std::max(v0.x, std::max(v1.x, v2.x))), (int)_width - 1);
+
+	if(minX > maxX) return;
+
+	//rasterize both sides, flip the winding to keep the edge functions positive inside
+	float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+
+	if(std::abs(area) < 1e-6f) return;
+
+	if(area < 0.0f) {
+		std::swap(v1, v2);
+		area = -area;
+	}
+
+	//edge functions e(x, y) = a * x + b * y + c, each one is opposite to the vertex with the same index
+	float a0 = v1.y - v2.y, b0 = v2.x - v1.x, c0 = v1.x * v2.y - v1.y * v2.x;
+	float a1 = v2.y - v0.y, b1 = v0.x - v2.x, c1 = v2.x * v0.y - v2.y * v0.x;
+	float a2 = v0.y - v1.y, b2 = v1.x - v0.x, c2 = v0.x * v1.y - v0.y * v1.x;
+
+	//depth plane from the barycentric weights
+	float inverseArea = 1.0f / area;
+	float zx = (a0 * v0.z + a1 * v1.z + a2 * v2.z) * inverseArea;
+	float zy = (b0 * v0.z + b1 * v1.z + b2 * v2.z) * inverseArea;
+	float zc = (c0 * v0.z + c1 * v1.z + c2 * v2.z) * inverseArea;
+
+#ifdef __AVX2__
+	const int laneCount = 8;
+
+	__m256 laneOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+	__m256 zero = _mm256_setzero_ps();
+
+	for(int y = minY; y <= maxY; y++) {
+		float pixelY = y + 0.5f;
+
+		__m256 rowE0 = _mm256_set1_ps(b0 * pixelY + c0);
+		__m256 rowE1 = _mm256_set1_ps(b1 * pixelY + c1);
+		__m256 rowE2 = _mm256_set1_ps(b2 * pixelY + c2);
+		__m256 rowZ = _mm256_set1_ps(zy * pixelY + zc);
+
+		float* row = &_depthBuffer[y * _width];
+
+		for(int x = minX & ~(laneCount - 1); x <= maxX; x += laneCount) {
+			__m256 pixelX = _mm256_add_ps(_mm256_set1_ps((float)x), laneOffsets);
+
+			__m256 e0 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(a0), pixelX), rowE0);
+			__m256 e1 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(a1), pixelX), rowE1);
+			__m256 e2 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(a2), pixelX), rowE2);
+
+			__m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GE_OQ), _mm256_cmp_ps(e1, zero, _CMP_GE_OQ)), _mm256_cmp_ps(e2, zero, _CMP_GE_OQ));
+			if(_mm256_movemask_ps(inside) == 0) continue;
+
+			__m256 depth = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(zx), pixelX), rowZ);
+			__m256 oldDepth = _mm256_loadu_ps(row + x);
+
+			_mm256_storeu_ps(row + x, _mm256_blendv_ps(oldDepth, _mm256_min_ps(oldDepth, depth), inside));
+		}
+	}
+#else
+	const int laneCount = 4;
+
+	__m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	__m128 zero = _mm_setzero_ps();
+
+	for(int y = minY; y <= maxY; y++) {
+		float pixelY = y + 0.5f;
+
+		__m128 rowE0 = _mm_set1_ps(b0 * pixelY + c0);
+		__m128 rowE1 = _mm_set1_ps(b1 * pixelY + c1);
+		__m128 rowE2 = _mm_set1_ps(b2 * pixelY + c2);
+		__m128 rowZ = _mm_set1_ps(zy * pixelY + zc);
+
+		float* row = &_depthBuffer[y * _width];
+
+		for(int x = minX & ~(laneCount - 1); x <= maxX; x += laneCount) {
+			__m128 pixelX = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+
+			__m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a0), pixelX), rowE0);
+			__m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a1), pixelX), rowE1);
+			__m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a2), pixelX), rowE2);
+
+			__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+			if(_mm_movemask_ps(inside) == 0) continue;
+
+			__m128 depth = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(zx), pixelX), rowZ);
+			__m128 oldDepth = _mm_loadu_ps(row + x);
+			__m128 newDepth = _mm_min_ps(oldDepth, depth);
+
+			_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, newDepth), _mm_andnot_ps(inside, oldDepth)));
+		}
+	}
+#endif
+}
+
+bool OcclusionCuller::_isVisible(const AABB& bounds) {
+	if(!bounds.isValid()) return true;
+
+	//project the corners of the box and get its screen rectangle and closest depth
+	glm::vec2 minScreen = glm::vec2(1.0f);
+	glm::vec2 maxScreen = glm::vec2(-1.0f);
+	float minDepth = 1.0f;
+
+	for(unsigned int i = 0; i < 8; i++) {
+		glm::vec3 corner = glm::vec3((i & 1) ? bounds.max.x : bounds.min.x, (i & 2) ? bounds.max.y : bounds.min.y, (i & 4) ? bounds.max.z : bounds.min.z);
+		glm::vec4 clipPos = _viewProjection * glm::vec4(corner, 1.0f);
+
+		if(clipPos.z < -clipPos.w) return true; //box intersects the near plane, assume it is visible
+
+		glm::vec3 ndc = glm::vec3(clipPos) / clipPos.w;
+
+		minScreen = glm::min(minScreen, glm::vec2(ndc));
+		maxScreen = glm::max(maxScreen, glm::vec2(ndc));
+		minDepth = std::min(minDepth, ndc.z * 0.5f + 0.5f);
+	}
+
+	//convert to tiles, boxes outside the screen are left to the frustum culling
+	int minTileX = (int)std::floor((minScreen.x * 0.5f + 0.5f) * _width) / (int)_TileSize;
+	int maxTileX = (int)std::floor((maxScreen.x * 0.5f + 0.5f) * _width) / (int)_TileSize;
+	int minTileY = (int)std::floor((minScreen.y * 0.5f + 0.5f) * _height) / (int)_TileSize;
+	int maxTileY = (int)std::floor((maxScreen.y * 0.5f + 0.5f) * _height) / (int)_TileSize;
+
+	minTileX = std::max(minTileX, 0);
+	minTileY = std::max(minTileY, 0);
+	maxTileX = std::min(maxTileX, (int)_tilesX - 1);
+	maxTileY = std::min(maxTileY, (int)_tilesY - 1);
+
+	if(minTileX > maxTileX || minTileY > maxTileY) return true;
+
+	//the box is hidden if it lies behind the farthest occluder depth of every tile it touches
+	for(int tileY = minTileY; tileY <= maxTileY; tileY++) {
+		for(int tileX = minTileX; tileX <= maxTileX; tileX++) {
+			if(minDepth <= _tileDepth[tileY * _tilesX + tileX]) return true;
+		}
+	}
+
+	return false;
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef OCCLUSIONCULLER_H
+#define OCCLUSIONCULLER_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class Node;
+class AABB;
+class RenderComponent;
+
+//rasterizes low poly occluders into a coarse depth buffer on the cpu and tests bounding boxes against it
+class OcclusionCuller {
+	public:
+		OcclusionCuller();
+		~OcclusionCuller();
+
+		void cull(std::vector<Node*>& renderables, const glm::mat4& viewProjection);
+
+		unsigned int getOccluderCount();
+		unsigned int getCulledCount();
+
+	private:
+		static const unsigned int _TileSize;
+		static const unsigned int _BandHeight;
+
+		unsigned int _width;
+		unsigned int _height;
+		unsigned int _tilesX;
+		unsigned int _tilesY;
+
+		std::vector<float> _depthBuffer;
+		std::vector<float> _tileDepth; //farthest depth of every tile, the coarse level of the hierarchy
+
+		std::vector<std::vector<glm::vec3>> _occluderTriangles; //screen space triangles of every occluder
+
+		glm::mat4 _viewProjection;
+
+		unsigned int _occluderCount;
+		unsigned int _culledCount;
+
+		void _transformOccluder(RenderComponent* renderComponent, const glm::mat4& modelMatrix, std::vector<glm::vec3>& triangles);
+		void _rasterizeBand(unsigned int band);
+		void _rasterizeTriangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2, int bandStart, int bandEnd);
+		bool _isVisible(const AABB& bounds);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,207 @@
+#include "ProbeCache.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "../Engine/Texture.h"
+
+#include "../Utility/Filepath.h"
+#include "../Utility/MappedFile.h"
+
+const char ProbeCache::_Magic[4] = { 'G', 'X', 'P', 'C' };
+const unsigned int ProbeCache::_Version = 2; //increase whenever the layout of the cache or the baking changes
+const std::string ProbeCache::_Extension = ".probecache";
+
+bool ProbeCache::Load(unsigned long long key, std::vector<Texture*>& cubemaps, std::vector<float>& values) {
+	MappedFile cache(_GetCachePath(key));
+	if(!cache.isOpen() || cache.getSize() < sizeof(Header)) return false;
+
+	const unsigned char* data = cache.getData();
+	const Header* header = (const Header*)data;
+
+	if(std::memcmp(header->magic, _Magic, sizeof(_Magic)) != 0 || header->version != _Version || header->key != key) return false;
+
+	unsigned long long tableEnd = sizeof(Header) + (unsigned long long)header->cubemapCount * sizeof(CubemapEntry);
+	unsigned long long valuesEnd = tableEnd + (unsigned long long)header->valueCount * sizeof(float);
+	if(valuesEnd > cache.getSize()) return false;
+
+	//make sure every level of every cubemap is inside of the file before creating anything
+	std::vector<CubemapEntry> entries((const CubemapEntry*)(data + sizeof(Header)), (const CubemapEntry*)(data + tableEnd));
+
+	for(unsigned int i = 0; i < entries.size(); i++) {
+		CubemapEntry& entry = entries[i];
+		if(_GetChannels(entry.internalFormat) == 0 || entry.size == 0 || entry.levels == 0 || entry.levels > 16) return false;
+
+		unsigned long long size = 0;
+
+		for(unsigned int level = 0; level < entry.levels; level++) {
+			size += 6 * _GetFaceSize(entry, level);
+		}
+
+		if(entry.offset > cache.getSize() || size > cache.getSize() - entry.offset) return false;
+	}
+
+	const float* valueData = (const float*)(data + tableEnd);
+	values.assign(valueData, valueData + header->valueCount);
+
+	//upload the half floats straight from the mapping, the faces of each level are stored back to back
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 2); //rgb rows of the smallest levels are not 4 byte aligned
+
+	for(unsigned int i = 0; i < entries.size(); i++) {
+		CubemapEntry& entry = entries[i];
+		GLenum format = (_GetChannels(entry.internalFormat) == 4) ? GL_RGBA : GL_RGB;
+
+		Texture* cubemap = new Texture(GL_TEXTURE_CUBE_MAP);
+		cubemap->bind();
+
+		const unsigned char* faceData = data + entry.offset;
+
+		for(unsigned int level = 0; level < entry.levels; level++) {
+			unsigned int levelSize = std::max(entry.size >> level, 1u);
+
+			for(unsigned int face = 0; face < 6; face++) {
+				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, level, entry.internalFormat, levelSize, levelSize, 0, format, GL_HALF_FLOAT, faceData);
+				faceData += _GetFaceSize(entry, level);
+			}
+		}
+
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, entry.levels - 1);
+		cubemap->filter(entry.minFilter, entry.magFilter, GL_CLAMP_TO_EDGE);
+
+		cubemaps.push_back(cubemap);
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	return true;
+}
+
+void ProbeCache::Write(unsigned long long key, std::vector<Texture*>& cubemaps, std::vector<float>& values) {
+	Header header;
+	std::memset(&header, 0, sizeof(Header));
+
+	std::memcpy(header.magic, _Magic, sizeof(_Magic));
+	header.version = _Version;
+	header.key = key;
+	header.cubemapCount = cubemaps.size();
+	header.valueCount = values.size();
+
+	//ask the driver for the layout of every cubemap, the renderer allocates them with different sizes, formats and level counts
+	std::vector<CubemapEntry> entries(cubemaps.size());
+	unsigned long long offset = sizeof(Header) + entries.size() * sizeof(CubemapEntry) + values.size() * sizeof(float);
+
+	for(unsigned int i = 0; i < cubemaps.size(); i++) {
+		CubemapEntry& entry = entries[i];
+		std::memset(&entry, 0, sizeof(CubemapEntry));
+
+		int internalFormat, size, minFilter, magFilter;
+
+		cubemaps[i]->bind();
+		glGetTexLevelParameteriv(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+		glGetTexLevelParameteriv(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_TEXTURE_WIDTH, &size);
+		glGetTexParameteriv(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, &minFilter);
+		glGetTexParameteriv(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, &magFilter);
+
+		if(_GetChannels(internalFormat) == 0 || size <= 0) {
+			std::cout << "ERROR: Unable to cache a probe, its cubemaps have to be 16 bit float" << std::endl;
+			return;
+		}
+
+		entry.internalFormat = internalFormat;
+		entry.size = size;
+		entry.minFilter = minFilter;
+		entry.magFilter = magFilter;
+
+		//count the allocated levels up to the max level
+		int maxLevel;
+		glGetTexParameteriv(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, &maxLevel);
+
+		while(entry.levels < 16 && (int)entry.levels <= maxLevel) {
+			int levelSize;
+			glGetTexLevelParameteriv(GL_TEXTURE_CUBE_MAP_POSITIVE_X, entry.levels, GL_TEXTURE_WIDTH, &levelSize);
+
+			if(levelSize == 0) break;
+			entry.levels++;
+		}
+
+		entry.offset = offset;
+
+		for(unsigned int level = 0; level < entry.levels; level++) {
+			offset += 6 * _GetFaceSize(entry, level);
+		}
+	}
+
+	//write into a temporary file first, so an interrupted write never leaves a broken cache behind
+	std::string cachePath = _GetCachePath(key);
+	std::string tempPath = cachePath + ".tmp";
+
+	std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+
+	if(!file.is_open()) {
+		std::cout << "ERROR: Unable to write the probe cache " + cachePath << std::endl;
+		return;
+	}
+
+	file.write((const char*)&header, sizeof(Header));
+	if(!entries.empty()) file.write((const char*)&entries[0], entries.size() * sizeof(CubemapEntry));
+	if(!values.empty()) file.write((const char*)&values[0], values.size() * sizeof(float));
+
+	//read the baked faces back as half floats
+	glPixelStorei(GL_PACK_ALIGNMENT, 2);
+
+	for(unsigned int i = 0; i < cubemaps.size(); i++) {
+		CubemapEntry& entry = entries[i];
+		GLenum format = (_GetChannels(entry.internalFormat) == 4) ? GL_RGBA : GL_RGB;
+
+		std::vector<unsigned char> faceData(_GetFaceSize(entry, 0));
+		cubemaps[i]->bind();
+
+		for(unsigned int level = 0; level < entry.levels; level++) {
+			for(unsigned int face = 0; face < 6; face++) {
+				glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, level, format, GL_HALF_FLOAT, &faceData[0]);
+				file.write((const char*)&faceData[0], _GetFaceSize(entry, level));
+			}
+		}
+	}
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+	file.close();
+
+	if(file.fail()) {
+		std::cout << "ERROR: Unable to write the probe cache " + cachePath << std::endl;
+		std::remove(tempPath.c_str());
+		return;
+	}
+
+	std::remove(cachePath.c_str());
+	std::rename(tempPath.c_str(), cachePath.c_str());
+}
+
+std::string ProbeCache::_GetCachePath(unsigned long long key) {
+	std::stringstream name;
+	name << "probe_" << std::hex << std::setw(16) << std::setfill('0') << key;
+
+	return Filepath::GetCachePath(name.str(), _Extension);
+}
+
+unsigned int ProbeCache::_GetChannels(unsigned int internalFormat) {
+	if(internalFormat == GL_RGB16F) return 3;
+	if(internalFormat == GL_RGBA16F) return 4;
+
+	return 0; //not supported
+}
+
+unsigned long long ProbeCache::_GetFaceSize(CubemapEntry& entry, unsigned int level) {
+	unsigned long long levelSize = std::max(entry.size >> level, 1u);
+
+	return levelSize * levelSize * _GetChannels(entry.internalFormat) * sizeof(unsigned short); //half floats
+}
\ No newline at end of file
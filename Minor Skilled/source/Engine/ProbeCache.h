@@ -0,0 +1,44 @@
+#ifndef PROBECACHE_H
+#define PROBECACHE_H
+
+#include <string>
+#include <vector>
+
+class Texture;
+
+//baked environment probe cubemaps with all their levels, keyed by a hash of the scene content, the probe position and the bake settings
+class ProbeCache {
+	public:
+		//values are stored next to the maps, like the spherical harmonics of a probe
+		static bool Load(unsigned long long key, std::vector<Texture*>& cubemaps, std::vector<float>& values);
+		static void Write(unsigned long long key, std::vector<Texture*>& cubemaps, std::vector<float>& values); //16 bit float cubemaps only
+
+	private:
+		static const char _Magic[4];
+		static const unsigned int _Version;
+		static const std::string _Extension;
+
+		struct Header {
+			char magic[4];
+			unsigned int version;
+			unsigned long long key; //guards against colliding file names
+			unsigned int cubemapCount;
+			unsigned int valueCount; //floats after the cubemap table
+		};
+
+		struct CubemapEntry {
+			unsigned long long offset;
+			unsigned int internalFormat; //GL_RGB16F or GL_RGBA16F
+			unsigned int size;
+			unsigned int levels;
+			unsigned int minFilter;
+			unsigned int magFilter;
+			unsigned int padding;
+		};
+
+		static std::string _GetCachePath(unsigned long long key);
+		static unsigned int _GetChannels(unsigned int internalFormat);
+		static unsigned long long _GetFaceSize(CubemapEntry& entry, unsigned int level);
+};
+
+#endif
\ No newline at end of file
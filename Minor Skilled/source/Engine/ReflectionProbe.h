@@ -0,0 +1,14 @@
+#ifndef REFLECTIONPROBE_H
+#define REFLECTIONPROBE_H
+
+#include <glm/glm.hpp>
+
+//capture point shared by all reflective objects inside of its influence box
+struct ReflectionProbe {
+	public:
+		glm::vec3 position;
+		glm::vec3 extents; //half size of the influence box around the position
+		bool boxProjection; //parallax corrects the reflections against the influence box, meant for probes filling a room
+};
+
+#endif
\ No newline at end of file
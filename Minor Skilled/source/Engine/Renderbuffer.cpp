@@ -24,6 +24,30 @@ void Renderbuffer::initMultisample(unsigned int samples, GLenum format, unsigned
 	glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, format, width, height);
 }
 
+unsigned long long Renderbuffer::getMemorySize() {
+	//ask the driver like the textures do, a renderbuffer without storage has a width of 0
+	int width, height, samples;
+
+	bind();
+	glGetRenderbufferParameteriv(GL_RENDERBUFFER, GL_RENDERBUFFER_WIDTH, &width);
+	glGetRenderbufferParameteriv(GL_RENDERBUFFER, GL_RENDERBUFFER_HEIGHT, &height);
+	glGetRenderbufferParameteriv(GL_RENDERBUFFER, GL_RENDERBUFFER_SAMPLES, &samples);
+
+	//sum up the bits of all channels
+	const GLenum channels[] = { GL_RENDERBUFFER_RED_SIZE, GL_RENDERBUFFER_GREEN_SIZE, GL_RENDERBUFFER_BLUE_SIZE, GL_RENDERBUFFER_ALPHA_SIZE, GL_RENDERBUFFER_DEPTH_SIZE, GL_RENDERBUFFER_STENCIL_SIZE };
+	int bits = 0;
+
+	for(unsigned int i = 0; i < 6; i++) {
+		int channelBits;
+		glGetRenderbufferParameteriv(GL_RENDERBUFFER, channels[i], &channelBits);
+		bits += channelBits;
+	}
+
+	Unbind();
+
+	return (unsigned long long)width * height * (samples > 0 ? samples : 1) * bits / 8;
+}
+
 void Renderbuffer::Unbind() {
 	glBindRenderbuffer(GL_RENDERBUFFER, 0);
 }
\ No newline at end of file
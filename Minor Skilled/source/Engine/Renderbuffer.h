@@ -15,6 +15,8 @@ class Renderbuffer {
 		void init(GLenum format, unsigned int width, unsigned int height);
 		void initMultisample(unsigned int samples, GLenum format, unsigned int width, unsigned int height);
 
+		unsigned long long getMemorySize();
+
 		static void Unbind();
 
 	private:
@@ -4,6 +4,10 @@
 #include <algorithm>
 #include <map>
 #include <random>
+#include <tuple>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
 
 #include <glad/glad.h> //NOTE: glad needs to the be included BEFORE glfw, throws errors otherwise
 #include <GLFW/glfw3.h>
@@ -11,6 +15,7 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
 #include <glm/gtx/norm.hpp>
+#include <glm/gtc/constants.hpp>
 
 #include "../Engine/Node.h"
 #include "../Engine/Transform.h"
@@ -25,7 +30,16 @@
 #include "../Engine/Renderbuffer.h"
 #include "../Engine/Framebuffer.h"
 #include "../Engine/Debug.h"
-
+#include "../Engine/BVH.h"
+#include "../Engine/OcclusionCuller.h"
+#include "../Engine/GPUScene.h"
+#include "../Engine/JobSystem.h"
+#include "../Engine/TextureStreamer.h"
+#include "../Engine/ProbeCache.h"
+#include "../Engine/IrradianceVolume.h"
+#include "../Engine/BrdfLUT.h"
+
+#include "../Materials/ColorMaterial.h"
 #include "../Materials/TextureMaterial.h"
 
 #include "../Components/LightComponent.h"
@@ -36,6 +50,9 @@
 #include "../Utility/ComponentType.h"
 #include "../Utility/Math.h"
 #include "../Utility/RenderSettings.h"
+#include "../Utility/AABB.h"
+#include "../Utility/Frustum.h"
+#include "../Utility/BrdfIntegrator.h"
 
 const std::vector<float> Renderer::_SkyboxVertices = {
 	// back face
@@ -90,7 +107,9 @@ const std::vector<float> Renderer::_ScreenQuadVertices = {
 	1.0f, -1.0f, 0.0f, 1.0f, 0.0f,
 };
 
-Renderer::Renderer(Debug* profiler) : _profiler(profiler) {
+const float Renderer::_UnbakedProbeChange = 1000000.0f;
+
+Renderer::Renderer(Debug* profiler) : _profiler(profiler), _probeEnvironmentMaps(nullptr), _probePrefilterMaps(nullptr), _probeLightHash(0), _unbakedProbes(0), _irradianceVolume(nullptr), _volumeCaptureMap(nullptr), _volumeLightHash(0), _volumeSceneHash(0), _volumeKey(0), _prefilterQuality(0) {
 	glEnable(GL_DEPTH_TEST); //enable the z-buffer
 	glDepthFunc(GL_LESS); //set depth funtion to less
 
@@ -106,6 +125,18 @@ Renderer::Renderer(Debug* profiler) : _profiler(profiler) {
 
 	glfwSwapInterval(0); //disable vsync
 
+	//acceleration structures
+	_renderableTree = new BVH();
+	_pointLightTree = new BVH();
+
+	_occlusionCuller = new OcclusionCuller();
+	_gpuScene = new GPUScene();
+
+	//no probe update in progress
+	_probeUpdate.probe = -1;
+	_probeUpdate.environmentMap = nullptr;
+	_probeUpdate.prefilterMap = nullptr;
+
 	//shaders
 	_initShaders();
 
@@ -117,39 +148,56 @@ Renderer::Renderer(Debug* profiler) : _profiler(profiler) {
 	_initUniformBuffers();
 	_initShaderStorageBuffers();
 
-	//setup FBOs
-	_initGBuffers();
-
-	_initConversionFBO();
-	_initShadowFBO();
+	//no render targets for optional features yet
+	_gPosition = _gNormal = _gAlbedo = _gEmissionSpec = nullptr;
+	_gEnvironmentShiny = nullptr;
+	_gMetalRoughAO = _gPrefilter = _gReflectance = nullptr;
+	_gBuffer = _gBufferPbr = nullptr;
+	_gRBO = nullptr;
+
+	_conversionFBO = nullptr;
+	_conversionRBO = nullptr;
+	_shadowFBO = nullptr;
+	_shadowMap = nullptr;
+	_environmentFBO = nullptr;
+	_environmentRBO = nullptr;
+
+	_bloomBlurFBOs[0] = _bloomBlurFBOs[1] = nullptr;
+	_blurColorBuffers[0] = _blurColorBuffers[1] = nullptr;
+	_ssaoFBO = _ssaoBlurFBO = nullptr;
+	_ssaoColorBuffer = _ssaoBlurColorBuffer = nullptr;
+	_ssrFBO = nullptr;
+	_ssrColorBuffer = nullptr;
+
+	//setup the FBOs every frame needs, the rest is created on first use
 	_initShadowCubeFBO();
 	_initDepthFBO();
-	_initEnvironmentFBO();
 	_initHdrFBO();
 
-	//setup post processing
-	_initBlurFBOs();
-	_initSSAOFBOs();
-	_initSSRFBO();
-
 	_generateSSAOKernel();
 	_generateNoiseTexture();
+
+	//BRDF lookup texture, it does not depend on the scene and is only integrated again when its parameters change
+	_brdfLUT = BrdfLUT::Load(RenderSettings::BrdfLUTSize, RenderSettings::BrdfSampleCount);
 }
 
 Renderer::~Renderer() {
-	//delete environment maps
-	for(std::map<RenderComponent*, Texture*>::iterator it = _environmentMaps.begin(); it != _environmentMaps.end(); it++) {
-		delete it->second;
-	}
+	delete _renderableTree;
+	delete _pointLightTree;
+	delete _occlusionCuller;
+	delete _gpuScene;
 
-	for(std::map<RenderComponent*, IBLMaps>::iterator it = _iblMaps.begin(); it != _iblMaps.end(); it++) {
-		delete it->second.environmentMap;
-		delete it->second.irradianceMap;
-		delete it->second.prefilterMap;
-	}
+	//delete reflection probes
+	_cancelProbeUpdate();
+
+	delete _probeEnvironmentMaps;
+	delete _probePrefilterMaps;
 
 	delete _brdfLUT;
 
+	delete _irradianceVolume;
+	delete _volumeCaptureMap;
+
 	//delete shaders
 	delete _equiToCubeShader;
 	delete _lightingShader;
@@ -157,8 +205,10 @@ Renderer::~Renderer() {
 	delete _shadowShader;
 	delete _shadowCubeShader;
 	delete _depthShader;
+	delete _shadowIndirectShader;
+	delete _depthIndirectShader;
 	delete _environmentShader;
-	delete _irradianceShader;
+	delete _irradianceSHShader;
 	delete _prefilterShader;
 	delete _brdfShader;
 	delete _skyboxShader;
@@ -168,36 +218,23 @@ Renderer::~Renderer() {
 	delete _bloomBlurShader;
 	delete _postProcessingShader;
 
-	//delete textures
-	delete _gPosition;
-	delete _gNormal;
-	delete _gAlbedo;
-	delete _gEmissionSpec;
-
-	delete _gEnvironmentShiny;
-
-	delete _gMetalRoughAO;
-	delete _gIrradiance;
-	delete _gPrefilter;
-	delete _gReflectance;
+	//delete render targets
+	_freeGBuffers(false);
+	_freeGBuffers(true);
 
-	delete _shadowMap;
-
-	for(unsigned int i = 0; i < _shadowCubeMaps.size(); i++) {
-		delete _shadowCubeMaps[i];
-	}
+	_freeConversionFBO();
+	_freeShadowFBO();
+	_freeShadowCubeMaps();
+	_freeDepthFBO();
+	_freeEnvironmentFBO();
+	_freeHdrFBO();
+	_freeBlurFBOs();
+	_freeSSAOFBOs();
+	_freeSSRFBO();
 
-	delete _sceneDepthBuffer;
-	delete _sceneColorBuffer;
-	delete _brightColorBuffer;
-	delete _blurColorBuffers[1];
-	delete _blurColorBuffers[0];
+	delete _shadowCubeFBO;
 
 	delete _ssaoNoiseTexture;
-	delete _ssaoColorBuffer;
-	delete _ssaoBlurColorBuffer;
-
-	delete _ssrColorBuffer;
 
 	//delete vertex arrays
 	delete _skyboxVAO;
@@ -209,38 +246,17 @@ Renderer::~Renderer() {
 
 	delete _matricesUBO;
 	delete _dataUBO;
+	delete _probesUBO;
+	delete _prefilterUBO;
 
 	delete _lightsSSBO;
-
-	//delete framebuffers
-	delete _gBuffer;
-	delete _gBufferPbr;
-
-	delete _conversionFBO;
-	delete _shadowFBO;
-	delete _shadowCubeFBO;
-	delete _depthFBO;
-
-	delete _environmentFBO;
-	delete _hdrFBO;
-	delete _bloomFBO;
-	delete _bloomBlurFBOs[0]; 
-	delete _bloomBlurFBOs[1];
-	delete _ssaoFBO;
-	delete _ssaoBlurFBO;
-	delete _ssrFBO;
-
-	//delete renderbuffers
-	delete _gRBO;
-
-	delete _conversionRBO;
-	delete _environmentRBO;
-	delete _hdrRBO;
+	delete _irradianceSSBO;
 }
 
 void Renderer::render(std::vector<Node*>& renderables, std::vector<Node*>& lights, Node* mainCamera, Node* directionalLight, Texture* skybox) {
 	//update texture and framebuffer dimensions if needed
 	_updateDimensions();
+	_updateRenderTargets();
 
 	//render from main camera
 	if(mainCamera == nullptr) {
@@ -262,8 +278,30 @@ void Renderer::render(std::vector<Node*>& renderables, std::vector<Node*>& light
 	std::vector<std::pair<RenderComponent*, glm::mat4>> renderComponents;
 	std::vector<std::pair<LightComponent*, glm::vec3>> lightComponents;
 
+	//select the detail levels of all objects, the shadow passes also need them for objects outside of the view
+	_updateLods(renderables, cameraPos, projectionMatrix[1][1]);
+
+	//cull the scene against the camera frustum
+	std::vector<Node*> visibleRenderables;
+	_renderableTree->queryFrustum(Frustum(projectionMatrix * viewMatrix), visibleRenderables);
+
+	//remove objects hidden behind occluders before any draw calls are generated
+	if(RenderSettings::IsEnabled(RenderSettings::OcclusionCulling)) _occlusionCuller->cull(visibleRenderables, projectionMatrix * viewMatrix);
+
+	//let the texture streamer know which mip levels the visible objects need
+	if(RenderSettings::IsEnabled(RenderSettings::TextureStreaming)) _updateTextureDemand(visibleRenderables, cameraPos, projectionMatrix[1][1], mainCameraComponent->getNearPlane());
+
+	//upload the whole scene for the gpu driven passes, they do their own culling
+	if(RenderSettings::IsEnabled(RenderSettings::GPUDriven)) {
+		std::vector<std::pair<RenderComponent*, glm::mat4>> sceneRenderComponents;
+		_getRenderComponents(renderables, sceneRenderComponents);
+		_gpuScene->update(sceneRenderComponents);
+	} else {
+		_gpuScene->invalidateDepthPyramid();
+	}
+
 	//fill collections with data
-	_getSortedRenderComponents(renderables, cameraPos, solidRenderComponents, blendRenderComponents); //Possible optimization: only re-sort if the camera moved
+	_getSortedRenderComponents(visibleRenderables, cameraPos, solidRenderComponents, blendRenderComponents); //Possible optimization: only re-sort if the camera moved
 	renderComponents.insert(renderComponents.end(), solidRenderComponents.begin(), solidRenderComponents.end()); //add solid objects to the total render component list
 	renderComponents.insert(renderComponents.end(), blendRenderComponents.begin(), blendRenderComponents.end()); //add blend objects too
 
@@ -301,7 +339,7 @@ void Renderer::render(std::vector<Node*>& renderables, std::vector<Node*>& light
 	}
 
 	//get closest point lights
-	if(cubeShadows) pointLightPositions = _getClosestPointLights(cameraPos, lightComponents); //get closest point lights if the setting is enabled and there are point lights in the scene
+	if(cubeShadows) pointLightPositions = _getClosestPointLights(cameraPos); //get closest point lights if the setting is enabled and there are point lights in the scene
 	pointLightCount = pointLightPositions.size();
 
 	//store the matrices and the vectors in the uniform buffer
@@ -315,13 +353,18 @@ void Renderer::render(std::vector<Node*>& renderables, std::vector<Node*>& light
 	//render shadow map
 	if(dirShadows || cubeShadows) {
 		_profiler->startQuery(QueryType::Shadow);
-		_renderShadowMaps(renderComponents, pointLightPositions, lightSpaceMatrix);
+		_renderShadowMaps(pointLightPositions, lightSpaceMatrix, dirShadows);
 		_profiler->endQuery(QueryType::Shadow);
 	}
 
+	//recapture a part of the reflection probes whose surroundings changed or that were never baked
+	if(RenderSettings::IsEnabled(RenderSettings::ProbeUpdates) || _unbakedProbes > 0) _updateReflectionProbes(renderables, cameraPos, directionalLight, skybox);
+	_updateIrradianceVolume(renderables, directionalLight, skybox);
+
 	//render the depth of the scene
 	_profiler->startQuery(QueryType::Depth);
-	_renderDepth(renderComponents);
+	glm::mat4 viewProjectionMatrix = projectionMatrix * viewMatrix;
+	_renderDepth(renderComponents, viewProjectionMatrix, previousViewProjectionMatrix);
 	_profiler->endQuery(QueryType::Depth);
 
 	//render scene
@@ -400,14 +443,17 @@ void Renderer::render(std::vector<Node*>& renderables, std::vector<Node*>& light
 	_profiler->endQuery(QueryType::Rendering);
 }
 
-void Renderer::renderEnvironmentMaps(std::vector<Node*>& renderables, Node* directionalLight, Texture* skybox) {
-	for(std::map<RenderComponent*, IBLMaps>::iterator it = _iblMaps.begin(); it != _iblMaps.end(); it++) {
-		delete it->second.environmentMap;
-		delete it->second.irradianceMap;
-		delete it->second.prefilterMap;
-	}
+void Renderer::renderEnvironmentMaps(std::vector<Node*>& renderables, std::vector<ReflectionProbe>& probes, Node* directionalLight, Texture* skybox, std::vector<std::string>& skyboxSources) {
+	_cancelProbeUpdate();
 
-	_iblMaps.clear();
+	delete _probeEnvironmentMaps;
+	delete _probePrefilterMaps;
+
+	_probeEnvironmentMaps = nullptr;
+	_probePrefilterMaps = nullptr;
+
+	//freed again once no probe is left to capture
+	_initEnvironmentFBO();
 
 	//obtain all render components and their model matrices from the renderables vector
 	std::vector<std::pair<RenderComponent*, glm::mat4>> renderComponents;
@@ -426,69 +472,198 @@ void Renderer::renderEnvironmentMaps(std::vector<Node*>& renderables, Node* dire
 	if(directionalLight != nullptr && directionalLight->hasComponent(ComponentType::Light)) directionalLightComponent = (LightComponent*)directionalLight->getComponent(ComponentType::Light);
 	else directionalLightComponent = nullptr;
 
-	//render all environment maps for all texture materials with reflection map
+	//use the probes of the scene, or group the reflective objects under shared probes if it has none
+	if(probes.empty()) {
+		_placeReflectionProbes(renderComponents);
+	} else {
+		if(probes.size() > RenderSettings::MaxReflectionProbes) std::cout << "WARNING: The scene has more than " << RenderSettings::MaxReflectionProbes << " reflection probes, the rest is ignored" << std::endl;
+
+		_reflectionProbes.assign(probes.begin(), probes.begin() + std::min((unsigned int)probes.size(), RenderSettings::MaxReflectionProbes));
+	}
+
+	//probe data for the shaders, position, extents and the irradiance harmonics per probe
+	_probeData.assign(RenderSettings::MaxReflectionProbes * _ProbeStride, glm::vec4(0.0f));
+
+	for(unsigned int i = 0; i < _reflectionProbes.size(); i++) {
+		_probeData[i * _ProbeStride] = glm::vec4(_reflectionProbes[i].position, _reflectionProbes[i].boxProjection ? 1.0f : 0.0f);
+		_probeData[i * _ProbeStride + 1] = glm::vec4(_reflectionProbes[i].extents, 0.0f);
+	}
+
+	//the runtime updates start comparing against the surroundings of the first frame
+	ProbeState probeState;
+	probeState.captured = false;
+	probeState.baked = true;
+	probeState.lightChanged = false;
+	probeState.change = 0.0f;
+
+	_probeStates.assign(_reflectionProbes.size(), probeState);
+	_probeLightHash = 0;
+	_unbakedProbes = 0;
+
+	//compare the shader integration of the BRDF lookup texture against the cpu one it was cooked with
+	if(RenderSettings::MeasureBrdfError) {
+		_environmentFBO->bind();
+		_measureBrdfError();
+	}
+
+	//everything the captures depend on, baked probes of an unchanged scene are loaded from the probe cache instead
+	unsigned long long sceneHash = _hashEnvironmentScene(renderComponents, directionalLightComponent, skybox, skyboxSources);
+
+	//the irradiance volume is off by default, its grid is only set up and captured once the option is enabled
+	delete _irradianceVolume;
+	_irradianceVolume = nullptr;
+	_volumeSceneHash = sceneHash;
+	_volumeKey = 0;
+
+	if(_reflectionProbes.empty()) {
+		_uploadReflectionProbes();
+
+		glViewport(0, 0, Window::ScreenWidth, Window::ScreenHeight);
+		Framebuffer::Unbind();
+		return;
+	}
+
+	//every probe has a layer in each array, the prefilter array only keeps the levels the shaders sample
+	unsigned int probeCount = _reflectionProbes.size();
+
+	_probeEnvironmentMaps = _createProbeArray(GL_RGB16F, RenderSettings::EnvironmentWidth, 1, GL_NEAREST, GL_NEAREST);
+	_probePrefilterMaps = _createProbeArray(GL_RGBA16F, RenderSettings::PrefilterWidth, RenderSettings::MaxMipLevels, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+
+	std::vector<unsigned long long>& probeKeys = _probeKeys;
+	probeKeys.assign(probeCount, 0);
+
+	std::vector<Texture*> environmentMaps(probeCount, nullptr);
+	unsigned int cachedProbes = 0;
+
+	//render all environment maps
 	std::cout << "Rendering environment maps..." << std::endl;
 
 	glm::mat4 environmentProjection = glm::perspective(glm::radians(90.0f), (float)RenderSettings::EnvironmentWidth / (float)RenderSettings::EnvironmentHeight, RenderSettings::EnvironmentNearPlane, RenderSettings::EnvironmentFarPlane);
-	
-	glm::vec3 renderPos;
-	RenderComponent* renderComponent;
-	TextureMaterial* textureMat;
-	Texture* environmentMap;
-	MaterialType materialType;
 
 	//set viewport and bind to cubemap framebuffer
 	glViewport(0, 0, RenderSettings::EnvironmentWidth, RenderSettings::EnvironmentHeight);
+	_environmentRBO->bind();
+	_environmentRBO->init(GL_DEPTH_COMPONENT, RenderSettings::EnvironmentWidth, RenderSettings::EnvironmentHeight);
+	Renderbuffer::Unbind();
+
 	_environmentFBO->bind();
 
-	for(unsigned int i = 0; i < renderComponents.size(); i++) {
-		//check for material types
-		renderComponent = renderComponents[i].first;
-		materialType = renderComponent->material->getMaterialType();
+	for(unsigned int i = 0; i < probeCount; i++) {
+		ReflectionProbe& probe = _reflectionProbes[i];
+		probeKeys[i] = Math::Hash(&probe.position, sizeof(glm::vec3), sceneHash);
 
-		if(materialType == MaterialType::Color) continue; //skip color materials
+		std::vector<Texture*> cachedMaps;
+		std::vector<float> cachedIrradiance;
+		bool cached = ProbeCache::Load(probeKeys[i], cachedMaps, cachedIrradiance) && cachedMaps.size() == 2 && cachedIrradiance.size() == 9 * 4;
 
-		if(materialType == MaterialType::Textures) {
-			textureMat = (TextureMaterial*)renderComponent->material;
+		if(cached) {
+			_copyToProbeArray(cachedMaps[0], _probeEnvironmentMaps, i, RenderSettings::EnvironmentWidth, 1);
+			_copyToProbeArray(cachedMaps[1], _probePrefilterMaps, i, RenderSettings::PrefilterWidth, RenderSettings::MaxMipLevels);
 
-			if(textureMat->getReflectionMap() == nullptr) continue; //skip texture material without reflection maps
+			std::memcpy(&_probeData[i * _ProbeStride + 2], &cachedIrradiance[0], cachedIrradiance.size() * sizeof(float));
+			cachedProbes++;
 		}
 
-		renderPos = renderComponents[i].second[3]; //world position component of the model matrix
+		for(unsigned int j = 0; j < cachedMaps.size(); j++) {
+			delete cachedMaps[j];
+		}
 
-		//render low quality environment map
-		environmentMap = _renderEnvironmentMap(renderComponents, environmentProjection, renderPos, renderComponent, skybox, directionalLightComponent, materialType == MaterialType::PBR);
+		if(cached) continue;
 
-		if(materialType == MaterialType::Textures) {
-			//add environment map to the map for texture materials
-			_environmentMaps[renderComponent] = environmentMap; 
-		} else {
-			//add environment map to the map for pbr materials
-			IBLMaps maps;
-			maps.environmentMap = environmentMap;
-			_iblMaps[renderComponent] = maps;
+		//leave the capture to the runtime updates, a few faces per frame instead of all probes before the first one
+		if(RenderSettings::IncrementalProbeBaking) {
+			_probeStates[i].baked = false;
+			_unbakedProbes++;
+			continue;
 		}
+
+		std::vector<RenderComponent*> skippedComponents;
+		_getSkippedComponents(i, renderComponents, skippedComponents);
+
+		//render low quality environment map
+		environmentMaps[i] = _renderEnvironmentMap(renderComponents, environmentProjection, probe.position, skippedComponents, skybox, directionalLightComponent);
 	}
 
-	//render all IBL maps for all pbr materials
+	//convolute the new captures and move them into the arrays
 	std::cout << "Rendering IBL maps..." << std::endl;
 
-	for(std::map<RenderComponent*, IBLMaps>::iterator it = _iblMaps.begin(); it != _iblMaps.end(); it++) {
-		IBLMaps* maps = &it->second;
-		renderPos = it->first->getOwner()->getTransform()->getWorldPosition();
+	for(unsigned int i = 0; i < probeCount; i++) {
+		if(environmentMaps[i] == nullptr) continue; //loaded from the probe cache
+
+		//the diffuse irradiance is projected into spherical harmonics before the mips are cut off
+		glm::vec4* irradiance = &_probeData[i * _ProbeStride + 2];
+		_projectIrradiance(environmentMaps[i], irradiance);
+
+		std::vector<Texture*> bakedMaps;
+		bakedMaps.push_back(environmentMaps[i]);
+		bakedMaps.push_back(_renderPrefilterMap(environmentMaps[i], environmentProjection));
+
+		//only the sampled levels end up in the arrays and the cache
+		bakedMaps[0]->bind();
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, 0);
+
+		bakedMaps[1]->bind();
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, RenderSettings::MaxMipLevels - 1);
+
+		_copyToProbeArray(bakedMaps[0], _probeEnvironmentMaps, i, RenderSettings::EnvironmentWidth, 1);
+		_copyToProbeArray(bakedMaps[1], _probePrefilterMaps, i, RenderSettings::PrefilterWidth, RenderSettings::MaxMipLevels);
+
+		std::vector<float> irradianceValues((float*)irradiance, (float*)(irradiance + 9));
+		ProbeCache::Write(probeKeys[i], bakedMaps, irradianceValues);
 
-		maps->irradianceMap = _renderIrradianceMap(maps->environmentMap, environmentProjection); //add irradiance map
-		maps->prefilterMap = _renderPrefilterMap(maps->environmentMap, environmentProjection); //add prefilter map 
+		for(unsigned int j = 0; j < bakedMaps.size(); j++) {
+			delete bakedMaps[j];
+		}
 	}
 
-	//render BRDF lookup texture
-	_renderBrdfLUT();
+	std::cout << "Baked " << probeCount - cachedProbes - _unbakedProbes << " and loaded " << cachedProbes << " reflection probes from the cache" << std::endl;
+	if(_unbakedProbes > 0) std::cout << "Baking " << _unbakedProbes << " reflection probes over the next frames..." << std::endl;
+
+	_uploadReflectionProbes();
 
 	//reset viewport and bind back to default framebuffer
 	glViewport(0, 0, Window::ScreenWidth, Window::ScreenHeight);
 	Framebuffer::Unbind();
 }
 
+void Renderer::updateBoundingVolumes(std::vector<Node*>& renderables, std::vector<Node*>& lights) {
+	//transform the local model bounds into world space
+	std::vector<AABB> renderableBounds(renderables.size());
+
+	JobSystem::ParallelFor(renderables.size(), 64, [&](unsigned int start, unsigned int end) {
+		for(unsigned int i = start; i < end; i++) {
+			RenderComponent* renderComponent = (RenderComponent*)renderables[i]->getComponent(ComponentType::Render);
+			if(renderComponent->model == nullptr) continue;
+
+			renderableBounds[i] = renderComponent->model->getBounds().transform(renderables[i]->getTransform()->worldTransform);
+		}
+	});
+
+	_renderableTree->update(renderables, renderableBounds);
+
+	//point lights are stored as points, only their position matters for the shadow selection
+	std::vector<Node*> pointLights;
+	std::vector<AABB> pointLightBounds;
+
+	for(unsigned int i = 0; i < lights.size(); i++) {
+		LightComponent* lightComponent = (LightComponent*)lights[i]->getComponent(ComponentType::Light);
+		if(lightComponent->lightType != LightType::Point) continue;
+
+		glm::vec3 lightPos = lights[i]->getTransform()->getWorldPosition();
+
+		pointLights.push_back(lights[i]);
+		pointLightBounds.push_back(AABB(lightPos, lightPos));
+	}
+
+	_pointLightTree->update(pointLights, pointLightBounds);
+}
+
+Node* Renderer::raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance) {
+	float distance;
+
+	return _renderableTree->raycast(origin, direction, maxDistance, distance);
+}
+
 Texture* Renderer::convertEquiToCube(Texture* skybox) {
 	std::cout << "Converting equirectangular texture to cubemap..." << std::endl;
 
@@ -522,8 +697,9 @@ Texture* Renderer::convertEquiToCube(Texture* skybox) {
 	Texture::SetActiveUnit(0);
 	skybox->bind();
 
-	//set viewport and bind to conversion framebuffer
+	//set viewport and bind to conversion framebuffer, it is only needed while a skybox is converted
 	glViewport(0, 0, RenderSettings::SkyboxWidth, RenderSettings::SkyboxHeight);
+	_initConversionFBO();
 	_conversionFBO->bind();
 	_skyboxVAO->bind();
 
@@ -543,12 +719,38 @@ Texture* Renderer::convertEquiToCube(Texture* skybox) {
 	Framebuffer::Unbind();
 	VertexArray::Unbind();
 
+	_freeConversionFBO();
+
+	//the mips are stored in the environment cache along with the faces
+	cubemap->bind();
+	cubemap->generateMipmaps();
+	cubemap->filter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE);
+
 	delete skybox; //the input texture is not needed anymore
 
 	//return new cubemap
 	return cubemap;
 }
 
+std::vector<RenderTargetInfo> Renderer::getRenderTargetInfos() {
+	std::vector<RenderTargetInfo> infos;
+
+	_addRenderTargetInfo(infos, "G-Buffer", { _gPosition, _gNormal, _gAlbedo, _gEmissionSpec }, { _gRBO });
+	_addRenderTargetInfo(infos, "G-Buffer Blinn-Phong", { _gEnvironmentShiny }, {});
+	_addRenderTargetInfo(infos, "G-Buffer PBR", { _gMetalRoughAO, _gPrefilter, _gReflectance }, {});
+	_addRenderTargetInfo(infos, "Scene Depth", { _sceneDepthBuffer }, {});
+	_addRenderTargetInfo(infos, "HDR", { _sceneColorBuffer, _brightColorBuffer }, { _hdrRBO });
+	_addRenderTargetInfo(infos, "Bloom", { _blurColorBuffers[0], _blurColorBuffers[1] }, {});
+	_addRenderTargetInfo(infos, "SSAO", { _ssaoColorBuffer, _ssaoBlurColorBuffer }, {});
+	_addRenderTargetInfo(infos, "SSR", { _ssrColorBuffer }, {});
+	_addRenderTargetInfo(infos, "Directional Shadows", { _shadowMap }, {});
+	_addRenderTargetInfo(infos, "Point Shadows", _shadowCubeMaps, {});
+	_addRenderTargetInfo(infos, "Environment Capture", {}, { _environmentRBO });
+	_addRenderTargetInfo(infos, "Reflection Probes", { _probeEnvironmentMaps, _probePrefilterMaps }, {});
+
+	return infos;
+}
+
 void Renderer::_initShaders() {
 	//initialize equirectangular to cubemap shader
 	_equiToCubeShader = new Shader(Filepath::ShaderPath + "skybox shader/cube.vs", Filepath::ShaderPath + "skybox shader/equiToCube.fs");
@@ -588,13 +790,16 @@ void Renderer::_initShaders() {
 	_lightingShaderPbr->setInt("gAlbedo", 2);
 	_lightingShaderPbr->setInt("gEmissionSpec", 3);
 	_lightingShaderPbr->setInt("gMetalRoughAO", 4);
-	_lightingShaderPbr->setInt("gIrradiance", 5);
 	_lightingShaderPbr->setInt("gPrefilter", 6);
 	_lightingShaderPbr->setInt("gReflectance", 7);
 
 	_lightingShaderPbr->setInt("ssao", 8);
 	_lightingShaderPbr->setInt("brdfLUT", 9);
 
+	for(unsigned int i = 0; i < 3; i++) {
+		_lightingShaderPbr->setInt("irradianceVolume[" + std::to_string(i) + "]", 17 + i);
+	}
+
 	_lightingShaderPbr->setInt("shadowMap", 11);
 
 	for(unsigned int i = 0; i < RenderSettings::MaxCubeShadows; i++) {
@@ -603,6 +808,7 @@ void Renderer::_initShaders() {
 
 	_lightingShaderPbr->setUniformBlockBinding("matricesBlock", 0); //set uniform block "matrices" to binding point 0
 	_lightingShaderPbr->setUniformBlockBinding("dataBlock", 1); //set uniform block "data" to binding point 1
+	_lightingShaderPbr->setUniformBlockBinding("probesBlock", 2); //set uniform block "probes" to binding point 2
 
 	_lightingShaderPbr->setShaderStorageBlockBinding("lightsBlock", 2); //set shader storage block "lights" to binding point 2
 
@@ -618,23 +824,38 @@ void Renderer::_initShaders() {
 	_depthShader->use();
 	_depthShader->setUniformBlockBinding("matricesBlock", 0); //set uniform block "matrices" to binding point 0
 
+	//initialize gpu driven shadow and depth shaders, they read their model matrices from the culled draw records
+	_shadowIndirectShader = new Shader(Filepath::ShaderPath + "depth shader/shadowIndirect.vs", Filepath::ShaderPath + "depth shader/shadow.fs");
+
+	_shadowIndirectShader->use();
+	_shadowIndirectShader->setShaderStorageBlockBinding("recordBlock", 3); //set shader storage block "records" to binding point 3
+	_shadowIndirectShader->setShaderStorageBlockBinding("remapBlock", 5); //set shader storage block "remap" to binding point 5
+
+	_depthIndirectShader = new Shader(Filepath::ShaderPath + "depth shader/depthIndirect.vs", Filepath::ShaderPath + "depth shader/depth.fs");
+
+	_depthIndirectShader->use();
+	_depthIndirectShader->setUniformBlockBinding("matricesBlock", 0); //set uniform block "matrices" to binding point 0
+	_depthIndirectShader->setShaderStorageBlockBinding("recordBlock", 3); //set shader storage block "records" to binding point 3
+	_depthIndirectShader->setShaderStorageBlockBinding("remapBlock", 5); //set shader storage block "remap" to binding point 5
+
 	//initialize environment shader
 	_environmentShader = new Shader(Filepath::ShaderPath + "skybox shader/environment.vs", Filepath::ShaderPath + "skybox shader/environment.fs");
 
 	_environmentShader->use();
 	_environmentShader->setInt("diffuseMap", 0);
 
-	//initialize irradiance shader
-	_irradianceShader = new Shader(Filepath::ShaderPath + "skybox shader/cube.vs", Filepath::ShaderPath + "skybox shader/irradiance.fs");
+	//initialize irradiance spherical harmonics compute shader
+	_irradianceSHShader = new Shader(Filepath::ShaderPath + "compute shader/irradianceSH.cs");
 
-	_irradianceShader->use();
-	_irradianceShader->setInt("environmentMap", 0);
+	_irradianceSHShader->use();
+	_irradianceSHShader->setInt("environmentMap", 0);
 
 	//initialize prefilter shader
 	_prefilterShader = new Shader(Filepath::ShaderPath + "skybox shader/cube.vs", Filepath::ShaderPath + "skybox shader/prefilter.fs");
 
 	_prefilterShader->use();
 	_prefilterShader->setInt("environmentMap", 0);
+	_prefilterShader->setUniformBlockBinding("prefilterBlock", 3); //set uniform block "prefilter" to binding point 3
 
 	//initialize brdf shader
 	_brdfShader = new Shader(Filepath::ShaderPath + "skybox shader/brdf.vs", Filepath::ShaderPath + "skybox shader/brdf.fs");
@@ -736,6 +957,24 @@ void Renderer::_initUniformBuffers() {
 
 	_dataUBO->bindBufferRange(1, neededMemory); //bind to binding point 1
 
+	//create reflection probes uniform buffer
+	neededMemory = sizeof(glm::vec4) * _ProbeStride * RenderSettings::MaxReflectionProbes + sizeof(glm::vec4) * 3; //position, extents and harmonics per probe + 16 for the probe count + the irradiance volume grid
+
+	_probesUBO = new Buffer(GL_UNIFORM_BUFFER);
+	_probesUBO->bind();
+	_probesUBO->allocateMemory(neededMemory); //allocate the memory, but don't fill it with data yet
+
+	_probesUBO->bindBufferRange(2, neededMemory); //bind to binding point 2
+
+	//create prefilter samples uniform buffer, holds the table of the level currently rendered
+	neededMemory = sizeof(glm::vec4) * RenderSettings::PrefilterReference; //16kb, the minimum uniform block size every driver supports
+
+	_prefilterUBO = new Buffer(GL_UNIFORM_BUFFER);
+	_prefilterUBO->bind();
+	_prefilterUBO->allocateMemory(neededMemory, GL_DYNAMIC_DRAW); //refilled for every prefilter level
+
+	_prefilterUBO->bindBufferRange(3, neededMemory); //bind to binding point 3
+
 	//unbind
 	Buffer::Unbind(GL_UNIFORM_BUFFER); 
 }
@@ -750,92 +989,100 @@ void Renderer::_initShaderStorageBuffers() {
 
 	_lightsSSBO->bindBufferRange(2, neededMemory); //bind to binding point 2
 
+	//create the output buffer of the irradiance projection
+	neededMemory = sizeof(glm::vec4) * 9; //9 spherical harmonics coefficients
+
+	_irradianceSSBO = new Buffer(GL_SHADER_STORAGE_BUFFER);
+	_irradianceSSBO->bind();
+	_irradianceSSBO->allocateMemory(neededMemory, GL_DYNAMIC_READ);
+
 	//unbind
 	Buffer::Unbind(GL_SHADER_STORAGE_BUFFER);
 }
 
-void Renderer::_initGBuffers() {
-	//init the color buffers for both gBuffers
-
-	//create the position color buffer
-	_gPosition = new Texture(GL_TEXTURE_2D, GL_RGB16F, Window::ScreenWidth, Window::ScreenHeight, GL_RGB, GL_FLOAT, GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, NULL, false);
+void Renderer::_initGBuffers(bool pbr) {
+	//init the color buffers both gBuffers share
+	if(_gPosition == nullptr) {
+		//create the position color buffer
+		_gPosition = new Texture(GL_TEXTURE_2D, GL_RGB16F, Window::ScreenWidth, Window::ScreenHeight, GL_RGB, GL_FLOAT, GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, NULL, false);
 
-	//create the normal color buffer
-	_gNormal = new Texture(GL_TEXTURE_2D, GL_RGB16F, Window::ScreenWidth, Window::ScreenHeight, GL_RGB, GL_FLOAT, GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, NULL, false);
+		//create the normal color buffer
+		_gNormal = new Texture(GL_TEXTURE_2D, GL_RGB16F, Window::ScreenWidth, Window::ScreenHeight, GL_RGB, GL_FLOAT, GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, NULL, false);
 
-	//create the albedo color buffer
-	_gAlbedo = new Texture(GL_TEXTURE_2D, GL_RGB16F, Window::ScreenWidth, Window::ScreenHeight, GL_RGB, GL_FLOAT, GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, NULL, false);
+		//create the albedo color buffer
+		_gAlbedo = new Texture(GL_TEXTURE_2D, GL_RGB16F, Window::ScreenWidth, Window::ScreenHeight, GL_RGB, GL_FLOAT, GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, NULL, false);
 
-	//create the emission + specular color buffer
-	_gEmissionSpec = new Texture(GL_TEXTURE_2D, GL_RG16F, Window::ScreenWidth, Window::ScreenHeight, GL_RG, GL_FLOAT, GL_LINEAR, GL_LINEAR, GL_NONE, NULL, false);
+		//create the emission + specular color buffer
+		_gEmissionSpec = new Texture(GL_TEXTURE_2D, GL_RG16F, Window::ScreenWidth, Window::ScreenHeight, GL_RG, GL_FLOAT, GL_LINEAR, GL_LINEAR, GL_NONE, NULL, false);
 
-	//init the color buffers for the normal gBuffer
-
-	//create the environment + shininess color buffer
-	_gEnvironmentShiny = new Texture(GL_TEXTURE_2D, GL_RGBA16F, Window::ScreenWidth, Window::ScreenHeight, GL_RGBA, GL_FLOAT, GL_LINEAR, GL_LINEAR, GL_NONE, NULL, false);
-
-	//init the color buffers for the PBR gBuffer
-
-	//create metallic + roughness + ambient occlusion color buffer
-	_gMetalRoughAO = new Texture(GL_TEXTURE_2D, GL_RGB16F, Window::ScreenWidth, Window::ScreenHeight, GL_RGB, GL_FLOAT, GL_LINEAR, GL_LINEAR, GL_NONE, NULL, false);
-
-	//create the irradiance color buffer
-	_gIrradiance = new Texture(GL_TEXTURE_2D, GL_RGB16F, Window::ScreenWidth, Window::ScreenHeight, GL_RGB, GL_FLOAT, GL_LINEAR, GL_LINEAR, GL_NONE, NULL, false);
-
-	//create the prefilter color buffer
-	_gPrefilter = new Texture(GL_TEXTURE_2D, GL_RGB16F, Window::ScreenWidth, Window::ScreenHeight, GL_RGB, GL_FLOAT, GL_LINEAR, GL_LINEAR, GL_NONE, NULL, false);
-
-	//create the reflectance (F0) color buffer
-	_gReflectance = new Texture(GL_TEXTURE_2D, GL_RGB16F, Window::ScreenWidth, Window::ScreenHeight, GL_RGB, GL_FLOAT, GL_LINEAR, GL_LINEAR, GL_NONE, NULL, false);
-
-	//create depth renderbuffer
-	_gRBO = new Renderbuffer();
-	_gRBO->bind();
-	_gRBO->init(GL_DEPTH_COMPONENT, Window::ScreenWidth, Window::ScreenHeight);
-	Renderbuffer::Unbind();
-
-	//create the gBuffer framebuffer and attach its color buffers for the deferred shading geometry pass
-	_gBuffer = new Framebuffer();
-	_gBuffer->bind();
-	_gBuffer->attachTexture(GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _gPosition);
-	_gBuffer->attachTexture(GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, _gNormal);
-	_gBuffer->attachTexture(GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, _gAlbedo);
-	_gBuffer->attachTexture(GL_COLOR_ATTACHMENT3, GL_TEXTURE_2D, _gEmissionSpec);
-	_gBuffer->attachTexture(GL_COLOR_ATTACHMENT4, GL_TEXTURE_2D, _gEnvironmentShiny);
-	_gBuffer->attachRenderbuffer(GL_DEPTH_ATTACHMENT, _gRBO);
-
-	//tell OpenGL which attachments the gBuffer will use for rendering
-	unsigned int attachments[5] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3, GL_COLOR_ATTACHMENT4};
-	_gBuffer->setDrawBuffers(5, attachments);
-
-	//check for completion
-	_gBuffer->checkForCompletion("_gBuffer");
-
-	//create the gBuffer framebuffer and attach its color buffers for the deferred shading geometry pass
-	_gBufferPbr = new Framebuffer();
-	_gBufferPbr->bind();
-	_gBufferPbr->attachTexture(GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _gPosition);
-	_gBufferPbr->attachTexture(GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, _gNormal);
-	_gBufferPbr->attachTexture(GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, _gAlbedo);
-	_gBufferPbr->attachTexture(GL_COLOR_ATTACHMENT3, GL_TEXTURE_2D, _gEmissionSpec);
-	_gBufferPbr->attachTexture(GL_COLOR_ATTACHMENT4, GL_TEXTURE_2D, _gMetalRoughAO);
-	_gBufferPbr->attachTexture(GL_COLOR_ATTACHMENT5, GL_TEXTURE_2D, _gIrradiance);
-	_gBufferPbr->attachTexture(GL_COLOR_ATTACHMENT6, GL_TEXTURE_2D, _gPrefilter);
-	_gBufferPbr->attachTexture(GL_COLOR_ATTACHMENT7, GL_TEXTURE_2D, _gReflectance);
-	_gBufferPbr->attachRenderbuffer(GL_DEPTH_ATTACHMENT, _gRBO);
-
-	//tell OpenGL which attachments the gBuffer will use for rendering
-	unsigned int attachmentsPbr[8] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3, GL_COLOR_ATTACHMENT4, GL_COLOR_ATTACHMENT5, GL_COLOR_ATTACHMENT6, GL_COLOR_ATTACHMENT7};
-	_gBufferPbr->setDrawBuffers(8, attachmentsPbr);
+		//create depth renderbuffer
+		_gRBO = new Renderbuffer();
+		_gRBO->bind();
+		_gRBO->init(GL_DEPTH_COMPONENT, Window::ScreenWidth, Window::ScreenHeight);
+		Renderbuffer::Unbind();
+	}
 
-	//check for completion
-	_gBufferPbr->checkForCompletion("gBufferPbr");
+	if(!pbr && _gBuffer == nullptr) {
+		//init the color buffers for the normal gBuffer
+
+		//create the environment + shininess color buffer
+		_gEnvironmentShiny = new Texture(GL_TEXTURE_2D, GL_RGBA16F, Window::ScreenWidth, Window::ScreenHeight, GL_RGBA, GL_FLOAT, GL_LINEAR, GL_LINEAR, GL_NONE, NULL, false);
+
+		//create the gBuffer framebuffer and attach its color buffers for the deferred shading geometry pass
+		_gBuffer = new Framebuffer();
+		_gBuffer->bind();
+		_gBuffer->attachTexture(GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _gPosition);
+		_gBuffer->attachTexture(GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, _gNormal);
+		_gBuffer->attachTexture(GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, _gAlbedo);
+		_gBuffer->attachTexture(GL_COLOR_ATTACHMENT3, GL_TEXTURE_2D, _gEmissionSpec);
+		_gBuffer->attachTexture(GL_COLOR_ATTACHMENT4, GL_TEXTURE_2D, _gEnvironmentShiny);
+		_gBuffer->attachRenderbuffer(GL_DEPTH_ATTACHMENT, _gRBO);
+
+		//tell OpenGL which attachments the gBuffer will use for rendering
+		unsigned int attachments[5] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3, GL_COLOR_ATTACHMENT4};
+		_gBuffer->setDrawBuffers(5, attachments);
+
+		//check for completion
+		_gBuffer->checkForCompletion("_gBuffer");
+	} else if(pbr && _gBufferPbr == nullptr) {
+		//init the color buffers for the PBR gBuffer
+
+		//create metallic + roughness + ambient occlusion color buffer
+		_gMetalRoughAO = new Texture(GL_TEXTURE_2D, GL_RGB16F, Window::ScreenWidth, Window::ScreenHeight, GL_RGB, GL_FLOAT, GL_LINEAR, GL_LINEAR, GL_NONE, NULL, false);
+
+		//create the prefilter color buffer
+		_gPrefilter = new Texture(GL_TEXTURE_2D, GL_RGB16F, Window::ScreenWidth, Window::ScreenHeight, GL_RGB, GL_FLOAT, GL_LINEAR, GL_LINEAR, GL_NONE, NULL, false);
+
+		//create the reflectance (F0) color buffer
+		_gReflectance = new Texture(GL_TEXTURE_2D, GL_RGB16F, Window::ScreenWidth, Window::ScreenHeight, GL_RGB, GL_FLOAT, GL_LINEAR, GL_LINEAR, GL_NONE, NULL, false);
+
+		//create the gBuffer framebuffer and attach its color buffers for the deferred shading geometry pass
+		_gBufferPbr = new Framebuffer();
+		_gBufferPbr->bind();
+		_gBufferPbr->attachTexture(GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _gPosition);
+		_gBufferPbr->attachTexture(GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, _gNormal);
+		_gBufferPbr->attachTexture(GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, _gAlbedo);
+		_gBufferPbr->attachTexture(GL_COLOR_ATTACHMENT3, GL_TEXTURE_2D, _gEmissionSpec);
+		_gBufferPbr->attachTexture(GL_COLOR_ATTACHMENT4, GL_TEXTURE_2D, _gMetalRoughAO);
+		_gBufferPbr->attachTexture(GL_COLOR_ATTACHMENT5, GL_TEXTURE_2D, _gPrefilter);
+		_gBufferPbr->attachTexture(GL_COLOR_ATTACHMENT6, GL_TEXTURE_2D, _gReflectance);
+		_gBufferPbr->attachRenderbuffer(GL_DEPTH_ATTACHMENT, _gRBO);
+
+		//tell OpenGL which attachments the gBuffer will use for rendering
+		unsigned int attachmentsPbr[7] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3, GL_COLOR_ATTACHMENT4, GL_COLOR_ATTACHMENT5, GL_COLOR_ATTACHMENT6};
+		_gBufferPbr->setDrawBuffers(7, attachmentsPbr);
+
+		//check for completion
+		_gBufferPbr->checkForCompletion("gBufferPbr");
+	}
 
 	//unbind
 	Framebuffer::Unbind();
 }
 
 void Renderer::_initConversionFBO() {
+	if(_conversionFBO != nullptr) return;
+
 	//init conversion RBO
 	_conversionRBO = new Renderbuffer();
 	_conversionRBO->bind();
@@ -852,6 +1099,8 @@ void Renderer::_initConversionFBO() {
 }
 
 void Renderer::_initShadowFBO() {
+	if(_shadowFBO != nullptr) return;
+
 	//create shadow texture
 	_shadowMap = new Texture(GL_TEXTURE_2D, GL_DEPTH_COMPONENT24, RenderSettings::ShadowWidth, RenderSettings::ShadowHeight, GL_DEPTH_COMPONENT, GL_FLOAT, GL_NEAREST, GL_NEAREST, GL_CLAMP_TO_BORDER, NULL, false);
 
@@ -873,29 +1122,33 @@ void Renderer::_initShadowFBO() {
 }
 
 void Renderer::_initShadowCubeFBO() {
-	//create shadow cubemap framebuffer
+	//create shadow cubemap framebuffer, the cubemaps are attached when rendering
 	_shadowCubeFBO = new Framebuffer();
 	_shadowCubeFBO->bind();
 	_shadowCubeFBO->setDrawBuffer(GL_NONE); //explicitly tell OpenGL that we are only using the depth attachments and no color attachments, otherwise the FBO will be incomplete
 	_shadowCubeFBO->setReadBuffer(GL_NONE);
 
-	float borderColor[] = {1.0f, 1.0f, 1.0f, 1.0f};
+	//bind back to default framebuffer
+	Framebuffer::Unbind();
+}
 
-	//create shadow cubemap texture for each possible light
-	for(unsigned int i = 0; i < RenderSettings::MaxCubeShadows; i++) {
-		_shadowCubeMaps.push_back(new Texture(GL_TEXTURE_CUBE_MAP)); //add to vector
+void Renderer::_initShadowCubeMaps(unsigned int count) {
+	//create a shadow cubemap for each light that casts shadows, they are kept for as long as cube shadows are enabled
+	count = std::min(count, RenderSettings::MaxCubeShadows);
 
-		_shadowCubeMaps[i]->bind();
-		_shadowCubeMaps[i]->filter(GL_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE);
+	while(_shadowCubeMaps.size() < count) {
+		Texture* shadowCubeMap = new Texture(GL_TEXTURE_CUBE_MAP);
+
+		shadowCubeMap->bind();
+		shadowCubeMap->filter(GL_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE);
 
 		//init all cubemap faces
-		for(unsigned int j = 0; j < 6; j++) {
-			_shadowCubeMaps[i]->initTarget(GL_TEXTURE_CUBE_MAP_POSITIVE_X + j, GL_DEPTH_COMPONENT24, RenderSettings::ShadowWidth, RenderSettings::ShadowHeight, GL_DEPTH_COMPONENT, GL_FLOAT, NULL); //we only need the depth component
+		for(unsigned int i = 0; i < 6; i++) {
+			shadowCubeMap->initTarget(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, GL_DEPTH_COMPONENT24, RenderSettings::ShadowWidth, RenderSettings::ShadowHeight, GL_DEPTH_COMPONENT, GL_FLOAT, NULL); //we only need the depth component
 		}
-	}
 
-	//bind back to default framebuffer
-	Framebuffer::Unbind();
+		_shadowCubeMaps.push_back(shadowCubeMap); //add to vector
+	}
 }
 
 void Renderer::_initDepthFBO() {
@@ -917,6 +1170,8 @@ void Renderer::_initDepthFBO() {
 }
 
 void Renderer::_initEnvironmentFBO() {
+	if(_environmentFBO != nullptr) return;
+
 	//create renderbuffer
 	_environmentRBO = new Renderbuffer();
 	_environmentRBO->bind();
@@ -964,6 +1219,8 @@ void Renderer::_initHdrFBO() {
 }
 
 void Renderer::_initBlurFBOs() {
+	if(_bloomBlurFBOs[0] != nullptr) return;
+
 	//create floating point blur colorbuffers
 	for(unsigned int i = 0; i < 2; i++) {
 		//create and bind framebuffer
@@ -984,6 +1241,8 @@ void Renderer::_initBlurFBOs() {
 }
 
 void Renderer::_initSSAOFBOs() {
+	if(_ssaoFBO != nullptr) return;
+
 	//create ssao color buffer
 	_ssaoColorBuffer = new Texture(GL_TEXTURE_2D, GL_RED, Window::ScreenWidth, Window::ScreenHeight, GL_RGB, GL_FLOAT, GL_NEAREST, GL_NEAREST, GL_NONE, NULL, false);
 
@@ -1011,6 +1270,8 @@ void Renderer::_initSSAOFBOs() {
 }
 
 void Renderer::_initSSRFBO() {
+	if(_ssrFBO != nullptr) return;
+
 	//create color buffer for the ssr texture
 	_ssrColorBuffer = new Texture(GL_TEXTURE_2D, GL_RGBA16F, Window::ScreenWidth, Window::ScreenHeight, GL_RGBA, GL_FLOAT, GL_LINEAR, GL_LINEAR, GL_NONE, NULL, false);
 
@@ -1026,229 +1287,1143 @@ void Renderer::_initSSRFBO() {
 	Framebuffer::Unbind();
 }
 
-Texture* Renderer::_renderEnvironmentMap(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents, glm::mat4& environmentProjection, glm::vec3& renderPos, RenderComponent* currentRenderComponent, Texture* skybox, LightComponent* dirLight, bool pbr) {
-	//create environment cubemap
-	Texture* environmentMap = new Texture(GL_TEXTURE_CUBE_MAP);
-	environmentMap->bind();
-
-	//init all cubemap faces
-	for(unsigned int i = 0; i < 6; i++) {
-		environmentMap->initTarget(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, GL_RGB16F, RenderSettings::EnvironmentWidth, RenderSettings::EnvironmentHeight, GL_RGB, GL_FLOAT, NULL); //hdr
-	}
-
+void Renderer::_freeGBuffers(bool pbr) {
 	if(pbr) {
-		environmentMap->filter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE);
-		environmentMap->generateMipmaps();
+		delete _gBufferPbr;
+		delete _gMetalRoughAO;
+		delete _gPrefilter;
+		delete _gReflectance;
+
+		_gBufferPbr = nullptr;
+		_gMetalRoughAO = nullptr;
+		_gPrefilter = nullptr;
+		_gReflectance = nullptr;
 	} else {
-		environmentMap->filter(GL_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE);
+		delete _gBuffer;
+		delete _gEnvironmentShiny;
+
+		_gBuffer = nullptr;
+		_gEnvironmentShiny = nullptr;
 	}
 
-	//view matrices for each cubemap face
-	std::vector<glm::mat4> environmentViews;
-	environmentViews.push_back(glm::lookAt(renderPos, renderPos + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f))); //right
-	environmentViews.push_back(glm::lookAt(renderPos, renderPos + glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f))); //left
-	environmentViews.push_back(glm::lookAt(renderPos, renderPos + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f))); //top
-	environmentViews.push_back(glm::lookAt(renderPos, renderPos + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f))); //bottom
-	environmentViews.push_back(glm::lookAt(renderPos, renderPos + glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f))); //front
-	environmentViews.push_back(glm::lookAt(renderPos, renderPos + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f))); //back
-
-	//forward render the scene objects without any special effects for each face
-	glm::mat4 modelMatrix;
-	RenderComponent* renderComponent;
-	Material* material;
-	Model* model;
+	//the shared color buffers go with the last gBuffer using them
+	if(_gBuffer != nullptr || _gBufferPbr != nullptr) return;
 
-	//bind shadow map
-	Texture::SetActiveUnit(1);
-	_shadowMap->bind();
+	delete _gPosition;
+	delete _gNormal;
+	delete _gAlbedo;
+	delete _gEmissionSpec;
+	delete _gRBO;
 
-	for(unsigned int i = 0; i < 6; i++) {
-		//attach respective face to render to to the framebuffer
-		_environmentFBO->attachTexture(GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, environmentMap);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	_gPosition = nullptr;
+	_gNormal = nullptr;
+	_gAlbedo = nullptr;
+	_gEmissionSpec = nullptr;
+	_gRBO = nullptr;
+}
+
+void Renderer::_freeConversionFBO() {
+	delete _conversionFBO;
+	delete _conversionRBO;
 
-		//setup shader matrix
-		_environmentShader->use();
-		_environmentShader->setVec3("renderPos", renderPos);
+	_conversionFBO = nullptr;
+	_conversionRBO = nullptr;
+}
 
-		_environmentShader->setBool("useLight", dirLight != nullptr);
+void Renderer::_freeShadowFBO() {
+	delete _shadowFBO;
+	delete _shadowMap;
 
-		if(dirLight != nullptr) {
-			_environmentShader->setVec3("lightDirection", dirLight->lightDirection);
-			_environmentShader->setVec3("lightAmbient", dirLight->lightAmbient);
-			_environmentShader->setVec3("lightDiffuse", dirLight->lightDiffuse);
-		}
+	_shadowFBO = nullptr;
+	_shadowMap = nullptr;
+}
 
-		_environmentShader->setMat4("viewMatrix", environmentViews[i]);
-		_environmentShader->setMat4("projectionMatrix", environmentProjection);
+void Renderer::_freeShadowCubeMaps() {
+	for(unsigned int i = 0; i < _shadowCubeMaps.size(); i++) {
+		delete _shadowCubeMaps[i];
+	}
 
-		//render each scene object
-		for(unsigned int i = 0; i < renderComponents.size(); i++) {
-			renderComponent = renderComponents[i].first;
+	_shadowCubeMaps.clear();
+}
 
-			if(renderComponent == currentRenderComponent) continue; //skip the current object to avoid rendering the inside of the mesh to the cubemap
+void Renderer::_freeDepthFBO() {
+	delete _depthFBO;
+	delete _sceneDepthBuffer;
 
-			modelMatrix = renderComponents[i].second;
-			material = renderComponent->material;
-			model = renderComponent->model;
+	_depthFBO = nullptr;
+	_sceneDepthBuffer = nullptr;
+}
 
-			_environmentShader->setMat4("modelMatrix", modelMatrix);
+void Renderer::_freeEnvironmentFBO() {
+	delete _environmentFBO;
+	delete _environmentRBO;
 
-			material->drawSimple(_environmentShader);
-			model->draw();
-		}
+	_environmentFBO = nullptr;
+	_environmentRBO = nullptr;
+}
 
-		//render skybox
-		_renderSkybox(environmentViews[i], environmentProjection, skybox);
-	}
+void Renderer::_freeHdrFBO() {
+	delete _hdrFBO;
+	delete _hdrRBO;
+	delete _sceneColorBuffer;
+	delete _brightColorBuffer;
 
-	return environmentMap;
+	_hdrFBO = nullptr;
+	_hdrRBO = nullptr;
+	_sceneColorBuffer = nullptr;
+	_brightColorBuffer = nullptr;
 }
 
-Texture* Renderer::_renderIrradianceMap(Texture* environmentMap, glm::mat4& irradianceProjection) {
-	//create environment cubemap
-	Texture* irradianceMap = new Texture(GL_TEXTURE_CUBE_MAP);
-	irradianceMap->bind();
+void Renderer::_freeBlurFBOs() {
+	for(unsigned int i = 0; i < 2; i++) {
+		delete _bloomBlurFBOs[i];
+		delete _blurColorBuffers[i];
 
-	//init all cubemap faces
-	for(unsigned int i = 0; i < 6; i++) {
-		irradianceMap->initTarget(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, GL_RGB16F, RenderSettings::IrradianceWidth, RenderSettings::IrradianceHeight, GL_RGB, GL_FLOAT, NULL); //hdr
+		_bloomBlurFBOs[i] = nullptr;
+		_blurColorBuffers[i] = nullptr;
 	}
+}
 
-	irradianceMap->filter(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE);
+void Renderer::_freeSSAOFBOs() {
+	delete _ssaoFBO;
+	delete _ssaoBlurFBO;
+	delete _ssaoColorBuffer;
+	delete _ssaoBlurColorBuffer;
 
-	//view matrices for each cubemap face
-	std::vector<glm::mat4> irradianceViews;
-	irradianceViews.push_back(glm::lookAt(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f))); //right
-	irradianceViews.push_back(glm::lookAt(glm::vec3(0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f))); //left
-	irradianceViews.push_back(glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f))); //top
-	irradianceViews.push_back(glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f))); //bottom
-	irradianceViews.push_back(glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f))); //front
-	irradianceViews.push_back(glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f))); //back
-
-	//rescale renderbuffer to irradiance dimensions
-	glViewport(0, 0, RenderSettings::IrradianceWidth, RenderSettings::IrradianceHeight);
-	_environmentRBO->bind();
-	_environmentRBO->init(GL_DEPTH_COMPONENT, RenderSettings::IrradianceWidth, RenderSettings::IrradianceHeight);
-	Renderbuffer::Unbind();
+	_ssaoFBO = nullptr;
+	_ssaoBlurFBO = nullptr;
+	_ssaoColorBuffer = nullptr;
+	_ssaoBlurColorBuffer = nullptr;
+}
 
-	//set shader uniforms
-	_irradianceShader->use();
-	_irradianceShader->setMat4("projectionMatrix", irradianceProjection);
+void Renderer::_freeSSRFBO() {
+	delete _ssrFBO;
+	delete _ssrColorBuffer;
 
-	//attach environment cubemap
-	Texture::SetActiveUnit(0);
-	environmentMap->bind();
+	_ssrFBO = nullptr;
+	_ssrColorBuffer = nullptr;
+}
 
-	//render each cubemap face
+Texture* Renderer::_renderEnvironmentMap(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents, glm::mat4& environmentProjection, glm::vec3& renderPos, std::vector<RenderComponent*>& skippedComponents, Texture* skybox, LightComponent* dirLight) {
+	Texture* environmentMap = _createEnvironmentMap();
+
+	for(unsigned int i = 0; i < 6; i++) {
+		_renderEnvironmentFace(environmentMap, i, renderComponents, environmentProjection, renderPos, skippedComponents, skybox, dirLight);
+	}
+
+	//the prefilter convolution samples the lower levels of the capture
+	environmentMap->bind();
+	environmentMap->generateMipmaps();
+
+	return environmentMap;
+}
+
+Texture* Renderer::_createEnvironmentMap() {
+	//create environment cubemap
+	Texture* environmentMap = new Texture(GL_TEXTURE_CUBE_MAP);
+	environmentMap->bind();
+
+	//init all cubemap faces
+	for(unsigned int i = 0; i < 6; i++) {
+		environmentMap->initTarget(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, GL_RGB16F, RenderSettings::EnvironmentWidth, RenderSettings::EnvironmentHeight, GL_RGB, GL_FLOAT, NULL); //hdr
+	}
+
+	environmentMap->filter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE);
+	environmentMap->generateMipmaps(); //allocates the levels, they are filled after the capture
+
+	return environmentMap;
+}
+
+void Renderer::_renderEnvironmentFace(Texture* environmentMap, unsigned int face, std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents, glm::mat4& environmentProjection, glm::vec3& renderPos, std::vector<RenderComponent*>& skippedComponents, Texture* skybox, LightComponent* dirLight) {
+	//forward render the scene objects without any special effects
+	glm::mat4 viewMatrix = _GetFaceView(renderPos, face);
+	glm::mat4 modelMatrix;
+	RenderComponent* renderComponent;
+	Material* material;
+	Model* model;
+
+	//bind shadow map
+	if(_shadowMap != nullptr) {
+		Texture::SetActiveUnit(1);
+		_shadowMap->bind();
+	}
+
+	//attach respective face to render to to the framebuffer
+	_environmentFBO->attachTexture(GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, environmentMap);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	//setup shader matrix
+	_environmentShader->use();
+	_environmentShader->setVec3("renderPos", renderPos);
+
+	_environmentShader->setBool("useLight", dirLight != nullptr);
+
+	if(dirLight != nullptr) {
+		_environmentShader->setVec3("lightDirection", dirLight->lightDirection);
+		_environmentShader->setVec3("lightAmbient", dirLight->lightAmbient);
+		_environmentShader->setVec3("lightDiffuse", dirLight->lightDiffuse);
+	}
+
+	_environmentShader->setMat4("viewMatrix", viewMatrix);
+	_environmentShader->setMat4("projectionMatrix", environmentProjection);
+
+	//render each scene object
+	for(unsigned int i = 0; i < renderComponents.size(); i++) {
+		renderComponent = renderComponents[i].first;
+
+		if(std::find(skippedComponents.begin(), skippedComponents.end(), renderComponent) != skippedComponents.end()) continue; //skip objects around the probe to avoid rendering the inside of the mesh to the cubemap
+
+		modelMatrix = renderComponents[i].second;
+		material = renderComponent->material;
+		model = renderComponent->model;
+
+		_environmentShader->setMat4("modelMatrix", modelMatrix);
+
+		//the low resolution captures hide the reduced detail
+		int lod = (int)_selectLod(model, modelMatrix, renderPos, environmentProjection[1][1], 0) + RenderSettings::EnvironmentLodBias;
+
+		material->drawSimple(_environmentShader);
+		model->draw(std::max(lod, 0));
+	}
+
+	//render skybox
+	_renderSkybox(viewMatrix, environmentProjection, skybox);
+}
+
+void Renderer::_projectIrradiance(Texture* environmentMap, glm::vec4* coefficients) {
+	//sample the mip level that matches the projection size, the harmonics only keep low frequencies anyway
+	float lod = std::log2((float)RenderSettings::EnvironmentWidth / (float)RenderSettings::IrradianceSampleSize);
+
+	_irradianceSHShader->use();
+	_irradianceSHShader->setFloat("lod", std::max(lod, 0.0f));
+	_irradianceSHShader->setInt("sampleSize", std::min(RenderSettings::IrradianceSampleSize, RenderSettings::EnvironmentWidth));
+
+	Texture::SetActiveUnit(0);
+	environmentMap->bind();
+
+	_irradianceSSBO->bindBufferBase(7);
+	_irradianceSHShader->dispatch(1); //a single work group sums up the whole cubemap
+
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	_irradianceSSBO->bind();
+	glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(glm::vec4) * 9, coefficients);
+	Buffer::Unbind(GL_SHADER_STORAGE_BUFFER);
+}
+
+Texture* Renderer::_renderPrefilterMap(Texture* environmentMap, glm::mat4& prefilterProjection) {
+	Texture* prefilterMap = _createPrefilterMap();
+
+	for(unsigned int mip = 0; mip < RenderSettings::MaxMipLevels; mip++) {
+		_renderPrefilterLevel(environmentMap, prefilterMap, mip, prefilterProjection);
+	}
+
+	if(RenderSettings::MeasurePrefilterError) _measurePrefilterError(environmentMap, prefilterMap, prefilterProjection);
+
+	return prefilterMap;
+}
+
+Texture* Renderer::_createPrefilterMap() {
+	//create environment cubemap
+	Texture* prefilterMap = new Texture(GL_TEXTURE_CUBE_MAP);
+	prefilterMap->bind();
+
+	//init all cubemap faces
+	for(unsigned int i = 0; i < 6; i++) {
+		prefilterMap->initTarget(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, GL_RGBA16F, RenderSettings::PrefilterWidth, RenderSettings::PrefilterHeight, GL_RGBA, GL_FLOAT, NULL); //hdr
+	}
+
+	prefilterMap->filter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE);
+	prefilterMap->generateMipmaps();
+
+	return prefilterMap;
+}
+
+void Renderer::_renderPrefilterLevel(Texture* environmentMap, Texture* prefilterMap, unsigned int mip, glm::mat4& prefilterProjection) {
+	//upload the sample table of the level
+	if(_prefilterQuality != RenderSettings::PrefilterQuality) _buildPrefilterSamples();
+
+	std::vector<glm::vec4>& samples = _prefilterSamples[mip];
+
+	_prefilterUBO->bind();
+	_prefilterUBO->bufferSubData(0, sizeof(glm::vec4) * samples.size(), &samples[0]);
+	Buffer::Unbind(GL_UNIFORM_BUFFER);
+
+	//set shader uniforms
+	_prefilterShader->use();
+	_prefilterShader->setMat4("projectionMatrix", prefilterProjection);
+	_prefilterShader->setInt("sampleCount", samples.size());
+
+	//attach environment cubemap
+	Texture::SetActiveUnit(0);
+	environmentMap->bind();
+
+	//rescale renderbuffer to prefilter mipmap dimensions
+	unsigned int mipWidth = (unsigned int)(RenderSettings::PrefilterWidth * std::pow(0.5f, mip));
+	unsigned int mipHeight = (unsigned int)(RenderSettings::PrefilterHeight * std::pow(0.5f, mip));
+
+	glViewport(0, 0, mipWidth, mipHeight);
+	_environmentRBO->bind();
+	_environmentRBO->init(GL_DEPTH_COMPONENT, mipWidth, mipHeight);
+	Renderbuffer::Unbind();
+
+	//render each cubemap face
 	for(unsigned int i = 0; i < 6; i++) {
 		//attach respective face to render to to the framebuffer
-		_environmentFBO->attachTexture(GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, irradianceMap);
+		_environmentFBO->attachTexture(GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, prefilterMap, mip);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		//set view matrix for the face
-		_irradianceShader->setMat4("viewMatrix", irradianceViews[i]);
+		//set view matrix for the face
+		_prefilterShader->setMat4("viewMatrix", _GetFaceView(glm::vec3(0.0f), i));
+
+		//render cube
+		_skyboxVAO->bind();
+		_skyboxVAO->drawArrays(GL_TRIANGLES, 0, 36);
+		VertexArray::Unbind();
+	}
+}
+
+void Renderer::_buildPrefilterSamples() {
+	//the view direction equals the normal, so the ggx samples only depend on the roughness and can be shared by all texels
+	_prefilterQuality = RenderSettings::PrefilterQuality;
+	_prefilterSamples.assign(RenderSettings::MaxMipLevels, std::vector<glm::vec4>());
+
+	unsigned int sampleCount = std::min(_prefilterQuality, RenderSettings::PrefilterReference);
+	float texelSolidAngle = 4.0f * glm::pi<float>() / (6.0f * RenderSettings::EnvironmentHeight * RenderSettings::EnvironmentHeight);
+	float lodBias = sampleCount < RenderSettings::PrefilterReference ? 1.0f : 0.0f; //blurs the aliasing of small sample counts away
+
+	for(unsigned int mip = 0; mip < RenderSettings::MaxMipLevels; mip++) {
+		std::vector<glm::vec4>& samples = _prefilterSamples[mip];
+
+		//a perfect mirror only reflects the texel itself
+		if(mip == 0) {
+			samples.push_back(glm::vec4(0.0f, 0.0f, 1.0f, 0.0f));
+			continue;
+		}
+
+		float roughness = (float)mip / (float)(RenderSettings::MaxMipLevels - 1);
+		float a = roughness * roughness;
+		float a2 = a * a;
+
+		for(unsigned int i = 0; i < sampleCount; i++) {
+			//the same samples as the brdf lookup texture, the normal is z in tangent space
+			glm::vec3 halfway = Math::ImportanceSampleGGX(Math::Hammersley(i, sampleCount), roughness);
+			float cosTheta = halfway.z;
+
+			glm::vec3 light = 2.0f * cosTheta * halfway - glm::vec3(0.0f, 0.0f, 1.0f);
+
+			if(light.z <= 0.0f) continue; //below the surface, would not add any weight
+
+			//filtered importance sampling, read the environment level whose texels cover the solid angle of the sample
+			float denom = cosTheta * cosTheta * (a2 - 1.0f) + 1.0f;
+			float distribution = a2 / (glm::pi<float>() * denom * denom);
+			float pdf = distribution * 0.25f + 0.0001f; //NdotH and HdotV cancel out
+
+			float sampleSolidAngle = 1.0f / ((float)sampleCount * pdf + 0.0001f);
+			float lod = std::max(0.5f * std::log2(sampleSolidAngle / texelSolidAngle) + lodBias, 0.0f);
+
+			samples.push_back(glm::vec4(light, lod));
+		}
+	}
+}
+
+void Renderer::_measurePrefilterError(Texture* environmentMap, Texture* prefilterMap, glm::mat4& prefilterProjection) {
+	unsigned int quality = RenderSettings::PrefilterQuality;
+	if(quality == RenderSettings::PrefilterReference) return;
+
+	//time every level of the current quality against the reference
+	std::vector<double> times(RenderSettings::MaxMipLevels);
+	std::vector<double> referenceTimes(RenderSettings::MaxMipLevels);
+
+	glFinish();
+
+	for(unsigned int mip = 0; mip < RenderSettings::MaxMipLevels; mip++) {
+		double start = glfwGetTime();
+		_renderPrefilterLevel(environmentMap, prefilterMap, mip, prefilterProjection);
+		glFinish();
+
+		times[mip] = glfwGetTime() - start;
+	}
+
+	RenderSettings::PrefilterQuality = RenderSettings::PrefilterReference;
+	Texture* referenceMap = _createPrefilterMap();
+
+	for(unsigned int mip = 0; mip < RenderSettings::MaxMipLevels; mip++) {
+		double start = glfwGetTime();
+		_renderPrefilterLevel(environmentMap, referenceMap, mip, prefilterProjection);
+		glFinish();
+
+		referenceTimes[mip] = glfwGetTime() - start;
+	}
+
+	RenderSettings::PrefilterQuality = quality;
+
+	//relative root mean square error per level over all faces
+	std::vector<float> pixels;
+	std::vector<float> referencePixels;
+
+	double time = 0.0;
+	double referenceTime = 0.0;
+
+	for(unsigned int mip = 0; mip < RenderSettings::MaxMipLevels; mip++) {
+		unsigned int mipWidth = (unsigned int)(RenderSettings::PrefilterWidth * std::pow(0.5f, mip));
+		unsigned int mipHeight = (unsigned int)(RenderSettings::PrefilterHeight * std::pow(0.5f, mip));
+
+		pixels.resize(mipWidth * mipHeight * 4);
+		referencePixels.resize(mipWidth * mipHeight * 4);
+
+		double error = 0.0;
+		double energy = 0.0;
+
+		for(unsigned int i = 0; i < 6; i++) {
+			prefilterMap->bind();
+			glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, mip, GL_RGBA, GL_FLOAT, &pixels[0]);
+			referenceMap->bind();
+			glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, mip, GL_RGBA, GL_FLOAT, &referencePixels[0]);
+
+			for(unsigned int j = 0; j < pixels.size(); j += 4) {
+				for(unsigned int k = 0; k < 3; k++) {
+					double difference = pixels[j + k] - referencePixels[j + k];
+
+					error += difference * difference;
+					energy += referencePixels[j + k] * referencePixels[j + k];
+				}
+			}
+		}
+
+		Texture::Unbind(GL_TEXTURE_CUBE_MAP);
+
+		float relativeError = energy > 0.0 ? (float)std::sqrt(error / energy) : 0.0f;
+		std::cout << "Prefilter level " << mip << " error: " << relativeError * 100.0f << "%, " << times[mip] * 1000.0 << "ms, reference " << referenceTimes[mip] * 1000.0 << "ms" << std::endl;
+
+		if(relativeError > RenderSettings::MaxPrefilterError) {
+			std::cout << "WARNING: Prefilter level " << mip << " with " << quality << " samples exceeds the error bound of " << RenderSettings::MaxPrefilterError * 100.0f << "%" << std::endl;
+		}
+
+		time += times[mip];
+		referenceTime += referenceTimes[mip];
+	}
+
+	std::cout << "Prefilter with " << quality << " samples took " << time * 1000.0 << "ms, reference took " << referenceTime * 1000.0 << "ms" << std::endl;
+
+	delete referenceMap;
+}
+
+void Renderer::_measureBrdfError() {
+	unsigned int size = RenderSettings::BrdfLUTSize;
+
+	//integrate on the gpu into a full float texture
+	Texture* gpuLUT = new Texture(GL_TEXTURE_2D, GL_RG32F, size, size, GL_RG, GL_FLOAT, GL_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE, NULL, false);
+
+	//rescale renderbuffer to LUT texture dimensions
+	glViewport(0, 0, size, size);
+	_environmentRBO->bind();
+	_environmentRBO->init(GL_DEPTH_COMPONENT, size, size);
+	Renderbuffer::Unbind();
+
+	//attach BRDF texture to framebuffer
+	_environmentFBO->attachTexture(GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gpuLUT);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	//render quad
+	_brdfShader->use();
+	_brdfShader->setInt("sampleCount", RenderSettings::BrdfSampleCount);
+
+	_screenQuadVAO->bind();
+	_screenQuadVAO->drawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	VertexArray::Unbind();
+
+	std::vector<float> gpuValues(size * size * 2);
+
+	gpuLUT->bind();
+	glGetTexImage(GL_TEXTURE_2D, 0, GL_RG, GL_FLOAT, &gpuValues[0]);
+	Texture::Unbind(GL_TEXTURE_2D);
+
+	delete gpuLUT;
+
+	//the cpu reference
+	std::vector<float> cpuValues;
+	BrdfIntegrator::Integrate(size, RenderSettings::BrdfSampleCount, cpuValues);
+
+	float maxError = 0.0f;
+	double totalError = 0.0;
+
+	for(unsigned int i = 0; i < cpuValues.size(); i++) {
+		float error = std::abs(gpuValues[i] - cpuValues[i]);
+
+		maxError = std::max(maxError, error);
+		totalError += error;
+	}
+
+	std::cout << "BRDF lookup texture error, max: " << maxError << ", mean: " << totalError / cpuValues.size() << std::endl;
+}
+
+unsigned long long Renderer::_hashEnvironmentScene(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents, LightComponent* dirLight, Texture* skybox, std::vector<std::string>& skyboxSources) {
+	unsigned long long hash = Math::Hash(nullptr, 0);
+
+	//objects, their placement and their materials
+	std::vector<Texture*> textures;
+
+	for(unsigned int i = 0; i < renderComponents.size(); i++) {
+		RenderComponent* renderComponent = renderComponents[i].first;
+		Material* material = renderComponent->material;
+
+		if(renderComponent->model != nullptr) hash = _HashFile(renderComponent->model->filepath, hash);
+		hash = Math::Hash(&renderComponents[i].second, sizeof(glm::mat4), hash);
+
+		MaterialType materialType = material->getMaterialType();
+		BlendMode blendMode = material->getBlendMode();
+
+		hash = Math::Hash(&materialType, sizeof(MaterialType), hash);
+		hash = Math::Hash(&blendMode, sizeof(BlendMode), hash);
+
+		//all values of color materials, the textured ones are covered by their texture files
+		if(materialType == MaterialType::Color) {
+			ColorMaterial* colorMaterial = (ColorMaterial*)material;
+
+			hash = Math::Hash(&colorMaterial->getAmbientColor(), sizeof(glm::vec3), hash);
+			hash = Math::Hash(&colorMaterial->getDiffuseColor(), sizeof(glm::vec3), hash);
+			hash = Math::Hash(&colorMaterial->getSpecular(), sizeof(float), hash);
+			hash = Math::Hash(&colorMaterial->getShininess(), sizeof(float), hash);
+		}
+
+		textures.clear();
+		material->getTextures(textures);
+
+		for(unsigned int j = 0; j < textures.size(); j++) {
+			if(textures[j] != nullptr) hash = _HashFile(textures[j]->filepath, hash);
+		}
+	}
+
+	//lighting
+	bool useLight = dirLight != nullptr;
+	hash = Math::Hash(&useLight, sizeof(bool), hash);
+
+	if(useLight) {
+		hash = Math::Hash(&dirLight->lightDirection, sizeof(glm::vec3), hash);
+		hash = Math::Hash(&dirLight->lightAmbient, sizeof(glm::vec3), hash);
+		hash = Math::Hash(&dirLight->lightDiffuse, sizeof(glm::vec3), hash);
+	}
+
+	//every source file of the skybox, the cubemap texture only remembers its first face
+	for(unsigned int i = 0; i < skyboxSources.size(); i++) {
+		hash = _HashFile((skyboxSources.size() == 6) ? Filepath::SkyboxPath + skyboxSources[i] : skyboxSources[i], hash);
+	}
+
+	if(skyboxSources.empty() && skybox != nullptr) hash = _HashFile(skybox->filepath, hash);
+
+	//bake settings
+	unsigned int sizes[] = {
+		RenderSettings::EnvironmentWidth, RenderSettings::EnvironmentHeight,
+		RenderSettings::IrradianceSampleSize,
+		RenderSettings::PrefilterWidth, RenderSettings::PrefilterHeight,
+		RenderSettings::MaxMipLevels,
+		RenderSettings::PrefilterQuality
+	};
+
+	float planes[] = { RenderSettings::EnvironmentNearPlane, RenderSettings::EnvironmentFarPlane, RenderSettings::LodScreenSize };
+	bool levelOfDetail = RenderSettings::IsEnabled(RenderSettings::LevelOfDetail);
+
+	hash = Math::Hash(sizes, sizeof(sizes), hash);
+	hash = Math::Hash(planes, sizeof(planes), hash);
+	hash = Math::Hash(&RenderSettings::EnvironmentLodBias, sizeof(int), hash);
+	hash = Math::Hash(&levelOfDetail, sizeof(bool), hash);
+
+	return hash;
+}
+
+void Renderer::_placeReflectionProbes(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents) {
+	_reflectionProbes.clear();
+
+	//group the reflective objects by grid cell, every group shares one probe in its center
+	struct ProbeGroup {
+		AABB positions;
+		AABB bounds;
+	};
+
+	std::map<std::tuple<int, int, int>, ProbeGroup> groups;
+
+	for(unsigned int i = 0; i < renderComponents.size(); i++) {
+		RenderComponent* renderComponent = renderComponents[i].first;
+		MaterialType materialType = renderComponent->material->getMaterialType();
+
+		if(materialType == MaterialType::Color || renderComponent->model == nullptr) continue;
+		if(materialType == MaterialType::Textures && ((TextureMaterial*)renderComponent->material)->getReflectionMap() == nullptr) continue; //texture materials without reflection maps do not sample probes
+
+		glm::vec3 position = renderComponents[i].second[3]; //world position component of the model matrix
+		glm::ivec3 cell = glm::ivec3(glm::floor(position / RenderSettings::ReflectionProbeSpacing));
+
+		ProbeGroup& group = groups[std::make_tuple(cell.x, cell.y, cell.z)];
+		group.positions.expand(position);
+		group.bounds.expand(renderComponent->model->getBounds().transform(renderComponents[i].second));
+	}
+
+	if(groups.size() > RenderSettings::MaxReflectionProbes) std::cout << "WARNING: The reflective objects need more than " << RenderSettings::MaxReflectionProbes << " reflection probes, the rest uses the nearest one" << std::endl;
+
+	for(std::map<std::tuple<int, int, int>, ProbeGroup>::iterator it = groups.begin(); it != groups.end() && _reflectionProbes.size() < RenderSettings::MaxReflectionProbes; it++) {
+		ProbeGroup& group = it->second;
+
+		//the influence covers the whole group and reaches halfway to the neighbouring cells
+		ReflectionProbe probe;
+		probe.position = group.positions.getCenter();
+		probe.extents = glm::max(group.bounds.max - probe.position, probe.position - group.bounds.min) + RenderSettings::ReflectionProbeSpacing * 0.5f;
+		probe.boxProjection = false;
+
+		_reflectionProbes.push_back(probe);
+	}
+}
+
+void Renderer::_selectReflectionProbes(glm::vec3 position, int& primaryProbe, int& secondaryProbe, float& probeBlend) {
+	primaryProbe = -1;
+	secondaryProbe = -1;
+	probeBlend = 0.0f;
+
+	float primaryWeight = 0.0f;
+	float secondaryWeight = 0.0f;
+
+	int nearestProbe = -1;
+	float nearestDistance = FLT_MAX;
+
+	//the two probes with the highest influence, it falls from 1 at the probe to 0 at the border of its box
+	for(unsigned int i = 0; i < _reflectionProbes.size(); i++) {
+		ReflectionProbe& probe = _reflectionProbes[i];
+
+		glm::vec3 offset = glm::abs(position - probe.position) / glm::max(probe.extents, glm::vec3(0.001f));
+		float weight = 1.0f - std::max(offset.x, std::max(offset.y, offset.z));
+
+		if(weight > primaryWeight) {
+			secondaryProbe = primaryProbe;
+			secondaryWeight = primaryWeight;
+
+			primaryProbe = i;
+			primaryWeight = weight;
+		} else if(weight > secondaryWeight) {
+			secondaryProbe = i;
+			secondaryWeight = weight;
+		}
+
+		float distance = glm::distance2(position, probe.position);
+
+		if(distance < nearestDistance) {
+			nearestProbe = i;
+			nearestDistance = distance;
+		}
+	}
+
+	if(primaryProbe < 0) {
+		primaryProbe = nearestProbe; //outside of every influence box
+		return;
+	}
+
+	if(secondaryProbe >= 0) probeBlend = secondaryWeight / (primaryWeight + secondaryWeight);
+}
+
+void Renderer::_bindReflectionProbes() {
+	if(_probeEnvironmentMaps == nullptr) return; //no probes, the shaders skip the lookups
+
+	//texture materials sample the environment, pbr materials the convoluted maps
+	Texture::SetActiveUnit(7);
+	_probeEnvironmentMaps->bind();
+
+	Texture::SetActiveUnit(9);
+	_probePrefilterMaps->bind();
+}
+
+void Renderer::_uploadReflectionProbes() {
+	int probeCount = _reflectionProbes.size();
+
+	_probesUBO->bind();
+	_probesUBO->bufferSubData(0, _probeData.size() * sizeof(glm::vec4), &_probeData[0]);
+	_probesUBO->bufferSubData(_probeData.size() * sizeof(glm::vec4), sizeof(int), &probeCount); //the lighting pass loops over the probes
+	Buffer::Unbind(GL_UNIFORM_BUFFER);
+}
+
+void Renderer::_getSkippedComponents(unsigned int probe, std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents, std::vector<RenderComponent*>& skippedComponents) {
+	glm::vec3 probePos = _reflectionProbes[probe].position;
+
+	//objects mainly using this probe are left out of its capture if the probe sits inside of them
+	for(unsigned int i = 0; i < renderComponents.size(); i++) {
+		Model* model = renderComponents[i].first->model;
+		if(model == nullptr || !model->getBounds().transform(renderComponents[i].second).contains(AABB(probePos, probePos))) continue;
+
+		int primaryProbe, secondaryProbe;
+		float probeBlend;
+
+		_selectReflectionProbes(glm::vec3(renderComponents[i].second[3]), primaryProbe, secondaryProbe, probeBlend);
+		if(primaryProbe == (int)probe) skippedComponents.push_back(renderComponents[i].first);
+	}
+}
+
+void Renderer::_updateReflectionProbes(std::vector<Node*>& renderables, glm::vec3& cameraPos, Node* directionalLight, Texture* skybox) {
+	if(_probeEnvironmentMaps == nullptr) return; //no probes in the scene
+
+	LightComponent* dirLight = nullptr;
+	if(directionalLight != nullptr && directionalLight->hasComponent(ComponentType::Light)) dirLight = (LightComponent*)directionalLight->getComponent(ComponentType::Light);
+
+	//a different light or skybox changes every probe
+	unsigned long long lightHash = _HashLighting(dirLight, skybox);
+	bool lightChanged = _probeLightHash != 0 && lightHash != _probeLightHash;
+	_probeLightHash = lightHash;
+
+	//count the objects around each probe that moved, appeared or disappeared since its last capture
+	std::vector<std::pair<Node*, glm::mat4>> surroundings;
+
+	for(unsigned int i = 0; i < _probeStates.size(); i++) {
+		ProbeState& state = _probeStates[i];
+
+		surroundings.clear();
+		_getProbeSurroundings(i, surroundings);
+
+		if(!state.captured) {
+			state.surroundings.swap(surroundings);
+			state.captured = true;
+			continue;
+		}
+
+		unsigned int changed = 0;
+		unsigned int previous = 0;
+
+		for(unsigned int j = 0; j < surroundings.size(); j++) {
+			while(previous < state.surroundings.size() && state.surroundings[previous].first < surroundings[j].first) {
+				previous++;
+				changed++; //disappeared
+			}
+
+			if(previous < state.surroundings.size() && state.surroundings[previous].first == surroundings[j].first) {
+				if(state.surroundings[previous].second != surroundings[j].second) changed++; //moved
+				previous++;
+			} else {
+				changed++; //appeared
+			}
+		}
+
+		changed += state.surroundings.size() - previous;
+
+		state.lightChanged = state.lightChanged || lightChanged;
+		state.change = (float)changed + (state.lightChanged ? 1.0f : 0.0f);
+	}
+
+	//pick the probe with the most changes relative to its distance to the camera, in units of its influence size
+	if(_probeUpdate.probe < 0) {
+		bool probeUpdates = RenderSettings::IsEnabled(RenderSettings::ProbeUpdates);
+
+		int probe = -1;
+		float highestPriority = 0.0f;
+
+		for(unsigned int i = 0; i < _probeStates.size(); i++) {
+			ProbeState& state = _probeStates[i];
+			if(state.baked && (!probeUpdates || state.change <= 0.0f)) continue;
+
+			ReflectionProbe& reflectionProbe = _reflectionProbes[i];
+			float distance = glm::distance(cameraPos, reflectionProbe.position) / std::max(glm::length(reflectionProbe.extents), 0.001f);
+			float priority = (state.baked ? state.change : _UnbakedProbeChange) / (1.0f + distance);
+
+			if(priority > highestPriority) {
+				probe = i;
+				highestPriority = priority;
+			}
+		}
+
+		if(probe < 0) return; //every probe is up to date
+
+		_startProbeUpdate(probe, renderables);
+	}
+
+	//render the next steps of the update within the budget
+	std::vector<std::pair<RenderComponent*, glm::mat4>> renderComponents;
+	glm::mat4 environmentProjection = glm::perspective(glm::radians(90.0f), (float)RenderSettings::EnvironmentWidth / (float)RenderSettings::EnvironmentHeight, RenderSettings::EnvironmentNearPlane, RenderSettings::EnvironmentFarPlane);
+
+	_initEnvironmentFBO();
+	_environmentFBO->bind();
+
+	for(int i = 0; i < std::max(RenderSettings::ProbeUpdateBudget, 1) && _probeUpdate.probe >= 0; i++) {
+		unsigned int step = _probeUpdate.step++;
+
+		if(step < 6) {
+			//capture one face
+			if(renderComponents.empty()) _getRenderComponents(renderables, renderComponents);
+
+			glViewport(0, 0, RenderSettings::EnvironmentWidth, RenderSettings::EnvironmentHeight);
+			_environmentRBO->bind();
+			_environmentRBO->init(GL_DEPTH_COMPONENT, RenderSettings::EnvironmentWidth, RenderSettings::EnvironmentHeight);
+			Renderbuffer::Unbind();
+
+			_renderEnvironmentFace(_probeUpdate.environmentMap, step, renderComponents, environmentProjection, _reflectionProbes[_probeUpdate.probe].position, _probeUpdate.skippedComponents, skybox, dirLight);
+		} else if(step == 6) {
+			//the capture is complete, project the irradiance before the prefilter levels are rendered
+			_probeUpdate.environmentMap->bind();
+			_probeUpdate.environmentMap->generateMipmaps();
+
+			_projectIrradiance(_probeUpdate.environmentMap, &_probeData[_probeUpdate.probe * _ProbeStride + 2]);
+		} else if(step < 7 + RenderSettings::MaxMipLevels) {
+			_renderPrefilterLevel(_probeUpdate.environmentMap, _probeUpdate.prefilterMap, step - 7, environmentProjection);
+		} else {
+			_finishProbeUpdate();
+		}
+	}
+
+	//reset viewport and bind back to default framebuffer
+	glViewport(0, 0, Window::ScreenWidth, Window::ScreenHeight);
+	Framebuffer::Unbind();
+}
+
+void Renderer::_getProbeSurroundings(unsigned int probe, std::vector<std::pair<Node*, glm::mat4>>& surroundings) {
+	ReflectionProbe& reflectionProbe = _reflectionProbes[probe];
 
-		//render cube
-		_skyboxVAO->bind();
-		_skyboxVAO->drawArrays(GL_TRIANGLES, 0, 36);
-		VertexArray::Unbind();
+	//objects close enough to the probe to make a noticeable difference in its capture
+	std::vector<Node*> nodes;
+	_renderableTree->querySphere(reflectionProbe.position, glm::length(reflectionProbe.extents), nodes);
+
+	std::sort(nodes.begin(), nodes.end());
+
+	for(unsigned int i = 0; i < nodes.size(); i++) {
+		surroundings.push_back(std::make_pair(nodes[i], nodes[i]->getTransform()->worldTransform));
 	}
+}
+
+void Renderer::_startProbeUpdate(unsigned int probe, std::vector<Node*>& renderables) {
+	ProbeState& state = _probeStates[probe];
+
+	//the capture starts now, anything that changes from here on triggers another update
+	state.surroundings.clear();
+	_getProbeSurroundings(probe, state.surroundings);
+
+	state.lightChanged = false;
+	state.change = 0.0f;
+
+	std::vector<std::pair<RenderComponent*, glm::mat4>> renderComponents;
+	_getRenderComponents(renderables, renderComponents);
+
+	_probeUpdate.probe = probe;
+	_probeUpdate.step = 0;
+	_probeUpdate.environmentMap = _createEnvironmentMap();
+	_probeUpdate.prefilterMap = _createPrefilterMap();
 
-	return irradianceMap;
+	_probeUpdate.skippedComponents.clear();
+	_getSkippedComponents(probe, renderComponents, _probeUpdate.skippedComponents);
 }
 
-Texture* Renderer::_renderPrefilterMap(Texture* environmentMap, glm::mat4& prefilterProjection) {
-	//create environment cubemap
-	Texture* prefilterMap = new Texture(GL_TEXTURE_CUBE_MAP);
-	prefilterMap->bind();
+void Renderer::_finishProbeUpdate() {
+	unsigned int probe = _probeUpdate.probe;
 
-	//init all cubemap faces
-	for(unsigned int i = 0; i < 6; i++) {
-		prefilterMap->initTarget(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, GL_RGBA16F, RenderSettings::PrefilterWidth, RenderSettings::PrefilterHeight, GL_RGBA, GL_FLOAT, NULL); //hdr
+	//swap the new maps in at once, so the probe never shows a half finished capture
+	_copyToProbeArray(_probeUpdate.environmentMap, _probeEnvironmentMaps, probe, RenderSettings::EnvironmentWidth, 1);
+	_copyToProbeArray(_probeUpdate.prefilterMap, _probePrefilterMaps, probe, RenderSettings::PrefilterWidth, RenderSettings::MaxMipLevels);
+
+	_probesUBO->bind();
+	_probesUBO->bufferSubData((probe * _ProbeStride + 2) * sizeof(glm::vec4), sizeof(glm::vec4) * 9, &_probeData[probe * _ProbeStride + 2]);
+	Buffer::Unbind(GL_UNIFORM_BUFFER);
+
+	//the first capture of a probe that was missing from the cache is stored just like a baked one
+	ProbeState& state = _probeStates[probe];
+
+	if(!state.baked) {
+		std::vector<Texture*> bakedMaps;
+		bakedMaps.push_back(_probeUpdate.environmentMap);
+		bakedMaps.push_back(_probeUpdate.prefilterMap);
+
+		bakedMaps[0]->bind();
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, 0);
+
+		bakedMaps[1]->bind();
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, RenderSettings::MaxMipLevels - 1);
+
+		glm::vec4* irradiance = &_probeData[probe * _ProbeStride + 2];
+		std::vector<float> irradianceValues((float*)irradiance, (float*)(irradiance + 9));
+		ProbeCache::Write(_probeKeys[probe], bakedMaps, irradianceValues);
+
+		state.baked = true;
+		_unbakedProbes--;
+
+		if(_unbakedProbes == 0) std::cout << "Baked the remaining reflection probes" << std::endl;
 	}
 
-	prefilterMap->filter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE);
-	prefilterMap->generateMipmaps();
+	_cancelProbeUpdate();
+}
 
-	//view matrices for each cubemap face
-	std::vector<glm::mat4> prefilterViews;
-	prefilterViews.push_back(glm::lookAt(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f))); //right
-	prefilterViews.push_back(glm::lookAt(glm::vec3(0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f))); //left
-	prefilterViews.push_back(glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f))); //top
-	prefilterViews.push_back(glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f))); //bottom
-	prefilterViews.push_back(glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f))); //front
-	prefilterViews.push_back(glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f))); //back
+void Renderer::_cancelProbeUpdate() {
+	delete _probeUpdate.environmentMap;
+	delete _probeUpdate.prefilterMap;
 
-	//set shader uniforms
-	_prefilterShader->use();
-	_prefilterShader->setMat4("projectionMatrix", prefilterProjection);
+	_probeUpdate.probe = -1;
+	_probeUpdate.environmentMap = nullptr;
+	_probeUpdate.prefilterMap = nullptr;
+}
 
-	_prefilterShader->setFloat("resolution", (float)RenderSettings::EnvironmentHeight);
+Texture* Renderer::_createProbeArray(unsigned int internalFormat, unsigned int size, unsigned int levels, unsigned int minFilter, unsigned int magFilter) {
+	Texture* probeArray = new Texture(GL_TEXTURE_CUBE_MAP_ARRAY);
+	probeArray->bind();
 
-	//attach environment cubemap
-	Texture::SetActiveUnit(0);
-	environmentMap->bind();
+	//six layers per probe, one for each face
+	glTexStorage3D(GL_TEXTURE_CUBE_MAP_ARRAY, levels, internalFormat, size, size, _reflectionProbes.size() * 6);
+	probeArray->filter(minFilter, magFilter, GL_CLAMP_TO_EDGE);
 
-	//render each mipmap level
-	for(unsigned int mip = 0; mip < RenderSettings::MaxMipLevels; mip++) {
-		//rescale renderbuffer to prefilter mipmap dimensions
-		unsigned int mipWidth = (unsigned int)(RenderSettings::PrefilterWidth * std::pow(0.5f, mip));
-		unsigned int mipHeight = (unsigned int)(RenderSettings::PrefilterHeight * std::pow(0.5f, mip));
+	//black until every probe is loaded or captured
+	for(unsigned int level = 0; level < levels; level++) {
+		glClearTexImage(probeArray->getID(), level, GL_RGBA, GL_FLOAT, NULL);
+	}
 
-		glViewport(0, 0, mipWidth, mipHeight);
-		_environmentRBO->bind();
-		_environmentRBO->init(GL_DEPTH_COMPONENT, mipWidth, mipHeight);
-		Renderbuffer::Unbind();
+	return probeArray;
+}
 
-		//render each cubemap face
-		float roughness = (float)mip / (float)(RenderSettings::MaxMipLevels - 1);
-		_prefilterShader->setFloat("roughness", roughness);
+void Renderer::_copyToProbeArray(Texture* cubemap, Texture* probeArray, unsigned int probe, unsigned int size, unsigned int levels) {
+	for(unsigned int level = 0; level < levels; level++) {
+		unsigned int levelSize = std::max(size >> level, 1u);
+
+		glCopyImageSubData(cubemap->getID(), GL_TEXTURE_CUBE_MAP, level, 0, 0, 0, probeArray->getID(), GL_TEXTURE_CUBE_MAP_ARRAY, level, 0, 0, probe * 6, levelSize, levelSize, 6);
+	}
+}
+
+void Renderer::_createIrradianceVolume(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents, unsigned long long sceneHash) {
+	delete _irradianceVolume;
+	_irradianceVolume = nullptr;
+
+	_volumeTransforms.clear();
+	_volumeUpdates.clear();
+	_volumeLightHash = 0;
+	_volumeKey = 0;
+
+	//the grid covers everything that is rendered
+	AABB bounds;
+
+	for(unsigned int i = 0; i < renderComponents.size(); i++) {
+		Model* model = renderComponents[i].first->model;
+		if(model != nullptr) bounds.expand(model->getBounds().transform(renderComponents[i].second));
+	}
+
+	if(!bounds.isValid()) return;
+
+	_irradianceVolume = new IrradianceVolume(bounds, RenderSettings::IrradianceVolumeSpacing, RenderSettings::MaxIrradianceVolumeSize);
+	std::vector<float>& coefficients = _irradianceVolume->getCoefficients();
+
+	if(_volumeCaptureMap == nullptr) {
+		_volumeCaptureMap = new Texture(GL_TEXTURE_CUBE_MAP);
+		_volumeCaptureMap->bind();
 
 		for(unsigned int i = 0; i < 6; i++) {
-			//attach respective face to render to to the framebuffer
-			_environmentFBO->attachTexture(GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, prefilterMap, mip);
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			_volumeCaptureMap->initTarget(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, GL_RGB16F, RenderSettings::IrradianceVolumeCaptureSize, RenderSettings::IrradianceVolumeCaptureSize, GL_RGB, GL_FLOAT, NULL); //hdr
+		}
+
+		_volumeCaptureMap->filter(GL_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE);
+	}
 
-			//set view matrix for the face
-			_prefilterShader->setMat4("viewMatrix", prefilterViews[i]);
+	//the grid is stored in the probe cache as plain coefficients without any cubemaps
+	glm::ivec3 size = _irradianceVolume->getSize();
+	glm::vec3 grid[] = { _irradianceVolume->getMin(), _irradianceVolume->getSpacing() };
 
-			//render cube
-			_skyboxVAO->bind();
-			_skyboxVAO->drawArrays(GL_TRIANGLES, 0, 36);
-			VertexArray::Unbind();
+	unsigned long long key = Math::Hash(&size, sizeof(glm::ivec3), sceneHash);
+	key = Math::Hash(grid, sizeof(grid), key);
+	key = Math::Hash(&RenderSettings::IrradianceVolumeCaptureSize, sizeof(unsigned int), key);
+
+	std::vector<Texture*> cachedMaps;
+	std::vector<float> cachedCoefficients;
+	bool cached = ProbeCache::Load(key, cachedMaps, cachedCoefficients) && cachedMaps.empty() && cachedCoefficients.size() == coefficients.size();
+
+	for(unsigned int i = 0; i < cachedMaps.size(); i++) {
+		delete cachedMaps[i];
+	}
+
+	if(cached) {
+		coefficients.swap(cachedCoefficients);
+		_irradianceVolume->upload();
+
+		std::cout << "Loaded the irradiance volume from the cache" << std::endl;
+		return;
+	}
+
+	//mark the whole grid dirty, the updates capture a few probes per frame and write the grid to the cache once all are done
+	_volumeKey = key;
+	_irradianceVolume->markDirty(AABB(_irradianceVolume->getMin(), _irradianceVolume->getProbePosition(_irradianceVolume->getProbeCount() - 1)));
+
+	std::cout << "Baking irradiance volume with " << size.x << "x" << size.y << "x" << size.z << " probes over the next frames..." << std::endl;
+}
+
+void Renderer::_updateIrradianceVolume(std::vector<Node*>& renderables, Node* directionalLight, Texture* skybox) {
+	glm::vec4 volumeData[2] = { glm::vec4(0.0f), glm::vec4(0.0f) };
+	bool enabled = RenderSettings::IsEnabled(RenderSettings::IrradianceVolume);
+
+	//the grid of the current scene is set up the first time the option is enabled
+	if(enabled && _volumeSceneHash != 0) {
+		std::vector<std::pair<RenderComponent*, glm::mat4>> renderComponents;
+		_getRenderComponents(renderables, renderComponents);
+
+		_createIrradianceVolume(renderComponents, _volumeSceneHash);
+		_volumeSceneHash = 0;
+	}
+
+	if(_irradianceVolume != nullptr) {
+		//upload the probes the workers finished projecting
+		if(!_volumeUpdates.empty() && !_irradianceVolume->isProjecting()) {
+			for(unsigned int i = 0; i < _volumeUpdates.size(); i++) {
+				_irradianceVolume->uploadProbe(_volumeUpdates[i]);
+			}
+
+			_volumeUpdates.clear();
+		}
+
+		LightComponent* dirLight = nullptr;
+		if(directionalLight != nullptr && directionalLight->hasComponent(ComponentType::Light)) dirLight = (LightComponent*)directionalLight->getComponent(ComponentType::Light);
+
+		//a different light or skybox changes the whole grid
+		unsigned long long lightHash = _HashLighting(dirLight, skybox);
+
+		if(_volumeLightHash != 0 && lightHash != _volumeLightHash) _irradianceVolume->markDirty(AABB(_irradianceVolume->getMin(), _irradianceVolume->getProbePosition(_irradianceVolume->getProbeCount() - 1)));
+		_volumeLightHash = lightHash;
+
+		//moved objects change the probes around their old and their new position
+		if(_volumeTransforms.size() != renderables.size()) {
+			_volumeTransforms.resize(renderables.size());
+
+			for(unsigned int i = 0; i < renderables.size(); i++) {
+				_volumeTransforms[i] = renderables[i]->getTransform()->worldTransform;
+			}
+		}
+
+		for(unsigned int i = 0; i < renderables.size(); i++) {
+			glm::mat4& worldTransform = renderables[i]->getTransform()->worldTransform;
+			if(worldTransform == _volumeTransforms[i]) continue;
+
+			Model* model = ((RenderComponent*)renderables[i]->getComponent(ComponentType::Render))->model;
+
+			if(model != nullptr) {
+				_irradianceVolume->markDirty(model->getBounds().transform(_volumeTransforms[i]));
+				_irradianceVolume->markDirty(model->getBounds().transform(worldTransform));
+			}
+
+			_volumeTransforms[i] = worldTransform;
+		}
+
+		//recapture a few of the changed probes, one batch at a time, the bake of a new grid also continues without probe updates
+		if(enabled && (RenderSettings::IsEnabled(RenderSettings::ProbeUpdates) || _volumeKey != 0) && _volumeUpdates.empty()) {
+			std::vector<std::pair<RenderComponent*, glm::mat4>> renderComponents;
+			std::vector<float> faces;
+
+			for(int i = 0; i < RenderSettings::IrradianceVolumeBudget; i++) {
+				int probe = _irradianceVolume->popDirtyProbe();
+
+				//every probe is captured and uploaded once nothing is left at the start of a batch
+				if(probe < 0 && i == 0 && _volumeKey != 0) {
+					std::vector<Texture*> bakedMaps;
+					ProbeCache::Write(_volumeKey, bakedMaps, _irradianceVolume->getCoefficients());
+					_volumeKey = 0;
+
+					std::cout << "Baked the irradiance volume" << std::endl;
+				}
+
+				if(probe < 0) break;
+
+				if(renderComponents.empty()) _getRenderComponents(renderables, renderComponents);
+
+				_captureVolumeProbe(probe, renderComponents, dirLight, skybox, faces);
+				_irradianceVolume->project(probe, faces, RenderSettings::IrradianceVolumeCaptureSize);
+
+				_volumeUpdates.push_back(probe);
+			}
+
+			//reset viewport and bind back to default framebuffer
+			glViewport(0, 0, Window::ScreenWidth, Window::ScreenHeight);
+			Framebuffer::Unbind();
 		}
+
+		//the shaders keep the ambient of the reflection probes until the grid is baked
+		volumeData[0] = glm::vec4(_irradianceVolume->getMin(), enabled && _volumeKey == 0 ? 1.0f : 0.0f);
+		volumeData[1] = glm::vec4(_irradianceVolume->getSpacing(), 0.0f);
 	}
 
-	return prefilterMap;
+	//the grid follows the probe count in the probes uniform buffer
+	_probesUBO->bind();
+	_probesUBO->bufferSubData((RenderSettings::MaxReflectionProbes * _ProbeStride + 1) * sizeof(glm::vec4), sizeof(volumeData), volumeData);
+	Buffer::Unbind(GL_UNIFORM_BUFFER);
 }
 
-void Renderer::_renderBrdfLUT() {
-	//create 2 channel lookup texture (LUT)
-	_brdfLUT = new Texture(GL_TEXTURE_2D, GL_RG16F, RenderSettings::EnvironmentWidth, RenderSettings::EnvironmentHeight, GL_RG, GL_FLOAT, GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, NULL, false);
+void Renderer::_captureVolumeProbe(unsigned int probe, std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents, LightComponent* dirLight, Texture* skybox, std::vector<float>& faces) {
+	glm::vec3 position = _irradianceVolume->getProbePosition(probe);
+	glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, RenderSettings::EnvironmentNearPlane, RenderSettings::EnvironmentFarPlane);
+	unsigned int size = RenderSettings::IrradianceVolumeCaptureSize;
 
-	//rescale renderbuffer to LUT texture dimensions
-	glViewport(0, 0, RenderSettings::EnvironmentWidth, RenderSettings::EnvironmentHeight);
+	//set viewport and bind to cubemap framebuffer
+	glViewport(0, 0, size, size);
+	_initEnvironmentFBO();
 	_environmentRBO->bind();
-	_environmentRBO->init(GL_DEPTH_COMPONENT, RenderSettings::EnvironmentWidth, RenderSettings::EnvironmentHeight);
+	_environmentRBO->init(GL_DEPTH_COMPONENT, size, size);
 	Renderbuffer::Unbind();
 
-	//attach BRDF texture to framebuffer
-	_environmentFBO->attachTexture(GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _brdfLUT);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	_environmentFBO->bind();
 
-	//render quad
-	_brdfShader->use();
-	_screenQuadVAO->bind();
-	_screenQuadVAO->drawArrays(GL_TRIANGLE_STRIP, 0, 4);
-	VertexArray::Unbind();
+	//the same capture as the reflection probes, only at a much lower resolution
+	std::vector<RenderComponent*> skippedComponents;
+
+	for(unsigned int i = 0; i < 6; i++) {
+		_renderEnvironmentFace(_volumeCaptureMap, i, renderComponents, projection, position, skippedComponents, skybox, dirLight);
+	}
+
+	//read the faces back for the projection on the workers
+	faces.resize(size * size * 3 * 6);
+	_volumeCaptureMap->bind();
+
+	for(unsigned int i = 0; i < 6; i++) {
+		glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, GL_FLOAT, &faces[i * size * size * 3]);
+	}
+}
+
+glm::mat4 Renderer::_GetFaceView(glm::vec3 position, unsigned int face) {
+	//view matrices for each cubemap face
+	switch(face) {
+		case 0: return glm::lookAt(position, position + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)); //right
+		case 1: return glm::lookAt(position, position + glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)); //left
+		case 2: return glm::lookAt(position, position + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)); //top
+		case 3: return glm::lookAt(position, position + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f)); //bottom
+		case 4: return glm::lookAt(position, position + glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f)); //front
+		default: return glm::lookAt(position, position + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f)); //back
+	}
+}
+
+unsigned long long Renderer::_HashLighting(LightComponent* dirLight, Texture* skybox) {
+	unsigned long long hash = Math::Hash(&skybox, sizeof(Texture*));
+
+	if(dirLight != nullptr) {
+		hash = Math::Hash(&dirLight->lightDirection, sizeof(glm::vec3), hash);
+		hash = Math::Hash(&dirLight->lightAmbient, sizeof(glm::vec3), hash);
+		hash = Math::Hash(&dirLight->lightDiffuse, sizeof(glm::vec3), hash);
+	}
+
+	return hash;
 }
 
-void Renderer::_renderShadowMaps(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents, std::vector<glm::vec3>& pointLights, glm::mat4& lightSpaceMatrix) {
+unsigned long long Renderer::_HashFile(std::string path, unsigned long long hash) {
+	//an edited file changes its modification time or size, hashing the whole contents of every asset for each bake would be too slow
+	unsigned long long stats[2] = { 0, 0 };
+	Filepath::GetFileStats(path, stats[0], stats[1]); //missing files keep zeros
+
+	hash = Math::Hash(path.c_str(), path.size(), hash);
+	return Math::Hash(stats, sizeof(stats), hash);
+}
+
+void Renderer::_renderShadowMaps(std::vector<glm::vec3>& pointLights, glm::mat4& lightSpaceMatrix, bool dirShadows) {
 	//adjust viewport and bind to shadow framebuffer
 	glViewport(0, 0, RenderSettings::ShadowWidth, RenderSettings::ShadowHeight);
-	_shadowFBO->bind();
-	glClear(GL_DEPTH_BUFFER_BIT);
+
+	if(dirShadows) {
+		_initShadowFBO();
+		_shadowFBO->bind();
+		glClear(GL_DEPTH_BUFFER_BIT);
+	}
+
+	//only objects inside the light volume can cast shadows into the shadow map
+	std::vector<Node*> shadowCasters;
+	std::vector<std::pair<RenderComponent*, glm::mat4>> renderComponents;
+
+	if(dirShadows && RenderSettings::IsEnabled(RenderSettings::GPUDriven)) {
+		//cull and draw all shadow casters with a single indirect draw call
+		_gpuScene->cull(lightSpaceMatrix, lightSpaceMatrix, GPUScene::ShadowPass, false);
+
+		_shadowIndirectShader->use();
+		_shadowIndirectShader->setMat4("lightSpaceMatrix", lightSpaceMatrix);
+		_gpuScene->draw();
+	} else if(dirShadows) {
+		_renderableTree->queryFrustum(Frustum(lightSpaceMatrix), shadowCasters);
+		_getRenderComponents(shadowCasters, renderComponents);
+	}
 
 	//setup shader uniforms
 	_shadowShader->use();
@@ -1280,7 +2455,7 @@ void Renderer::_renderShadowMaps(std::vector<std::pair<RenderComponent*, glm::ma
 		if(!material->getCastsShadows()) continue; //skip this model, if it should not cast shadows
 
 		_shadowShader->setMat4("modelMatrix", modelMatrix);
-		model->draw();
+		model->drawPositions(_getShadowLod(renderComponent));
 	}
 
 	//use shadow cubemap shader
@@ -1292,6 +2467,8 @@ void Renderer::_renderShadowMaps(std::vector<std::pair<RenderComponent*, glm::ma
 	glm::vec3 lightPos;
 	glm::vec3 modelPos;
 
+	_initShadowCubeMaps(pointLights.size());
+
 	for(unsigned int i = 0; i < pointLights.size(); i++) {
 		//bind to correct cubemap shadow framebuffer
 		_shadowCubeFBO->bind();
@@ -1317,6 +2494,13 @@ void Renderer::_renderShadowMaps(std::vector<std::pair<RenderComponent*, glm::ma
 
 		_shadowCubeShader->setVec3("lightPos", lightPos);
 
+		//gather the objects within the range of the shadow cubemap
+		shadowCasters.clear();
+		renderComponents.clear();
+
+		_renderableTree->querySphere(lightPos, RenderSettings::CubeShadowFarPlane, shadowCasters);
+		_getRenderComponents(shadowCasters, renderComponents);
+
 		//render all models' depth into the shadow cubemap from the lights perspective
 		for(unsigned int i = 0; i < renderComponents.size(); i++) {
 			renderComponent = renderComponents[i].first;
@@ -1338,7 +2522,7 @@ void Renderer::_renderShadowMaps(std::vector<std::pair<RenderComponent*, glm::ma
 			if(!material->getCastsShadows()) continue; //skip this model, if it should not cast shadows (e.g. like glass)
 
 			_shadowCubeShader->setMat4("modelMatrix", modelMatrix);
-			model->draw();
+			model->drawPositions(_getShadowLod(renderComponent));
 		}
 	}
 
@@ -1346,13 +2530,25 @@ void Renderer::_renderShadowMaps(std::vector<std::pair<RenderComponent*, glm::ma
 	glViewport(0, 0, Window::ScreenWidth, Window::ScreenHeight);
 }
 
-void Renderer::_renderDepth(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents) {
+void Renderer::_renderDepth(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents, glm::mat4& viewProjection, glm::mat4& previousViewProjection) {
 	//render the depth texture seperately to enable rendering thickness maps if needed lateron
 
 	//bind to depth framebuffer
 	_depthFBO->bind();
 	glClear(GL_DEPTH_BUFFER_BIT);
 
+	if(RenderSettings::IsEnabled(RenderSettings::GPUDriven)) {
+		//cull against the frustum and last frame's depth pyramid on the gpu, then draw the survivors indirectly
+		_gpuScene->cull(viewProjection, previousViewProjection, GPUScene::DepthPass, RenderSettings::IsEnabled(RenderSettings::OcclusionCulling));
+
+		_depthIndirectShader->use();
+		_gpuScene->draw();
+
+		//downsample the new depth for next frame's occlusion test
+		_gpuScene->buildDepthPyramid(_sceneDepthBuffer, Window::ScreenWidth, Window::ScreenHeight);
+		return;
+	}
+
 	//setup shader uniforms
 	_depthShader->use();
 
@@ -1380,7 +2576,7 @@ void Renderer::_renderDepth(std::vector<std::pair<RenderComponent*, glm::mat4>>&
 		model = renderComponent->model;
 
 		_depthShader->setMat4("modelMatrix", modelMatrix);
-		model->draw();
+		model->drawPositions(renderComponent->lodLevel);
 	}
 }
 
@@ -1394,6 +2590,8 @@ void Renderer::_renderGeometry(std::vector<std::pair<RenderComponent*, glm::mat4
 	GLfloat clearColor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
 	glClearTexImage(_gEmissionSpec->getID(), 0, GL_RG, GL_FLOAT, &clearColor); //initialize the emission spec with 0 to avoid having specularity on the skybox
 
+	_bindReflectionProbes();
+
 	MaterialType materialType;
 	RenderComponent* renderComponent;
 	Material* material;
@@ -1411,22 +2609,17 @@ void Renderer::_renderGeometry(std::vector<std::pair<RenderComponent*, glm::mat4
 		modelMatrix = solidRenderComponents[i].second;
 		model = renderComponent->model;
 
-		if(_iblMaps.count(renderComponent)) {
-			//bind irradiance and prefilter map
-			Texture::SetActiveUnit(8);
-			_iblMaps[renderComponent].irradianceMap->bind();
+		if(materialType != MaterialType::Color) {
+			//blend between the probes around the object
+			int primaryProbe, secondaryProbe;
+			float probeBlend;
 
-			Texture::SetActiveUnit(9);
-			_iblMaps[renderComponent].prefilterMap->bind();
-		} else if(_environmentMaps.count(renderComponent)) {
-			//bind environment map
-
-			Texture::SetActiveUnit(8);
-			_environmentMaps[renderComponent]->bind();
+			_selectReflectionProbes(glm::vec3(modelMatrix[3]), primaryProbe, secondaryProbe, probeBlend);
+			Material::SetReflectionProbes(primaryProbe, secondaryProbe, probeBlend);
 		}
 
 		material->drawDeferred(modelMatrix); //deferred
-		model->draw();
+		model->draw(renderComponent->lodLevel);
 	}
 }
 
@@ -1554,10 +2747,6 @@ void Renderer::_renderLighting(Texture* skybox, unsigned int pointLightCount, bo
 		Texture::SetActiveUnit(4);
 		_gMetalRoughAO->bind();
 
-		//bind irradiance color buffer
-		Texture::SetActiveUnit(5);
-		_gIrradiance->bind();
-
 		//bind prefilter color buffer
 		Texture::SetActiveUnit(6);
 		_gPrefilter->bind();
@@ -1569,6 +2758,9 @@ void Renderer::_renderLighting(Texture* skybox, unsigned int pointLightCount, bo
 		//bind brdf LUT
 		Texture::SetActiveUnit(9);
 		_brdfLUT->bind();
+
+		//bind irradiance volume
+		if(_irradianceVolume != nullptr) _irradianceVolume->bind(17);
 	} else {
 		//use lighting shader and bind textures
 		_lightingShader->use();
@@ -1597,8 +2789,10 @@ void Renderer::_renderLighting(Texture* skybox, unsigned int pointLightCount, bo
 	}
 
 	//bind ssao texture
-	Texture::SetActiveUnit(8);
-	_ssaoBlurColorBuffer->bind();
+	if(_ssaoBlurColorBuffer != nullptr) {
+		Texture::SetActiveUnit(8);
+		_ssaoBlurColorBuffer->bind();
+	}
 
 	if(dirShadows) {
 		Texture::SetActiveUnit(11);
@@ -1634,6 +2828,14 @@ void Renderer::_renderScene(std::vector<std::pair<RenderComponent*, glm::mat4>>&
 		_shadowCubeMaps[i]->bind();
 	}
 
+	//bind the probe arrays and the brdf LUT
+	_bindReflectionProbes();
+
+	Texture::SetActiveUnit(10);
+	_brdfLUT->bind();
+
+	if(_irradianceVolume != nullptr) _irradianceVolume->bind(17);
+
 	RenderComponent* renderComponent;
 	MaterialType materialType;
 	Material* material;
@@ -1652,26 +2854,17 @@ void Renderer::_renderScene(std::vector<std::pair<RenderComponent*, glm::mat4>>&
 		model = renderComponent->model;
 		modelMatrix = renderComponents[i].second;
 
-		if(_iblMaps.count(renderComponent)) {
-			//bind irradiance cubemap, prefilter cubemap and brdfLUT
-
-			Texture::SetActiveUnit(8);
-			_iblMaps[renderComponent].irradianceMap->bind();
+		if(materialType != MaterialType::Color) {
+			//blend between the probes around the object
+			int primaryProbe, secondaryProbe;
+			float probeBlend;
 
-			Texture::SetActiveUnit(9);
-			_iblMaps[renderComponent].prefilterMap->bind();
-
-			Texture::SetActiveUnit(10);
-			_brdfLUT->bind();
-		} else if(_environmentMaps.count(renderComponent)) {
-			//bind environment cubemap
-
-			Texture::SetActiveUnit(8);
-			_environmentMaps[renderComponent]->bind();
+			_selectReflectionProbes(glm::vec3(modelMatrix[3]), primaryProbe, secondaryProbe, probeBlend);
+			Material::SetReflectionProbes(primaryProbe, secondaryProbe, probeBlend);
 		}
 
 		material->drawForward(modelMatrix); //forward
-		model->draw();
+		model->draw(renderComponent->lodLevel);
 	}
 }
 
@@ -1703,6 +2896,7 @@ void Renderer::_renderSkybox(glm::mat4& viewMatrix, glm::mat4& projectionMatrix,
 
 void Renderer::_renderPostProcessingQuad() {
 	//blur bright fragments with two-pass Gaussian Blur 
+	bool bloom = RenderSettings::IsEnabled(RenderSettings::Bloom);
 	bool horizontal = true;
 	bool firstIteration = true;
 
@@ -1712,7 +2906,7 @@ void Renderer::_renderPostProcessingQuad() {
 	_screenQuadVAO->bind();
 	Texture::SetActiveUnit(0);
 
-	for(unsigned int i = 0; i < RenderSettings::BloomBlurAmount; i++) {
+	for(unsigned int i = 0; bloom && i < RenderSettings::BloomBlurAmount; i++) {
 		_bloomBlurFBOs[horizontal]->bind();
 
 		_bloomBlurShader->setInt("horizontal", horizontal);
@@ -1736,10 +2930,10 @@ void Renderer::_renderPostProcessingQuad() {
 
 	//set uniforms for gamma correction and tone mapping
 	_postProcessingShader->use();
-	_postProcessingShader->setBool("useBloom", RenderSettings::IsEnabled(RenderSettings::Bloom));
+	_postProcessingShader->setBool("useBloom", bloom);
 	_postProcessingShader->setBool("useFXAA", RenderSettings::IsEnabled(RenderSettings::FXAA));
 	_postProcessingShader->setBool("useMotionBlur", RenderSettings::IsEnabled(RenderSettings::MotionBlur));
-	_postProcessingShader->setBool("useSSR", RenderSettings::IsEnabled(RenderSettings::SSR));
+	_postProcessingShader->setBool("useSSR", RenderSettings::IsEnabled(RenderSettings::SSR | RenderSettings::Deferred)); //the ssr texture is only rendered in deferred shading
 
 	_postProcessingShader->setBool("ssrDebug", RenderSettings::SsrDebug);
 
@@ -1762,17 +2956,35 @@ void Renderer::_renderPostProcessingQuad() {
 	Texture::SetActiveUnit(1);
 	_sceneDepthBuffer->bind(); //bind scene depth texture
 
-	Texture::SetActiveUnit(2);
-	_blurColorBuffers[!horizontal]->bind(); //bind blurred bloom texture
+	if(bloom) {
+		Texture::SetActiveUnit(2);
+		_blurColorBuffers[!horizontal]->bind(); //bind blurred bloom texture
+	}
 
-	Texture::SetActiveUnit(3);
-	_ssrColorBuffer->bind(); //bind the ssr reflection texture
+	if(_ssrColorBuffer != nullptr) {
+		Texture::SetActiveUnit(3);
+		_ssrColorBuffer->bind(); //bind the ssr reflection texture
+	}
 
 	//render texture to the screen and tone map and gamma correct
 	_screenQuadVAO->drawArrays(GL_TRIANGLE_STRIP, 0, 4);
 	VertexArray::Unbind();
 }
 
+void Renderer::_getRenderComponents(std::vector<Node*>& nodes, std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents) {
+	RenderComponent* renderComponent;
+
+	for(unsigned int i = 0; i < nodes.size(); i++) {
+		renderComponent = (RenderComponent*)nodes[i]->getComponent(ComponentType::Render);
+
+		std::pair<RenderComponent*, glm::mat4> renderPair;
+		renderPair.first = renderComponent;
+		renderPair.second = nodes[i]->getTransform()->worldTransform;
+
+		renderComponents.push_back(renderPair);
+	}
+}
+
 void Renderer::_getSortedRenderComponents(std::vector<Node*>& renderables, glm::vec3& cameraPos, std::vector<std::pair<RenderComponent*, glm::mat4>>& solidRenderables, std::vector<std::pair<RenderComponent*, glm::mat4>>& blendRenderables) {
 	//fill both vectors with the objects
 	std::vector<std::pair<RenderComponent*, glm::mat4>> newBlendRenderables;
@@ -1819,35 +3031,101 @@ void Renderer::_getSortedRenderComponents(std::vector<Node*>& renderables, glm::
 	}
 }
 
-std::vector<glm::vec3> Renderer::_getClosestPointLights(glm::vec3 cameraPos, std::vector<std::pair<LightComponent*, glm::vec3>>& lightComponents) {
-	//insert all point lights into the map to sort them automatically
-	std::map<float, unsigned int> sortedPointLights;
-	float distance;
+std::vector<glm::vec3> Renderer::_getClosestPointLights(glm::vec3 cameraPos) {
+	//k nearest query on the point light tree, capped by the amount of shadow cubemaps
+	std::vector<Node*> nearestPointLights;
+	_pointLightTree->queryNearest(cameraPos, RenderSettings::MaxCubeShadows, nearestPointLights);
+
+	std::vector<glm::vec3> closestPointLights;
 
-	for(unsigned int i = 0; i < lightComponents.size(); i++) {
-		if(lightComponents[i].first->lightType != LightType::Point) continue; //skip every non point light
+	for(unsigned int i = 0; i < nearestPointLights.size(); i++) {
+		closestPointLights.push_back(nearestPointLights[i]->getTransform()->getWorldPosition());
+	}
 
-		distance = glm::distance2(cameraPos, lightComponents[i].second); //distance squared for comparisons
+	return closestPointLights;
+}
 
-		while(sortedPointLights.count(distance)) { //offset the distance slightly if there is an objects with the exact same distance already to allow having both in the map
-			distance += 0.0001f;
+void Renderer::_updateLods(std::vector<Node*>& renderables, glm::vec3& cameraPos, float projectionScale) {
+	RenderComponent* renderComponent;
+
+	for(unsigned int i = 0; i < renderables.size(); i++) {
+		renderComponent = (RenderComponent*)renderables[i]->getComponent(ComponentType::Render);
+
+		if(RenderSettings::IsEnabled(RenderSettings::LevelOfDetail)) {
+			renderComponent->lodLevel = _selectLod(renderComponent->model, renderables[i]->getTransform()->worldTransform, cameraPos, projectionScale, renderComponent->lodLevel);
+		} else {
+			renderComponent->lodLevel = 0; //always draw the full resolution meshes
 		}
+	}
+}
 
-		sortedPointLights[distance] = i; //add index of light pair to map
+unsigned int Renderer::_selectLod(Model* model, glm::mat4& modelMatrix, glm::vec3& viewPos, float projectionScale, unsigned int currentLod) {
+	unsigned int lodCount = model->getLodCount();
+	if(lodCount == 1) return 0;
+
+	//approximate the projected height of the bounding sphere relative to the screen height
+	AABB& bounds = model->getBounds();
+
+	float scale = std::max(glm::length(glm::vec3(modelMatrix[0])), std::max(glm::length(glm::vec3(modelMatrix[1])), glm::length(glm::vec3(modelMatrix[2]))));
+	float radius = glm::length(bounds.getExtents()) * scale;
+	float distance = glm::distance(glm::vec3(modelMatrix * glm::vec4(bounds.getCenter(), 1.0f)), viewPos);
+
+	if(distance <= radius) return 0; //the camera is inside of the bounds
+
+	float screenSize = radius * projectionScale / distance;
+
+	//level n is used below LodScreenSize / 2^(n - 1), only switch once the size moved past the threshold by the hysteresis margin
+	unsigned int lod = std::min(currentLod, lodCount - 1);
+	float threshold = RenderSettings::LodScreenSize / (float)(1 << lod); //threshold of the next coarser level
+
+	while(lod + 1 < lodCount && screenSize < threshold * (1.0f - RenderSettings::LodHysteresis)) {
+		lod++;
+		threshold *= 0.5f;
 	}
 
-	//fill vector with the light entires closest to the camera
-	unsigned int counter = 0;
-	std::vector<glm::vec3> closestPointLights;
+	while(lod > 0 && screenSize > threshold * 2.0f * (1.0f + RenderSettings::LodHysteresis)) {
+		lod--;
+		threshold *= 2.0f;
+	}
 
-	for(std::map<float, unsigned int>::iterator it = sortedPointLights.begin(); it != sortedPointLights.end(); it++) {
-		if(counter >= RenderSettings::MaxCubeShadows) break; //do not allow more point lights than specified in the settings
+	return lod;
+}
+
+void Renderer::_updateTextureDemand(std::vector<Node*>& visibleRenderables, glm::vec3& cameraPos, float projectionScale, float nearPlane) {
+	RenderComponent* renderComponent;
+	std::vector<Texture*> textures;
+
+	for(unsigned int i = 0; i < visibleRenderables.size(); i++) {
+		renderComponent = (RenderComponent*)visibleRenderables[i]->getComponent(ComponentType::Render);
+
+		float uvDensity = renderComponent->model->getUvDensity();
+		if(uvDensity <= 0.0f) continue; //no texture coordinates
+
+		//the closest point of the bounding sphere needs the finest level
+		glm::mat4& modelMatrix = visibleRenderables[i]->getTransform()->worldTransform;
+		AABB& bounds = renderComponent->model->getBounds();
+
+		float scale = std::max(glm::length(glm::vec3(modelMatrix[0])), std::max(glm::length(glm::vec3(modelMatrix[1])), glm::length(glm::vec3(modelMatrix[2]))));
+		float radius = glm::length(bounds.getExtents()) * scale;
+		float distance = std::max(glm::distance(glm::vec3(modelMatrix * glm::vec4(bounds.getCenter(), 1.0f)), cameraPos) - radius, nearPlane);
+
+		//pixels covered by one world unit at that distance, uv density is uv area per surface area of the mesh
+		float pixelsPerUnit = projectionScale * 0.5f * Window::ScreenHeight / distance;
+		float uvsPerPixel = std::sqrt(uvDensity) / scale / pixelsPerUnit;
 
-		closestPointLights.push_back(lightComponents[it->second].second); //add to new vector by indexing the unsorted one
-		counter++;
+		textures.clear();
+		renderComponent->material->getTextures(textures);
+
+		for(unsigned int j = 0; j < textures.size(); j++) {
+			TextureStreamer::Request(textures[j], uvsPerPixel);
+		}
 	}
+}
 
-	return closestPointLights;
+unsigned int Renderer::_getShadowLod(RenderComponent* renderComponent) {
+	if(!RenderSettings::IsEnabled(RenderSettings::LevelOfDetail)) return 0;
+
+	return (unsigned int)std::max((int)renderComponent->lodLevel + RenderSettings::ShadowLodBias, 0);
 }
 
 void Renderer::_fillUniformBuffers(glm::mat4& viewMatrix, glm::mat4& projectionMatrix, glm::mat4& previousViewProjection, glm::mat4& lightSpaceMatrix, glm::vec3& cameraPos, glm::vec3& directionalLightPos, bool dirShadows, std::vector<glm::vec3>& pointLightPositions) {
@@ -1952,49 +3230,65 @@ void Renderer::_updateDimensions() {
 	if(!Window::DimensionsChanged) return;
 
 	//first free all ressources that depend on the screen dimensions to avoid memory leaks
-	delete _gBuffer;
-	delete _gBufferPbr;
-	delete _depthFBO;
-	delete _hdrFBO;
-	delete _bloomBlurFBOs[0];
-	delete _bloomBlurFBOs[1];
-	delete _ssaoFBO;
-	delete _ssaoBlurFBO;
-	delete _ssrFBO;
+	_freeGBuffers(false);
+	_freeGBuffers(true);
+	_freeDepthFBO();
+	_freeHdrFBO();
+	_freeBlurFBOs();
+	_freeSSAOFBOs();
+	_freeSSRFBO();
+
+	//then reallocate the ones every frame needs with the correct new dimensions, the rest follows in _updateRenderTargets
+	_initDepthFBO();
+	_initHdrFBO();
 
-	delete _gRBO;
-	delete _hdrRBO;
+	Window::DimensionsChanged = false; //reset
+}
 
-	delete _gPosition;
-	delete _gNormal;
-	delete _gAlbedo;
-	delete _gEmissionSpec;
+void Renderer::_updateRenderTargets() {
+	bool deferred = RenderSettings::IsEnabled(RenderSettings::Deferred);
+	bool pbr = RenderSettings::IsEnabled(RenderSettings::PBR);
 
-	delete _gEnvironmentShiny;
+	//only the gBuffer of the current shading mode is kept
+	if(!deferred || pbr) _freeGBuffers(false);
+	if(!deferred || !pbr) _freeGBuffers(true);
+	if(deferred) _initGBuffers(pbr);
 
-	delete _gMetalRoughAO;
-	delete _gIrradiance;
-	delete _gPrefilter;
-	delete _gReflectance;
+	//the screen space effects read from the gBuffer, so they need deferred shading too
+	if(RenderSettings::IsEnabled(RenderSettings::Deferred | RenderSettings::SSAO)) _initSSAOFBOs();
+	else _freeSSAOFBOs();
 
-	delete _sceneDepthBuffer;
-	delete _sceneColorBuffer;
-	delete _brightColorBuffer;
-	delete _blurColorBuffers[0];
-	delete _blurColorBuffers[1];
-	delete _ssaoColorBuffer;
-	delete _ssaoBlurColorBuffer;
-	delete _ssrColorBuffer;
+	if(RenderSettings::IsEnabled(RenderSettings::Deferred | RenderSettings::SSR)) _initSSRFBO();
+	else _freeSSRFBO();
 
-	//then reallocate them with the correct new dimensions
-	_initGBuffers();
-	_initDepthFBO();
-	_initHdrFBO();
-	_initBlurFBOs();
-	_initSSAOFBOs();
-	_initSSRFBO();
+	if(RenderSettings::IsEnabled(RenderSettings::Bloom)) _initBlurFBOs();
+	else _freeBlurFBOs();
 
-	Window::DimensionsChanged = false; //reset
+	//the shadow maps are created when they are rendered for the first time
+	bool shadows = RenderSettings::IsEnabled(RenderSettings::Shadows);
+
+	if(!shadows || !RenderSettings::ShowDirectionalShadows) _freeShadowFBO();
+	if(!shadows || !RenderSettings::ShowCubeShadows) _freeShadowCubeMaps();
+
+	//the environment framebuffer is only needed while probes are captured
+	if(!RenderSettings::IsEnabled(RenderSettings::ProbeUpdates) && _unbakedProbes == 0 && _volumeKey == 0) _freeEnvironmentFBO();
+}
+
+void Renderer::_addRenderTargetInfo(std::vector<RenderTargetInfo>& infos, std::string name, std::vector<Texture*> textures, std::vector<Renderbuffer*> renderbuffers) {
+	RenderTargetInfo info;
+	info.name = name;
+	info.memory = 0;
+
+	//freed targets are null and count as nothing
+	for(unsigned int i = 0; i < textures.size(); i++) {
+		if(textures[i] != nullptr) info.memory += textures[i]->getMemorySize();
+	}
+
+	for(unsigned int i = 0; i < renderbuffers.size(); i++) {
+		if(renderbuffers[i] != nullptr) info.memory += renderbuffers[i]->getMemorySize();
+	}
+
+	infos.push_back(info);
 }
 
 void Renderer::_applyCullMode() {
@@ -4,12 +4,14 @@
 #include <vector>
 #include <map>
 #include <bitset>
+#include <string>
 
 #include <glm\glm.hpp>
 
-#include "../Engine/IBLMaps.h"
+#include "../Engine/ReflectionProbe.h"
 
 class Node;
+class Model;
 class Shader;
 class Texture;
 class RenderComponent;
@@ -20,6 +22,15 @@ class Buffer;
 class Framebuffer;
 class Renderbuffer;
 class Debug;
+class BVH;
+class OcclusionCuller;
+class GPUScene;
+class IrradianceVolume;
+
+struct RenderTargetInfo {
+	std::string name;
+	unsigned long long memory; //resident gpu memory in bytes, 0 while the feature is disabled
+};
 
 class Renderer {
 	public:
@@ -27,10 +38,15 @@ class Renderer {
 		~Renderer();
 
 		void render(std::vector<Node*>& renderables, std::vector<Node*>& lights, Node* mainCamera, Node* directionalLight, Texture* skybox);
-		void renderEnvironmentMaps(std::vector<Node*>& renderables, Node* directionalLight, Texture* skybox);
+		void renderEnvironmentMaps(std::vector<Node*>& renderables, std::vector<ReflectionProbe>& probes, Node* directionalLight, Texture* skybox, std::vector<std::string>& skyboxSources); //places probes itself if there are none
+		void updateBoundingVolumes(std::vector<Node*>& renderables, std::vector<Node*>& lights);
+
+		Node* raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance);
 
 		Texture* convertEquiToCube(Texture* skybox);
 
+		std::vector<RenderTargetInfo> getRenderTargetInfos();
+
 	private:
 		//profiler
 		Debug* _profiler;
@@ -41,12 +57,55 @@ class Renderer {
 		//vertex data
 		static const std::vector<float> _SkyboxVertices;
 		static const std::vector<float> _ScreenQuadVertices;
+		static const unsigned int _ProbeStride = 11; //vec4s per probe in the probes uniform buffer
+		static const float _UnbakedProbeChange; //priority of a missing capture, above any number of changed objects
+
+		//acceleration structures
+		BVH* _renderableTree;
+		BVH* _pointLightTree;
 
-		//environment map data
-		std::map<RenderComponent*, Texture*> _environmentMaps;
-		std::map<RenderComponent*, IBLMaps> _iblMaps;
+		OcclusionCuller* _occlusionCuller;
+		GPUScene* _gpuScene;
+
+		//reflection probe data, one layer per probe in each cubemap array
+		std::vector<ReflectionProbe> _reflectionProbes;
+		std::vector<glm::vec4> _probeData; //contents of the probes uniform buffer
+		Texture* _probeEnvironmentMaps;
+		Texture* _probePrefilterMaps;
 		Texture* _brdfLUT;
 
+		//runtime probe updates, a changed probe is recaptured a few faces and prefilter levels per frame
+		struct ProbeState {
+			std::vector<std::pair<Node*, glm::mat4>> surroundings; //objects around the probe at its last capture, sorted by node
+			bool captured; //the surroundings are recorded the first time the probes are checked
+			bool baked; //false for a probe that was not in the probe cache, it stays black until the runtime updates captured it
+			bool lightChanged;
+			float change; //objects that moved, appeared or disappeared since the last capture
+		};
+
+		struct ProbeUpdate {
+			int probe; //-1 if no probe is being updated
+			unsigned int step; //six capture faces, the irradiance projection, the prefilter levels and the copy into the arrays
+			Texture* environmentMap;
+			Texture* prefilterMap;
+			std::vector<RenderComponent*> skippedComponents;
+		};
+
+		std::vector<ProbeState> _probeStates;
+		ProbeUpdate _probeUpdate;
+		unsigned long long _probeLightHash;
+		std::vector<unsigned long long> _probeKeys; //probe cache keys of the current scene
+		unsigned int _unbakedProbes;
+
+		//grid of irradiance probes for the diffuse ambient, recaptured around objects that move
+		IrradianceVolume* _irradianceVolume;
+		Texture* _volumeCaptureMap;
+		std::vector<glm::mat4> _volumeTransforms; //world transforms of the renderables when they were last checked
+		std::vector<unsigned int> _volumeUpdates; //probes projected on the workers, uploaded once done
+		unsigned long long _volumeLightHash;
+		unsigned long long _volumeSceneHash; //scene the grid is set up for once the option is enabled, 0 if it is set up
+		unsigned long long _volumeKey; //probe cache key of a grid still captured over the next frames, 0 once it is baked
+
 		//shaders
 		Shader* _equiToCubeShader;
 		Shader* _lightingShader;
@@ -54,8 +113,10 @@ class Renderer {
 		Shader* _shadowShader;
 		Shader* _shadowCubeShader;
 		Shader* _depthShader;
+		Shader* _shadowIndirectShader;
+		Shader* _depthIndirectShader;
 		Shader* _environmentShader;
-		Shader* _irradianceShader;
+		Shader* _irradianceSHShader;
 		Shader* _prefilterShader;
 		Shader* _brdfShader;
 		Shader* _skyboxShader;
@@ -74,7 +135,6 @@ class Renderer {
 		Texture* _gEnvironmentShiny;
 
 		Texture* _gMetalRoughAO;
-		Texture* _gIrradiance;
 		Texture* _gPrefilter;
 		Texture* _gReflectance;
 
@@ -100,6 +160,9 @@ class Renderer {
 		//UBOs, SSBOs
 		Buffer* _matricesUBO;
 		Buffer* _dataUBO;
+		Buffer* _probesUBO;
+		Buffer* _prefilterUBO;
+		Buffer* _irradianceSSBO;
 
 		Buffer* _lightsSSBO;
 
@@ -113,7 +176,6 @@ class Renderer {
 		Framebuffer* _depthFBO;
 		Framebuffer* _environmentFBO;
 		Framebuffer* _hdrFBO;
-		Framebuffer* _bloomFBO;
 		Framebuffer* _bloomBlurFBOs[2];
 		Framebuffer* _ssaoFBO;
 		Framebuffer* _ssaoBlurFBO;
@@ -127,6 +189,8 @@ class Renderer {
 
 		//kernels
 		std::vector<glm::vec3> _ssaoKernel;
+		std::vector<std::vector<glm::vec4>> _prefilterSamples; //tangent space sample directions with their source level in w, per prefilter level
+		unsigned int _prefilterQuality; //sample count the tables were built for
 
 		//init functions
 		void _initShaders();
@@ -137,26 +201,71 @@ class Renderer {
 		void _initUniformBuffers();
 		void _initShaderStorageBuffers();
 
-		void _initGBuffers();
+		//the render targets of optional features are created on first use, see _updateRenderTargets
+		void _initGBuffers(bool pbr);
 		void _initConversionFBO();
 		void _initShadowFBO();
 		void _initShadowCubeFBO();
+		void _initShadowCubeMaps(unsigned int count);
 		void _initDepthFBO();
 		void _initEnvironmentFBO();
 		void _initHdrFBO();
 		void _initBlurFBOs();
 		void _initSSAOFBOs();
 		void _initSSRFBO();
+
+		void _freeGBuffers(bool pbr);
+		void _freeConversionFBO();
+		void _freeShadowFBO();
+		void _freeShadowCubeMaps();
+		void _freeDepthFBO();
+		void _freeEnvironmentFBO();
+		void _freeHdrFBO();
+		void _freeBlurFBOs();
+		void _freeSSAOFBOs();
+		void _freeSSRFBO();
 		
 		//environment render functions
-		Texture* _renderEnvironmentMap(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents, glm::mat4& environmentProjection, glm::vec3& renderPos, RenderComponent* currentRenderComponent, Texture* skybox, LightComponent* dirLight, bool pbr);
-		Texture* _renderIrradianceMap(Texture* environmentMap, glm::mat4& irradianceProjection);
+		Texture* _renderEnvironmentMap(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents, glm::mat4& environmentProjection, glm::vec3& renderPos, std::vector<RenderComponent*>& skippedComponents, Texture* skybox, LightComponent* dirLight);
+		Texture* _createEnvironmentMap();
+		void _renderEnvironmentFace(Texture* environmentMap, unsigned int face, std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents, glm::mat4& environmentProjection, glm::vec3& renderPos, std::vector<RenderComponent*>& skippedComponents, Texture* skybox, LightComponent* dirLight);
+		void _projectIrradiance(Texture* environmentMap, glm::vec4* coefficients); //9 spherical harmonics coefficients, rgb in xyz
 		Texture* _renderPrefilterMap(Texture* environmentMap, glm::mat4& prefilterProjection);
-		void _renderBrdfLUT();
+		Texture* _createPrefilterMap();
+		void _renderPrefilterLevel(Texture* environmentMap, Texture* prefilterMap, unsigned int mip, glm::mat4& prefilterProjection);
+		void _buildPrefilterSamples();
+		void _measurePrefilterError(Texture* environmentMap, Texture* prefilterMap, glm::mat4& prefilterProjection);
+		void _measureBrdfError();
+		unsigned long long _hashEnvironmentScene(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents, LightComponent* dirLight, Texture* skybox, std::vector<std::string>& skyboxSources);
+
+		//reflection probe functions
+		void _placeReflectionProbes(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents);
+		void _selectReflectionProbes(glm::vec3 position, int& primaryProbe, int& secondaryProbe, float& probeBlend);
+		void _bindReflectionProbes();
+		void _uploadReflectionProbes();
+		void _getSkippedComponents(unsigned int probe, std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents, std::vector<RenderComponent*>& skippedComponents);
+
+		//runtime probe update functions
+		void _updateReflectionProbes(std::vector<Node*>& renderables, glm::vec3& cameraPos, Node* directionalLight, Texture* skybox);
+		void _getProbeSurroundings(unsigned int probe, std::vector<std::pair<Node*, glm::mat4>>& surroundings);
+		void _startProbeUpdate(unsigned int probe, std::vector<Node*>& renderables);
+		void _finishProbeUpdate();
+		void _cancelProbeUpdate();
+
+		//irradiance volume functions
+		void _createIrradianceVolume(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents, unsigned long long sceneHash);
+		void _updateIrradianceVolume(std::vector<Node*>& renderables, Node* directionalLight, Texture* skybox);
+		void _captureVolumeProbe(unsigned int probe, std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents, LightComponent* dirLight, Texture* skybox, std::vector<float>& faces);
+
+		static glm::mat4 _GetFaceView(glm::vec3 position, unsigned int face);
+		static unsigned long long _HashLighting(LightComponent* dirLight, Texture* skybox);
+		static unsigned long long _HashFile(std::string path, unsigned long long hash);
+		Texture* _createProbeArray(unsigned int internalFormat, unsigned int size, unsigned int levels, unsigned int minFilter, unsigned int magFilter);
+		void _copyToProbeArray(Texture* cubemap, Texture* probeArray, unsigned int probe, unsigned int size, unsigned int levels);
 
 		//render functions
-		void _renderShadowMaps(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents, std::vector<glm::vec3>& pointLights, glm::mat4& lightSpaceMatrix);
-		void _renderDepth(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents);
+		void _renderShadowMaps(std::vector<glm::vec3>& pointLights, glm::mat4& lightSpaceMatrix, bool dirShadows);
+		void _renderDepth(std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents, glm::mat4& viewProjection, glm::mat4& previousViewProjection);
 		void _renderGeometry(std::vector<std::pair<RenderComponent*, glm::mat4>>& solidRenderComponents, bool pbr);
 		void _renderSSAO();
 		void _renderSSAOBlur();
@@ -167,8 +276,14 @@ class Renderer {
 		void _renderPostProcessingQuad();
 
 		//helper functions
+		void _getRenderComponents(std::vector<Node*>& nodes, std::vector<std::pair<RenderComponent*, glm::mat4>>& renderComponents);
 		void _getSortedRenderComponents(std::vector<Node*>& renderables, glm::vec3& cameraPos, std::vector<std::pair<RenderComponent*, glm::mat4>>& solidRenderables, std::vector<std::pair<RenderComponent*, glm::mat4>>& blendRenderables);
-		std::vector<glm::vec3> _getClosestPointLights(glm::vec3 cameraPos, std::vector<std::pair<LightComponent*, glm::vec3>>& lightComponents);
+		std::vector<glm::vec3> _getClosestPointLights(glm::vec3 cameraPos);
+
+		void _updateLods(std::vector<Node*>& renderables, glm::vec3& cameraPos, float projectionScale);
+		unsigned int _selectLod(Model* model, glm::mat4& modelMatrix, glm::vec3& viewPos, float projectionScale, unsigned int currentLod);
+		void _updateTextureDemand(std::vector<Node*>& visibleRenderables, glm::vec3& cameraPos, float projectionScale, float nearPlane);
+		unsigned int _getShadowLod(RenderComponent* renderComponent);
 
 		void _fillUniformBuffers(glm::mat4& viewMatrix, glm::mat4& projectionMatrix, glm::mat4& previousViewProjection, glm::mat4& lightSpaceMatrix, glm::vec3& cameraPos, glm::vec3& directionalLightPos, bool dirShadows, std::vector<glm::vec3>& pointLightPositions);
 		void _fillShaderStorageBuffers(std::vector<std::pair<LightComponent*, glm::vec3>>& lightComponents);
@@ -179,6 +294,8 @@ class Renderer {
 		void _blitGDepthToHDR(bool pbr);
 
 		void _updateDimensions();
+		void _updateRenderTargets();
+		void _addRenderTargetInfo(std::vector<RenderTargetInfo>& infos, std::string name, std::vector<Texture*> textures, std::vector<Renderbuffer*> renderbuffers);
 		void _applyCullMode();
 };
 
@@ -4,4 +4,8 @@ Scene::Scene() {
 }
 
 Scene::~Scene() {
+}
+
+unsigned int Scene::getVersion() {
+	return 0;
 }
\ No newline at end of file
@@ -7,9 +7,10 @@ class SceneManager;
 class Scene {
 	public:
 		Scene();
-		~Scene();
+		virtual ~Scene();
 
 		virtual void initializeScene(World* world, SceneManager* manager) = 0;
+		virtual unsigned int getVersion(); //content version of a scene built in code, 0 if it has none
 };
 
 #endif
\ No newline at end of file
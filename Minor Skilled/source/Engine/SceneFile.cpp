@@ -0,0 +1,638 @@
+#include "SceneFile.h"
+
+#include <iostream>
+#include <fstream>
+#include <unordered_map>
+#include <cstring>
+#include <cstdio>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../Engine/World.h"
+#include "../Engine/Node.h"
+#include "../Engine/Transform.h"
+#include "../Engine/SceneManager.h"
+#include "../Engine/AssetManager.h"
+#include "../Engine/Model.h"
+#include "../Engine/Texture.h"
+#include "../Engine/Material.h"
+#include "../Engine/Window.h"
+#include "../Engine/JobSystem.h"
+
+#include "../Components/CameraComponent.h"
+#include "../Components/LightComponent.h"
+#include "../Components/RenderComponent.h"
+
+#include "../Materials/ColorMaterial.h"
+#include "../Materials/TextureMaterial.h"
+#include "../Materials/PBRMaterial.h"
+
+#include "../Utility/Filepath.h"
+#include "../Utility/MappedFile.h"
+#include "../Utility/ComponentType.h"
+
+const char SceneFile::_Magic[4] = { 'G', 'X', 'S', 'N' };
+const unsigned int SceneFile::_Version = 3; //increase whenever the layout of the file changes
+const unsigned int SceneFile::_None = 0xffffffff;
+
+bool SceneFile::Load(std::string path, World* world, SceneManager* manager, unsigned long long sourceVersion) {
+	MappedFile file(path);
+	if(!file.isOpen() || file.getSize() < sizeof(Header)) return false;
+
+	const unsigned char* data = file.getData();
+	const Header* header = (const Header*)data;
+	unsigned long long size = file.getSize();
+
+	if(std::memcmp(header->magic, _Magic, sizeof(_Magic)) != 0 || header->version != _Version) {
+		std::cout << "ERROR: " + path + " is not a supported scene file" << std::endl;
+		return false;
+	}
+
+	if(sourceVersion != 0 && header->sourceVersion != 0 && header->sourceVersion != sourceVersion) {
+		std::cout << "WARNING: " + path + " was generated from an older version of its scene" << std::endl;
+		return false;
+	}
+
+	//make sure every table is inside of the file and every index is in range before anything is created
+	bool valid = _IsInside(header->nodeOffset, header->nodeCount, sizeof(NodeRecord), size) &&
+		_IsInside(header->transformOffset, (unsigned long long)header->nodeCount * TransformArrayCount, 3 * sizeof(float), size) &&
+		_IsInside(header->cameraOffset, header->cameraCount, sizeof(CameraRecord), size) &&
+		_IsInside(header->lightOffset, header->lightCount, sizeof(LightRecord), size) &&
+		_IsInside(header->renderOffset, header->renderCount, sizeof(RenderRecord), size) &&
+		_IsInside(header->materialOffset, header->materialCount, sizeof(MaterialRecord), size) &&
+		_IsInside(header->modelOffset, header->modelCount, sizeof(StringRef), size) &&
+		_IsInside(header->textureOffset, header->textureCount, sizeof(TextureRecord), size) &&
+		_IsInside(header->skyboxOffset, header->skyboxCount, sizeof(StringRef), size) &&
+		_IsInside(header->probeOffset, header->probeCount, sizeof(ProbeRecord), size) &&
+		_IsInside(header->stringOffset, header->stringSize, 1, size);
+
+	const NodeRecord* nodeRecords = (const NodeRecord*)(data + header->nodeOffset);
+	const CameraRecord* cameraRecords = (const CameraRecord*)(data + header->cameraOffset);
+	const LightRecord* lightRecords = (const LightRecord*)(data + header->lightOffset);
+	const RenderRecord* renderRecords = (const RenderRecord*)(data + header->renderOffset);
+	const MaterialRecord* materialRecords = (const MaterialRecord*)(data + header->materialOffset);
+	const StringRef* modelRecords = (const StringRef*)(data + header->modelOffset);
+	const TextureRecord* textureRecords = (const TextureRecord*)(data + header->textureOffset);
+	const StringRef* skyboxRecords = (const StringRef*)(data + header->skyboxOffset);
+	const ProbeRecord* probeRecords = (const ProbeRecord*)(data + header->probeOffset);
+	const char* strings = (const char*)(data + header->stringOffset);
+	const float* transforms = (const float*)(data + header->transformOffset);
+
+	unsigned int nodeCount = header->nodeCount;
+
+	auto isString = [header](StringRef reference) {
+		return (unsigned long long)reference.offset + reference.length <= header->stringSize;
+	};
+
+	for(unsigned int i = 0; valid && i < nodeCount; i++) {
+		valid = (nodeRecords[i].parent == _None || nodeRecords[i].parent < i) && isString(nodeRecords[i].name);
+	}
+
+	for(unsigned int i = 0; valid && i < header->cameraCount; i++) {
+		valid = cameraRecords[i].node < nodeCount;
+	}
+
+	for(unsigned int i = 0; valid && i < header->lightCount; i++) {
+		valid = lightRecords[i].node < nodeCount && lightRecords[i].lightType <= LightType::Spot;
+	}
+
+	for(unsigned int i = 0; valid && i < header->renderCount; i++) {
+		valid = renderRecords[i].node < nodeCount && renderRecords[i].model < header->modelCount && renderRecords[i].material < header->materialCount;
+	}
+
+	for(unsigned int i = 0; valid && i < header->materialCount; i++) {
+		valid = materialRecords[i].materialType <= MaterialType::PBR && materialRecords[i].blendMode <= BlendMode::Transparent;
+
+		for(unsigned int j = 0; valid && j < _MaxTextures; j++) {
+			valid = materialRecords[i].textures[j] == _None || materialRecords[i].textures[j] < header->textureCount;
+		}
+	}
+
+	for(unsigned int i = 0; valid && i < header->modelCount; i++) {
+		valid = isString(modelRecords[i]);
+	}
+
+	for(unsigned int i = 0; valid && i < header->textureCount; i++) {
+		valid = isString(textureRecords[i].path) && textureRecords[i].filter <= TextureFilter::ClampToEdge;
+	}
+
+	for(unsigned int i = 0; valid && i < header->skyboxCount; i++) {
+		valid = isString(skyboxRecords[i]);
+	}
+
+	valid = valid && (header->mainCamera == _None || header->mainCamera < nodeCount);
+	valid = valid && (header->directionalLight == _None || header->directionalLight < nodeCount);
+	valid = valid && (header->skyboxCount == 0 || header->skyboxCount == 1 || header->skyboxCount == 6);
+
+	if(!valid) {
+		std::cout << "ERROR: The scene file " + path + " is corrupted" << std::endl;
+		return false;
+	}
+
+	//request the assets first, the textures are decoded on the workers while the nodes are created
+	std::vector<Model*> models(header->modelCount);
+	std::vector<Texture*> textures(header->textureCount);
+
+	for(unsigned int i = 0; i < header->modelCount; i++) {
+		models[i] = AssetManager::LoadModel(_GetString(strings, modelRecords[i]));
+	}
+
+	for(unsigned int i = 0; i < header->textureCount; i++) {
+		textures[i] = AssetManager::LoadTexture(_GetString(strings, textureRecords[i].path), (TextureFilter)textureRecords[i].filter, textureRecords[i].sRGB != 0);
+	}
+
+	//nodes and transforms do not touch any shared state, so they are created in parallel straight from the mapped arrays
+	std::vector<Node*> nodes(nodeCount);
+
+	auto getVector = [transforms, nodeCount](TransformArray array, unsigned int index) {
+		const float* vector = transforms + ((unsigned long long)array * nodeCount + index) * 3;
+		return glm::vec3(vector[0], vector[1], vector[2]);
+	};
+
+	JobSystem::ParallelFor(nodeCount, 1024, [&](unsigned int start, unsigned int end) {
+		for(unsigned int i = start; i < end; i++) {
+			Node* node = new Node(glm::vec3(0.0f), _GetString(strings, nodeRecords[i].name));
+			Transform* transform = node->getTransform();
+
+			transform->localTransform = glm::mat4(glm::vec4(getVector(AxisX, i), 0.0f), glm::vec4(getVector(AxisY, i), 0.0f), glm::vec4(getVector(AxisZ, i), 0.0f), glm::vec4(getVector(Position, i), 1.0f));
+
+			glm::vec3 euler = getVector(Euler, i);
+			transform->_pitch = euler.x;
+			transform->_yaw = euler.y;
+			transform->_roll = euler.z;
+
+			nodes[i] = node;
+		}
+	});
+
+	//components
+	for(unsigned int i = 0; i < header->cameraCount; i++) {
+		const CameraRecord& record = cameraRecords[i];
+		glm::mat4 projection = glm::perspective(glm::radians(record.fieldOfView), (float)Window::ScreenWidth / (float)Window::ScreenHeight, record.nearPlane, record.farPlane);
+
+		nodes[record.node]->addComponent(new CameraComponent(projection, record.fieldOfView, record.nearPlane, record.farPlane, record.movementSpeed, record.rotationSpeed));
+	}
+
+	for(unsigned int i = 0; i < header->lightCount; i++) {
+		const LightRecord& record = lightRecords[i];
+		LightComponent* lightComponent = new LightComponent((LightType)record.lightType);
+
+		lightComponent->lightDirection = glm::vec3(record.direction[0], record.direction[1], record.direction[2]);
+		lightComponent->lightAmbient = glm::vec3(record.ambient[0], record.ambient[1], record.ambient[2]);
+		lightComponent->lightDiffuse = glm::vec3(record.diffuse[0], record.diffuse[1], record.diffuse[2]);
+		lightComponent->lightSpecular = glm::vec3(record.specular[0], record.specular[1], record.specular[2]);
+		lightComponent->constantAttenuation = record.attenuation[0];
+		lightComponent->linearAttenuation = record.attenuation[1];
+		lightComponent->quadraticAttenuation = record.attenuation[2];
+		lightComponent->innerCutoff = record.innerCutoff;
+		lightComponent->outerCutoff = record.outerCutoff;
+
+		nodes[record.node]->addComponent(lightComponent);
+	}
+
+	for(unsigned int i = 0; i < header->renderCount; i++) {
+		const RenderRecord& record = renderRecords[i];
+		if(models[record.model] == nullptr) continue; //the model failed to load
+
+		//render components own their material, so every component gets its own instance of the shared record
+		nodes[record.node]->addComponent(new RenderComponent(models[record.model], _CreateMaterial(materialRecords[record.material], textures)));
+	}
+
+	//link the hierarchy in file order, which keeps the child order of the exported scene
+	for(unsigned int i = 0; i < nodeCount; i++) {
+		if(nodeRecords[i].parent == _None) world->addChild(nodes[i]);
+		else nodes[nodeRecords[i].parent]->addChild(nodes[i]);
+	}
+
+	if(header->mainCamera != _None) manager->setMainCamera(nodes[header->mainCamera]);
+	if(header->directionalLight != _None) manager->setDirectionalLight(nodes[header->directionalLight]);
+
+	if(header->skyboxCount == 1) {
+		manager->setSkybox(_GetString(strings, skyboxRecords[0]));
+	} else if(header->skyboxCount == 6) {
+		std::vector<std::string> faces;
+
+		for(unsigned int i = 0; i < 6; i++) {
+			faces.push_back(_GetString(strings, skyboxRecords[i]));
+		}
+
+		manager->setSkybox(faces);
+	}
+
+	for(unsigned int i = 0; i < header->probeCount; i++) {
+		const ProbeRecord& record = probeRecords[i];
+
+		glm::vec3 position = glm::vec3(record.position[0], record.position[1], record.position[2]);
+		glm::vec3 extents = glm::vec3(record.extents[0], record.extents[1], record.extents[2]);
+
+		manager->addReflectionProbe(position, extents, record.boxProjection != 0);
+	}
+
+	return true;
+}
+
+bool SceneFile::Write(std::string path, World* world, SceneManager* manager, unsigned long long sourceVersion) {
+	//flatten the hierarchy depth first, so every parent ends up in front of its children
+	std::vector<Node*> nodes;
+	std::vector<NodeRecord> nodeRecords;
+	std::unordered_map<Node*, unsigned int> nodeIndices;
+
+	std::vector<std::pair<Node*, unsigned int>> stack;
+
+	for(unsigned int i = world->getChildCount(); i > 0; i--) {
+		stack.push_back(std::make_pair(world->getChildAt(i - 1), _None));
+	}
+
+	std::string strings;
+
+	auto addString = [&strings](const std::string& value) {
+		StringRef reference;
+		reference.offset = strings.size();
+		reference.length = value.size();
+
+		strings += value;
+
+		return reference;
+	};
+
+	while(!stack.empty()) {
+		Node* node = stack.back().first;
+		unsigned int parent = stack.back().second;
+		stack.pop_back();
+
+		unsigned int index = nodes.size();
+		nodeIndices[node] = index;
+		nodes.push_back(node);
+
+		NodeRecord record;
+		record.parent = parent;
+		record.name = addString(node->getName());
+		nodeRecords.push_back(record);
+
+		for(unsigned int i = node->getChildCount(); i > 0; i--) {
+			stack.push_back(std::make_pair(node->getChildAt(i - 1), index));
+		}
+	}
+
+	//transforms as one array per component
+	unsigned int nodeCount = nodes.size();
+	std::vector<float> transforms((unsigned long long)nodeCount * TransformArrayCount * 3);
+
+	auto setVector = [&transforms, nodeCount](TransformArray array, unsigned int index, glm::vec3 vector) {
+		float* destination = &transforms[((unsigned long long)array * nodeCount + index) * 3];
+
+		destination[0] = vector.x;
+		destination[1] = vector.y;
+		destination[2] = vector.z;
+	};
+
+	//assets are referenced by their index in the model and texture tables
+	std::vector<StringRef> modelRecords;
+	std::vector<TextureRecord> textureRecords;
+	std::unordered_map<Model*, unsigned int> modelIndices;
+	std::unordered_map<Texture*, unsigned int> textureIndices;
+
+	auto getTextureIndex = [&](Texture* texture) {
+		if(texture == nullptr || texture->filepath.empty()) return _None;
+
+		auto it = textureIndices.find(texture);
+		if(it != textureIndices.end()) return it->second;
+
+		TextureRecord record;
+		record.path = addString(texture->filepath);
+
+		TextureFilter filter = TextureFilter::Repeat;
+		bool sRGB = false;
+
+		if(!AssetManager::GetTextureOptions(texture, filter, sRGB)) {
+			std::cout << "WARNING: " + texture->filepath + " was not loaded through the asset manager, it is exported with the default options" << std::endl;
+		}
+
+		record.filter = filter;
+		record.sRGB = sRGB ? 1 : 0;
+
+		unsigned int index = textureRecords.size();
+		textureIndices[texture] = index;
+		textureRecords.push_back(record);
+
+		return index;
+	};
+
+	std::vector<MaterialRecord> materialRecords;
+	std::unordered_map<Material*, unsigned int> materialIndices;
+
+	auto getMaterialIndex = [&](Material* material) {
+		auto it = materialIndices.find(material);
+		if(it != materialIndices.end()) return it->second;
+
+		MaterialRecord record;
+		std::memset(&record, 0, sizeof(MaterialRecord));
+
+		record.materialType = material->getMaterialType();
+		record.blendMode = material->getBlendMode();
+		record.castsShadows = material->getCastsShadows() ? 1 : 0;
+
+		for(unsigned int i = 0; i < _MaxTextures; i++) {
+			record.textures[i] = _None;
+		}
+
+		if(record.materialType == MaterialType::Color) {
+			ColorMaterial* colorMaterial = (ColorMaterial*)material;
+
+			glm::vec3 ambient = colorMaterial->getAmbientColor();
+			glm::vec3 diffuse = colorMaterial->getDiffuseColor();
+
+			float values[_MaxValues] = { ambient.x, ambient.y, ambient.z, diffuse.x, diffuse.y, diffuse.z, colorMaterial->getSpecular(), colorMaterial->getShininess() };
+			std::memcpy(record.values, values, sizeof(values));
+		} else if(record.materialType == MaterialType::Textures) {
+			TextureMaterial* textureMaterial = (TextureMaterial*)material;
+
+			Texture* maps[] = { textureMaterial->getDiffuseMap(), textureMaterial->getSpecularMap(), textureMaterial->getNormalMap(), textureMaterial->getEmissionMap(), textureMaterial->getHeightMap(), textureMaterial->getReflectionMap() };
+
+			for(unsigned int i = 0; i < 6; i++) {
+				record.textures[i] = getTextureIndex(maps[i]);
+			}
+
+			record.values[0] = textureMaterial->getShininess();
+			record.values[1] = textureMaterial->getRefractionFactor();
+			record.values[2] = textureMaterial->getHeightScale();
+			record.flipNormals = textureMaterial->getFlipNormals() ? 1 : 0;
+		} else {
+			PBRMaterial* pbrMaterial = (PBRMaterial*)material;
+
+			Texture* maps[] = { pbrMaterial->getAlbedoMap(), pbrMaterial->getNormalMap(), pbrMaterial->getMetallicMap(), pbrMaterial->getRoughnessMap(), pbrMaterial->getAoMap(), pbrMaterial->getEmissionMap(), pbrMaterial->getHeightMap() };
+
+			for(unsigned int i = 0; i < 7; i++) {
+				record.textures[i] = getTextureIndex(maps[i]);
+			}
+
+			glm::vec3 F0 = pbrMaterial->getF0();
+
+			record.values[0] = F0.x;
+			record.values[1] = F0.y;
+			record.values[2] = F0.z;
+			record.values[3] = pbrMaterial->getRefractionFactor();
+			record.values[4] = pbrMaterial->getHeightScale();
+			record.flipNormals = pbrMaterial->getFlipNormals() ? 1 : 0;
+		}
+
+		unsigned int index = materialRecords.size();
+		materialIndices[material] = index;
+		materialRecords.push_back(record);
+
+		return index;
+	};
+
+	//component records
+	std::vector<CameraRecord> cameraRecords;
+	std::vector<LightRecord> lightRecords;
+	std::vector<RenderRecord> renderRecords;
+
+	for(unsigned int i = 0; i < nodeCount; i++) {
+		Node* node = nodes[i];
+		Transform* transform = node->getTransform();
+
+		setVector(AxisX, i, glm::vec3(transform->localTransform[0]));
+		setVector(AxisY, i, glm::vec3(transform->localTransform[1]));
+		setVector(AxisZ, i, glm::vec3(transform->localTransform[2]));
+		setVector(Position, i, glm::vec3(transform->localTransform[3]));
+		setVector(Euler, i, transform->getLocalEuler());
+
+		if(node->hasComponent(ComponentType::Camera)) {
+			CameraComponent* cameraComponent = (CameraComponent*)node->getComponent(ComponentType::Camera);
+
+			CameraRecord record;
+			record.node = i;
+			record.fieldOfView = cameraComponent->fieldOfView;
+			record.nearPlane = cameraComponent->getNearPlane();
+			record.farPlane = cameraComponent->getFarPlane();
+			record.movementSpeed = cameraComponent->movementSpeed;
+			record.rotationSpeed = cameraComponent->rotationSpeed;
+
+			cameraRecords.push_back(record);
+		}
+
+		if(node->hasComponent(ComponentType::Light)) {
+			LightComponent* lightComponent = (LightComponent*)node->getComponent(ComponentType::Light);
+
+			LightRecord record;
+			record.node = i;
+			record.lightType = lightComponent->lightType;
+
+			for(unsigned int j = 0; j < 3; j++) {
+				record.direction[j] = lightComponent->lightDirection[j];
+				record.ambient[j] = lightComponent->lightAmbient[j];
+				record.diffuse[j] = lightComponent->lightDiffuse[j];
+				record.specular[j] = lightComponent->lightSpecular[j];
+			}
+
+			record.attenuation[0] = lightComponent->constantAttenuation;
+			record.attenuation[1] = lightComponent->linearAttenuation;
+			record.attenuation[2] = lightComponent->quadraticAttenuation;
+			record.innerCutoff = lightComponent->innerCutoff;
+			record.outerCutoff = lightComponent->outerCutoff;
+
+			lightRecords.push_back(record);
+		}
+
+		if(node->hasComponent(ComponentType::Render)) {
+			RenderComponent* renderComponent = (RenderComponent*)node->getComponent(ComponentType::Render);
+			Model* model = renderComponent->model;
+
+			if(model->filepath.empty()) {
+				std::cout << "WARNING: The model of " + node->getName() + " was not loaded from a file, it is not exported" << std::endl;
+				continue;
+			}
+
+			auto it = modelIndices.find(model);
+
+			if(it == modelIndices.end()) {
+				it = modelIndices.insert(std::make_pair(model, (unsigned int)modelRecords.size())).first;
+				modelRecords.push_back(addString(model->filepath));
+			}
+
+			RenderRecord record;
+			record.node = i;
+			record.model = it->second;
+			record.material = getMaterialIndex(renderComponent->material);
+
+			renderRecords.push_back(record);
+		}
+	}
+
+	std::vector<StringRef> skyboxRecords;
+	std::vector<std::string>& skyboxSources = manager->getSkyboxSources();
+
+	for(unsigned int i = 0; i < skyboxSources.size(); i++) {
+		skyboxRecords.push_back(addString(skyboxSources[i]));
+	}
+
+	std::vector<ProbeRecord> probeRecords;
+	std::vector<ReflectionProbe>& probes = manager->getReflectionProbes();
+
+	for(unsigned int i = 0; i < probes.size(); i++) {
+		ProbeRecord record;
+
+		for(unsigned int j = 0; j < 3; j++) {
+			record.position[j] = probes[i].position[j];
+			record.extents[j] = probes[i].extents[j];
+		}
+
+		record.boxProjection = probes[i].boxProjection;
+
+		probeRecords.push_back(record);
+	}
+
+	//header and table layout
+	Header header;
+	std::memset(&header, 0, sizeof(Header));
+
+	std::memcpy(header.magic, _Magic, sizeof(_Magic));
+	header.version = _Version;
+	header.sourceVersion = sourceVersion;
+
+	header.nodeCount = nodeCount;
+	header.cameraCount = cameraRecords.size();
+	header.lightCount = lightRecords.size();
+	header.renderCount = renderRecords.size();
+	header.materialCount = materialRecords.size();
+	header.modelCount = modelRecords.size();
+	header.textureCount = textureRecords.size();
+	header.skyboxCount = skyboxRecords.size();
+	header.probeCount = probeRecords.size();
+
+	auto findNode = [&nodeIndices](Node* node) {
+		auto it = nodeIndices.find(node);
+		return (it != nodeIndices.end()) ? it->second : _None;
+	};
+
+	header.mainCamera = findNode(manager->getMainCamera());
+	header.directionalLight = findNode(manager->getDirectionalLight());
+
+	unsigned long long offset = _Align(sizeof(Header));
+
+	header.nodeOffset = offset;
+	offset = _Align(offset + nodeRecords.size() * sizeof(NodeRecord));
+	header.transformOffset = offset;
+	offset = _Align(offset + transforms.size() * sizeof(float));
+	header.cameraOffset = offset;
+	offset = _Align(offset + cameraRecords.size() * sizeof(CameraRecord));
+	header.lightOffset = offset;
+	offset = _Align(offset + lightRecords.size() * sizeof(LightRecord));
+	header.renderOffset = offset;
+	offset = _Align(offset + renderRecords.size() * sizeof(RenderRecord));
+	header.materialOffset = offset;
+	offset = _Align(offset + materialRecords.size() * sizeof(MaterialRecord));
+	header.modelOffset = offset;
+	offset = _Align(offset + modelRecords.size() * sizeof(StringRef));
+	header.textureOffset = offset;
+	offset = _Align(offset + textureRecords.size() * sizeof(TextureRecord));
+	header.skyboxOffset = offset;
+	offset = _Align(offset + skyboxRecords.size() * sizeof(StringRef));
+	header.probeOffset = offset;
+	offset = _Align(offset + probeRecords.size() * sizeof(ProbeRecord));
+	header.stringOffset = offset;
+	header.stringSize = strings.size();
+
+	//write into a temporary file first, so an interrupted write never leaves a broken scene behind
+	size_t separator = path.find_last_of("/\\");
+	if(separator != std::string::npos) Filepath::MakeDirectory(path.substr(0, separator));
+
+	std::string tempPath = path + ".tmp";
+	std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+
+	if(!file.is_open()) {
+		std::cout << "ERROR: Unable to write the scene file " + path << std::endl;
+		return false;
+	}
+
+	const char padding[16] = { 0 };
+	unsigned long long position = 0;
+
+	auto writeTable = [&](unsigned long long tableOffset, const void* table, unsigned long long tableSize) {
+		file.write(padding, tableOffset - position);
+		if(tableSize > 0) file.write((const char*)table, tableSize);
+
+		position = tableOffset + tableSize;
+	};
+
+	writeTable(0, &header, sizeof(Header));
+	writeTable(header.nodeOffset, nodeRecords.data(), nodeRecords.size() * sizeof(NodeRecord));
+	writeTable(header.transformOffset, transforms.data(), transforms.size() * sizeof(float));
+	writeTable(header.cameraOffset, cameraRecords.data(), cameraRecords.size() * sizeof(CameraRecord));
+	writeTable(header.lightOffset, lightRecords.data(), lightRecords.size() * sizeof(LightRecord));
+	writeTable(header.renderOffset, renderRecords.data(), renderRecords.size() * sizeof(RenderRecord));
+	writeTable(header.materialOffset, materialRecords.data(), materialRecords.size() * sizeof(MaterialRecord));
+	writeTable(header.modelOffset, modelRecords.data(), modelRecords.size() * sizeof(StringRef));
+	writeTable(header.textureOffset, textureRecords.data(), textureRecords.size() * sizeof(TextureRecord));
+	writeTable(header.skyboxOffset, skyboxRecords.data(), skyboxRecords.size() * sizeof(StringRef));
+	writeTable(header.probeOffset, probeRecords.data(), probeRecords.size() * sizeof(ProbeRecord));
+	writeTable(header.stringOffset, strings.data(), strings.size());
+
+	file.close();
+
+	if(file.fail()) {
+		std::cout << "ERROR: Unable to write the scene file " + path << std::endl;
+		std::remove(tempPath.c_str());
+		return false;
+	}
+
+	std::remove(path.c_str());
+	std::rename(tempPath.c_str(), path.c_str());
+
+	return true;
+}
+
+Material* SceneFile::_CreateMaterial(const MaterialRecord& record, std::vector<Texture*>& textures) {
+	Texture* maps[_MaxTextures];
+
+	for(unsigned int i = 0; i < _MaxTextures; i++) {
+		maps[i] = (record.textures[i] != _None) ? textures[record.textures[i]] : nullptr;
+	}
+
+	const float* values = record.values;
+	Material* material;
+
+	if(record.materialType == MaterialType::Color) {
+		material = new ColorMaterial(glm::vec3(values[0], values[1], values[2]), glm::vec3(values[3], values[4], values[5]), values[6], values[7], record.castsShadows != 0);
+	} else if(record.materialType == MaterialType::Textures) {
+		TextureMaterial* textureMaterial = new TextureMaterial(maps[0], maps[1], maps[2], (BlendMode)record.blendMode);
+		textureMaterial->setEmissionMap(maps[3]);
+		textureMaterial->setHeightMap(maps[4]);
+		textureMaterial->setReflectionMap(maps[5]);
+		textureMaterial->setShininess(values[0]);
+		textureMaterial->setRefractionFactor(values[1]);
+		textureMaterial->setHeightScale(values[2]);
+		textureMaterial->setFlipNormals(record.flipNormals != 0);
+
+		material = textureMaterial;
+	} else {
+		PBRMaterial* pbrMaterial = new PBRMaterial(maps[0], maps[1], maps[2], maps[3], maps[4], (BlendMode)record.blendMode);
+		pbrMaterial->setEmissionMap(maps[5]);
+		pbrMaterial->setHeightMap(maps[6]);
+		pbrMaterial->setF0(glm::vec3(values[0], values[1], values[2]));
+		pbrMaterial->setRefractionFactor(values[3]);
+		pbrMaterial->setHeightScale(values[4]);
+		pbrMaterial->setFlipNormals(record.flipNormals != 0);
+
+		material = pbrMaterial;
+	}
+
+	material->setBlendMode((BlendMode)record.blendMode);
+	material->setCastsShadows(record.castsShadows != 0);
+
+	return material;
+}
+
+std::string SceneFile::_GetString(const char* strings, StringRef reference) {
+	return std::string(strings + reference.offset, reference.length);
+}
+
+bool SceneFile::_IsInside(unsigned long long offset, unsigned long long count, unsigned long long stride, unsigned long long size) {
+	return offset <= size && count * stride <= size - offset;
+}
+
+unsigned long long SceneFile::_Align(unsigned long long offset) {
+	return (offset + 15) & ~15ull;
+}
\ No newline at end of file
@@ -0,0 +1,135 @@
+#ifndef SCENEFILE_H
+#define SCENEFILE_H
+
+#include <string>
+#include <vector>
+
+class World;
+class SceneManager;
+class Material;
+class Texture;
+
+//binary scene description, the file is mapped and its tables are instantiated in bulk into the scene graph
+class SceneFile {
+	public:
+		//sourceVersion is the version of the scene the file is generated from, files of another version are rejected, 0 skips the check
+		static bool Load(std::string path, World* world, SceneManager* manager, unsigned long long sourceVersion = 0);
+		static bool Write(std::string path, World* world, SceneManager* manager, unsigned long long sourceVersion = 0); //serializes everything currently in the world
+
+	private:
+		static const char _Magic[4];
+		static const unsigned int _Version;
+		static const unsigned int _None; //unused index
+		static const unsigned int _MaxTextures = 7;
+		static const unsigned int _MaxValues = 8;
+
+		struct StringRef {
+			unsigned int offset; //into the string table
+			unsigned int length;
+		};
+
+		struct Header {
+			char magic[4];
+			unsigned int version;
+			unsigned long long sourceVersion; //0 for files exported by hand, those are never replaced
+
+			unsigned int nodeCount;
+			unsigned int cameraCount;
+			unsigned int lightCount;
+			unsigned int renderCount;
+			unsigned int materialCount;
+			unsigned int modelCount;
+			unsigned int textureCount;
+			unsigned int skyboxCount; //one equirectangular image or six cubemap faces
+			unsigned int probeCount;
+
+			unsigned int mainCamera; //node indices
+			unsigned int directionalLight;
+
+			unsigned long long nodeOffset;
+			unsigned long long transformOffset;
+			unsigned long long cameraOffset;
+			unsigned long long lightOffset;
+			unsigned long long renderOffset;
+			unsigned long long materialOffset;
+			unsigned long long modelOffset;
+			unsigned long long textureOffset;
+			unsigned long long skyboxOffset;
+			unsigned long long probeOffset;
+			unsigned long long stringOffset;
+			unsigned long long stringSize;
+		};
+
+		//parents always come before their children
+		struct NodeRecord {
+			unsigned int parent;
+			StringRef name;
+		};
+
+		//the transforms are stored as separate arrays of three floats with one entry per node, in this order
+		enum TransformArray {
+			AxisX,
+			AxisY,
+			AxisZ,
+			Position,
+			Euler, //degrees, shown in the ui
+			TransformArrayCount
+		};
+
+		struct CameraRecord {
+			unsigned int node;
+			float fieldOfView;
+			float nearPlane;
+			float farPlane;
+			float movementSpeed;
+			float rotationSpeed;
+		};
+
+		struct LightRecord {
+			unsigned int node;
+			unsigned int lightType;
+			float direction[3];
+			float ambient[3];
+			float diffuse[3];
+			float specular[3];
+			float attenuation[3]; //constant, linear, quadratic
+			float innerCutoff;
+			float outerCutoff;
+		};
+
+		struct RenderRecord {
+			unsigned int node;
+			unsigned int model;
+			unsigned int material;
+		};
+
+		//texture slots and values in the order of the material constructors and setters
+		struct MaterialRecord {
+			unsigned int materialType;
+			unsigned int blendMode;
+			unsigned int castsShadows;
+			unsigned int flipNormals;
+			unsigned int textures[_MaxTextures];
+			float values[_MaxValues];
+		};
+
+		struct ProbeRecord {
+			float position[3];
+			float extents[3];
+			unsigned int boxProjection;
+		};
+
+		struct TextureRecord {
+			StringRef path;
+			unsigned int filter;
+			unsigned int sRGB;
+		};
+
+		static Material* _CreateMaterial(const MaterialRecord& record, std::vector<Texture*>& textures);
+		static std::string _GetString(const char* strings, StringRef reference);
+
+		static bool _IsInside(unsigned long long offset, unsigned long long count, unsigned long long stride, unsigned long long size);
+		static unsigned long long _Align(unsigned long long offset);
+};
+
+#endif
\ No newline at end of file
@@ -3,6 +3,11 @@
 #include <iostream>
 #include <string>
 #include <bitset>
+#include <chrono>
+#include <algorithm>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
 
 #define STB_IMAGE_IMPLEMENTATION //NOTE: has to be done once in the project BEFORE including std_image.h
 #include "../../dependencies/stb_image/stb_image.h"
@@ -13,24 +18,46 @@
 #include "../Engine/World.h"
 #include "../Engine/Renderer.h"
 #include "../Engine/Texture.h"
+#include "../Engine/Model.h"
+#include "../Engine/Material.h"
+#include "../Engine/Framebuffer.h"
 #include "../Engine/Debug.h"
+#include "../Engine/JobSystem.h"
+#include "../Engine/AssetManager.h"
+#include "../Engine/Uploader.h"
+#include "../Engine/TextureStreamer.h"
+#include "../Engine/EnvironmentCache.h"
+#include "../Engine/SceneFile.h"
 
 #include "../UI/OverlayUI.h"
 
 #include "../Components/LightComponent.h"
+#include "../Components/CameraComponent.h"
+#include "../Components/RenderComponent.h"
 
 #include "../Utility/Time.h"
 #include "../Utility/Input.h"
 #include "../Utility/ComponentType.h"
 #include "../Utility/LightType.h"
+#include "../Utility/RenderSettings.h"
 
-SceneManager::SceneManager(): _queuedSceneIndex(-1) {
+SceneManager::SceneManager(): _queuedSceneIndex(-1), _loadingScene(nullptr), _loadingSceneIndex(-1) {
 }
 
 SceneManager::~SceneManager() {
+	Uploader::Shutdown(); //finishes the uploads that are still in flight
+
 	delete _window;
 	delete _world;
 	delete _skybox;
+
+	if(_loadingScene != nullptr) {
+		delete _loadingScene->world;
+		delete _loadingScene->skybox;
+		delete _loadingScene;
+	}
+
+	AssetManager::Clear(); //assets which are still resident without a scene
 	delete _renderer;
 	delete _profiler;
 	delete _ui;
@@ -38,6 +65,8 @@ SceneManager::~SceneManager() {
 	for(unsigned int i = 0; i < _scenes.size(); i++) {
 		delete _scenes[i];
 	}
+
+	JobSystem::Shutdown();
 }
 
 void SceneManager::queueScene(int index) {
@@ -49,26 +78,83 @@ void SceneManager::addScene(Scene* scene) {
 }
 
 void SceneManager::setSkybox(Texture* skybox, bool isEquirectangular) {
-	if(skybox == nullptr) {
+	if(_loadingScene == nullptr) {
+		std::cout << "ERROR: Unable to assign skybox. No scene is being loaded." << std::endl;
+		return;
+	} else if(skybox == nullptr) {
 		std::cout << "ERROR: Unable to assign skybox. It was null." << std::endl;
 		return;
 	}
 
-	if(isEquirectangular) _skybox = _renderer->convertEquiToCube(skybox);
-	else _skybox = skybox;
+	if(isEquirectangular) _loadingScene->skybox = _renderer->convertEquiToCube(skybox);
+	else _loadingScene->skybox = skybox;
+
+	_loadingScene->skyboxSources.clear();
+}
+
+void SceneManager::setSkybox(std::string hdrPath) {
+	if(_loadingScene == nullptr) {
+		std::cout << "ERROR: Unable to assign skybox. No scene is being loaded." << std::endl;
+		return;
+	}
+
+	std::cout << "Loading skybox..." << std::endl;
+
+	//a cached cubemap skips both the hdr decode and the conversion
+	Texture* skybox = EnvironmentCache::Load(hdrPath, RenderSettings::SkyboxWidth);
+
+	if(skybox == nullptr) {
+		Texture* equirectangular = Texture::LoadHDR(hdrPath);
+
+		if(equirectangular == nullptr) {
+			std::cout << "ERROR: Unable to assign skybox. " + hdrPath + " failed to load." << std::endl;
+			return;
+		}
+
+		skybox = _renderer->convertEquiToCube(equirectangular);
+		EnvironmentCache::Write(hdrPath, skybox, RenderSettings::SkyboxWidth);
+	}
+
+	_loadingScene->skybox = skybox;
+	_loadingScene->skyboxSources.assign(1, hdrPath);
+}
+
+void SceneManager::setSkybox(std::vector<std::string>& faces) {
+	if(_loadingScene == nullptr) {
+		std::cout << "ERROR: Unable to assign skybox. No scene is being loaded." << std::endl;
+		return;
+	}
+
+	std::cout << "Loading skybox..." << std::endl;
+
+	Texture* skybox = Texture::LoadCubemap(faces, true); //load skyboxes in linear space
+
+	if(skybox == nullptr) {
+		std::cout << "ERROR: Unable to assign skybox. The cubemap failed to load." << std::endl;
+		return;
+	}
+
+	_loadingScene->skybox = skybox;
+	_loadingScene->skyboxSources = faces;
 }
 
 void SceneManager::setMainCamera(Node* mainCamera) {
-	if(!mainCamera->hasComponent(ComponentType::Camera)) {
+	if(_loadingScene == nullptr) {
+		std::cout << "ERROR: Unable to assign main camera. No scene is being loaded." << std::endl;
+		return;
+	} else if(!mainCamera->hasComponent(ComponentType::Camera)) {
 		std::cout << "ERROR: Unable to assign main camera. It has no camera component." << std::endl;
 		return;
 	}
 
-	_mainCamera = mainCamera;
+	_loadingScene->mainCamera = mainCamera;
 }
 
 void SceneManager::setDirectionalLight(Node * directionalLight) {
-	if(!directionalLight->hasComponent(ComponentType::Light)) {
+	if(_loadingScene == nullptr) {
+		std::cout << "ERROR: Unable to assign directional light. No scene is being loaded." << std::endl;
+		return;
+	} else if(!directionalLight->hasComponent(ComponentType::Light)) {
 		std::cout << "ERROR: Unable to assign directional light. It has no light component." << std::endl;
 		return;
 	} else if(((LightComponent*)directionalLight->getComponent(ComponentType::Light))->lightType != LightType::Directional) {
@@ -76,25 +162,86 @@ void SceneManager::setDirectionalLight(Node * directionalLight) {
 		return;
 	}
 
-	_directionalLight = directionalLight;
+	_loadingScene->directionalLight = directionalLight;
+}
+
+void SceneManager::addReflectionProbe(glm::vec3 position, glm::vec3 extents, bool boxProjection) {
+	if(_loadingScene == nullptr) {
+		std::cout << "ERROR: Unable to add reflection probe. No scene is being loaded." << std::endl;
+		return;
+	}
+
+	ReflectionProbe probe;
+	probe.position = position;
+	probe.extents = extents;
+	probe.boxProjection = boxProjection;
+
+	_loadingScene->reflectionProbes.push_back(probe);
+}
+
+bool SceneManager::isLoading() {
+	return _loadingScene != nullptr;
+}
+
+Node* SceneManager::getMainCamera() {
+	return _mainCamera;
+}
+
+Node* SceneManager::getDirectionalLight() {
+	return _directionalLight;
+}
+
+std::vector<std::string>& SceneManager::getSkyboxSources() {
+	return _skyboxSources;
+}
+
+std::vector<ReflectionProbe>& SceneManager::getReflectionProbes() {
+	return _reflectionProbes;
+}
+
+void SceneManager::exportScene(std::string path) {
+	if(SceneFile::Write(path, _world, this)) Debug::Log("Scene exported to " + path);
+}
+
+Node* SceneManager::pickNode(glm::vec2 screenPos) {
+	if(_mainCamera == nullptr) return nullptr;
+
+	CameraComponent* cameraComponent = (CameraComponent*)_mainCamera->getComponent(ComponentType::Camera);
+
+	//unproject the screen position onto the near and far plane to get a world space ray
+	glm::mat4 inverseViewProjection = glm::inverse(cameraComponent->getProjectionMatrix() * cameraComponent->getViewMatrix());
+	glm::vec2 ndc = glm::vec2(2.0f * screenPos.x / Window::ScreenWidth - 1.0f, 1.0f - 2.0f * screenPos.y / Window::ScreenHeight);
+
+	glm::vec4 nearPoint = inverseViewProjection * glm::vec4(ndc, -1.0f, 1.0f);
+	glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndc, 1.0f, 1.0f);
+
+	glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+	glm::vec3 ray = glm::vec3(farPoint) / farPoint.w - origin;
+
+	return _renderer->raycast(origin, glm::normalize(ray), glm::length(ray));
 }
 
 void SceneManager::initialize(unsigned int sceneIndex) {
 	std::cout << "---Initializing Engine---" << std::endl;
 
+	JobSystem::Initialize(); //worker threads shared by the scene update, culling, sorting and asset loading
+
 	_window = new Window(1920, 1017, 0, 27, "GraphX Engine v1.0");
+	Uploader::Initialize(); //needs the context of the window
 	_world = new World(); //scene graph
 	_profiler = new Debug();
 	_renderer = new Renderer(_profiler);
-	_ui = new OverlayUI(this, _window, _profiler);
+	_ui = new OverlayUI(this, _renderer, _window, _profiler);
 
 	_skybox = nullptr;
 	_mainCamera = nullptr;
 	_directionalLight = nullptr;
 
+	//the first scene loads while the render loop already runs and shows the ui
 	_queuedSceneIndex = sceneIndex;
 	_loadScene();
-	
+
+
 	std::cout << "---Engine initialized---" << std::endl;
 
 	//initialization info
@@ -121,7 +268,11 @@ void SceneManager::run() {
 		_window->swapBuffers();
 		_window->pollEvents();
 
-		if(_queuedSceneIndex != -1) _loadScene();
+		TextureStreamer::Update(); //picks the mip levels to stream from the requests of the last frame
+		Uploader::Update(); //streams in textures and meshes requested at runtime
+
+		if(_loadingScene != nullptr) _updateLoading();
+		else if(_queuedSceneIndex != -1) _loadScene();
 	}
 }
 
@@ -135,9 +286,11 @@ void SceneManager::_update() {
 	//update scene graph and pass in vectors to fill
 	_world->update(_renderables, _lights); 
 
-	//resets the last mouse pos back to the current mouse pos and updates keypresses
+	//refit the bounding volume hierarchies used for culling and spatial queries
+	_renderer->updateBoundingVolumes(_renderables, _lights);
+
+	//resets the last mouse pos back to the current mouse pos, the key presses are polled again in the next frame
 	Input::ResetMousePos(); 
-	Input::CheckInputStatus();
 
 	_profiler->endQuery(QueryType::Update);
 }
@@ -146,8 +299,13 @@ void SceneManager::_render() {
 	//start new imgui frame and setup the UI after the update is done
 	_ui->setupFrame(_world);
 
-	//render the scene
-	_renderer->render(_renderables, _lights, _mainCamera, _directionalLight, _skybox);
+	//render the scene, there is nothing to show yet while the first scene is loading
+	if(_mainCamera != nullptr) {
+		_renderer->render(_renderables, _lights, _mainCamera, _directionalLight, _skybox);
+	} else {
+		Framebuffer::Unbind();
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	}
 
 	//render the ui on top of the scene
 	_profiler->startQuery(QueryType::UI);
@@ -156,31 +314,89 @@ void SceneManager::_render() {
 }
 
 void SceneManager::_loadScene() {
-	//unload current scene objects and the skybox
-	_world->erase();
+	//the new scene is built next to the current one, which keeps rendering until everything is resident
+	std::cout << "Loading Scene " + std::to_string(_queuedSceneIndex + 1) + "..." << std::endl;
 
-	delete _skybox;
+	_loadStart = std::chrono::high_resolution_clock::now();
 
-	//set unused members to nullptr
-	_skybox = nullptr;
-	_mainCamera = nullptr;
-	_directionalLight = nullptr;
+	_loadingScene = new LoadingScene();
+	_loadingScene->world = new World();
+	_loadingScene->skybox = nullptr;
+	_loadingScene->mainCamera = nullptr;
+	_loadingScene->directionalLight = nullptr;
+
+	_loadingSceneIndex = _queuedSceneIndex;
+	_queuedSceneIndex = -1; //scenes queued from here on are loaded after this one
+
+	//the scene only queues its model imports, texture decodes and uploads
+	_scenes[_loadingSceneIndex]->initializeScene(_loadingScene->world, this);
+
+	for(unsigned int i = 0; i < _loadingScene->world->getChildCount(); i++) {
+		_collectLoadingAssets(_loadingScene->world->getChildAt(i));
+	}
+}
+
+void SceneManager::_collectLoadingAssets(Node* node) {
+	if(node->hasComponent(ComponentType::Render)) {
+		RenderComponent* renderComponent = (RenderComponent*)node->getComponent(ComponentType::Render);
+
+		if(renderComponent->model != nullptr) _loadingScene->models.push_back(renderComponent->model);
+		if(renderComponent->material != nullptr) renderComponent->material->getTextures(_loadingScene->textures);
+	}
+
+	for(unsigned int i = 0; i < node->getChildCount(); i++) {
+		_collectLoadingAssets(node->getChildAt(i));
+	}
+}
+
+void SceneManager::_updateLoading() {
+	//create the buffers of a few imported meshes, the uploads themselves are time sliced by the uploader
+	Model::UpdateLoads();
+
+	//the environment maps need everything of the new scene to be resident, finished assets are not checked again
+	std::vector<Model*>& models = _loadingScene->models;
+	std::vector<Texture*>& textures = _loadingScene->textures;
+
+	models.erase(std::remove_if(models.begin(), models.end(), [](Model* model) { return model->isLoaded(); }), models.end());
+	textures.erase(std::remove_if(textures.begin(), textures.end(), [](Texture* texture) { return texture->isLoaded(); }), textures.end());
+
+	if(!models.empty() || !textures.empty()) return;
+
+	_swapScene();
+}
+
+void SceneManager::_swapScene() {
+	//unload the current scene objects and the skybox, the ui still points at the old nodes
+	_ui->clearSelection();
+
+	delete _world;
+	delete _skybox;
 
 	_renderables.clear();
 	_lights.clear();
 
-	//load new scene
-	std::cout << "Loading Scene " + std::to_string(_queuedSceneIndex + 1) + "..." << std::endl;
+	//swap in the new scene at once
+	_world = _loadingScene->world;
+	_skybox = _loadingScene->skybox;
+	_skyboxSources.swap(_loadingScene->skyboxSources);
+	_mainCamera = _loadingScene->mainCamera;
+	_directionalLight = _loadingScene->directionalLight;
+	_reflectionProbes.swap(_loadingScene->reflectionProbes);
+
+	delete _loadingScene;
+	_loadingScene = nullptr;
 
-	_scenes[_queuedSceneIndex]->initializeScene(_world, this);
+	//the previous scene released its assets when it was deleted, only unload the ones the new scene did not pick up again
+	AssetManager::PurgeUnused();
+	AssetManager::PrintReport();
 
-	//render environment maps for the scene
+	//render environment maps for the scene, probes missing from the cache are captured over the next frames
 	_initializeEnvironmentMaps();
 
-	std::cout << "Scene " + std::to_string(_queuedSceneIndex + 1) + " successfully loaded" << std::endl;
+	float loadTime = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - _loadStart).count();
+	std::cout << "Scene " + std::to_string(_loadingSceneIndex + 1) + " successfully loaded in " + std::to_string(loadTime) + "s" << std::endl;
 
-	//reset queued scene index
-	_queuedSceneIndex = -1;
+	_loadingSceneIndex = -1;
 }
 
 void SceneManager::_initializeEnvironmentMaps() {
@@ -190,7 +406,7 @@ void SceneManager::_initializeEnvironmentMaps() {
 	_profiler->startQuery(QueryType::Environment);
 
 	//render the environment maps before the renderloop starts
-	_renderer->renderEnvironmentMaps(_renderables, _directionalLight, _skybox);
+	_renderer->renderEnvironmentMaps(_renderables, _reflectionProbes, _directionalLight, _skybox, _skyboxSources);
 
 	_profiler->endQuery(QueryType::Environment);
 }
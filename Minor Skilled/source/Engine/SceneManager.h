@@ -2,7 +2,13 @@
 #define SCENEMANAGER_H
 
 #include <vector>
+#include <string>
 #include <bitset>
+#include <chrono>
+
+#include <glm/glm.hpp>
+
+#include "../Engine/ReflectionProbe.h"
 
 class Window;
 class World;
@@ -12,6 +18,7 @@ class Renderer;
 class OverlayUI;
 class Debug;
 class Scene;
+class Model;
 
 class SceneManager {
 	public:
@@ -22,8 +29,24 @@ class SceneManager {
 		void addScene(Scene* scene);
 
 		void setSkybox(Texture* skybox, bool isEquirectangular = false);
+		void setSkybox(std::string hdrPath); //equirectangular hdr image, the converted cubemap is cached on disk
+		void setSkybox(std::vector<std::string>& faces); //sRGB cubemap faces relative to the skybox directory
 		void setMainCamera(Node* mainCamera);
 		void setDirectionalLight(Node* directionalLight);
+		void addReflectionProbe(glm::vec3 position, glm::vec3 extents, bool boxProjection = false); //scenes without probes get them placed automatically
+
+		//the setters above apply to the scene that is being loaded, the getters below return the current scene
+
+		bool isLoading(); //a queued scene is being loaded while the current one keeps rendering
+
+		Node* getMainCamera();
+		Node* getDirectionalLight();
+		std::vector<std::string>& getSkyboxSources(); //files the skybox was loaded from, empty if it was assigned as a texture
+		std::vector<ReflectionProbe>& getReflectionProbes();
+
+		void exportScene(std::string path);
+
+		Node* pickNode(glm::vec2 screenPos);
 
 		virtual void initialize(unsigned int sceneIndex);
 		virtual void run();
@@ -38,9 +61,25 @@ class SceneManager {
 		virtual void _render();
 
 	private:
+		//everything a scene assigns while it is initialized, swapped in at once when all its assets are resident
+		struct LoadingScene {
+			World* world;
+			Texture* skybox;
+			std::vector<std::string> skyboxSources;
+			Node* mainCamera;
+			Node* directionalLight;
+			std::vector<ReflectionProbe> reflectionProbes;
+
+			//assets of the scene that are still loading, the current scene streaming its own textures does not hold up the swap
+			std::vector<Model*> models;
+			std::vector<Texture*> textures;
+		};
+
 		Texture * _skybox;
+		std::vector<std::string> _skyboxSources;
 		Node* _mainCamera;
 		Node* _directionalLight;
+		std::vector<ReflectionProbe> _reflectionProbes;
 
 		Debug* _profiler;
 
@@ -51,7 +90,14 @@ class SceneManager {
 
 		int _queuedSceneIndex;
 
+		LoadingScene* _loadingScene; //nullptr if no scene is loading
+		int _loadingSceneIndex;
+		std::chrono::high_resolution_clock::time_point _loadStart;
+
 		void _loadScene();
+		void _collectLoadingAssets(Node* node);
+		void _updateLoading();
+		void _swapScene();
 		void _initializeEnvironmentMaps();
 
 };
@@ -1,5 +1,49 @@
 #include "shader.h"
 
+Shader::Shader(std::string computePath) {
+	//retrieve the compute source code from filePath
+	std::string computeCode;
+	std::ifstream cShaderFile;
+
+	//ensure ifstream objects can throw exceptions:
+	cShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+
+	try {
+		//open file
+		cShaderFile.open(computePath);
+		std::stringstream cShaderStream;
+
+		//read file's buffer contents into stream
+		cShaderStream << cShaderFile.rdbuf();
+
+		//close file handler
+		cShaderFile.close();
+
+		//convert stream into string
+		computeCode = cShaderStream.str();
+
+	} catch(std::ifstream::failure e) {
+		std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+	}
+
+	const char* cShaderCode = computeCode.c_str();
+
+	//compute shader
+	unsigned int compute = glCreateShader(GL_COMPUTE_SHADER);
+	glShaderSource(compute, 1, &cShaderCode, NULL);
+	glCompileShader(compute);
+	_checkCompileErrors(compute, "COMPUTE", computePath);
+
+	//shader Program
+	_id = glCreateProgram();
+	glAttachShader(_id, compute);
+	glLinkProgram(_id);
+	_checkCompileErrors(_id, "PROGRAM", "");
+
+	//delete the shader as it's linked into our program now and no longer necessary
+	glDeleteShader(compute);
+}
+
 Shader::Shader(std::string vertexPath, std::string fragmentPath) {
 	//retrieve the vertex/fragment source code from filePath
 	std::string vertexCode;
@@ -147,6 +191,10 @@ void Shader::use() {
 	glUseProgram(_id);
 }
 
+void Shader::dispatch(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ) {
+	glDispatchCompute(groupsX, groupsY, groupsZ);
+}
+
 void Shader::setBool(std::string name, bool value) {
 	glUniform1i(glGetUniformLocation(_id, name.c_str()), (int)value);
 }
@@ -155,6 +203,10 @@ void Shader::setInt(std::string name, int value) {
 	glUniform1i(glGetUniformLocation(_id, name.c_str()), value);
 }
 
+void Shader::setUint(std::string name, unsigned int value) {
+	glUniform1ui(glGetUniformLocation(_id, name.c_str()), value);
+}
+
 void Shader::setFloat(std::string name, float value) {
 	glUniform1f(glGetUniformLocation(_id, name.c_str()), value);
 }
@@ -12,13 +12,16 @@
 
 class Shader {
 	public:
+		Shader(std::string computePath); //compute shader
 		Shader(std::string vertexPath, std::string fragmentPath);
 		Shader(std::string vertexPath, std::string geometryPath, std::string fragmentPath); //overloaded constructor for geometry shader support
 
 		void use();
+		void dispatch(unsigned int groupsX, unsigned int groupsY = 1, unsigned int groupsZ = 1);
 
 		void setBool(std::string name, bool value);
 		void setInt(std::string name, int value);
+		void setUint(std::string name, unsigned int value);
 		void setFloat(std::string name, float value);
 		void setVec2(std::string name, float x, float y);
 		void setVec2(std::string name, glm::vec2 value);
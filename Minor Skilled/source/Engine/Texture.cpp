@@ -1,16 +1,34 @@
 #include "Texture.h"
 
 #include <iostream>
+#include <algorithm>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
 #include "../../dependencies/stb_image/stb_image.h"
 
+#include "../Engine/Uploader.h"
+#include "../Engine/TextureCache.h"
+#include "../Engine/TextureStreamer.h"
+
 #include "../Utility/Filepath.h"
+#include "../Utility/TextureCompressor.h"
+#include "../Utility/RenderSettings.h"
+#include "../Utility/Math.h"
+
+//EXT_texture_compression_s3tc and EXT_texture_sRGB are not part of the core profile glad was generated for
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+JobCounter Texture::_LoadCounter;
 
 Texture::Texture(GLenum target, GLenum internalFormat, unsigned int width, unsigned int height, GLenum format, GLenum type, GLenum minFilter, GLenum magFilter, GLenum wrap, const void* pixels, bool genMipmaps):
- _target(target){
+ _target(target), _loading(false), _loaded(true) {
 
 	glGenTextures(1, &_id);
 
@@ -22,11 +40,19 @@ Texture::Texture(GLenum target, GLenum internalFormat, unsigned int width, unsig
 	if(genMipmaps) generateMipmaps();
 }
 
-Texture::Texture(GLenum target): _target(target) {
+Texture::Texture(GLenum target): _target(target), _loading(false), _loaded(true) {
 	glGenTextures(1, &_id);
 }
 
 Texture::~Texture() {
+	//never let a worker or the uploader hand over pixels for a deleted texture
+	if(_loading) {
+		FinishLoads();
+		Uploader::Flush();
+	}
+
+	TextureStreamer::Unregister(this);
+
 	glDeleteTextures(1, &_id);
 }
 
@@ -42,6 +68,52 @@ void Texture::generateMipmaps() {
 	glGenerateMipmap(_target);
 }
 
+bool Texture::isLoaded() {
+	return _loaded;
+}
+
+unsigned long long Texture::getMemorySize() {
+	//ask the driver for the size of every allocated level, the textures do not remember their formats themselves
+	GLenum levelTarget = (_target == GL_TEXTURE_CUBE_MAP) ? GL_TEXTURE_CUBE_MAP_POSITIVE_X : _target;
+	unsigned int faces = (_target == GL_TEXTURE_CUBE_MAP) ? 6 : 1;
+	unsigned long long memory = 0;
+
+	bind();
+
+	for(int level = 0; level < 16; level++) {
+		int width, height, depth, compressed;
+
+		glGetTexLevelParameteriv(levelTarget, level, GL_TEXTURE_WIDTH, &width);
+		if(width == 0) break; //no more levels allocated
+
+		glGetTexLevelParameteriv(levelTarget, level, GL_TEXTURE_HEIGHT, &height);
+		glGetTexLevelParameteriv(levelTarget, level, GL_TEXTURE_DEPTH, &depth);
+		glGetTexLevelParameteriv(levelTarget, level, GL_TEXTURE_COMPRESSED, &compressed);
+
+		if(compressed == GL_TRUE) {
+			int size;
+			glGetTexLevelParameteriv(levelTarget, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+
+			memory += (unsigned long long)size * faces;
+		} else {
+			//sum up the bits of all channels
+			const GLenum channels[] = { GL_TEXTURE_RED_SIZE, GL_TEXTURE_GREEN_SIZE, GL_TEXTURE_BLUE_SIZE, GL_TEXTURE_ALPHA_SIZE, GL_TEXTURE_DEPTH_SIZE, GL_TEXTURE_STENCIL_SIZE };
+			int bits = 0;
+
+			for(unsigned int i = 0; i < 6; i++) {
+				int channelBits;
+				glGetTexLevelParameteriv(levelTarget, level, channels[i], &channelBits);
+
+				bits += channelBits;
+			}
+
+			memory += (unsigned long long)width * height * std::max(depth, 1) * bits / 8 * faces;
+		}
+	}
+
+	return memory;
+}
+
 void Texture::init(GLenum internalFormat, unsigned int width, unsigned int height, GLenum format, GLenum type, const void* pixels) {
 	glTexImage2D(_target, 0, internalFormat, width, height, 0, format, type, pixels);
 }
@@ -58,7 +130,7 @@ void Texture::filter(GLenum minFilter, GLenum magFilter, GLenum wrap) {
 		glTexParameteri(_target, GL_TEXTURE_WRAP_S, wrap);
 		glTexParameteri(_target, GL_TEXTURE_WRAP_T, wrap);
 
-		if(_target == GL_TEXTURE_CUBE_MAP) glTexParameteri(_target, GL_TEXTURE_WRAP_R, wrap);
+		if(_target == GL_TEXTURE_CUBE_MAP || _target == GL_TEXTURE_3D) glTexParameteri(_target, GL_TEXTURE_WRAP_R, wrap);
 	}
 }
 
@@ -67,8 +139,6 @@ Texture * Texture::LoadTexture(std::string path, TextureFilter filter, bool sRGB
 	//when setting the sRGB parameter to true, OpenGL transforms  the texture from gamma corrected/sRGB color space back to linear color space so that they can/have to be gamma corrected in the shaders
 	//diffuse and color textures are almost always in sRGB space - specular map, normals maps, etc. are almost always in linear space
 
-	stbi_set_flip_vertically_on_load(false);
-
 	//create opengl texture object
 	Texture* texture = new Texture(GL_TEXTURE_2D);
 
@@ -79,35 +149,7 @@ Texture * Texture::LoadTexture(std::string path, TextureFilter filter, bool sRGB
 	unsigned char* textureData = stbi_load(path.c_str(), &width, &height, &nrComponents, 0);
 
 	if(textureData) {
-		//identify format
-		GLenum internalFormat;
-		GLenum dataFormat;
-
-		if(nrComponents == 1) {
-			internalFormat = dataFormat = GL_RED;
-		} else if(nrComponents == 3) {
-			internalFormat = sRGB ? GL_SRGB : GL_RGB;
-			dataFormat = GL_RGB;
-		} else if(nrComponents == 4) {
-			internalFormat = sRGB ? GL_SRGB_ALPHA : GL_RGBA;
-			dataFormat = GL_RGBA;
-		}
-
-		//load texture into opengl
-		texture->bind();
-		texture->init(internalFormat, width, height, dataFormat, GL_UNSIGNED_BYTE, textureData);
-		texture->generateMipmaps();
-
-		//set texture filter options
-		switch(filter) {
-			case TextureFilter::Repeat:
-				texture->filter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_REPEAT);
-				break;
-
-			case TextureFilter::ClampToEdge:
-				texture->filter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE);
-				break;
-		}
+		_SetupImage(texture, textureData, width, height, nrComponents, filter, sRGB);
 
 		stbi_image_free(textureData); //free memory
 
@@ -121,9 +163,148 @@ Texture * Texture::LoadTexture(std::string path, TextureFilter filter, bool sRGB
 	return texture;
 }
 
-Texture * Texture::LoadCubemap(std::vector<std::string>& faces, bool sRGB) {
-	stbi_set_flip_vertically_on_load(false);
+Texture* Texture::LoadTextureAsync(std::string path, TextureFilter filter, bool sRGB) {
+	//the texture object exists right away, so materials can hold on to it while the image is decoded on a worker
+	Texture* texture = new Texture(GL_TEXTURE_2D);
+	texture->filepath = path;
+	texture->_loading = true;
+	texture->_loaded = false;
 
+	//1x1 placeholder, grey for colors and a flat normal for linear data
+	const unsigned char placeholder[4] = { 128, 128, (unsigned char)(sRGB ? 128 : 255), 255 };
+
+	texture->bind();
+	texture->init(GL_RGBA, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+	texture->filter(GL_LINEAR, GL_LINEAR, (filter == TextureFilter::Repeat) ? GL_REPEAT : GL_CLAMP_TO_EDGE);
+
+	GLenum wrap = (filter == TextureFilter::Repeat) ? GL_REPEAT : GL_CLAMP_TO_EDGE;
+
+	JobSystem::Schedule([texture, path, wrap, sRGB]() {
+		//cooked textures are uploaded as they are, everything else gets decoded and copied straight into the staging ring
+		CompressedImage image;
+
+		if(RenderSettings::CompressTextures) {
+			if(TextureCache::Load(path, sRGB, image) || CookTexture(path, sRGB, image)) {
+				_UploadCompressed(texture, image, TextureStreamer::Register(texture, path, wrap, image), wrap);
+			} else {
+				std::cout << "Texture failed to load at path: " + path << std::endl; //keeps the placeholder
+				texture->_loading = false;
+				texture->_loaded = true;
+			}
+
+			return;
+		}
+
+		int width, height, components;
+		unsigned char* data = stbi_load(path.c_str(), &width, &height, &components, 0);
+
+		if(!data) {
+			std::cout << "Texture failed to load at path: " + path << std::endl; //keeps the placeholder
+			texture->_loading = false;
+			texture->_loaded = true;
+		} else {
+			GLenum internalFormat;
+			GLenum dataFormat;
+			_GetFormats(components, sRGB, internalFormat, dataFormat);
+
+			Uploader::UploadTexture(texture, data, width, height, internalFormat, dataFormat, GL_UNSIGNED_BYTE, wrap, true);
+		}
+
+		stbi_image_free(data); //free memory
+	}, &_LoadCounter);
+
+	return texture;
+}
+
+bool Texture::CookTexture(std::string path, bool sRGB, CompressedImage& image) {
+	int width, height, components;
+	unsigned char* data = stbi_load(path.c_str(), &width, &height, &components, 4); //the encoders work on rgba
+
+	if(!data) return false;
+
+	TextureCompressor::Compress(data, width, height, components, sRGB, image);
+	TextureCache::Write(path, image);
+
+	stbi_image_free(data); //free memory
+
+	return true;
+}
+
+void Texture::FinishLoads() {
+	//the main thread helps decoding, the uploads are finished with Uploader::Flush
+	JobSystem::Wait(&_LoadCounter);
+}
+
+bool Texture::IsLoading() {
+	return _LoadCounter.pending > 0;
+}
+
+void Texture::_GetFormats(int components, bool sRGB, GLenum& internalFormat, GLenum& dataFormat) {
+	if(components == 1) {
+		internalFormat = dataFormat = GL_RED;
+	} else if(components == 3) {
+		internalFormat = sRGB ? GL_SRGB : GL_RGB;
+		dataFormat = GL_RGB;
+	} else {
+		internalFormat = sRGB ? GL_SRGB_ALPHA : GL_RGBA;
+		dataFormat = GL_RGBA;
+	}
+}
+
+GLenum Texture::_GetCompressedFormat(BlockFormat format, bool sRGB) {
+	switch(format) {
+		case BC1:
+			return sRGB ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+
+		case BC3:
+			return sRGB ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+
+		case BC4:
+			return GL_COMPRESSED_RED_RGTC1;
+
+		case BC5:
+			return GL_COMPRESSED_RG_RGTC2;
+
+		case BC7:
+			return sRGB ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+	}
+
+	return GL_NONE;
+}
+
+void Texture::_UploadCompressed(Texture* texture, const CompressedImage& image, unsigned int firstLevel, GLenum wrap) {
+	//skip the larger levels, the reduced chain becomes a complete texture of its own
+	unsigned int offset = TextureCompressor::GetLevelOffset(image.format, image.width, image.height, firstLevel);
+	unsigned int width = std::max(image.width >> firstLevel, 1u);
+	unsigned int height = std::max(image.height >> firstLevel, 1u);
+
+	Uploader::UploadCompressedTexture(texture, &image.data[offset], image.data.size() - offset, width, height, image.levels - firstLevel, _GetCompressedFormat(image.format, image.sRGB), TextureCompressor::GetBlockSize(image.format), wrap);
+}
+
+void Texture::_SetupImage(Texture* texture, unsigned char* data, int width, int height, int components, TextureFilter filter, bool sRGB) {
+	//identify format
+	GLenum internalFormat;
+	GLenum dataFormat;
+	_GetFormats(components, sRGB, internalFormat, dataFormat);
+
+	//load texture into opengl
+	texture->bind();
+	texture->init(internalFormat, width, height, dataFormat, GL_UNSIGNED_BYTE, data);
+	texture->generateMipmaps();
+
+	//set texture filter options
+	switch(filter) {
+		case TextureFilter::Repeat:
+			texture->filter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_REPEAT);
+			break;
+
+		case TextureFilter::ClampToEdge:
+			texture->filter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE);
+			break;
+	}
+}
+
+Texture * Texture::LoadCubemap(std::vector<std::string>& faces, bool sRGB) {
 	Texture* texture = new Texture(GL_TEXTURE_CUBE_MAP);
 	texture->bind();
 
@@ -154,14 +335,27 @@ Texture * Texture::LoadCubemap(std::vector<std::string>& faces, bool sRGB) {
 }
 
 Texture* Texture::LoadHDR(std::string path) {
-	stbi_set_flip_vertically_on_load(true);
 	int width, height, nrComponents;
-	float *data = stbi_loadf(path.c_str(), &width, &height, &nrComponents, 0);
+	float *data = stbi_loadf(path.c_str(), &width, &height, &nrComponents, 3);
 
 	if(data) {
+		//convert to half floats on the workers, so the driver does not have to convert on the main thread
+		//the rows are flipped on the way instead of through stb_image, its flip setting is global and shared with the decoding workers
+		unsigned int rowSize = width * 3;
+		std::vector<unsigned short> halfData((size_t)rowSize * height);
+
+		JobSystem::ParallelFor(height, 16, [&](unsigned int start, unsigned int end) {
+			for(unsigned int y = start; y < end; y++) {
+				Math::FloatToHalf(data + (size_t)(height - 1 - y) * rowSize, &halfData[(size_t)y * rowSize], rowSize);
+			}
+		});
+
 		Texture* texture = new Texture(GL_TEXTURE_2D);
 		texture->bind();
-		texture->init(GL_RGB16F, width, height, GL_RGB, GL_FLOAT, data);
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 2); //rows of odd widths are not 4 byte aligned
+		texture->init(GL_RGB16F, width, height, GL_RGB, GL_HALF_FLOAT, &halfData[0]);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
 		texture->filter(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE);
 
@@ -3,16 +3,21 @@
 
 #include <string>
 #include <vector>
+#include <atomic>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include "../Engine/JobSystem.h"
+
 #include "../Utility/TextureFilter.h"
+#include "../Utility/BlockFormat.h"
 
 class Shader;
 class VertexArray;
 class Buffer;
 class Framebuffer;
+struct CompressedImage;
 
 class Texture {
 	public:
@@ -28,20 +33,41 @@ class Texture {
 
 		void generateMipmaps();
 
+		unsigned long long getMemorySize();
+		bool isLoaded(); //false until the first decode and upload of an async load finished
+
 		void init(GLenum internalFormat, unsigned int width, unsigned int height, GLenum format, GLenum type, const void* pixels);
 		void initTarget(GLenum target, GLenum internalFormat, unsigned int width, unsigned int height, GLenum format, GLenum type, const void* pixels);
 		void filter(GLenum minFilter, GLenum magFilter, GLenum wrap);
 
 		static Texture* LoadTexture(std::string path, TextureFilter filter = TextureFilter::Repeat, bool sRGB = false);
+		static Texture* LoadTextureAsync(std::string path, TextureFilter filter = TextureFilter::Repeat, bool sRGB = false); //returns a placeholder which is filled in once decoded
 		static Texture* LoadCubemap(std::vector<std::string>& faces, bool sRGB = false);
 		static Texture* LoadHDR(std::string path);
 
+		static bool CookTexture(std::string path, bool sRGB, CompressedImage& image); //decodes, block compresses and caches the image, can be called from any thread
+		static void FinishLoads();
+		static bool IsLoading(); //decodes that did not queue their uploads yet
+
 		static void Unbind(GLenum target);
 		static void SetActiveUnit(unsigned int unit);
 
 	private:
+		friend class Uploader; //swaps in the streamed texture object
+		friend class TextureStreamer; //reuploads the texture with a different set of levels
+
 		unsigned int _id;
 		GLenum _target;
+
+		std::atomic<bool> _loading; //the decode or upload of this texture is still in flight
+		std::atomic<bool> _loaded; //the first load finished, streaming levels in and out afterwards keeps it set
+
+		static JobCounter _LoadCounter;
+
+		static void _GetFormats(int components, bool sRGB, GLenum& internalFormat, GLenum& dataFormat);
+		static GLenum _GetCompressedFormat(BlockFormat format, bool sRGB);
+		static void _UploadCompressed(Texture* texture, const CompressedImage& image, unsigned int firstLevel, GLenum wrap);
+		static void _SetupImage(Texture* texture, unsigned char* data, int width, int height, int components, TextureFilter filter, bool sRGB);
 };
 
 #endif
\ No newline at end of file
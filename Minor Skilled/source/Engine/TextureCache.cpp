@@ -0,0 +1,173 @@
+#include "TextureCache.h"
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+
+#include "../Utility/Filepath.h"
+#include "../Utility/MappedFile.h"
+
+const unsigned int TextureCache::_Version = 1; //increase whenever the encoders or the mip generation change
+const unsigned int TextureCache::_HeaderSize = offsetof(Header, miscFlags2) + sizeof(unsigned int); //the struct is padded to 8 bytes, the file layout is not
+
+const unsigned int TextureCache::_DdsMagic = 0x20534444; //"DDS "
+const unsigned int TextureCache::_CookerMagic = 0x43545847; //"GXTC"
+const unsigned int TextureCache::_Dx10FourCC = 0x30315844; //"DX10"
+
+bool TextureCache::Load(std::string path, bool sRGB, CompressedImage& image, unsigned int firstLevel) {
+	unsigned long long sourceTime;
+	unsigned long long sourceSize;
+
+	if(!Filepath::GetFileStats(path, sourceTime, sourceSize)) return false;
+
+	MappedFile cache(GetCachePath(path, sRGB));
+	if(!cache.isOpen() || cache.getSize() < _HeaderSize) return false;
+
+	const Header* header = (const Header*)cache.getData();
+
+	if(header->magic != _DdsMagic || header->cookerMagic != _CookerMagic || header->cookerVersion != _Version) return false;
+	if(header->pixelFormat.fourCC != _Dx10FourCC) return false;
+	if(header->sourceSize != sourceSize) return false;
+
+	bool touched = header->sourceTime != sourceTime;
+
+	if(touched) {
+		//the timestamp changed (e.g. after a checkout), the cache is still valid if the contents are the same
+		MappedFile source(path);
+		if(!source.isOpen() || source.getHash() != header->sourceHash) return false;
+	}
+
+	if(!_GetBlockFormat(header->dxgiFormat, image.format, image.sRGB) || image.sRGB != sRGB) return false;
+
+	unsigned int width = header->width;
+	unsigned int height = header->height;
+	unsigned int levels = std::max(header->mipMapCount, 1u);
+
+	//make sure the whole chain is inside of the file
+	unsigned long long size = TextureCompressor::GetLevelOffset(image.format, width, height, levels);
+	if(width == 0 || height == 0 || _HeaderSize + size > cache.getSize()) return false;
+
+	firstLevel = std::min(firstLevel, levels - 1);
+	unsigned int offset = TextureCompressor::GetLevelOffset(image.format, width, height, firstLevel);
+
+	image.width = std::max(width >> firstLevel, 1u);
+	image.height = std::max(height >> firstLevel, 1u);
+	image.levels = levels - firstLevel;
+
+	const unsigned char* data = cache.getData() + _HeaderSize;
+	image.data.assign(data + offset, data + size);
+
+	//store the new timestamp, so streaming the levels later on does not hash the source again
+	if(touched) {
+		cache.close();
+		Filepath::PatchFile(GetCachePath(path, sRGB), offsetof(Header, sourceTime), &sourceTime, sizeof(sourceTime));
+	}
+
+	return true;
+}
+
+void TextureCache::Write(std::string path, const CompressedImage& image) {
+	Header header;
+	std::memset(&header, 0, sizeof(Header));
+
+	if(!Filepath::GetFileStats(path, header.sourceTime, header.sourceSize)) return;
+
+	MappedFile source(path);
+	if(!source.isOpen()) return;
+
+	header.magic = _DdsMagic;
+	header.size = 124;
+	header.flags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000; //caps, height, width, pixel format, mip map count, linear size
+	header.height = image.height;
+	header.width = image.width;
+	header.pitchOrLinearSize = TextureCompressor::GetLevelSize(image.format, image.width, image.height);
+	header.mipMapCount = image.levels;
+
+	header.cookerMagic = _CookerMagic;
+	header.cookerVersion = _Version;
+	header.sourceHash = source.getHash();
+
+	header.pixelFormat.size = sizeof(PixelFormat);
+	header.pixelFormat.flags = 0x4; //four cc
+	header.pixelFormat.fourCC = _Dx10FourCC;
+
+	header.caps[0] = 0x1000 | 0x400000 | 0x8; //texture, mip map, complex
+
+	header.dxgiFormat = _GetDxgiFormat(image.format, image.sRGB);
+	header.resourceDimension = 3; //texture 2d
+	header.arraySize = 1;
+
+	std::string cachePath = GetCachePath(path, image.sRGB);
+	std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+
+	if(!file.is_open()) {
+		std::cout << "ERROR: Unable to write the texture cache " + cachePath << std::endl;
+		return;
+	}
+
+	file.write((const char*)&header, _HeaderSize);
+	file.write((const char*)&image.data[0], image.data.size());
+}
+
+std::string TextureCache::GetCachePath(std::string path, bool sRGB) {
+	//the format depends on the color space, so both versions are cached separately
+	return Filepath::GetCachePath(path, sRGB ? ".srgb.dds" : ".dds");
+}
+
+unsigned int TextureCache::GetVersion() {
+	return _Version;
+}
+
+unsigned int TextureCache::_GetDxgiFormat(BlockFormat format, bool sRGB) {
+	switch(format) {
+		case BC1:
+			return sRGB ? 72 : 71;
+
+		case BC3:
+			return sRGB ? 78 : 77;
+
+		case BC4:
+			return 80;
+
+		case BC5:
+			return 83;
+
+		case BC7:
+			return sRGB ? 99 : 98;
+	}
+
+	return 0;
+}
+
+bool TextureCache::_GetBlockFormat(unsigned int dxgiFormat, BlockFormat& format, bool& sRGB) {
+	sRGB = (dxgiFormat == 72 || dxgiFormat == 78 || dxgiFormat == 99);
+
+	switch(dxgiFormat) {
+		case 71:
+		case 72:
+			format = BC1;
+			return true;
+
+		case 77:
+		case 78:
+			format = BC3;
+			return true;
+
+		case 80:
+			format = BC4;
+			return true;
+
+		case 83:
+			format = BC5;
+			return true;
+
+		case 98:
+		case 99:
+			format = BC7;
+			return true;
+	}
+
+	return false;
+}
\ No newline at end of file
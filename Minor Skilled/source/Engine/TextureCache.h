@@ -0,0 +1,67 @@
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include <string>
+
+#include "../Utility/TextureCompressor.h"
+
+//cooked textures stored as dds files, loading them skips the decoding, the mip generation and the block compression
+class TextureCache {
+	public:
+		static bool Load(std::string path, bool sRGB, CompressedImage& image, unsigned int firstLevel = 0); //the image starts at the first level, e.g. to stream in only part of the chain
+		static void Write(std::string path, const CompressedImage& image);
+
+		static std::string GetCachePath(std::string path, bool sRGB);
+		static unsigned int GetVersion();
+
+	private:
+		static const unsigned int _Version;
+		static const unsigned int _HeaderSize;
+
+		static const unsigned int _DdsMagic;
+		static const unsigned int _CookerMagic;
+		static const unsigned int _Dx10FourCC;
+
+		//dds layout, the source file state is kept in the reserved fields of the header
+		struct PixelFormat {
+			unsigned int size;
+			unsigned int flags;
+			unsigned int fourCC;
+			unsigned int rgbBitCount;
+			unsigned int bitMasks[4];
+		};
+
+		struct Header {
+			unsigned int magic;
+			unsigned int size;
+			unsigned int flags;
+			unsigned int height;
+			unsigned int width;
+			unsigned int pitchOrLinearSize;
+			unsigned int depth;
+			unsigned int mipMapCount;
+
+			unsigned int cookerMagic;
+			unsigned int cookerVersion;
+			unsigned long long sourceTime;
+			unsigned long long sourceSize;
+			unsigned long long sourceHash;
+			unsigned int reserved[3];
+
+			PixelFormat pixelFormat;
+			unsigned int caps[4];
+			unsigned int reserved2;
+
+			//dx10 extension, the only way to store bc7 and srgb formats
+			unsigned int dxgiFormat;
+			unsigned int resourceDimension;
+			unsigned int miscFlag;
+			unsigned int arraySize;
+			unsigned int miscFlags2;
+		};
+
+		static unsigned int _GetDxgiFormat(BlockFormat format, bool sRGB);
+		static bool _GetBlockFormat(unsigned int dxgiFormat, BlockFormat& format, bool& sRGB);
+};
+
+#endif
\ No newline at end of file
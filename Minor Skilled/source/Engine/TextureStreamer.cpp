@@ -0,0 +1,198 @@
+#include "TextureStreamer.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+#include "../Engine/Texture.h"
+#include "../Engine/TextureCache.h"
+#include "../Engine/Uploader.h"
+#include "../Engine/JobSystem.h"
+
+#include "../Utility/RenderSettings.h"
+
+const unsigned int TextureStreamer::_TailSize = 64;
+const unsigned int TextureStreamer::_MaxStreamsPerUpdate = 4;
+const unsigned int TextureStreamer::_EvictionDelay = 60;
+
+std::unordered_map<Texture*, TextureStreamer::StreamedTexture*> TextureStreamer::_Textures;
+std::vector<TextureStreamer::StreamedTexture*> TextureStreamer::_Registered;
+std::mutex TextureStreamer::_Mutex;
+
+unsigned int TextureStreamer::_Frame = 0;
+unsigned long long TextureStreamer::_ResidentMemory = 0;
+
+unsigned int TextureStreamer::Register(Texture* texture, std::string path, GLenum wrap, const CompressedImage& image) {
+	StreamedTexture* streamedTexture = new StreamedTexture();
+	streamedTexture->texture = texture;
+	streamedTexture->path = path;
+	streamedTexture->wrap = wrap;
+	streamedTexture->format = image.format;
+	streamedTexture->sRGB = image.sRGB;
+	streamedTexture->width = image.width;
+	streamedTexture->height = image.height;
+	streamedTexture->levels = image.levels;
+	streamedTexture->tailLevel = 0;
+	streamedTexture->requestedLevel = FLT_MAX;
+	streamedTexture->lastRequestFrame = 0;
+
+	while(streamedTexture->tailLevel + 1 < image.levels && std::max(image.width >> streamedTexture->tailLevel, image.height >> streamedTexture->tailLevel) > _TailSize) {
+		streamedTexture->tailLevel++;
+	}
+
+	//start with the small levels only, the rest is streamed in once the texture is seen
+	streamedTexture->residentLevel = RenderSettings::IsEnabled(RenderSettings::TextureStreaming) ? streamedTexture->tailLevel : 0;
+
+	std::lock_guard<std::mutex> lock(_Mutex);
+	_Registered.push_back(streamedTexture);
+
+	return streamedTexture->residentLevel;
+}
+
+void TextureStreamer::Unregister(Texture* texture) {
+	{
+		std::lock_guard<std::mutex> lock(_Mutex);
+
+		for(unsigned int i = 0; i < _Registered.size(); i++) {
+			if(_Registered[i]->texture != texture) continue;
+
+			delete _Registered[i];
+			_Registered.erase(_Registered.begin() + i);
+			return;
+		}
+	}
+
+	auto it = _Textures.find(texture);
+	if(it == _Textures.end()) return;
+
+	delete it->second;
+	_Textures.erase(it);
+}
+
+void TextureStreamer::Request(Texture* texture, float uvsPerPixel) {
+	auto it = _Textures.find(texture);
+	if(it == _Textures.end()) return;
+
+	StreamedTexture* streamedTexture = it->second;
+
+	//one texel per pixel at the full resolution is level 0, every halving of the footprint is one level further down
+	float texelsPerPixel = uvsPerPixel * std::max(streamedTexture->width, streamedTexture->height);
+
+	streamedTexture->requestedLevel = std::min(streamedTexture->requestedLevel, std::log2(std::max(texelsPerPixel, 1.0f)));
+	streamedTexture->lastRequestFrame = _Frame;
+}
+
+void TextureStreamer::Update() {
+	{
+		std::lock_guard<std::mutex> lock(_Mutex);
+
+		for(unsigned int i = 0; i < _Registered.size(); i++) {
+			_Textures[_Registered[i]->texture] = _Registered[i];
+		}
+
+		_Registered.clear();
+	}
+
+	bool streaming = RenderSettings::IsEnabled(RenderSettings::TextureStreaming);
+	unsigned long long budget = (unsigned long long)std::max(RenderSettings::TextureStreamingBudget, 0) * 1024 * 1024;
+
+	//level each texture should have from the requests of the last frame
+	std::vector<std::pair<StreamedTexture*, unsigned int>> targets;
+	targets.reserve(_Textures.size());
+
+	for(auto it = _Textures.begin(); it != _Textures.end(); it++) {
+		StreamedTexture* streamedTexture = it->second;
+		unsigned int target;
+
+		if(!streaming) target = 0; //everything fully resident
+		else if(streamedTexture->lastRequestFrame == _Frame && streamedTexture->requestedLevel != FLT_MAX) target = std::min((unsigned int)streamedTexture->requestedLevel, streamedTexture->tailLevel);
+		else if(_Frame - streamedTexture->lastRequestFrame < _EvictionDelay) target = streamedTexture->residentLevel; //out of view for a moment
+		else target = streamedTexture->tailLevel;
+
+		streamedTexture->requestedLevel = FLT_MAX;
+		targets.push_back(std::make_pair(streamedTexture, target));
+	}
+
+	//drop the same number of levels on every texture until all of them fit into the budget
+	unsigned int bias = 0;
+
+	while(streaming && bias < 16) {
+		unsigned long long memory = 0;
+
+		for(unsigned int i = 0; i < targets.size(); i++) {
+			memory += _GetChainSize(targets[i].first, std::min(targets[i].second + bias, targets[i].first->tailLevel));
+		}
+
+		if(memory <= budget) break;
+		bias++;
+	}
+
+	//stream in missing levels, evict unneeded ones only if they are more than one level off or memory is short
+	unsigned int streams = 0;
+	_ResidentMemory = 0;
+
+	for(unsigned int i = 0; i < targets.size(); i++) {
+		StreamedTexture* streamedTexture = targets[i].first;
+		unsigned int level = std::min(targets[i].second + bias, streamedTexture->tailLevel);
+
+		bool streamIn = level < streamedTexture->residentLevel;
+		bool evict = level > streamedTexture->residentLevel + 1 || (level > streamedTexture->residentLevel && bias > 0);
+
+		if((streamIn || evict) && streams < _MaxStreamsPerUpdate && !streamedTexture->texture->_loading) {
+			_Stream(streamedTexture, level);
+			streams++;
+		}
+
+		_ResidentMemory += _GetChainSize(streamedTexture, streamedTexture->residentLevel);
+	}
+
+	_Frame++;
+}
+
+unsigned long long TextureStreamer::GetResidentMemory() {
+	return _ResidentMemory;
+}
+
+unsigned long long TextureStreamer::GetFullMemory() {
+	unsigned long long memory = 0;
+
+	for(auto it = _Textures.begin(); it != _Textures.end(); it++) {
+		memory += _GetChainSize(it->second, 0);
+	}
+
+	return memory;
+}
+
+unsigned int TextureStreamer::GetTextureCount() {
+	return _Textures.size();
+}
+
+unsigned long long TextureStreamer::_GetChainSize(StreamedTexture* streamedTexture, unsigned int level) {
+	BlockFormat format = streamedTexture->format;
+
+	return TextureCompressor::GetLevelOffset(format, streamedTexture->width, streamedTexture->height, streamedTexture->levels) - TextureCompressor::GetLevelOffset(format, streamedTexture->width, streamedTexture->height, level);
+}
+
+void TextureStreamer::_Stream(StreamedTexture* streamedTexture, unsigned int level) {
+	//the levels are read from the texture cache again and replace the current texture object once uploaded
+	Texture* texture = streamedTexture->texture;
+	texture->_loading = true;
+
+	streamedTexture->residentLevel = level;
+
+	std::string path = streamedTexture->path;
+	bool sRGB = streamedTexture->sRGB;
+	GLenum wrap = streamedTexture->wrap;
+
+	JobSystem::Schedule([texture, path, sRGB, wrap, level]() {
+		CompressedImage image;
+
+		if(TextureCache::Load(path, sRGB, image, level)) {
+			Texture::_UploadCompressed(texture, image, 0, wrap);
+		} else {
+			std::cout << "ERROR: Unable to stream the levels of " + path << std::endl; //keeps the current levels
+			texture->_loading = false;
+		}
+	}, &Texture::_LoadCounter);
+}
\ No newline at end of file
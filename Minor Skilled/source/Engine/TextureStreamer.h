@@ -0,0 +1,64 @@
+#ifndef TEXTURESTREAMER_H
+#define TEXTURESTREAMER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "../Utility/TextureCompressor.h"
+
+class Texture;
+
+//keeps only the mips of cooked textures resident that are needed on screen, within a memory budget
+class TextureStreamer {
+	public:
+		//can be called from any thread, returns the first level of the image that should be uploaded
+		static unsigned int Register(Texture* texture, std::string path, GLenum wrap, const CompressedImage& image);
+		static void Unregister(Texture* texture);
+
+		//main thread only, uvsPerPixel is the texture coordinate range one screen pixel covers
+		static void Request(Texture* texture, float uvsPerPixel);
+		static void Update();
+
+		static unsigned long long GetResidentMemory();
+		static unsigned long long GetFullMemory(); //if every streamed texture was fully resident
+		static unsigned int GetTextureCount();
+
+	private:
+		static const unsigned int _TailSize; //levels up to this size always stay resident
+		static const unsigned int _MaxStreamsPerUpdate;
+		static const unsigned int _EvictionDelay; //frames without requests until a texture drops to its tail
+
+		struct StreamedTexture {
+			Texture* texture;
+			std::string path;
+			GLenum wrap;
+
+			BlockFormat format;
+			bool sRGB;
+			unsigned int width;
+			unsigned int height;
+			unsigned int levels;
+
+			unsigned int tailLevel;
+			unsigned int residentLevel; //largest level in gpu memory, or on its way there
+			float requestedLevel; //finest level requested this frame
+			unsigned int lastRequestFrame;
+		};
+
+		static std::unordered_map<Texture*, StreamedTexture*> _Textures;
+		static std::vector<StreamedTexture*> _Registered; //added by the loading workers, picked up on the next update
+		static std::mutex _Mutex;
+
+		static unsigned int _Frame;
+		static unsigned long long _ResidentMemory;
+
+		static unsigned long long _GetChainSize(StreamedTexture* streamedTexture, unsigned int level);
+		static void _Stream(StreamedTexture* streamedTexture, unsigned int level);
+};
+
+#endif
\ No newline at end of file
@@ -33,6 +33,8 @@ class Transform {
 		glm::vec3 getWorldPerspective();
 
 	private:
+		friend class SceneFile; //restores the local matrix and the euler angles without rebuilding them
+
 		glm::vec3 _localScale;
 		glm::quat _localRotation;
 		glm::vec3 _localPosition;
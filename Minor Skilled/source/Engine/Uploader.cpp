@@ -0,0 +1,351 @@
+#include "Uploader.h"
+
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+
+#include "../Engine/Texture.h"
+#include "../Engine/Buffer.h"
+
+#include "../Utility/RenderSettings.h"
+
+const unsigned long long Uploader::_RingSize = 64 * 1024 * 1024;
+const unsigned long long Uploader::_Alignment = 256;
+
+unsigned int Uploader::_RingBuffer = 0;
+unsigned char* Uploader::_RingData = nullptr;
+
+unsigned long long Uploader::_Head = 0;
+unsigned long long Uploader::_Tail = 0;
+
+std::deque<Uploader::Allocation*> Uploader::_Allocations;
+std::deque<Uploader::Request*> Uploader::_Queue;
+std::deque<Uploader::Batch> Uploader::_Batches;
+unsigned int Uploader::_PendingBytes = 0;
+
+std::mutex Uploader::_Mutex;
+
+void Uploader::Initialize() {
+	//one persistent, coherent mapping for the whole lifetime, so any thread can write into it without gl calls
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+	glGenBuffers(1, &_RingBuffer);
+	glBindBuffer(GL_COPY_READ_BUFFER, _RingBuffer);
+	glBufferStorage(GL_COPY_READ_BUFFER, _RingSize, NULL, flags);
+	_RingData = (unsigned char*)glMapBufferRange(GL_COPY_READ_BUFFER, 0, _RingSize, flags);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+	if(_RingData == nullptr) std::cout << "ERROR: Unable to map the staging ring, uploads fall back to client memory" << std::endl;
+}
+
+void Uploader::Shutdown() {
+	Flush();
+
+	if(_RingData != nullptr) {
+		glBindBuffer(GL_COPY_READ_BUFFER, _RingBuffer);
+		glUnmapBuffer(GL_COPY_READ_BUFFER);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	}
+
+	glDeleteBuffers(1, &_RingBuffer);
+
+	_RingBuffer = 0;
+	_RingData = nullptr;
+}
+
+void Uploader::UploadTexture(Texture* texture, const void* pixels, unsigned int width, unsigned int height, GLenum internalFormat, GLenum format, GLenum type, GLenum wrap, bool genMipmaps) {
+	unsigned int channels = 4;
+
+	if(format == GL_RED) channels = 1;
+	else if(format == GL_RG) channels = 2;
+	else if(format == GL_RGB) channels = 3;
+
+	unsigned int channelSize = 1;
+
+	if(type == GL_FLOAT) channelSize = 4;
+	else if(type == GL_HALF_FLOAT) channelSize = 2;
+
+	Request* request = new Request();
+	request->texture = texture;
+	request->buffer = nullptr;
+	request->width = width;
+	request->height = height;
+	request->internalFormat = internalFormat;
+	request->format = format;
+	request->type = type;
+	request->wrap = wrap;
+	request->genMipmaps = genMipmaps;
+	request->compressed = false;
+	request->levels = 1;
+	request->blockSize = 0;
+	request->size = width * height * channels * channelSize; //rows are tightly packed, see _Issue
+	request->stagingTexture = 0;
+
+	_Enqueue(request, pixels);
+}
+
+void Uploader::UploadCompressedTexture(Texture* texture, const void* data, unsigned int size, unsigned int width, unsigned int height, unsigned int levels, GLenum internalFormat, unsigned int blockSize, GLenum wrap) {
+	Request* request = new Request();
+	request->texture = texture;
+	request->buffer = nullptr;
+	request->width = width;
+	request->height = height;
+	request->internalFormat = internalFormat;
+	request->format = GL_NONE;
+	request->type = GL_NONE;
+	request->wrap = wrap;
+	request->genMipmaps = false;
+	request->compressed = true;
+	request->levels = levels;
+	request->blockSize = blockSize;
+	request->size = size;
+	request->stagingTexture = 0;
+
+	_Enqueue(request, data);
+}
+
+void Uploader::UploadBuffer(Buffer* buffer, const void* data, unsigned int size, std::function<void()> onComplete) {
+	//the buffer needs to have its storage allocated already
+	Request* request = new Request();
+	request->texture = nullptr;
+	request->buffer = buffer;
+	request->size = size;
+	request->stagingTexture = 0;
+	request->onComplete = onComplete;
+
+	_Enqueue(request, data);
+}
+
+void Uploader::Update() {
+	//finish uploads the gpu is done with and stream in new ones within the budget of this frame
+	_RetireBatches(false);
+	_IssueQueued((unsigned long long)std::max(RenderSettings::UploadBudget, 0) * 1024);
+}
+
+void Uploader::Flush() {
+	//issue and wait for everything, e.g. at the end of a scene load
+	while(!_IssueQueued(~0ull)) {
+		_RetireBatches(true);
+	}
+
+	_RetireBatches(true);
+}
+
+unsigned int Uploader::GetPendingBytes() {
+	std::lock_guard<std::mutex> lock(_Mutex);
+	return _PendingBytes;
+}
+
+void Uploader::_Enqueue(Request* request, const void* data) {
+	bool staged;
+
+	{
+		std::lock_guard<std::mutex> lock(_Mutex);
+		staged = _Allocate(request);
+	}
+
+	//copy outside of the lock, other threads can reserve their own ranges meanwhile
+	if(staged) std::memcpy(_RingData + request->offset, data, request->size);
+	else request->data.assign((const unsigned char*)data, (const unsigned char*)data + request->size); //keep a cpu copy until there is space
+
+	std::lock_guard<std::mutex> lock(_Mutex);
+	_Queue.push_back(request);
+	_PendingBytes += request->size;
+}
+
+bool Uploader::_Allocate(Request* request) {
+	if(_RingData == nullptr) return false;
+
+	unsigned long long size = (request->size + _Alignment - 1) & ~(_Alignment - 1);
+	if(size > _RingSize) return false;
+
+	//skip the rest of the ring if the data does not fit in before it wraps around
+	unsigned long long position = _Head % _RingSize;
+	unsigned long long padding = (position + size > _RingSize) ? _RingSize - position : 0;
+
+	if(_Head + padding + size - _Tail > _RingSize) return false; //the gpu still reads from that space
+
+	Allocation* allocation = new Allocation();
+	allocation->start = _Head;
+	allocation->end = _Head + padding + size;
+	allocation->released = false;
+
+	request->allocation = allocation;
+	request->offset = (_Head + padding) % _RingSize;
+
+	_Head = allocation->end;
+	_Allocations.push_back(allocation);
+
+	return true;
+}
+
+void Uploader::_Release(Allocation* allocation) {
+	//requests can finish out of allocation order, the ring only moves on once the oldest allocation is free
+	allocation->released = true;
+
+	while(!_Allocations.empty() && _Allocations.front()->released) {
+		_Tail = _Allocations.front()->end;
+
+		delete _Allocations.front();
+		_Allocations.pop_front();
+	}
+}
+
+bool Uploader::_IssueQueued(unsigned long long budget) {
+	std::vector<Request*> issued;
+	unsigned long long issuedBytes = 0;
+	bool drained = false;
+
+	while(true) {
+		Request* request;
+
+		{
+			std::lock_guard<std::mutex> lock(_Mutex);
+
+			if(_Queue.empty()) {
+				drained = true;
+				break;
+			}
+
+			request = _Queue.front();
+
+			//always issue at least one request, so a single large upload cannot block the queue
+			if(!issued.empty() && issuedBytes + request->size > budget) break;
+
+			//data that did not fit into the ring earlier gets staged now, if nothing frees up anymore it is uploaded straight from cpu memory
+			if(request->allocation == nullptr && _Allocate(request)) {
+				std::memcpy(_RingData + request->offset, &request->data[0], request->size);
+				std::vector<unsigned char>().swap(request->data);
+			} else if(request->allocation == nullptr && !_Batches.empty() && request->size <= _RingSize) {
+				break; //wait for the gpu to release space
+			}
+
+			_Queue.pop_front();
+		}
+
+		_Issue(request);
+
+		issued.push_back(request);
+		issuedBytes += request->size;
+	}
+
+	if(!issued.empty()) {
+		Batch batch;
+		batch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		batch.requests = issued;
+
+		_Batches.push_back(batch);
+	}
+
+	return drained;
+}
+
+void Uploader::_Issue(Request* request) {
+	//staged data is read from the ring at its offset, everything else from client memory
+	const void* source = (request->allocation != nullptr) ? (const void*)request->offset : (const void*)&request->data[0];
+
+	if(request->allocation != nullptr) glBindBuffer(request->texture != nullptr ? GL_PIXEL_UNPACK_BUFFER : GL_COPY_READ_BUFFER, _RingBuffer);
+
+	if(request->texture != nullptr) {
+		//upload into a new texture object, the old one stays in use until the copy finished
+		glGenTextures(1, &request->stagingTexture);
+		glBindTexture(GL_TEXTURE_2D, request->stagingTexture);
+
+		bool mipmapped = request->genMipmaps;
+
+		if(request->compressed) {
+			//the cooked levels are stored back to back
+			const unsigned char* level = (const unsigned char*)source;
+			unsigned int width = request->width;
+			unsigned int height = request->height;
+
+			for(unsigned int i = 0; i < request->levels; i++) {
+				unsigned int levelSize = ((width + 3) / 4) * ((height + 3) / 4) * request->blockSize;
+				glCompressedTexImage2D(GL_TEXTURE_2D, i, request->internalFormat, width, height, 0, levelSize, level);
+
+				level += levelSize;
+				width = std::max(width / 2, 1u);
+				height = std::max(height / 2, 1u);
+			}
+
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, request->levels - 1);
+			mipmapped = request->levels > 1;
+
+			//single channel data is read as grey, like the uncompressed rgb version
+			if(request->internalFormat == GL_COMPRESSED_RED_RGTC1) {
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_RED);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+			}
+		} else {
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glTexImage2D(GL_TEXTURE_2D, 0, request->internalFormat, request->width, request->height, 0, request->format, request->type, source);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+			if(request->genMipmaps) glGenerateMipmap(GL_TEXTURE_2D);
+		}
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmapped ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, request->wrap);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, request->wrap);
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	} else {
+		glBindBuffer(GL_COPY_WRITE_BUFFER, request->buffer->getID());
+
+		if(request->allocation != nullptr) glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, request->offset, 0, request->size);
+		else glBufferSubData(GL_COPY_WRITE_BUFFER, 0, request->size, source);
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	}
+
+	std::vector<unsigned char>().swap(request->data); //gl copied the client memory already
+}
+
+void Uploader::_Complete(Request* request) {
+	if(request->texture != nullptr) {
+		//swap in the finished texture, materials keep using the same Texture object
+		Texture* texture = request->texture;
+
+		glDeleteTextures(1, &texture->_id);
+		texture->_id = request->stagingTexture;
+		texture->_loading = false;
+		texture->_loaded = true;
+	}
+
+	if(request->onComplete) request->onComplete();
+
+	{
+		std::lock_guard<std::mutex> lock(_Mutex);
+
+		if(request->allocation != nullptr) _Release(request->allocation);
+		_PendingBytes -= request->size;
+	}
+
+	delete request;
+}
+
+bool Uploader::_RetireBatches(bool wait) {
+	while(!_Batches.empty()) {
+		Batch& batch = _Batches.front();
+
+		GLenum result = glClientWaitSync(batch.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? 1000000000 : 0);
+
+		if(result == GL_TIMEOUT_EXPIRED) {
+			if(!wait) return false; //still in flight, check again next frame
+			continue;
+		}
+
+		glDeleteSync(batch.fence);
+
+		for(unsigned int i = 0; i < batch.requests.size(); i++) {
+			_Complete(batch.requests[i]);
+		}
+
+		_Batches.pop_front();
+	}
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#ifndef UPLOADER_H
+#define UPLOADER_H
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <functional>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+class Texture;
+class Buffer;
+
+//streams texture and buffer data to the gpu through a persistently mapped staging ring, finished uploads are tracked with fences
+class Uploader {
+	public:
+		static void Initialize();
+		static void Shutdown();
+
+		//can be called from any thread, the data is copied into the staging ring right away if there is space
+		static void UploadTexture(Texture* texture, const void* pixels, unsigned int width, unsigned int height, GLenum internalFormat, GLenum format, GLenum type, GLenum wrap, bool genMipmaps);
+		static void UploadCompressedTexture(Texture* texture, const void* data, unsigned int size, unsigned int width, unsigned int height, unsigned int levels, GLenum internalFormat, unsigned int blockSize, GLenum wrap);
+		static void UploadBuffer(Buffer* buffer, const void* data, unsigned int size, std::function<void()> onComplete = nullptr);
+
+		//main thread only
+		static void Update();
+		static void Flush();
+
+		static unsigned int GetPendingBytes();
+
+	private:
+		static const unsigned long long _RingSize;
+		static const unsigned long long _Alignment;
+
+		struct Allocation {
+			unsigned long long start; //including the padding to skip the end of the ring
+			unsigned long long end;
+			bool released;
+		};
+
+		struct Request {
+			Texture* texture;
+			Buffer* buffer;
+
+			unsigned int width;
+			unsigned int height;
+			GLenum internalFormat;
+			GLenum format;
+			GLenum type;
+			GLenum wrap;
+			bool genMipmaps;
+
+			//block compressed textures come with all their levels
+			bool compressed;
+			unsigned int levels;
+			unsigned int blockSize;
+
+			unsigned int size;
+			Allocation* allocation; //nullptr while the data waits on the cpu for space in the ring
+			unsigned long long offset;
+			std::vector<unsigned char> data;
+
+			unsigned int stagingTexture; //uploads go into a new texture object which replaces the old one once the fence passed
+			std::function<void()> onComplete;
+		};
+
+		struct Batch {
+			GLsync fence;
+			std::vector<Request*> requests;
+		};
+
+		static unsigned int _RingBuffer;
+		static unsigned char* _RingData;
+
+		//virtual offsets which only grow, the physical offset is the remainder of the ring size
+		static unsigned long long _Head;
+		static unsigned long long _Tail;
+
+		static std::deque<Allocation*> _Allocations;
+		static std::deque<Request*> _Queue;
+		static std::deque<Batch> _Batches;
+		static unsigned int _PendingBytes;
+
+		static std::mutex _Mutex;
+
+		static void _Enqueue(Request* request, const void* data);
+		static bool _Allocate(Request* request);
+		static void _Release(Allocation* allocation);
+		static bool _IssueQueued(unsigned long long budget);
+		static void _Issue(Request* request);
+		static void _Complete(Request* request);
+		static bool _RetireBatches(bool wait);
+};
+
+#endif
\ No newline at end of file
@@ -13,4 +13,13 @@ struct Vertex {
 
 };
 
+//compressed layout of Vertex, 20 instead of 56 bytes
+struct PackedVertex {
+	public:
+		unsigned short position[4]; //quantized to the mesh bounds, w holds the bitangent sign
+		short frame[4]; //octahedral encoded normal and tangent
+		unsigned short uv[2]; //half floats
+
+};
+
 #endif
\ No newline at end of file
@@ -27,9 +27,13 @@ void VertexArray::drawElements(GLenum primitive, unsigned int indexAmount, GLenu
 	glDrawElements(primitive, indexAmount, type, indices);
 }
 
-void VertexArray::setAttribute(unsigned int index, unsigned int size, GLenum type, GLsizei stride, const void* pointer) {
+void VertexArray::setAttribute(unsigned int index, unsigned int size, GLenum type, GLsizei stride, const void* pointer, bool normalized) {
 	glEnableVertexAttribArray(index);
-	glVertexAttribPointer(index, size, type, GL_FALSE, stride, pointer);
+	glVertexAttribPointer(index, size, type, normalized ? GL_TRUE : GL_FALSE, stride, pointer); //normalized integers are mapped to [0, 1] or [-1, 1]
+}
+
+void VertexArray::disableAttribute(unsigned int index) {
+	glDisableVertexAttribArray(index); //the shader reads the current generic attribute value instead
 }
 
 void VertexArray::Unbind() {
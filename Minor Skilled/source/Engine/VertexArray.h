@@ -16,7 +16,8 @@ class VertexArray {
 		void drawArrays(GLenum primitive, unsigned int startIndex, unsigned int vertexCount);
 		void drawElements(GLenum primitive, unsigned int indexAmount, GLenum type, const void* indices);
 
-		void setAttribute(unsigned int index, unsigned int size, GLenum type, GLsizei stride, const void* pointer);
+		void setAttribute(unsigned int index, unsigned int size, GLenum type, GLsizei stride, const void* pointer, bool normalized = false);
+		void disableAttribute(unsigned int index);
 
 		static void Unbind();
 
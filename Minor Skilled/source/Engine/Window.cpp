@@ -9,11 +9,11 @@ unsigned int Window::ScreenHeight = 720;
 
 bool Window::DimensionsChanged = false;
 
-Window::Window(unsigned int width, unsigned int height, unsigned int xStartPos, unsigned int yStartPos, std::string name) {
+Window::Window(unsigned int width, unsigned int height, unsigned int xStartPos, unsigned int yStartPos, std::string name, bool visible) {
 	ScreenWidth = width;
 	ScreenHeight = height;
 
-	_initializeGLFW();
+	_initializeGLFW(visible);
 	_initializeWindow(name, xStartPos, yStartPos);
 	_initializeGLAD();
 
@@ -44,7 +44,7 @@ GLFWwindow* Window::getGlfwWindow() {
 	return _glfwWindow;
 }
 
-void Window::_initializeGLFW() {
+void Window::_initializeGLFW(bool visible) {
 	int success = glfwInit();
 
 	//OpenGL version 4.6.0
@@ -53,6 +53,7 @@ void Window::_initializeGLFW() {
 
 	glfwWindowHint(GLFW_SAMPLES, 4); //set amount of 4 multisamples (if MSAA is enabled)
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
 
 	std::cout << "GLFW Initialization Status: " + std::to_string(success) << std::endl;
 }
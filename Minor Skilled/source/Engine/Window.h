@@ -8,7 +8,7 @@
 
 class Window {
 	public:
-		Window(unsigned int width, unsigned int height, unsigned int startXPos, unsigned int startYPos, std::string name);
+		Window(unsigned int width, unsigned int height, unsigned int startXPos, unsigned int startYPos, std::string name, bool visible = true); //invisible windows only provide a context, e.g. for the asset cooker
 		~Window();
 
 		static unsigned int ScreenWidth;
@@ -28,7 +28,7 @@ class Window {
 
 		static void _framebufferSizeCallback(GLFWwindow* window, int width, int height); //needs to be static to be passed into GLFW
 
-		void _initializeGLFW();
+		void _initializeGLFW(bool visible);
 		void _initializeWindow(std::string name, unsigned int xStartPos, unsigned int yStartPos);
 		void _initializeGLAD();
 };
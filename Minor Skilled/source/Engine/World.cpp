@@ -1,6 +1,7 @@
 #include "World.h"
 
 #include "../Engine/Node.h"
+#include "../Engine/JobSystem.h"
 
 World::World() {
 }
@@ -37,8 +38,30 @@ void World::removeChild(Node* node) {
 void World::update(std::vector<Node*>& renderables, std::vector<Node*>& lights) {
 	glm::mat4 worldModel = glm::mat4(1.0f);
 
-	for(unsigned int i = 0; i < _children.size(); i++) {
-		_children[i]->update(worldModel, renderables, lights);
+	unsigned int childCount = _children.size();
+
+	_subtreeRenderables.resize(childCount);
+	_subtreeLights.resize(childCount);
+
+	//every root node subtree is independent, so update them in parallel
+	//the components run on the workers and only read the input polled on the main thread before
+	JobCounter counter;
+
+	for(unsigned int i = 0; i < childCount; i++) {
+		_subtreeRenderables[i].clear();
+		_subtreeLights[i].clear();
+
+		JobSystem::Schedule([this, i, &worldModel]() {
+			_children[i]->update(worldModel, _subtreeRenderables[i], _subtreeLights[i]);
+		}, &counter);
+	}
+
+	JobSystem::Wait(&counter);
+
+	//merge the collections in hierarchy order to keep the result deterministic
+	for(unsigned int i = 0; i < childCount; i++) {
+		renderables.insert(renderables.end(), _subtreeRenderables[i].begin(), _subtreeRenderables[i].end());
+		lights.insert(lights.end(), _subtreeLights[i].begin(), _subtreeLights[i].end());
 	}
 }
 
@@ -22,6 +22,10 @@ class World {
 	private:
 		std::vector<Node*> _children;
 
+		//collections filled by the subtree jobs, merged after the update
+		std::vector<std::vector<Node*>> _subtreeRenderables;
+		std::vector<std::vector<Node*>> _subtreeLights;
+
 };
 
 #endif
\ No newline at end of file
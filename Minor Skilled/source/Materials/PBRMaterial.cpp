@@ -2,6 +2,7 @@
 
 #include "../Engine/Shader.h"
 #include "../Engine/Texture.h"
+#include "../Engine/AssetManager.h"
 
 #include "../Utility/Filepath.h"
 #include "../Utility/RenderSettings.h"
@@ -11,17 +12,24 @@ Shader* PBRMaterial::_DeferredShader = nullptr;
 
 PBRMaterial::PBRMaterial(Texture * albedoMap, Texture * normalMap, Texture * metallicMap, Texture * roughnessMap, Texture * aoMap, BlendMode blendMode) : Material(MaterialType::PBR, blendMode, true),
 _albedoMap(albedoMap), _normalMap(normalMap), _metallicMap(metallicMap), _roughnessMap(roughnessMap), _aoMap(aoMap), _emissionMap(nullptr), _heightMap(nullptr), _F0(glm::vec3(0.04f)), _refractionFactor(0.0f), _heightScale(0.0f), _flipNormals(false) {
+	AssetManager::Retain(_albedoMap);
+	AssetManager::Retain(_normalMap);
+	AssetManager::Retain(_metallicMap);
+	AssetManager::Retain(_roughnessMap);
+	AssetManager::Retain(_aoMap);
+
 	_initShader();
 }
 
 PBRMaterial::~PBRMaterial() {
-	delete _albedoMap;
-	delete _normalMap;
-	delete _metallicMap;
-	delete _roughnessMap;
-	delete _aoMap;
-	delete _emissionMap;
-	delete _heightMap;
+	//the textures can be shared with other materials
+	AssetManager::Release(_albedoMap);
+	AssetManager::Release(_normalMap);
+	AssetManager::Release(_metallicMap);
+	AssetManager::Release(_roughnessMap);
+	AssetManager::Release(_aoMap);
+	AssetManager::Release(_emissionMap);
+	AssetManager::Release(_heightMap);
 }
 
 Texture * PBRMaterial::getAlbedoMap() {
@@ -69,30 +77,51 @@ bool & PBRMaterial::getFlipNormals() {
 }
 
 void PBRMaterial::setAlbedoMap(Texture * albedoMap) {
+	AssetManager::Retain(albedoMap);
+	AssetManager::Release(_albedoMap);
+
 	_albedoMap = albedoMap;
 }
 
 void PBRMaterial::setNormalMap(Texture * normalMap) {
+	AssetManager::Retain(normalMap);
+	AssetManager::Release(_normalMap);
+
 	_normalMap = normalMap;
 }
 
 void PBRMaterial::setMetallicMap(Texture * metallicMap) {
+	AssetManager::Retain(metallicMap);
+	AssetManager::Release(_metallicMap);
+
 	_metallicMap = metallicMap;
 }
 
 void PBRMaterial::setRoughnessMap(Texture * roughnessMap) {
+	AssetManager::Retain(roughnessMap);
+	AssetManager::Release(_roughnessMap);
+
 	_roughnessMap = roughnessMap;
 }
 
 void PBRMaterial::setAoMap(Texture * aoMap) {
+	AssetManager::Retain(aoMap);
+	AssetManager::Release(_aoMap);
+
 	_aoMap = aoMap;
 }
 
 void PBRMaterial::setEmissionMap(Texture * emissionMap) {
+	AssetManager::Retain(emissionMap);
+	AssetManager::Release(_emissionMap);
+
 	_emissionMap = emissionMap;
 }
 
 void PBRMaterial::setHeightMap(Texture * heightMap) {
+	AssetManager::Retain(heightMap);
+	AssetManager::Release(_heightMap);
+
 	_heightMap = heightMap;
 }
 
@@ -112,6 +141,16 @@ void PBRMaterial::setFlipNormals(bool value) {
 	_flipNormals = value;
 }
 
+void PBRMaterial::getTextures(std::vector<Texture*>& textures) {
+	if(_albedoMap != nullptr) textures.push_back(_albedoMap);
+	if(_normalMap != nullptr) textures.push_back(_normalMap);
+	if(_metallicMap != nullptr) textures.push_back(_metallicMap);
+	if(_roughnessMap != nullptr) textures.push_back(_roughnessMap);
+	if(_aoMap != nullptr) textures.push_back(_aoMap);
+	if(_emissionMap != nullptr) textures.push_back(_emissionMap);
+	if(_heightMap != nullptr) textures.push_back(_heightMap);
+}
+
 void PBRMaterial::drawSimple(Shader * shader) {
 	//set environment shader properties
 	shader->setBool("useTexture", true);
@@ -199,6 +238,7 @@ void PBRMaterial::drawForward(glm::mat4& modelMatrix) {
 	_ForwardShader->setBool("material.flipNormals", _flipNormals);
 
 	_ForwardShader->setFloat("maxReflectionLod", (float)(RenderSettings::MaxMipLevels - 1));
+	_setReflectionProbes(_ForwardShader);
 }
 
 void PBRMaterial::drawDeferred(glm::mat4 & modelMatrix) {
@@ -279,6 +319,7 @@ void PBRMaterial::drawDeferred(glm::mat4 & modelMatrix) {
 	_DeferredShader->setBool("material.flipNormals", _flipNormals);
 
 	_DeferredShader->setFloat("maxReflectionLod", (float)(RenderSettings::MaxMipLevels - 1));
+	_setReflectionProbes(_DeferredShader);
 }
 
 void PBRMaterial::_initShader() {
@@ -294,10 +335,13 @@ void PBRMaterial::_initShader() {
 		_ForwardShader->setInt("material.emission", 5);
 		_ForwardShader->setInt("material.height", 6);
 
-		_ForwardShader->setInt("irradianceMap", 8);
-		_ForwardShader->setInt("prefilterMap", 9);
+		_ForwardShader->setInt("prefilterMaps", 9);
 		_ForwardShader->setInt("brdfLUT", 10);
 
+		for(unsigned int i = 0; i < 3; i++) {
+			_ForwardShader->setInt("irradianceVolume[" + std::to_string(i) + "]", 17 + i); //after the shadow maps
+		}
+
 		_ForwardShader->setInt("shadowMap", 11); //assign to slot 10, so that it shares it with the other materials which have more textures
 
 		for(unsigned int i = 0; i < RenderSettings::MaxCubeShadows; i++) {
@@ -306,6 +350,7 @@ void PBRMaterial::_initShader() {
 
 		_ForwardShader->setUniformBlockBinding("matricesBlock", 0); //set uniform block "matrices" to binding point 0
 		_ForwardShader->setUniformBlockBinding("dataBlock", 1); //set uniform block "data" to binding point 1
+		_ForwardShader->setUniformBlockBinding("probesBlock", 2); //set uniform block "probes" to binding point 2
 
 		_ForwardShader->setShaderStorageBlockBinding("lightsBlock", 2); //set shader storage block "lights" to binding point 2
 	}
@@ -322,10 +367,10 @@ void PBRMaterial::_initShader() {
 		_DeferredShader->setInt("material.emission", 5);
 		_DeferredShader->setInt("material.height", 6);
 
-		_DeferredShader->setInt("irradianceMap", 8);
-		_DeferredShader->setInt("prefilterMap", 9);
+		_DeferredShader->setInt("prefilterMaps", 9);
 
 		_DeferredShader->setUniformBlockBinding("matricesBlock", 0); //set uniform block "matrices" to binding point 0
 		_DeferredShader->setUniformBlockBinding("dataBlock", 1); //set uniform block "data" to binding point 1
+		_DeferredShader->setUniformBlockBinding("probesBlock", 2); //set uniform block "probes" to binding point 2
 	}
 }
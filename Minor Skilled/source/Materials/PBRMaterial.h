@@ -35,6 +35,8 @@ class PBRMaterial : public Material {
 		void setHeightScale(float heightScale);
 		void setFlipNormals(bool value);
 
+		virtual void getTextures(std::vector<Texture*>& textures);
+
 		virtual void drawSimple(Shader* shader);
 		virtual void drawForward(glm::mat4& modelMatrix);
 		virtual void drawDeferred(glm::mat4& modelMatrix);
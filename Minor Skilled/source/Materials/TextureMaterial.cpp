@@ -4,6 +4,7 @@
 
 #include "../Engine/Texture.h"
 #include "../Engine/Shader.h"
+#include "../Engine/AssetManager.h"
 
 #include "../Components/LightComponent.h"
 
@@ -14,22 +15,29 @@ Shader* TextureMaterial::_ForwardShader = nullptr;
 Shader* TextureMaterial::_DeferredShader = nullptr;
 
 TextureMaterial::TextureMaterial(Texture* diffuseMap, BlendMode blendMode) :Material(MaterialType::Textures, blendMode, true), _diffuseMap(diffuseMap), _specularMap(nullptr),
-_normalMap(nullptr), _emissionMap(nullptr), _heightMap(nullptr), _shininess(32.0f), _refractionFactor(0.0f), _heightScale(0.0f), _flipNormals(false) {
+_normalMap(nullptr), _emissionMap(nullptr), _reflectionMap(nullptr), _heightMap(nullptr), _shininess(32.0f), _refractionFactor(0.0f), _heightScale(0.0f), _flipNormals(false) {
+	AssetManager::Retain(_diffuseMap);
+
 	_initShader();
 }
 
 TextureMaterial::TextureMaterial(Texture * diffuseMap, Texture * specularMap, Texture * normalMap, BlendMode blendMode) :
-	Material(MaterialType::Textures, blendMode, true),_diffuseMap(diffuseMap), _specularMap(specularMap), _normalMap(normalMap), _emissionMap(nullptr), _reflectionMap(nullptr), _heightMap(nullptr), _shininess(32.0f), _refractionFactor(0.0f), _heightScale(0.0f) {
+	Material(MaterialType::Textures, blendMode, true),_diffuseMap(diffuseMap), _specularMap(specularMap), _normalMap(normalMap), _emissionMap(nullptr), _reflectionMap(nullptr), _heightMap(nullptr), _shininess(32.0f), _refractionFactor(0.0f), _heightScale(0.0f), _flipNormals(false) {
+	AssetManager::Retain(_diffuseMap);
+	AssetManager::Retain(_specularMap);
+	AssetManager::Retain(_normalMap);
+
 	_initShader();
 }
 
 TextureMaterial::~TextureMaterial() {
-	delete _diffuseMap;
-	delete _specularMap;
-	delete _normalMap;
-	delete _emissionMap;
-	delete _reflectionMap;
-	delete _heightMap;
+	//the textures can be shared with other materials
+	AssetManager::Release(_diffuseMap);
+	AssetManager::Release(_specularMap);
+	AssetManager::Release(_normalMap);
+	AssetManager::Release(_emissionMap);
+	AssetManager::Release(_reflectionMap);
+	AssetManager::Release(_heightMap);
 }
 
 Texture * TextureMaterial::getDiffuseMap() {
@@ -73,26 +81,44 @@ bool & TextureMaterial::getFlipNormals() {
 }
 
 void TextureMaterial::setDiffuseMap(Texture* diffuseMap) {
+	AssetManager::Retain(diffuseMap);
+	AssetManager::Release(_diffuseMap);
+
 	_diffuseMap = diffuseMap;
 }
 
 void TextureMaterial::setSpecularMap(Texture* specularMap) {
+	AssetManager::Retain(specularMap);
+	AssetManager::Release(_specularMap);
+
 	_specularMap = specularMap;
 }
 
 void TextureMaterial::setNormalMap(Texture* normalMap) {
+	AssetManager::Retain(normalMap);
+	AssetManager::Release(_normalMap);
+
 	_normalMap = normalMap;
 }
 
 void TextureMaterial::setEmissionMap(Texture * emissionMap) {
+	AssetManager::Retain(emissionMap);
+	AssetManager::Release(_emissionMap);
+
 	_emissionMap = emissionMap;
 }
 
 void TextureMaterial::setHeightMap(Texture * heightMap) {
+	AssetManager::Retain(heightMap);
+	AssetManager::Release(_heightMap);
+
 	_heightMap = heightMap;
 }
 
 void TextureMaterial::setReflectionMap(Texture * reflectionMap) {
+	AssetManager::Retain(reflectionMap);
+	AssetManager::Release(_reflectionMap);
+
 	_reflectionMap = reflectionMap;
 }
 
@@ -112,6 +138,15 @@ void TextureMaterial::setFlipNormals(bool value) {
 	_flipNormals = value;
 }
 
+void TextureMaterial::getTextures(std::vector<Texture*>& textures) {
+	if(_diffuseMap != nullptr) textures.push_back(_diffuseMap);
+	if(_specularMap != nullptr) textures.push_back(_specularMap);
+	if(_normalMap != nullptr) textures.push_back(_normalMap);
+	if(_emissionMap != nullptr) textures.push_back(_emissionMap);
+	if(_heightMap != nullptr) textures.push_back(_heightMap);
+	if(_reflectionMap != nullptr) textures.push_back(_reflectionMap);
+}
+
 void TextureMaterial::drawSimple(Shader* shader) {
 	//set environment shader properties
 	shader->setBool("useTexture", true);
@@ -191,6 +226,8 @@ void TextureMaterial::drawForward(glm::mat4& modelMatrix) {
 	_ForwardShader->setBool("material.flipNormals", _flipNormals);
 
 	_ForwardShader->setInt("material.blendMode", _blendMode);
+
+	_setReflectionProbes(_ForwardShader);
 }
 
 void TextureMaterial::drawDeferred(glm::mat4 & modelMatrix) {
@@ -262,6 +299,8 @@ void TextureMaterial::drawDeferred(glm::mat4 & modelMatrix) {
 	_DeferredShader->setFloat("material.refractionFactor", _refractionFactor);
 	_DeferredShader->setFloat("material.heightScale", _heightScale);
 	_DeferredShader->setBool("material.flipNormals", _flipNormals);
+
+	_setReflectionProbes(_DeferredShader);
 }
 
 void TextureMaterial::_initShader() {
@@ -277,7 +316,7 @@ void TextureMaterial::_initShader() {
 		_ForwardShader->setInt("material.reflection", 4);
 		_ForwardShader->setInt("material.height", 5);
 
-		_ForwardShader->setInt("environmentMap", 8);
+		_ForwardShader->setInt("environmentMaps", 7);
 		_ForwardShader->setInt("shadowMap", 11); //assign to slot 11, so that it shares it with the other materials which have more textures
 
 		for(unsigned int i = 0; i < RenderSettings::MaxCubeShadows; i++) {
@@ -286,6 +325,7 @@ void TextureMaterial::_initShader() {
 
 		_ForwardShader->setUniformBlockBinding("matricesBlock", 0); //set uniform block "matrices" to binding point 0
 		_ForwardShader->setUniformBlockBinding("dataBlock", 1); //set uniform block "data" to binding point 1
+		_ForwardShader->setUniformBlockBinding("probesBlock", 2); //set uniform block "probes" to binding point 2
 
 		_ForwardShader->setShaderStorageBlockBinding("lightsBlock", 2); //set shader storage block "lights" to binding point 2
 	}
@@ -301,9 +341,10 @@ void TextureMaterial::_initShader() {
 		_DeferredShader->setInt("material.reflection", 4);
 		_DeferredShader->setInt("material.height", 5);
 
-		_DeferredShader->setInt("environmentMap", 8);
+		_DeferredShader->setInt("environmentMaps", 7);
 
 		_DeferredShader->setUniformBlockBinding("matricesBlock", 0); //set uniform block "matrices" to binding point 0
 		_DeferredShader->setUniformBlockBinding("dataBlock", 1); //set uniform block "data" to binding point 1
+		_DeferredShader->setUniformBlockBinding("probesBlock", 2); //set uniform block "probes" to binding point 2
 	}
 }
\ No newline at end of file
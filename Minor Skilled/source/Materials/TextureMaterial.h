@@ -42,6 +42,8 @@ class TextureMaterial : public Material {
 		void setHeightScale(float heightScale);
 		void setFlipNormals(bool value);
 
+		virtual void getTextures(std::vector<Texture*>& textures);
+
 		virtual void drawSimple(Shader* shader);
 		virtual void drawForward(glm::mat4& modelMatrix);
 		virtual void drawDeferred(glm::mat4& modelMatrix);
@@ -0,0 +1,39 @@
+#include "BinaryScene.h"
+
+#include <iostream>
+
+#include "../Engine/SceneManager.h"
+#include "../Engine/SceneFile.h"
+#include "../Engine/World.h"
+
+BinaryScene::BinaryScene(std::string path, Scene* sourceScene):Scene(), _path(path), _sourceScene(sourceScene) {
+}
+
+BinaryScene::~BinaryScene() {
+	delete _sourceScene;
+}
+
+void BinaryScene::initializeScene(World* world, SceneManager* manager) {
+	std::cout << "Initializing Scene from " + _path << std::endl;
+
+	//files generated from the source scene are rebuilt once the source scene changes
+	unsigned int sourceVersion = (_sourceScene != nullptr) ? _sourceScene->getVersion() : 0;
+
+	if(SceneFile::Load(_path, world, manager, sourceVersion)) {
+		std::cout << "Scene initialized" << std::endl;
+		return;
+	}
+
+	if(_sourceScene == nullptr) {
+		std::cout << "ERROR: Unable to load the scene file " + _path << std::endl;
+		return;
+	}
+
+	//first run, the source scene changed or the file was removed to rebuild it
+	std::cout << "Building " + _path + " from its source scene" << std::endl;
+
+	world->erase();
+	_sourceScene->initializeScene(world, manager);
+
+	SceneFile::Write(_path, world, manager, sourceVersion);
+}
\ No newline at end of file
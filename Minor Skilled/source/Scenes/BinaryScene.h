@@ -0,0 +1,22 @@
+#ifndef BINARYSCENE_H
+#define BINARYSCENE_H
+
+#include <string>
+
+#include "../Engine/Scene.h"
+
+//scene loaded from a scene file, it is built by the source scene and exported if there is none yet or the source scene changed since
+class BinaryScene: public Scene {
+	public:
+		BinaryScene(std::string path, Scene* sourceScene = nullptr);
+		~BinaryScene();
+
+		virtual void initializeScene(World* world, SceneManager* manager);
+
+	private:
+		std::string _path;
+		Scene* _sourceScene;
+
+};
+
+#endif
\ No newline at end of file
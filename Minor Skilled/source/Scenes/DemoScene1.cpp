@@ -14,6 +14,7 @@
 #include "../Engine/Transform.h"
 #include "../Engine/Model.h"
 #include "../Engine/Renderer.h"
+#include "../Engine/AssetManager.h"
 
 #include "../Components/CameraComponent.h"
 #include "../Components/RenderComponent.h"
@@ -27,12 +28,18 @@
 #include "../Utility/LightType.h"
 #include "../Utility/BlendMode.h"
 
+const unsigned int DemoScene1::_Version = 1; //increase whenever the content of the scene changes, its generated scene file is rebuilt then
+
 DemoScene1::DemoScene1():Scene() {
 }
 
 DemoScene1::~DemoScene1() {
 }
 
+unsigned int DemoScene1::getVersion() {
+	return _Version;
+}
+
 void DemoScene1::initializeScene(World* world, SceneManager* manager) {
 	std::cout << "Initializing Scene" << std::endl;
 
@@ -123,57 +130,55 @@ void DemoScene1::initializeScene(World* world, SceneManager* manager) {
 	//load models
 	std::cout << "Loading models..." << std::endl;
 
-	Model* planeModel = Model::LoadModel(Filepath::ModelPath + "plane.obj");
+	Model* planeModel = AssetManager::LoadModel(Filepath::ModelPath + "plane.obj");
 
-	Model* nyraHead = Model::LoadModel(Filepath::ModelPath + "nyra/nyra head.obj");
-	Model* nyraBody = Model::LoadModel(Filepath::ModelPath + "nyra/nyra body.obj");
+	Model* nyraHead = AssetManager::LoadModel(Filepath::ModelPath + "nyra/nyra head.obj");
+	Model* nyraBody = AssetManager::LoadModel(Filepath::ModelPath + "nyra/nyra body.obj");
 
-	Model* fernModel = Model::LoadModel(Filepath::ModelPath + "plants/FernBranch001.obj");
-	Model* grassModel1 = Model::LoadModel(Filepath::ModelPath + "plants/GrassBlade001.obj");
-	Model* grassModel2 = Model::LoadModel(Filepath::ModelPath + "plants/GrassBlade002.obj");
+	Model* fernModel = AssetManager::LoadModel(Filepath::ModelPath + "plants/FernBranch001.obj");
+	Model* grassModel1 = AssetManager::LoadModel(Filepath::ModelPath + "plants/GrassBlade001.obj");
+	Model* grassModel2 = AssetManager::LoadModel(Filepath::ModelPath + "plants/GrassBlade002.obj");
 
-	Model* rockModel = Model::LoadModel(Filepath::ModelPath + "rock/rock.obj");
-	Model* benchModel = Model::LoadModel(Filepath::ModelPath + "bench/bench.obj");
-	Model* stumpModel = Model::LoadModel(Filepath::ModelPath + "stump/stump.obj");
-	Model* logModel = Model::LoadModel(Filepath::ModelPath + "log/log.obj");
+	Model* rockModel = AssetManager::LoadModel(Filepath::ModelPath + "rock/rock.obj");
+	Model* benchModel = AssetManager::LoadModel(Filepath::ModelPath + "bench/bench.obj");
+	Model* stumpModel = AssetManager::LoadModel(Filepath::ModelPath + "stump/stump.obj");
+	Model* logModel = AssetManager::LoadModel(Filepath::ModelPath + "log/log.obj");
 
 	//load textures
 	std::cout << "Loading textures..." << std::endl;
 
-	Texture* planeDiffuse = Texture::LoadTexture(Filepath::TexturePath + "pbr/grass/albedo.png", TextureFilter::Repeat, true);
-	Texture* planeNormal = Texture::LoadTexture(Filepath::TexturePath + "pbr/grass/normal.png", TextureFilter::Repeat);
+	Texture* planeDiffuse = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/grass/albedo.png", TextureFilter::Repeat, true);
+	Texture* planeNormal = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/grass/normal.png", TextureFilter::Repeat);
 
-	Texture* headDiffuse = Texture::LoadTexture(Filepath::ModelPath + "nyra/head_d.png", TextureFilter::Repeat, true);
-	Texture* headSpecular = Texture::LoadTexture(Filepath::ModelPath + "nyra/head_s.png", TextureFilter::Repeat);
-	Texture* headNormal = Texture::LoadTexture(Filepath::ModelPath + "nyra/head_n.png", TextureFilter::Repeat);
+	Texture* headDiffuse = AssetManager::LoadTexture(Filepath::ModelPath + "nyra/head_d.png", TextureFilter::Repeat, true);
+	Texture* headSpecular = AssetManager::LoadTexture(Filepath::ModelPath + "nyra/head_s.png", TextureFilter::Repeat);
+	Texture* headNormal = AssetManager::LoadTexture(Filepath::ModelPath + "nyra/head_n.png", TextureFilter::Repeat);
 
-	Texture* bodyDiffuse = Texture::LoadTexture(Filepath::ModelPath + "nyra/body_d.png", TextureFilter::Repeat, true);
-	Texture* bodySpecular = Texture::LoadTexture(Filepath::ModelPath + "nyra/body_s.png", TextureFilter::Repeat);
-	Texture* bodyNormal = Texture::LoadTexture(Filepath::ModelPath + "nyra/body_n.png", TextureFilter::Repeat);
+	Texture* bodyDiffuse = AssetManager::LoadTexture(Filepath::ModelPath + "nyra/body_d.png", TextureFilter::Repeat, true);
+	Texture* bodySpecular = AssetManager::LoadTexture(Filepath::ModelPath + "nyra/body_s.png", TextureFilter::Repeat);
+	Texture* bodyNormal = AssetManager::LoadTexture(Filepath::ModelPath + "nyra/body_n.png", TextureFilter::Repeat);
 
-	Texture* fernDiffuse = Texture::LoadTexture(Filepath::ModelPath + "plants/FernBranch001_COL_1K.png", TextureFilter::Repeat, true);
-	Texture* grass1Diffuse = Texture::LoadTexture(Filepath::ModelPath + "plants/GrassBlades001_COL_1K.png", TextureFilter::Repeat, true);
-	Texture* grass2Diffuse = Texture::LoadTexture(Filepath::ModelPath + "plants/GrassBlades002_COL_1K.png", TextureFilter::Repeat, true);
+	Texture* fernDiffuse = AssetManager::LoadTexture(Filepath::ModelPath + "plants/FernBranch001_COL_1K.png", TextureFilter::Repeat, true);
+	Texture* grass1Diffuse = AssetManager::LoadTexture(Filepath::ModelPath + "plants/GrassBlades001_COL_1K.png", TextureFilter::Repeat, true);
+	Texture* grass2Diffuse = AssetManager::LoadTexture(Filepath::ModelPath + "plants/GrassBlades002_COL_1K.png", TextureFilter::Repeat, true);
 
-	Texture* rockDiffuse = Texture::LoadTexture(Filepath::ModelPath + "rock/Rock-Texture-Surface.jpg", TextureFilter::Repeat, true);
+	Texture* rockDiffuse = AssetManager::LoadTexture(Filepath::ModelPath + "rock/Rock-Texture-Surface.jpg", TextureFilter::Repeat, true);
 
-	Texture* benchDiffuse = Texture::LoadTexture(Filepath::ModelPath + "bench/MexicanDoors_BaseColor.png", TextureFilter::Repeat, true);
-	Texture* benchSpecular = Texture::LoadTexture(Filepath::ModelPath + "bench/MexicanDoors_Glossiness.png", TextureFilter::Repeat);
-	Texture* benchNormal = Texture::LoadTexture(Filepath::ModelPath + "bench/MexicanDoors_Normal.png", TextureFilter::Repeat);
+	Texture* benchDiffuse = AssetManager::LoadTexture(Filepath::ModelPath + "bench/MexicanDoors_BaseColor.png", TextureFilter::Repeat, true);
+	Texture* benchSpecular = AssetManager::LoadTexture(Filepath::ModelPath + "bench/MexicanDoors_Glossiness.png", TextureFilter::Repeat);
+	Texture* benchNormal = AssetManager::LoadTexture(Filepath::ModelPath + "bench/MexicanDoors_Normal.png", TextureFilter::Repeat);
 
-	Texture* stumpDiffuse = Texture::LoadTexture(Filepath::ModelPath + "stump/Birch stump_D.png", TextureFilter::Repeat, true);
-	Texture* stumpNormal = Texture::LoadTexture(Filepath::ModelPath + "stump/Birch stump_N.png", TextureFilter::Repeat);
+	Texture* stumpDiffuse = AssetManager::LoadTexture(Filepath::ModelPath + "stump/Birch stump_D.png", TextureFilter::Repeat, true);
+	Texture* stumpNormal = AssetManager::LoadTexture(Filepath::ModelPath + "stump/Birch stump_N.png", TextureFilter::Repeat);
 
-	Texture* logDiffuse = Texture::LoadTexture(Filepath::ModelPath + "log/log_diffuse.png", TextureFilter::Repeat, true);
-	Texture* logNormal = Texture::LoadTexture(Filepath::ModelPath + "log/log_normal.png", TextureFilter::Repeat);
+	Texture* logDiffuse = AssetManager::LoadTexture(Filepath::ModelPath + "log/log_diffuse.png", TextureFilter::Repeat, true);
+	Texture* logNormal = AssetManager::LoadTexture(Filepath::ModelPath + "log/log_normal.png", TextureFilter::Repeat);
 
-	Texture* brickDiffuse = Texture::LoadTexture(Filepath::TexturePath + "bricks2.jpg", TextureFilter::Repeat, true);
-	Texture* brickNormal = Texture::LoadTexture(Filepath::TexturePath + "bricks2_normal.jpg");
-	Texture* brickHeight = Texture::LoadTexture(Filepath::TexturePath + "bricks2_disp.jpg", TextureFilter::Repeat);
-
-	//load skybox
-	std::cout << "Loading skybox..." << std::endl;
+	Texture* brickDiffuse = AssetManager::LoadTexture(Filepath::TexturePath + "bricks2.jpg", TextureFilter::Repeat, true);
+	Texture* brickNormal = AssetManager::LoadTexture(Filepath::TexturePath + "bricks2_normal.jpg");
+	Texture* brickHeight = AssetManager::LoadTexture(Filepath::TexturePath + "bricks2_disp.jpg", TextureFilter::Repeat);
 
+	//skybox, loaded by the scene manager
 	std::vector<std::string> cubemapFaces{
 		"ocean/right.jpg",
 		"ocean/left.jpg",
@@ -183,8 +188,6 @@ void DemoScene1::initializeScene(World* world, SceneManager* manager) {
 		"ocean/back.jpg",
 	};
 
-	Texture* skybox = Texture::LoadCubemap(cubemapFaces, true); //load skyboxes in linear space
-
 	//create materials
 	TextureMaterial* planeMat = new TextureMaterial(planeDiffuse, nullptr, planeNormal, BlendMode::Opaque);
 
@@ -309,7 +312,7 @@ void DemoScene1::initializeScene(World* world, SceneManager* manager) {
 	//set main camera, (main) directional light and skybox
 	manager->setMainCamera(mainCamera);
 	manager->setDirectionalLight(directionalLight);
-	manager->setSkybox(skybox, false);
+	manager->setSkybox(cubemapFaces);
 
 	std::cout << "Scene initialized" << std::endl;
 }
@@ -9,7 +9,10 @@ class DemoScene1: public Scene {
 		~DemoScene1();
 
 		virtual void initializeScene(World* world, SceneManager* manager);
+		virtual unsigned int getVersion();
 
+	private:
+		static const unsigned int _Version;
 };
 
 #endif
\ No newline at end of file
@@ -14,6 +14,7 @@
 #include "../Engine/Transform.h"
 #include "../Engine/Model.h"
 #include "../Engine/Renderer.h"
+#include "../Engine/AssetManager.h"
 
 #include "../Components/CameraComponent.h"
 #include "../Components/RenderComponent.h"
@@ -27,12 +28,18 @@
 #include "../Utility/LightType.h"
 #include "../Utility/BlendMode.h"
 
+const unsigned int DemoScene2::_Version = 1; //increase whenever the content of the scene changes, its generated scene file is rebuilt then
+
 DemoScene2::DemoScene2():Scene() {
 }
 
 DemoScene2::~DemoScene2() {
 }
 
+unsigned int DemoScene2::getVersion() {
+	return _Version;
+}
+
 void DemoScene2::initializeScene(World* world, SceneManager* manager) {
 	std::cout << "Initializing Scene" << std::endl;
 
@@ -92,33 +99,31 @@ void DemoScene2::initializeScene(World* world, SceneManager* manager) {
 	//load models
 	std::cout << "Loading models..." << std::endl;
 
-	Model* cyborgModel = Model::LoadModel(Filepath::ModelPath + "cyborg/cyborg.obj");
-	Model* planeModel = Model::LoadModel(Filepath::ModelPath + "plane.obj");
-	Model* sphereModel = Model::LoadModel(Filepath::ModelPath + "sphere_smooth.obj");
-	Model* suzannaModel = Model::LoadModel(Filepath::ModelPath + "suzanna_smooth.obj");
+	Model* cyborgModel = AssetManager::LoadModel(Filepath::ModelPath + "cyborg/cyborg.obj");
+	Model* planeModel = AssetManager::LoadModel(Filepath::ModelPath + "plane.obj");
+	Model* sphereModel = AssetManager::LoadModel(Filepath::ModelPath + "sphere_smooth.obj");
+	Model* suzannaModel = AssetManager::LoadModel(Filepath::ModelPath + "suzanna_smooth.obj");
 
 	//load textures
 	std::cout << "Loading textures..." << std::endl;
 
-	Texture* cyborgDiffuse = Texture::LoadTexture(Filepath::ModelPath + "cyborg/cyborg_diffuse.png", TextureFilter::Repeat, true); //load diffuse textures in linear space
-	Texture* cyborgSpecular = Texture::LoadTexture(Filepath::ModelPath + "cyborg/cyborg_specular.png", TextureFilter::Repeat);
-	Texture* cyborgNormal = Texture::LoadTexture(Filepath::ModelPath + "cyborg/cyborg_normal.png", TextureFilter::Repeat);
-	Texture* cyborgEmission = Texture::LoadTexture(Filepath::ModelPath + "cyborg/cyborg_emission.png", TextureFilter::Repeat);
-
-	Texture* whiteTexture = Texture::LoadTexture(Filepath::TexturePath + "white.png", TextureFilter::Repeat);
+	Texture* cyborgDiffuse = AssetManager::LoadTexture(Filepath::ModelPath + "cyborg/cyborg_diffuse.png", TextureFilter::Repeat, true); //load diffuse textures in linear space
+	Texture* cyborgSpecular = AssetManager::LoadTexture(Filepath::ModelPath + "cyborg/cyborg_specular.png", TextureFilter::Repeat);
+	Texture* cyborgNormal = AssetManager::LoadTexture(Filepath::ModelPath + "cyborg/cyborg_normal.png", TextureFilter::Repeat);
+	Texture* cyborgEmission = AssetManager::LoadTexture(Filepath::ModelPath + "cyborg/cyborg_emission.png", TextureFilter::Repeat);
 
-	Texture* groundDiffuse = Texture::LoadTexture(Filepath::TexturePath + "wood.png", TextureFilter::Repeat, true);
+	Texture* whiteTexture = AssetManager::LoadTexture(Filepath::TexturePath + "white.png", TextureFilter::Repeat);
 
-	Texture* brickDiffuse = Texture::LoadTexture(Filepath::TexturePath + "brickwall.jpg", TextureFilter::Repeat, true);
-	Texture* brickNormal = Texture::LoadTexture(Filepath::TexturePath + "brickwall_normal.jpg");
+	Texture* groundDiffuse = AssetManager::LoadTexture(Filepath::TexturePath + "wood.png", TextureFilter::Repeat, true);
 
-	Texture* window1Diffuse = Texture::LoadTexture(Filepath::TexturePath + "window.png", TextureFilter::Repeat, true);
-	Texture* window2Diffuse = Texture::LoadTexture(Filepath::TexturePath + "window2.png", TextureFilter::Repeat, true);
+	Texture* brickDiffuse = AssetManager::LoadTexture(Filepath::TexturePath + "brickwall.jpg", TextureFilter::Repeat, true);
+	Texture* brickNormal = AssetManager::LoadTexture(Filepath::TexturePath + "brickwall_normal.jpg");
 
-	//load skybox
-	std::cout << "Loading skybox..." << std::endl;
+	Texture* window1Diffuse = AssetManager::LoadTexture(Filepath::TexturePath + "window.png", TextureFilter::Repeat, true);
+	Texture* window2Diffuse = AssetManager::LoadTexture(Filepath::TexturePath + "window2.png", TextureFilter::Repeat, true);
 
-	Texture* skybox = Texture::LoadHDR(Filepath::SkyboxPath + "Milkyway/Milkyway_Small.hdr");
+	//skybox
+	std::string skyboxPath = Filepath::SkyboxPath + "Milkyway/Milkyway_Small.hdr"; //decoded and converted by the scene manager unless it is cached
 
 	//create materials
 	ColorMaterial* pointLightMat = new ColorMaterial(glm::vec3(1.5f, 1.5f, 0.0f), glm::vec3(1.5f, 1.5f, 0.0f), 0.0f);
@@ -224,7 +229,7 @@ void DemoScene2::initializeScene(World* world, SceneManager* manager) {
 
 	//set main camera, (main) directional light and skybox
 	manager->setMainCamera(mainCamera);
-	manager->setSkybox(skybox, true);
+	manager->setSkybox(skyboxPath);
 
 	std::cout << "Scene initialized" << std::endl;
 }
@@ -9,7 +9,10 @@ class DemoScene2: public Scene {
 		~DemoScene2();
 
 		virtual void initializeScene(World* world, SceneManager* manager);
+		virtual unsigned int getVersion();
 
+	private:
+		static const unsigned int _Version;
 };
 
 #endif
\ No newline at end of file
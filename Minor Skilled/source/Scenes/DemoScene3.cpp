@@ -14,6 +14,7 @@
 #include "../Engine/Transform.h"
 #include "../Engine/Model.h"
 #include "../Engine/Renderer.h"
+#include "../Engine/AssetManager.h"
 
 #include "../Components/CameraComponent.h"
 #include "../Components/RenderComponent.h"
@@ -27,12 +28,18 @@
 #include "../Utility/LightType.h"
 #include "../Utility/BlendMode.h"
 
+const unsigned int DemoScene3::_Version = 1; //increase whenever the content of the scene changes, its generated scene file is rebuilt then
+
 DemoScene3::DemoScene3():Scene() {
 }
 
 DemoScene3::~DemoScene3() {
 }
 
+unsigned int DemoScene3::getVersion() {
+	return _Version;
+}
+
 void DemoScene3::initializeScene(World* world, SceneManager* manager) {
 	std::cout << "Initializing Scene" << std::endl;
 
@@ -84,66 +91,64 @@ void DemoScene3::initializeScene(World* world, SceneManager* manager) {
 	//load models
 	std::cout << "Loading models..." << std::endl;
 
-	Model* planeModel = Model::LoadModel(Filepath::ModelPath + "plane.obj");
-	Model* sphereModel = Model::LoadModel(Filepath::ModelPath + "sphere_smooth.obj");
+	Model* planeModel = AssetManager::LoadModel(Filepath::ModelPath + "plane.obj");
+	Model* sphereModel = AssetManager::LoadModel(Filepath::ModelPath + "sphere_smooth.obj");
 
-	Model* cerberusModel = Model::LoadModel(Filepath::ModelPath + "cerberus/Cerberus_LP.fbx");
+	Model* cerberusModel = AssetManager::LoadModel(Filepath::ModelPath + "cerberus/Cerberus_LP.fbx");
 
 	//load textures
 	std::cout << "Loading textures..." << std::endl;
 
-	Texture* groundAlbedo = Texture::LoadTexture(Filepath::TexturePath + "pbr/metal/albedo.png", TextureFilter::Repeat, true); //load albedo textures in linear space
-	Texture* groundNormal = Texture::LoadTexture(Filepath::TexturePath + "pbr/metal/normal.png", TextureFilter::Repeat);
-	Texture* groundMetallic = Texture::LoadTexture(Filepath::TexturePath + "pbr/metal/metallic.png", TextureFilter::Repeat);
-	Texture* groundRoughness = Texture::LoadTexture(Filepath::TexturePath + "pbr/metal/roughness.png", TextureFilter::Repeat);
-	Texture* groundAo = Texture::LoadTexture(Filepath::TexturePath + "pbr/metal/ao.png", TextureFilter::Repeat);
-
-	Texture* cerberusAlbedo = Texture::LoadTexture(Filepath::ModelPath + "cerberus/Cerberus_A.tga", TextureFilter::Repeat, true);
-	Texture* cerberusNormal = Texture::LoadTexture(Filepath::ModelPath + "cerberus/Cerberus_N.tga", TextureFilter::Repeat);
-	Texture* cerberusMetallic = Texture::LoadTexture(Filepath::ModelPath + "cerberus/Cerberus_M.tga", TextureFilter::Repeat);
-	Texture* cerberusRoughness = Texture::LoadTexture(Filepath::ModelPath + "cerberus/Cerberus_R.tga", TextureFilter::Repeat);
-	Texture* cerberusAo = Texture::LoadTexture(Filepath::ModelPath + "cerberus/Cerberus_AO.tga", TextureFilter::Repeat);
-
-	Texture* goldAlbedo = Texture::LoadTexture(Filepath::TexturePath + "pbr/gold/albedo.png", TextureFilter::Repeat, true); //load albedo textures in linear space
-	Texture* goldNormal = Texture::LoadTexture(Filepath::TexturePath + "pbr/gold/normal.png", TextureFilter::Repeat);
-	Texture* goldMetallic = Texture::LoadTexture(Filepath::TexturePath + "pbr/gold/metallic.png", TextureFilter::Repeat);
-	Texture* goldRoughness = Texture::LoadTexture(Filepath::TexturePath + "pbr/gold/roughness.png", TextureFilter::Repeat);
-	Texture* goldAo = Texture::LoadTexture(Filepath::TexturePath + "pbr/gold/ao.png", TextureFilter::Repeat);
-
-	Texture* fabricAlbedo = Texture::LoadTexture(Filepath::TexturePath + "pbr/fabric/albedo.png", TextureFilter::Repeat, true); //load albedo textures in linear space
-	Texture* fabricNormal = Texture::LoadTexture(Filepath::TexturePath + "pbr/fabric/normal.png", TextureFilter::Repeat);
-	Texture* fabricMetallic = Texture::LoadTexture(Filepath::TexturePath + "pbr/fabric/metallic.png", TextureFilter::Repeat);
-	Texture* fabricRoughness = Texture::LoadTexture(Filepath::TexturePath + "pbr/fabric/roughness.png", TextureFilter::Repeat);
-	Texture* fabricAo = Texture::LoadTexture(Filepath::TexturePath + "pbr/fabric/ao.png", TextureFilter::Repeat);
-
-	Texture* plasticAlbedo = Texture::LoadTexture(Filepath::TexturePath + "pbr/plastic/albedo.png", TextureFilter::Repeat, true); //load albedo textures in linear space
-	Texture* plasticNormal = Texture::LoadTexture(Filepath::TexturePath + "pbr/plastic/normal.png", TextureFilter::Repeat);
-	Texture* plasticMetallic = Texture::LoadTexture(Filepath::TexturePath + "pbr/plastic/metallic.png", TextureFilter::Repeat);
-	Texture* plasticRoughness = Texture::LoadTexture(Filepath::TexturePath + "pbr/plastic/roughness.png", TextureFilter::Repeat);
-	Texture* plasticAo = Texture::LoadTexture(Filepath::TexturePath + "pbr/plastic/ao.png", TextureFilter::Repeat);
-
-	Texture* rustedIronAlbedo = Texture::LoadTexture(Filepath::TexturePath + "pbr/rusted_iron/albedo.png", TextureFilter::Repeat, true); //load albedo textures in linear space
-	Texture* rustedIronNormal = Texture::LoadTexture(Filepath::TexturePath + "pbr/rusted_iron/normal.png", TextureFilter::Repeat);
-	Texture* rustedIronMetallic = Texture::LoadTexture(Filepath::TexturePath + "pbr/rusted_iron/metallic.png", TextureFilter::Repeat);
-	Texture* rustedIronRoughness = Texture::LoadTexture(Filepath::TexturePath + "pbr/rusted_iron/roughness.png", TextureFilter::Repeat);
-	Texture* rustedIronAo = Texture::LoadTexture(Filepath::TexturePath + "pbr/rusted_iron/ao.png", TextureFilter::Repeat);
-
-	Texture* sandAlbedo = Texture::LoadTexture(Filepath::TexturePath + "pbr/sand/albedo.png", TextureFilter::Repeat, true); //load albedo textures in linear space
-	Texture* sandNormal = Texture::LoadTexture(Filepath::TexturePath + "pbr/sand/normal.png", TextureFilter::Repeat);
-	Texture* sandMetallic = Texture::LoadTexture(Filepath::TexturePath + "pbr/sand/metallic.png", TextureFilter::Repeat);
-	Texture* sandRoughness = Texture::LoadTexture(Filepath::TexturePath + "pbr/sand/roughness.png", TextureFilter::Repeat);
-	Texture* sandAo = Texture::LoadTexture(Filepath::TexturePath + "pbr/sand/ao.png", TextureFilter::Repeat);
-
-	Texture* woodAlbedo = Texture::LoadTexture(Filepath::TexturePath + "pbr/wood/albedo.png", TextureFilter::Repeat, true); //load albedo textures in linear space
-	Texture* woodNormal = Texture::LoadTexture(Filepath::TexturePath + "pbr/wood/normal.png", TextureFilter::Repeat);
-	Texture* woodMetallic = Texture::LoadTexture(Filepath::TexturePath + "pbr/wood/metallic.png", TextureFilter::Repeat);
-	Texture* woodRoughness = Texture::LoadTexture(Filepath::TexturePath + "pbr/wood/roughness.png", TextureFilter::Repeat);
-	Texture* woodAo = Texture::LoadTexture(Filepath::TexturePath + "pbr/wood/ao.png", TextureFilter::Repeat);
-
-	//load skybox
-	std::cout << "Loading skybox..." << std::endl;
-
-	Texture* skybox = Texture::LoadHDR(Filepath::SkyboxPath + "Hamarikyu_Bridge_B/14-Hamarikyu_Bridge_B_3k.hdr");
+	Texture* groundAlbedo = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/metal/albedo.png", TextureFilter::Repeat, true); //load albedo textures in linear space
+	Texture* groundNormal = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/metal/normal.png", TextureFilter::Repeat);
+	Texture* groundMetallic = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/metal/metallic.png", TextureFilter::Repeat);
+	Texture* groundRoughness = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/metal/roughness.png", TextureFilter::Repeat);
+	Texture* groundAo = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/metal/ao.png", TextureFilter::Repeat);
+
+	Texture* cerberusAlbedo = AssetManager::LoadTexture(Filepath::ModelPath + "cerberus/Cerberus_A.tga", TextureFilter::Repeat, true);
+	Texture* cerberusNormal = AssetManager::LoadTexture(Filepath::ModelPath + "cerberus/Cerberus_N.tga", TextureFilter::Repeat);
+	Texture* cerberusMetallic = AssetManager::LoadTexture(Filepath::ModelPath + "cerberus/Cerberus_M.tga", TextureFilter::Repeat);
+	Texture* cerberusRoughness = AssetManager::LoadTexture(Filepath::ModelPath + "cerberus/Cerberus_R.tga", TextureFilter::Repeat);
+	Texture* cerberusAo = AssetManager::LoadTexture(Filepath::ModelPath + "cerberus/Cerberus_AO.tga", TextureFilter::Repeat);
+
+	Texture* goldAlbedo = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/gold/albedo.png", TextureFilter::Repeat, true); //load albedo textures in linear space
+	Texture* goldNormal = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/gold/normal.png", TextureFilter::Repeat);
+	Texture* goldMetallic = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/gold/metallic.png", TextureFilter::Repeat);
+	Texture* goldRoughness = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/gold/roughness.png", TextureFilter::Repeat);
+	Texture* goldAo = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/gold/ao.png", TextureFilter::Repeat);
+
+	Texture* fabricAlbedo = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/fabric/albedo.png", TextureFilter::Repeat, true); //load albedo textures in linear space
+	Texture* fabricNormal = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/fabric/normal.png", TextureFilter::Repeat);
+	Texture* fabricMetallic = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/fabric/metallic.png", TextureFilter::Repeat);
+	Texture* fabricRoughness = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/fabric/roughness.png", TextureFilter::Repeat);
+	Texture* fabricAo = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/fabric/ao.png", TextureFilter::Repeat);
+
+	Texture* plasticAlbedo = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/plastic/albedo.png", TextureFilter::Repeat, true); //load albedo textures in linear space
+	Texture* plasticNormal = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/plastic/normal.png", TextureFilter::Repeat);
+	Texture* plasticMetallic = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/plastic/metallic.png", TextureFilter::Repeat);
+	Texture* plasticRoughness = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/plastic/roughness.png", TextureFilter::Repeat);
+	Texture* plasticAo = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/plastic/ao.png", TextureFilter::Repeat);
+
+	Texture* rustedIronAlbedo = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/rusted_iron/albedo.png", TextureFilter::Repeat, true); //load albedo textures in linear space
+	Texture* rustedIronNormal = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/rusted_iron/normal.png", TextureFilter::Repeat);
+	Texture* rustedIronMetallic = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/rusted_iron/metallic.png", TextureFilter::Repeat);
+	Texture* rustedIronRoughness = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/rusted_iron/roughness.png", TextureFilter::Repeat);
+	Texture* rustedIronAo = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/rusted_iron/ao.png", TextureFilter::Repeat);
+
+	Texture* sandAlbedo = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/sand/albedo.png", TextureFilter::Repeat, true); //load albedo textures in linear space
+	Texture* sandNormal = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/sand/normal.png", TextureFilter::Repeat);
+	Texture* sandMetallic = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/sand/metallic.png", TextureFilter::Repeat);
+	Texture* sandRoughness = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/sand/roughness.png", TextureFilter::Repeat);
+	Texture* sandAo = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/sand/ao.png", TextureFilter::Repeat);
+
+	Texture* woodAlbedo = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/wood/albedo.png", TextureFilter::Repeat, true); //load albedo textures in linear space
+	Texture* woodNormal = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/wood/normal.png", TextureFilter::Repeat);
+	Texture* woodMetallic = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/wood/metallic.png", TextureFilter::Repeat);
+	Texture* woodRoughness = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/wood/roughness.png", TextureFilter::Repeat);
+	Texture* woodAo = AssetManager::LoadTexture(Filepath::TexturePath + "pbr/wood/ao.png", TextureFilter::Repeat);
+
+	//skybox
+	std::string skyboxPath = Filepath::SkyboxPath + "Hamarikyu_Bridge_B/14-Hamarikyu_Bridge_B_3k.hdr"; //decoded and converted by the scene manager unless it is cached
 
 	//create materials
 	ColorMaterial* pointLightMat = new ColorMaterial(glm::vec3(1.5f, 1.5f, 0.0f), glm::vec3(1.5f, 1.5f, 0.0f), 0.0f);
@@ -238,7 +243,7 @@ void DemoScene3::initializeScene(World* world, SceneManager* manager) {
 	//set main camera, (main) directional light and skybox
 	manager->setMainCamera(mainCamera);
 	manager->setDirectionalLight(directionalLight);
-	manager->setSkybox(skybox, true);
+	manager->setSkybox(skyboxPath);
 
 	std::cout << "Scene initialized" << std::endl;
 }
@@ -16,6 +16,7 @@
 #include "../../dependencies/imgui/imgui_impl_glfw.h"
 
 #include "../Engine/SceneManager.h"
+#include "../Engine/Renderer.h"
 #include "../Engine/Window.h"
 #include "../Engine/Debug.h"
 #include "../Engine/World.h"
@@ -24,6 +25,8 @@
 #include "../Engine/Material.h"
 #include "../Engine/Model.h"
 #include "../Engine/Texture.h"
+#include "../Engine/Uploader.h"
+#include "../Engine/TextureStreamer.h"
 
 #include "../Components/CameraComponent.h"
 #include "../Components/LightComponent.h"
@@ -35,8 +38,9 @@
 
 #include "../Utility/RenderSettings.h"
 #include "../Utility/Input.h"
+#include "../Utility/Filepath.h"
 
-OverlayUI::OverlayUI(SceneManager* sceneManager, Window* window, Debug* profiler) : _renderUI(true), _profiler(profiler), _sceneManager(sceneManager), _activeNode(nullptr) {
+OverlayUI::OverlayUI(SceneManager* sceneManager, Renderer* renderer, Window* window, Debug* profiler) : _renderUI(true), _profiler(profiler), _sceneManager(sceneManager), _renderer(renderer), _activeNode(nullptr) {
 	_initImgui(window);
 }
 
@@ -63,9 +67,21 @@ void OverlayUI::setupFrame(World* world) {
 		_setupSettings();
 		_setupHierarchy(world);
 		_setupSceneSelection();
+
+		//select objects by clicking on them in the scene
+		if(Input::GetMouseDown(MouseButton::Left) && !ImGui::GetIO().WantCaptureMouse) {
+			glm::dvec2 mousePos = Input::GetCurrentMousePos();
+			Node* pickedNode = _sceneManager->pickNode(glm::vec2(mousePos));
+
+			if(pickedNode != nullptr) _activeNode = pickedNode;
+		}
 	}
 }
 
+void OverlayUI::clearSelection() {
+	_activeNode = nullptr;
+}
+
 void OverlayUI::render() {
 	//render the data we set up
 	ImGui::Render();
@@ -193,6 +209,13 @@ void OverlayUI::_setupSettings() {
 	ImGui::CheckboxFlags("Bloom", &RenderSettings::Options, RenderSettings::Bloom);
 	ImGui::CheckboxFlags("FXAA", &RenderSettings::Options, RenderSettings::FXAA);
 	ImGui::CheckboxFlags("Motion Blur", &RenderSettings::Options, RenderSettings::MotionBlur);
+	ImGui::CheckboxFlags("Occlusion Culling", &RenderSettings::Options, RenderSettings::OcclusionCulling);
+	ImGui::CheckboxFlags("GPU Driven", &RenderSettings::Options, RenderSettings::GPUDriven);
+	ImGui::CheckboxFlags("Level of Detail", &RenderSettings::Options, RenderSettings::LevelOfDetail);
+	ImGui::CheckboxFlags("Compressed Vertices", &RenderSettings::Options, RenderSettings::CompressedVertices);
+	ImGui::CheckboxFlags("Texture Streaming", &RenderSettings::Options, RenderSettings::TextureStreaming);
+	ImGui::CheckboxFlags("Probe Updates", &RenderSettings::Options, RenderSettings::ProbeUpdates);
+	ImGui::CheckboxFlags("Irradiance Volume", &RenderSettings::Options, RenderSettings::IrradianceVolume);
 	ImGui::CheckboxFlags("Deferred", &RenderSettings::Options, RenderSettings::Deferred);
 
 	ImGui::Indent();
@@ -237,6 +260,74 @@ void OverlayUI::_setupSettings() {
 		ImGui::InputFloat("Point Far Plane", &RenderSettings::CubeShadowFarPlane);
 	}
 
+	ImGui::Text("\nLevel of Detail Settings");
+
+	if(ImGui::CollapsingHeader("LOD Selection")) {
+		ImGui::InputFloat("Screen Size", &RenderSettings::LodScreenSize);
+		ImGui::InputFloat("Hysteresis", &RenderSettings::LodHysteresis);
+		ImGui::InputInt("Shadow Bias", &RenderSettings::ShadowLodBias);
+		ImGui::InputInt("Environment Bias", &RenderSettings::EnvironmentLodBias);
+	}
+
+	ImGui::Text("\nStreaming Settings");
+
+	if(ImGui::CollapsingHeader("Uploads")) {
+		ImGui::InputInt("Budget per Frame (KB)", &RenderSettings::UploadBudget);
+		ImGui::Text("Pending: %u KB", Uploader::GetPendingBytes() / 1024);
+		ImGui::Checkbox("Compress Textures", &RenderSettings::CompressTextures);
+	}
+
+	if(ImGui::CollapsingHeader("Texture Streaming")) {
+		ImGui::InputInt("Budget (MB)", &RenderSettings::TextureStreamingBudget);
+		ImGui::Text("Resident: %llu / %llu MB", TextureStreamer::GetResidentMemory() / (1024 * 1024), TextureStreamer::GetFullMemory() / (1024 * 1024));
+		ImGui::Text("Textures: %u", TextureStreamer::GetTextureCount());
+	}
+
+	if(ImGui::CollapsingHeader("Reflection Probes")) {
+		ImGui::InputInt("Steps per Frame", &RenderSettings::ProbeUpdateBudget);
+		ImGui::InputInt("Volume Probes per Frame", &RenderSettings::IrradianceVolumeBudget);
+		ImGui::Checkbox("Incremental Baking", &RenderSettings::IncrementalProbeBaking);
+		ImGui::Checkbox("Measure Prefilter Error", &RenderSettings::MeasurePrefilterError);
+		ImGui::Checkbox("Measure BRDF Error", &RenderSettings::MeasureBrdfError);
+
+		ImGui::Text("Prefilter Quality");
+
+		if(ImGui::Button("Low")) {
+			RenderSettings::PrefilterQuality = RenderSettings::PrefilterLow;
+		}
+
+		ImGui::SameLine();
+
+		if(ImGui::Button("Medium")) {
+			RenderSettings::PrefilterQuality = RenderSettings::PrefilterMedium;
+		}
+
+		ImGui::SameLine();
+
+		if(ImGui::Button("High")) {
+			RenderSettings::PrefilterQuality = RenderSettings::PrefilterHigh;
+		}
+
+		ImGui::SameLine();
+
+		if(ImGui::Button("Reference")) {
+			RenderSettings::PrefilterQuality = RenderSettings::PrefilterReference;
+		}
+	}
+
+	if(ImGui::CollapsingHeader("Render Targets")) {
+		//only the targets of enabled features are allocated
+		std::vector<RenderTargetInfo> infos = _renderer->getRenderTargetInfos();
+		unsigned long long total = 0;
+
+		for(unsigned int i = 0; i < infos.size(); i++) {
+			ImGui::Text("%s: %.1f MB", infos[i].name.c_str(), infos[i].memory / (1024.0f * 1024.0f));
+			total += infos[i].memory;
+		}
+
+		ImGui::Text("Total: %.1f MB", total / (1024.0f * 1024.0f));
+	}
+
 	ImGui::Text("\nPost Processing Settings");
 
 	if(ImGui::CollapsingHeader("Image Correction Settings")) {
@@ -595,6 +686,17 @@ void OverlayUI::_setupSceneSelection() {
 		_sceneManager->queueScene(2);
 	}
 
+	ImGui::SameLine();
+
+	if(ImGui::Button("Export")) {
+		_sceneManager->exportScene(Filepath::ScenePath + "export.scene");
+	}
+
+	if(_sceneManager->isLoading()) {
+		ImGui::SameLine();
+		ImGui::Text("Loading...");
+	}
+
 	ImGui::End();
 }
 
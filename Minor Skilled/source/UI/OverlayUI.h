@@ -8,6 +8,7 @@
 #include <glm\gtc\matrix_transform.hpp>
 
 class SceneManager;
+class Renderer;
 class Window;
 class Debug;
 class World;
@@ -15,15 +16,18 @@ class Node;
 
 class OverlayUI {
 	public:
-		OverlayUI(SceneManager* sceneManager, Window* window, Debug* profiler);
+		OverlayUI(SceneManager* sceneManager, Renderer* renderer, Window* window, Debug* profiler);
 		~OverlayUI();
 
 		void setupFrame(World* world);
 		void render();
 
+		void clearSelection(); //the selected node is about to be deleted
+
 	private:
 		Debug* _profiler;
 		SceneManager* _sceneManager;
+		Renderer* _renderer;
 
 		Node* _activeNode;
 
@@ -0,0 +1,85 @@
+#include "AABB.h"
+
+#include <algorithm>
+#include <limits>
+
+AABB::AABB(): min(glm::vec3(std::numeric_limits<float>::max())), max(glm::vec3(-std::numeric_limits<float>::max())) {
+}
+
+AABB::AABB(glm::vec3 minimum, glm::vec3 maximum): min(minimum), max(maximum) {
+}
+
+bool AABB::isValid() const {
+	return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+}
+
+glm::vec3 AABB::getCenter() const {
+	return (min + max) * 0.5f;
+}
+
+glm::vec3 AABB::getExtents() const {
+	return (max - min) * 0.5f;
+}
+
+float AABB::getSurfaceArea() const {
+	if(!isValid()) return 0.0f;
+
+	glm::vec3 size = max - min;
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+float AABB::getDistance2(glm::vec3 point) const {
+	//squared distance from the point to the closest point on the box, 0 if it is inside
+	glm::vec3 closestPoint = glm::clamp(point, min, max);
+	glm::vec3 difference = point - closestPoint;
+
+	return glm::dot(difference, difference);
+}
+
+void AABB::expand(glm::vec3 point) {
+	min = glm::min(min, point);
+	max = glm::max(max, point);
+}
+
+void AABB::expand(const AABB& other) {
+	min = glm::min(min, other.min);
+	max = glm::max(max, other.max);
+}
+
+bool AABB::contains(const AABB& other) const {
+	return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z && max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+}
+
+bool AABB::intersectsSphere(glm::vec3 center, float radius) const {
+	return getDistance2(center) <= radius * radius;
+}
+
+bool AABB::intersectsRay(glm::vec3 origin, glm::vec3 inverseDirection, float maxDistance, float& distance) const {
+	//slab test
+	glm::vec3 t1 = (min - origin) * inverseDirection;
+	glm::vec3 t2 = (max - origin) * inverseDirection;
+
+	glm::vec3 tMin = glm::min(t1, t2);
+	glm::vec3 tMax = glm::max(t1, t2);
+
+	float enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+	float exit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+
+	if(enter > exit) return false;
+
+	distance = enter;
+	return true;
+}
+
+AABB AABB::transform(const glm::mat4& matrix) const {
+	if(!isValid()) return AABB();
+
+	//transform center and extents separately, the absolute matrix yields the new extents (Arvo)
+	glm::vec3 center = glm::vec3(matrix * glm::vec4(getCenter(), 1.0f));
+	glm::vec3 extents = getExtents();
+
+	glm::mat3 absoluteMatrix = glm::mat3(glm::abs(glm::vec3(matrix[0])), glm::abs(glm::vec3(matrix[1])), glm::abs(glm::vec3(matrix[2])));
+	glm::vec3 newExtents = absoluteMatrix * extents;
+
+	return AABB(center - newExtents, center + newExtents);
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#ifndef AABB_H
+#define AABB_H
+
+#include <glm/glm.hpp>
+
+class AABB {
+	public:
+		AABB();
+		AABB(glm::vec3 minimum, glm::vec3 maximum);
+
+		glm::vec3 min;
+		glm::vec3 max;
+
+		bool isValid() const;
+		glm::vec3 getCenter() const;
+		glm::vec3 getExtents() const;
+		float getSurfaceArea() const;
+		float getDistance2(glm::vec3 point) const;
+
+		void expand(glm::vec3 point);
+		void expand(const AABB& other);
+
+		bool contains(const AABB& other) const;
+		bool intersectsSphere(glm::vec3 center, float radius) const;
+		bool intersectsRay(glm::vec3 origin, glm::vec3 inverseDirection, float maxDistance, float& distance) const;
+
+		AABB transform(const glm::mat4& matrix) const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,13 @@
+#ifndef BLOCKFORMAT_H
+#define BLOCKFORMAT_H
+
+//block compression formats textures are cooked into
+enum BlockFormat {
+	BC1, //rgb, 4 bits per pixel
+	BC3, //rgba, 8 bits per pixel
+	BC4, //single channel, 4 bits per pixel
+	BC5, //two channels, 8 bits per pixel
+	BC7 //rgba in high quality, 8 bits per pixel
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "BrdfIntegrator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../Engine/JobSystem.h"
+
+#include "../Utility/Math.h"
+
+void BrdfIntegrator::Integrate(unsigned int size, unsigned int sampleCount, std::vector<float>& lut) {
+	lut.assign(size * size * 2, 0.0f);
+	float* output = &lut[0];
+
+	//every texel sums its samples in the same order on its own, so the threads never change the result
+	JobSystem::ParallelFor(size, 8, [output, size, sampleCount](unsigned int start, unsigned int end) {
+		std::vector<glm::vec3> halfways;
+
+		for(unsigned int y = start; y < end; y++) {
+			//texel centers, like the texture coordinates of the screen quad
+			float roughness = ((float)y + 0.5f) / (float)size;
+			_SampleHalfways(roughness, sampleCount, halfways);
+
+			for(unsigned int x = 0; x < size; x++) {
+				float NdotV = ((float)x + 0.5f) / (float)size;
+				_IntegrateTexel(NdotV, roughness, halfways, &output[(y * size + x) * 2]);
+			}
+		}
+	});
+}
+
+void BrdfIntegrator::_SampleHalfways(float roughness, unsigned int sampleCount, std::vector<glm::vec3>& halfways) {
+	halfways.resize(sampleCount);
+
+	for(unsigned int i = 0; i < sampleCount; i++) {
+		glm::vec3 halfway = Math::ImportanceSampleGGX(Math::Hammersley(i, sampleCount), roughness);
+
+		//the shader builds its tangent space around the normal (0, 0, 1) from the x axis, which maps x to -y and y to x
+		halfways[i] = glm::vec3(halfway.y, -halfway.x, halfway.z);
+	}
+}
+
+void BrdfIntegrator::_IntegrateTexel(float NdotV, float roughness, const std::vector<glm::vec3>& halfways, float* texel) {
+	glm::vec3 view(std::sqrt(1.0f - NdotV * NdotV), 0.0f, NdotV);
+
+	//schlick ggx with the remapping for image based lighting
+	float k = (roughness * roughness) / 2.0f;
+	float geometryView = NdotV / (NdotV * (1.0f - k) + k);
+
+	float scale = 0.0f;
+	float bias = 0.0f;
+
+	for(unsigned int i = 0; i < halfways.size(); i++) {
+		const glm::vec3& halfway = halfways[i];
+
+		glm::vec3 light = glm::normalize(2.0f * glm::dot(view, halfway) * halfway - view);
+
+		float NdotL = std::max(light.z, 0.0f);
+		float NdotH = std::max(halfway.z, 0.0f);
+		float VdotH = std::max(glm::dot(view, halfway), 0.0f);
+
+		if(NdotL > 0.0f) {
+			float geometry = NdotL / (NdotL * (1.0f - k) + k) * geometryView;
+			float visibility = (geometry * VdotH) / (NdotH * NdotV);
+			float fresnel = std::pow(1.0f - VdotH, 5.0f);
+
+			scale += (1.0f - fresnel) * visibility;
+			bias += fresnel * visibility;
+		}
+	}
+
+	texel[0] = scale / (float)halfways.size();
+	texel[1] = bias / (float)halfways.size();
+}
\ No newline at end of file
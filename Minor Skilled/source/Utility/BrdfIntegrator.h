@@ -0,0 +1,19 @@
+#ifndef BRDFINTEGRATOR_H
+#define BRDFINTEGRATOR_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+//cpu version of the split sum brdf integration in brdf.fs, the rows are integrated on the job system workers
+class BrdfIntegrator {
+	public:
+		//scale and bias per texel with NdotV along x and roughness along y, the same for any thread count
+		static void Integrate(unsigned int size, unsigned int sampleCount, std::vector<float>& lut);
+
+	private:
+		static void _SampleHalfways(float roughness, unsigned int sampleCount, std::vector<glm::vec3>& halfways);
+		static void _IntegrateTexel(float NdotV, float roughness, const std::vector<glm::vec3>& halfways, float* texel);
+};
+
+#endif
\ No newline at end of file
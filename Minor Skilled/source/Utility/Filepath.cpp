@@ -1,6 +1,140 @@
 #include "../Utility/Filepath.h"
 
+#include <vector>
+#include <fstream>
+#include <cctype>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
 const std::string Filepath::ShaderPath = "assets/shaders/";
 const std::string Filepath::ModelPath = "assets/models/";
 const std::string Filepath::TexturePath = "assets/textures/";
-const std::string Filepath::SkyboxPath = "assets/skyboxes/";
\ No newline at end of file
+const std::string Filepath::SkyboxPath = "assets/skyboxes/";
+const std::string Filepath::CachePath = "assets/cache/";
+const std::string Filepath::ScenePath = "assets/scenes/";
+
+std::string Filepath::GetCachePath(std::string sourcePath, std::string extension) {
+	//create the cache directory on first use
+	MakeDirectory(CachePath);
+
+	//flatten the source path into a single file name
+	std::string name = sourcePath;
+
+	if(name.compare(0, 7, "assets/") == 0) name = name.substr(7);
+
+	for(unsigned int i = 0; i < name.size(); i++) {
+		if(name[i] == '/' || name[i] == '\\' || name[i] == ':' || name[i] == ' ') name[i] = '_';
+	}
+
+	return CachePath + name + extension;
+}
+
+bool Filepath::GetFileStats(std::string path, unsigned long long& modificationTime, unsigned long long& fileSize) {
+	struct stat fileStats;
+
+	if(stat(path.c_str(), &fileStats) != 0) return false;
+
+	modificationTime = (unsigned long long)fileStats.st_mtime;
+	fileSize = (unsigned long long)fileStats.st_size;
+
+	return true;
+}
+
+bool Filepath::PatchFile(std::string path, unsigned long long offset, const void* data, size_t size) {
+	//opening for reading as well keeps the rest of the file, writing alone would truncate it
+	std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+	if(!file.is_open()) return false;
+
+	file.seekp(offset);
+	file.write((const char*)data, size);
+
+	return file.good();
+}
+
+std::string Filepath::GetCanonicalPath(std::string path) {
+	//unify the separators and resolve "." and ".." so different spellings of a path compare equal
+	std::vector<std::string> parts;
+	std::string part;
+
+	for(unsigned int i = 0; i <= path.size(); i++) {
+		if(i == path.size() || path[i] == '/' || path[i] == '\\') {
+			if(part == "..") {
+				if(!parts.empty() && parts.back() != "..") parts.pop_back();
+				else parts.push_back(part);
+			} else if(!part.empty() && part != ".") {
+				parts.push_back(part);
+			}
+
+			part.clear();
+		} else {
+#ifdef _WIN32
+			part += (char)std::tolower((unsigned char)path[i]); //windows paths are case insensitive
+#else
+			part += path[i];
+#endif
+		}
+	}
+
+	std::string canonicalPath = (!path.empty() && path[0] == '/') ? "/" : "";
+
+	for(unsigned int i = 0; i < parts.size(); i++) {
+		if(i > 0) canonicalPath += "/";
+		canonicalPath += parts[i];
+	}
+
+	return canonicalPath;
+}
+
+void Filepath::MakeDirectory(std::string path) {
+#ifdef _WIN32
+	_mkdir(path.c_str());
+#else
+	mkdir(path.c_str(), 0755);
+#endif
+}
+
+void Filepath::ListFiles(std::string directory, std::vector<std::string>& files) {
+	if(!directory.empty() && directory.back() != '/') directory += "/";
+
+#ifdef _WIN32
+	WIN32_FIND_DATAA entry;
+	HANDLE search = FindFirstFileA((directory + "*").c_str(), &entry);
+	if(search == INVALID_HANDLE_VALUE) return;
+
+	do {
+		std::string name = entry.cFileName;
+		if(name == "." || name == "..") continue;
+
+		if(entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ListFiles(directory + name, files);
+		else files.push_back(directory + name);
+	} while(FindNextFileA(search, &entry));
+
+	FindClose(search);
+#else
+	DIR* search = opendir(directory.c_str());
+	if(search == nullptr) return;
+
+	while(dirent* entry = readdir(search)) {
+		std::string name = entry->d_name;
+		if(name == "." || name == "..") continue;
+
+		struct stat fileStats;
+		if(stat((directory + name).c_str(), &fileStats) != 0) continue;
+
+		if(S_ISDIR(fileStats.st_mode)) ListFiles(directory + name, files);
+		else files.push_back(directory + name);
+	}
+
+	closedir(search);
+#endif
+}
\ No newline at end of file
@@ -1,8 +1,9 @@
-
 #ifndef FILEPATH_H
 #define FILEPATH_H
 
 #include <string>
+#include <vector>
+#include <cstddef>
 
 class Filepath {
 	public:
@@ -10,6 +11,15 @@ class Filepath {
 		static const std::string ModelPath;
 		static const std::string TexturePath;
 		static const std::string SkyboxPath;
+		static const std::string CachePath;
+		static const std::string ScenePath;
+
+		static std::string GetCachePath(std::string sourcePath, std::string extension);
+		static bool GetFileStats(std::string path, unsigned long long& modificationTime, unsigned long long& fileSize);
+		static bool PatchFile(std::string path, unsigned long long offset, const void* data, size_t size); //overwrites bytes of an existing file in place
+		static std::string GetCanonicalPath(std::string path);
+		static void MakeDirectory(std::string path); //no-op if it already exists
+		static void ListFiles(std::string directory, std::vector<std::string>& files); //recursive, paths start with the directory
 };
 
 #endif
\ No newline at end of file
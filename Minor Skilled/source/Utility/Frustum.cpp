@@ -0,0 +1,53 @@
+#include "Frustum.h"
+
+#include "../Utility/AABB.h"
+
+Frustum::Frustum(const glm::mat4& viewProjection) {
+	//extract the planes from the rows of the view projection matrix (Gribb/Hartmann)
+	glm::vec4 rows[4];
+
+	for(unsigned int i = 0; i < 4; i++) {
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+	}
+
+	_planes[0] = rows[3] + rows[0];
+	_planes[1] = rows[3] - rows[0];
+	_planes[2] = rows[3] + rows[1];
+	_planes[3] = rows[3] - rows[1];
+	_planes[4] = rows[3] + rows[2];
+	_planes[5] = rows[3] - rows[2];
+
+	for(unsigned int i = 0; i < 6; i++) {
+		_planes[i] /= glm::length(glm::vec3(_planes[i]));
+	}
+}
+
+bool Frustum::intersects(const AABB& box) const {
+	glm::vec3 center = box.getCenter();
+	glm::vec3 extents = box.getExtents();
+
+	for(unsigned int i = 0; i < 6; i++) {
+		glm::vec3 normal = glm::vec3(_planes[i]);
+
+		//projected radius of the box onto the plane normal
+		float radius = glm::dot(extents, glm::abs(normal));
+
+		if(glm::dot(normal, center) + _planes[i].w < -radius) return false; //completely behind one plane
+	}
+
+	return true;
+}
+
+bool Frustum::contains(const AABB& box) const {
+	glm::vec3 center = box.getCenter();
+	glm::vec3 extents = box.getExtents();
+
+	for(unsigned int i = 0; i < 6; i++) {
+		glm::vec3 normal = glm::vec3(_planes[i]);
+		float radius = glm::dot(extents, glm::abs(normal));
+
+		if(glm::dot(normal, center) + _planes[i].w < radius) return false; //not completely in front of the plane
+	}
+
+	return true;
+}
\ No newline at end of file
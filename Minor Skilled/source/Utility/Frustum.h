@@ -0,0 +1,19 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+class AABB;
+
+class Frustum {
+	public:
+		Frustum(const glm::mat4& viewProjection);
+
+		bool intersects(const AABB& box) const;
+		bool contains(const AABB& box) const;
+
+	private:
+		glm::vec4 _planes[6]; //left, right, bottom, top, near, far
+};
+
+#endif
\ No newline at end of file
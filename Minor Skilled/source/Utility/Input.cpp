@@ -1,6 +1,6 @@
 #include "Input.h"
 
-#include <iterator>
+#include <algorithm>
 #include <iostream>
 #include <string>
 
@@ -8,8 +8,10 @@
 
 #include "../Utility/RenderSettings.h"
 
-std::map<Key, bool> Input::_KeysReleased;
-std::map<MouseButton, bool> Input::_MouseButtonsReleased;
+bool Input::_Keys[GLFW_KEY_LAST + 1] = {};
+bool Input::_LastKeys[GLFW_KEY_LAST + 1] = {};
+bool Input::_MouseButtons[GLFW_MOUSE_BUTTON_LAST + 1] = {};
+bool Input::_LastMouseButtons[GLFW_MOUSE_BUTTON_LAST + 1] = {};
 GLFWwindow* Input::_Window = nullptr;
 glm::dvec2 Input::_LastMousePos = glm::vec2(0.0, 0.0);
 glm::dvec2 Input::_CurrentMousePos = glm::vec2(0.0, 0.0);
@@ -23,6 +25,18 @@ void Input::Initialize(GLFWwindow* window) {
 }
 
 void Input::ProcessInput() {
+	//keep the last frame for the presses and releases, then poll every key and button once
+	std::copy(_Keys, _Keys + GLFW_KEY_LAST + 1, _LastKeys);
+	std::copy(_MouseButtons, _MouseButtons + GLFW_MOUSE_BUTTON_LAST + 1, _LastMouseButtons);
+
+	for(int key = GLFW_KEY_SPACE; key <= GLFW_KEY_LAST; key++) {
+		_Keys[key] = glfwGetKey(_Window, key) == GLFW_PRESS;
+	}
+
+	for(int mouseButton = 0; mouseButton <= GLFW_MOUSE_BUTTON_LAST; mouseButton++) {
+		_MouseButtons[mouseButton] = glfwGetMouseButton(_Window, mouseButton) == GLFW_PRESS;
+	}
+
 	//close the window
 	if(GetKey(Key::ESC)) glfwSetWindowShouldClose(_Window, true);
 
@@ -35,82 +49,28 @@ void Input::ResetMousePos() {
 	_LastMousePos = _CurrentMousePos;
 }
 
-void Input::CheckInputStatus() {
-	//reset the key if needed, done at the end of processing input
-	for(std::map<Key, bool>::iterator it = _KeysReleased.begin(); it != _KeysReleased.end(); it++) {
-		Key key = it->first;
-
-		if(!GetKey(key) && !_KeysReleased[key]) _KeysReleased[key] = true; //reset key to released state
-		else if(GetKey(key) && !_KeysReleased[key]) _KeysReleased[key] = false; //reset key to pressed state
-	}
-
-	//reset the mouse button if needed
-	for(std::map<MouseButton, bool>::iterator it = _MouseButtonsReleased.begin(); it != _MouseButtonsReleased.end(); it++) {
-		MouseButton mouseButton = it->first;
-
-		if(!GetMouse(mouseButton) && !_MouseButtonsReleased[mouseButton]) _MouseButtonsReleased[mouseButton] = true; //reset button to released state
-		else if(GetMouse(mouseButton) && !_MouseButtonsReleased[mouseButton]) _MouseButtonsReleased[mouseButton] = false; //reset button to pressed state
-	}
-}
-
 bool Input::GetKey(Key key) {
-	return glfwGetKey(_Window, key);
+	return _Keys[key];
 }
 
 bool Input::GetKeyDown(Key key) {
-	//lazy init
-	if(!_KeysReleased.count(key)) _KeysReleased[key] = true;
-
-	if(GetKey(key) && _KeysReleased[key]) {
-		//update to show that the key is pressed
-		_KeysReleased[key] = false;
-		return true;
-	} 
-
-	return false;
+	return _Keys[key] && !_LastKeys[key];
 }
 
 bool Input::GetKeyUp(Key key) {
-	//lazy init
-	if(!_KeysReleased.count(key)) _KeysReleased[key] = true;
-
-	if(!GetKey(key) && !_KeysReleased[key]) { //may skip one frame of detecting a key release in the early frames
-		//update to show that the key is released
-		_KeysReleased[key] = true;
-		return true;
-	}
-
-	return false;
+	return !_Keys[key] && _LastKeys[key];
 }
 
 bool Input::GetMouse(MouseButton mouseButton) {
-	return glfwGetMouseButton(_Window, mouseButton);
+	return _MouseButtons[mouseButton];
 }
 
 bool Input::GetMouseDown(MouseButton mouseButton) {
-	//lazy init
-	if(!_MouseButtonsReleased.count(mouseButton)) _MouseButtonsReleased[mouseButton] = true;
-
-	if(GetMouse(mouseButton) && _MouseButtonsReleased[mouseButton]) {
-		//update to show that the button is pressed
-		_MouseButtonsReleased[mouseButton] = false;
-		return true;
-	}
-
-	return false;
+	return _MouseButtons[mouseButton] && !_LastMouseButtons[mouseButton];
 }
 
 bool Input::GetMouseUp(MouseButton mouseButton) {
-	//lazy init
-	if(!_MouseButtonsReleased.count(mouseButton)) _MouseButtonsReleased[mouseButton] = true;
-
-	if(!GetMouse(mouseButton) && !_MouseButtonsReleased[mouseButton]) { //may skip one frame of detecting a key release in the early frames
-		//update to show that the button is released
-		_MouseButtonsReleased[mouseButton] = true;
-		return true;
-	}
-
-	return false;
+	return !_MouseButtons[mouseButton] && _LastMouseButtons[mouseButton];
 }
 
 glm::dvec2 Input::GetLastMousePos() {
@@ -1,8 +1,6 @@
 #ifndef INPUT_H
 #define INPUT_H
 
-#include <map>
-
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
@@ -14,9 +12,8 @@ class Input {
 	public:
 		static void Initialize(GLFWwindow* window);
 
-		static void ProcessInput();
+		static void ProcessInput(); //main thread only, polls the state the getters read for the rest of the frame
 		static void ResetMousePos();
-		static void CheckInputStatus();
 
 		static bool GetKey(Key key);
 		static bool GetKeyDown(Key key);
@@ -30,8 +27,11 @@ class Input {
 		static glm::dvec2 GetCurrentMousePos();
 
 	private:
-		static std::map<Key, bool> _KeysReleased;
-		static std::map<MouseButton, bool> _MouseButtonsReleased;
+		//snapshots of this and the last frame, glfw may only be queried on the main thread but the components update on the workers
+		static bool _Keys[GLFW_KEY_LAST + 1];
+		static bool _LastKeys[GLFW_KEY_LAST + 1];
+		static bool _MouseButtons[GLFW_MOUSE_BUTTON_LAST + 1];
+		static bool _LastMouseButtons[GLFW_MOUSE_BUTTON_LAST + 1];
 
 		static GLFWwindow* _Window;
 
@@ -0,0 +1,92 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "../Utility/Math.h"
+
+#ifdef _WIN32
+MappedFile::MappedFile(std::string path): _data(nullptr), _size(0), _file(nullptr), _mapping(nullptr) {
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if(file == INVALID_HANDLE_VALUE) return;
+
+	_file = file;
+
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(file, &size) || size.QuadPart == 0) return;
+
+	_mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if(_mapping == NULL) return;
+
+	_data = (const unsigned char*)MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+	if(_data != nullptr) _size = (size_t)size.QuadPart;
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+void MappedFile::close() {
+	if(_data != nullptr) UnmapViewOfFile(_data);
+	if(_mapping != nullptr) CloseHandle(_mapping);
+	if(_file != nullptr) CloseHandle(_file);
+
+	_data = nullptr;
+	_size = 0;
+	_mapping = nullptr;
+	_file = nullptr;
+}
+#else
+MappedFile::MappedFile(std::string path): _data(nullptr), _size(0) {
+	int file = open(path.c_str(), O_RDONLY);
+	if(file < 0) return;
+
+	struct stat fileStats;
+
+	if(fstat(file, &fileStats) == 0 && fileStats.st_size > 0) {
+		void* data = mmap(NULL, fileStats.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+		if(data != MAP_FAILED) {
+			_data = (const unsigned char*)data;
+			_size = fileStats.st_size;
+		}
+	}
+
+	::close(file); //the mapping stays valid after closing the descriptor
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+void MappedFile::close() {
+	if(_data != nullptr) munmap((void*)_data, _size);
+
+	_data = nullptr;
+	_size = 0;
+}
+#endif
+
+bool MappedFile::isOpen() {
+	return _data != nullptr;
+}
+
+const unsigned char* MappedFile::getData() {
+	return _data;
+}
+
+size_t MappedFile::getSize() {
+	return _size;
+}
+
+unsigned long long MappedFile::getHash() {
+	return Math::Hash(_data, _size); //over the whole file
+}
\ No newline at end of file
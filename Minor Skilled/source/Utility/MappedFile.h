@@ -0,0 +1,34 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+
+//read only memory mapping of a whole file, the operating system pages the contents in on demand
+class MappedFile {
+	public:
+		MappedFile(std::string path);
+		~MappedFile();
+
+		bool isOpen();
+
+		const unsigned char* getData();
+		size_t getSize();
+
+		unsigned long long getHash();
+
+		void close(); //unmaps the file early, e.g. to write to it
+
+	private:
+		const unsigned char* _data;
+		size_t _size;
+
+#ifdef _WIN32
+		void* _file;
+		void* _mapping;
+#endif
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+};
+
+#endif
\ No newline at end of file
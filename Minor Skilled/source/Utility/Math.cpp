@@ -1,5 +1,157 @@
 #include "Math.h"
 
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+#include <glm/gtc/constants.hpp>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MATH_SSE2 //msvc has no __SSE2__, but every x64 cpu supports it
+#endif
+
 float Math::Lerp(float a, float b, float f) {
 	return a + f * (b - a); //linear interpolation
 }
+
+glm::vec2 Math::Hammersley(unsigned int i, unsigned int count) {
+	unsigned int bits = i;
+	bits = (bits << 16u) | (bits >> 16u);
+	bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+	bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+	bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+	bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+
+	return glm::vec2((float)i / (float)count, (float)bits * 2.3283064365386963e-10f); // / 0x100000000
+}
+
+glm::vec3 Math::ImportanceSampleGGX(glm::vec2 xi, float roughness) {
+	float a = roughness * roughness;
+
+	float phi = 2.0f * glm::pi<float>() * xi.x;
+	float cosTheta = std::sqrt((1.0f - xi.y) / (1.0f + (a * a - 1.0f) * xi.y));
+	float sinTheta = std::sqrt(1.0f - cosTheta * cosTheta);
+
+	return glm::vec3(std::cos(phi) * sinTheta, std::sin(phi) * sinTheta, cosTheta);
+}
+
+
+unsigned short Math::FloatToHalf(float value) {
+	unsigned int bits;
+	std::memcpy(&bits, &value, sizeof(float));
+
+	unsigned int sign = (bits >> 16) & 0x8000;
+	unsigned int exponent = (bits >> 23) & 0xff;
+	unsigned int mantissa = bits & 0x7fffff;
+
+	if(exponent == 0xff) return (unsigned short)(mantissa != 0 ? (sign | 0x7e00) : (sign | 0x7bff)); //nan stays nan, infinity is clamped
+
+	int halfExponent = (int)exponent - 127 + 15;
+	if(halfExponent >= 31) return (unsigned short)(sign | 0x7bff);
+
+	if(halfExponent <= 0) {
+		if(halfExponent < -10) return (unsigned short)sign; //too small even for a denormal
+
+		//denormal, shift in the implicit leading one
+		mantissa |= 0x800000;
+
+		unsigned int shift = 14 - halfExponent;
+		unsigned int half = mantissa >> shift;
+		unsigned int remainder = mantissa & ((1u << shift) - 1);
+		unsigned int halfway = 1u << (shift - 1);
+
+		if(remainder > halfway || (remainder == halfway && (half & 1))) half++; //round to nearest even
+
+		return (unsigned short)(sign | half);
+	}
+
+	unsigned int half = ((unsigned int)halfExponent << 10) | (mantissa >> 13);
+	unsigned int remainder = mantissa & 0x1fff;
+
+	if(remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) half++; //a carry moves into the exponent, which is still correct
+	if(half >= 0x7c00) half = 0x7bff;
+
+	return (unsigned short)(sign | half);
+}
+
+void Math::FloatToHalf(const float* source, unsigned short* destination, unsigned int count) {
+	unsigned int i = 0;
+
+#ifdef __AVX2__
+	//every avx2 cpu also has the f16c conversion instructions
+	const __m256 maxHalf = _mm256_set1_ps(65504.0f);
+	const __m256 minHalf = _mm256_set1_ps(-65504.0f);
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+	const __m256 quietNan = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fc00000));
+
+	for(; i + 8 <= count; i += 8) {
+		__m256 values = _mm256_loadu_ps(source + i);
+
+		//nan keeps its sign and becomes the same quiet nan as in the scalar conversion, the clamp passes it through
+		__m256 nan = _mm256_cmp_ps(values, values, _CMP_UNORD_Q);
+		values = _mm256_blendv_ps(values, _mm256_or_ps(_mm256_and_ps(values, signMask), quietNan), nan);
+		values = _mm256_max_ps(minHalf, _mm256_min_ps(maxHalf, values));
+
+		_mm_storeu_si128((__m128i*)(destination + i), _mm256_cvtps_ph(values, _MM_FROUND_TO_NEAREST_INT));
+	}
+#elif defined(MATH_SSE2)
+	//the same rounding as the scalar conversion on four values at once, the results match bit for bit
+	const __m128i signMask = _mm_set1_epi32(0x80000000);
+	const __m128i infinity = _mm_set1_epi32(0x7f800000);
+	const __m128i minNormal = _mm_set1_epi32(0x38800000); //smallest float that is a normal half
+	const __m128i maxHalf = _mm_set1_epi32(0x7bff);
+	const __m128i nanHalf = _mm_set1_epi32(0x7e00);
+	const __m128i rebias = _mm_set1_epi32((127 - 15) << 23);
+	const __m128i roundBias = _mm_set1_epi32(0xfff);
+	const __m128i one = _mm_set1_epi32(1);
+	const __m128 denormalMagic = _mm_set1_ps(0.5f); //aligns the denormal mantissa with the lowest bits, the addition rounds to nearest even
+
+	__m128i halves[2];
+
+	for(; i + 8 <= count; i += 8) {
+		for(unsigned int j = 0; j < 2; j++) {
+			__m128i bits = _mm_castps_si128(_mm_loadu_ps(source + i + j * 4));
+			__m128i sign = _mm_srli_epi32(_mm_and_si128(bits, signMask), 16);
+			__m128i magnitude = _mm_andnot_si128(signMask, bits);
+
+			//normal halves, rounded to nearest even and clamped to the largest finite half like infinity
+			__m128i odd = _mm_and_si128(_mm_srli_epi32(magnitude, 13), one);
+			__m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_sub_epi32(magnitude, rebias), _mm_add_epi32(roundBias, odd)), 13);
+			__m128i overflow = _mm_cmpgt_epi32(normal, maxHalf);
+			normal = _mm_or_si128(_mm_and_si128(overflow, maxHalf), _mm_andnot_si128(overflow, normal));
+
+			//denormal halves and zero
+			__m128i denormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(magnitude), denormalMagic)), _mm_castps_si128(denormalMagic));
+			__m128i isDenormal = _mm_cmplt_epi32(magnitude, minNormal);
+			__m128i half = _mm_or_si128(_mm_and_si128(isDenormal, denormal), _mm_andnot_si128(isDenormal, normal));
+
+			__m128i isNan = _mm_cmpgt_epi32(magnitude, infinity);
+			half = _mm_or_si128(_mm_and_si128(isNan, nanHalf), _mm_andnot_si128(isNan, half));
+
+			//sign extend the 16 bits so the signed saturation of the pack keeps them as they are
+			half = _mm_or_si128(half, sign);
+			halves[j] = _mm_srai_epi32(_mm_slli_epi32(half, 16), 16);
+		}
+
+		_mm_storeu_si128((__m128i*)(destination + i), _mm_packs_epi32(halves[0], halves[1]));
+	}
+#endif
+
+	for(; i < count; i++) {
+		destination[i] = FloatToHalf(source[i]);
+	}
+}
+
+unsigned long long Math::Hash(const void* data, size_t size, unsigned long long hash) {
+	const unsigned char* bytes = (const unsigned char*)data;
+
+	for(size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
\ No newline at end of file
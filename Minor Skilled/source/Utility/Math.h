@@ -1,10 +1,26 @@
 #ifndef MATH_H
 #define MATH_H
 
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
 class Math {
 	public:
 		static float Lerp(float a, float b, float f);
 
+		//low discrepancy point i of count, the radical inverse reverses the bits like in the shaders
+		static glm::vec2 Hammersley(unsigned int i, unsigned int count);
+		//halfway vector biased towards the ggx lobe (importance sampling), the normal is z in tangent space
+		static glm::vec3 ImportanceSampleGGX(glm::vec2 xi, float roughness);
+
+		//values outside of the half float range are clamped to the largest finite half
+		static unsigned short FloatToHalf(float value);
+		static void FloatToHalf(const float* source, unsigned short* destination, unsigned int count);
+
+		//64 bit FNV-1a, pass the previous result as hash to continue it over more data
+		static unsigned long long Hash(const void* data, size_t size, unsigned long long hash = 14695981039346656037ull);
+
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,321 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <glm/glm.hpp>
+
+const unsigned int MeshOptimizer::_CacheSize = 16; //fifo size the orderings are optimized and measured for
+
+void MeshOptimizer::WeldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+	//open addressing hash table over the raw vertex bytes, Vertex only consists of floats so there is no padding
+	unsigned int tableSize = 1;
+	while(tableSize < vertices.size() * 2) tableSize *= 2;
+
+	const unsigned int empty = 0xffffffff;
+	std::vector<unsigned int> table(tableSize, empty);
+	std::vector<unsigned int> remap(vertices.size());
+	std::vector<Vertex> welded;
+	welded.reserve(vertices.size());
+
+	for(unsigned int i = 0; i < vertices.size(); i++) {
+		//64 bit FNV-1a folded to 32 bits
+		const unsigned char* bytes = (const unsigned char*)&vertices[i];
+		unsigned long long hash = 14695981039346656037ull;
+
+		for(unsigned int j = 0; j < sizeof(Vertex); j++) {
+			hash ^= bytes[j];
+			hash *= 1099511628211ull;
+		}
+
+		unsigned int slot = (unsigned int)(hash ^ (hash >> 32)) & (tableSize - 1);
+
+		//linear probing until the vertex or a free slot is found
+		while(table[slot] != empty && std::memcmp(&welded[table[slot]], &vertices[i], sizeof(Vertex)) != 0) {
+			slot = (slot + 1) & (tableSize - 1);
+		}
+
+		if(table[slot] == empty) {
+			table[slot] = welded.size();
+			welded.push_back(vertices[i]);
+		}
+
+		remap[i] = table[slot];
+	}
+
+	for(unsigned int i = 0; i < indices.size(); i++) {
+		indices[i] = remap[indices[i]];
+	}
+
+	vertices.swap(welded);
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount) {
+	_Tipsify(indices, vertexCount, nullptr);
+}
+
+void MeshOptimizer::OptimizeOverdraw(const std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, float threshold) {
+	//the cache optimization produces the hard cluster boundaries wherever the cache had to be flushed anyway
+	std::vector<unsigned int> boundaries;
+	_Tipsify(indices, vertices.size(), &boundaries);
+
+	unsigned int triangleCount = indices.size() / 3;
+	if(triangleCount == 0) return;
+
+	//split the clusters further where the acmr of the part so far stays within the threshold of the whole cluster
+	std::vector<unsigned int> cacheTimes(vertices.size(), 0);
+	unsigned int time = _CacheSize + 1;
+
+	std::vector<unsigned int> clusters;
+
+	for(unsigned int i = 0; i < boundaries.size(); i++) {
+		unsigned int start = boundaries[i];
+		unsigned int end = (i + 1 < boundaries.size()) ? boundaries[i + 1] : triangleCount;
+
+		time += _CacheSize + 1; //start with an empty cache
+		float clusterAcmr = (float)_GetClusterMisses(indices, start, end, cacheTimes, time) / (float)(end - start);
+
+		time += _CacheSize + 1;
+		clusters.push_back(start);
+
+		unsigned int clusterStart = start;
+		unsigned int misses = 0;
+
+		for(unsigned int j = start; j < end; j++) {
+			misses += _GetClusterMisses(indices, j, j + 1, cacheTimes, time);
+
+			if(j + 1 < end && (float)misses <= threshold * clusterAcmr * (float)(j + 1 - clusterStart)) {
+				clusters.push_back(j + 1);
+				clusterStart = j + 1;
+				misses = 0;
+
+				time += _CacheSize + 1;
+			}
+		}
+	}
+
+	//area weighted center and normal of each cluster and of the whole mesh
+	std::vector<glm::vec3> clusterCenters(clusters.size(), glm::vec3(0.0f));
+	std::vector<glm::vec3> clusterNormals(clusters.size(), glm::vec3(0.0f));
+	glm::vec3 meshCenter(0.0f);
+	float meshArea = 0.0f;
+
+	for(unsigned int i = 0; i < clusters.size(); i++) {
+		unsigned int end = (i + 1 < clusters.size()) ? clusters[i + 1] : triangleCount;
+		float clusterArea = 0.0f;
+
+		for(unsigned int j = clusters[i]; j < end; j++) {
+			glm::vec3 v0 = vertices[indices[j * 3]].position;
+			glm::vec3 v1 = vertices[indices[j * 3 + 1]].position;
+			glm::vec3 v2 = vertices[indices[j * 3 + 2]].position;
+
+			glm::vec3 normal = glm::cross(v1 - v0, v2 - v0);
+			float area = glm::length(normal);
+
+			clusterCenters[i] += (v0 + v1 + v2) * (area / 3.0f);
+			clusterNormals[i] += normal;
+			clusterArea += area;
+		}
+
+		meshCenter += clusterCenters[i];
+		meshArea += clusterArea;
+
+		if(clusterArea > 0.0f) clusterCenters[i] /= clusterArea;
+
+		float normalLength = glm::length(clusterNormals[i]);
+		if(normalLength > 0.0f) clusterNormals[i] /= normalLength;
+	}
+
+	if(meshArea > 0.0f) meshCenter /= meshArea;
+
+	//draw the clusters facing away from the center first, they are the most likely to occlude the others
+	std::vector<float> sortKeys(clusters.size());
+	std::vector<unsigned int> order(clusters.size());
+
+	for(unsigned int i = 0; i < clusters.size(); i++) {
+		sortKeys[i] = glm::dot(clusterCenters[i] - meshCenter, clusterNormals[i]);
+		order[i] = i;
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&sortKeys](unsigned int a, unsigned int b) { return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<unsigned int> sorted;
+	sorted.reserve(indices.size());
+
+	for(unsigned int i = 0; i < order.size(); i++) {
+		unsigned int start = clusters[order[i]] * 3;
+		unsigned int end = (order[i] + 1 < clusters.size()) ? clusters[order[i] + 1] * 3 : indices.size();
+
+		sorted.insert(sorted.end(), indices.begin() + start, indices.begin() + end);
+	}
+
+	indices.swap(sorted);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, std::vector<std::vector<unsigned int>>& lods) {
+	//store the vertices in the order they are first used, unused vertices get dropped
+	const unsigned int unused = 0xffffffff;
+	std::vector<unsigned int> remap(vertices.size(), unused);
+	std::vector<Vertex> ordered;
+	ordered.reserve(vertices.size());
+
+	for(unsigned int i = 0; i < indices.size(); i++) {
+		if(remap[indices[i]] == unused) {
+			remap[indices[i]] = ordered.size();
+			ordered.push_back(vertices[indices[i]]);
+		}
+
+		indices[i] = remap[indices[i]];
+	}
+
+	//the detail levels only reference vertices of the full mesh, but remap defensively
+	for(unsigned int i = 0; i < lods.size(); i++) {
+		for(unsigned int j = 0; j < lods[i].size(); j++) {
+			unsigned int& index = lods[i][j];
+
+			if(remap[index] == unused) {
+				remap[index] = ordered.size();
+				ordered.push_back(vertices[index]);
+			}
+
+			index = remap[index];
+		}
+	}
+
+	vertices.swap(ordered);
+}
+
+float MeshOptimizer::GetAcmr(const std::vector<unsigned int>& indices, unsigned int vertexCount) {
+	if(indices.size() < 3) return 0.0f;
+
+	std::vector<unsigned int> cacheTimes(vertexCount, 0);
+	unsigned int time = _CacheSize + 1;
+
+	return (float)_GetClusterMisses(indices, 0, indices.size() / 3, cacheTimes, time) / (float)(indices.size() / 3);
+}
+
+void MeshOptimizer::_Tipsify(std::vector<unsigned int>& indices, unsigned int vertexCount, std::vector<unsigned int>* hardBoundaries) {
+	//Sander et al. 2007, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"
+	unsigned int triangleCount = indices.size() / 3;
+	if(triangleCount == 0) return;
+
+	//vertex to triangle adjacency
+	std::vector<unsigned int> liveTriangles(vertexCount, 0);
+
+	for(unsigned int i = 0; i < indices.size(); i++) {
+		liveTriangles[indices[i]]++;
+	}
+
+	std::vector<unsigned int> adjacencyOffsets(vertexCount + 1, 0);
+
+	for(unsigned int i = 0; i < vertexCount; i++) {
+		adjacencyOffsets[i + 1] = adjacencyOffsets[i] + liveTriangles[i];
+	}
+
+	std::vector<unsigned int> adjacency(indices.size());
+	std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+	for(unsigned int i = 0; i < indices.size(); i++) {
+		adjacency[fill[indices[i]]++] = i / 3;
+	}
+
+	std::vector<unsigned int> cacheTimes(vertexCount, 0);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<unsigned int> deadEnds;
+	std::vector<unsigned int> candidates;
+	std::vector<unsigned int> result;
+	result.reserve(indices.size());
+
+	unsigned int time = _CacheSize + 1;
+	unsigned int cursor = 0;
+
+	//start fanning around the first vertex which is in use
+	int fanningVertex = -1;
+
+	while(cursor < vertexCount && liveTriangles[cursor] == 0) cursor++;
+	if(cursor < vertexCount) fanningVertex = cursor;
+
+	if(hardBoundaries != nullptr) hardBoundaries->push_back(0);
+
+	while(fanningVertex >= 0) {
+		candidates.clear();
+
+		//emit all remaining triangles around the fanning vertex
+		for(unsigned int i = adjacencyOffsets[fanningVertex]; i < adjacencyOffsets[fanningVertex + 1]; i++) {
+			unsigned int triangle = adjacency[i];
+			if(emitted[triangle]) continue;
+
+			for(unsigned int j = 0; j < 3; j++) {
+				unsigned int vertex = indices[triangle * 3 + j];
+
+				result.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+
+				if(time - cacheTimes[vertex] > _CacheSize) {
+					cacheTimes[vertex] = time;
+					time++;
+				}
+			}
+
+			emitted[triangle] = true;
+		}
+
+		//continue with the candidate that is still in the cache after its remaining triangles were emitted, oldest first
+		int nextVertex = -1;
+		int bestPriority = -1;
+
+		for(unsigned int i = 0; i < candidates.size(); i++) {
+			unsigned int vertex = candidates[i];
+			if(liveTriangles[vertex] == 0) continue;
+
+			int priority = 0;
+			if(time - cacheTimes[vertex] + 2 * liveTriangles[vertex] <= _CacheSize) priority = time - cacheTimes[vertex];
+
+			if(priority > bestPriority) {
+				bestPriority = priority;
+				nextVertex = vertex;
+			}
+		}
+
+		if(nextVertex == -1) {
+			//dead end, go back to recently used vertices first and scan for unprocessed ones otherwise
+			while(!deadEnds.empty() && nextVertex == -1) {
+				unsigned int vertex = deadEnds.back();
+				deadEnds.pop_back();
+
+				if(liveTriangles[vertex] > 0) nextVertex = vertex;
+			}
+
+			while(nextVertex == -1 && cursor < vertexCount) {
+				if(liveTriangles[cursor] > 0) nextVertex = cursor;
+				else cursor++;
+			}
+
+			//the cache is most likely cold from here on, which makes this a good place to split the mesh for overdraw sorting
+			if(nextVertex != -1 && hardBoundaries != nullptr && hardBoundaries->back() != result.size() / 3) hardBoundaries->push_back(result.size() / 3);
+		}
+
+		fanningVertex = nextVertex;
+	}
+
+	indices.swap(result);
+}
+
+unsigned int MeshOptimizer::_GetClusterMisses(const std::vector<unsigned int>& indices, unsigned int start, unsigned int end, std::vector<unsigned int>& cacheTimes, unsigned int& time) {
+	//fifo cache simulation, a vertex is cached if fewer than cache size misses happened since it was loaded
+	unsigned int misses = 0;
+
+	for(unsigned int i = start * 3; i < end * 3; i++) {
+		unsigned int vertex = indices[i];
+
+		if(time - cacheTimes[vertex] > _CacheSize) {
+			cacheTimes[vertex] = time;
+			time++;
+			misses++;
+		}
+	}
+
+	return misses;
+}
\ No newline at end of file
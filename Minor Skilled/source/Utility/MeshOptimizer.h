@@ -0,0 +1,25 @@
+#ifndef MESHOPTIMIZER_H
+#define MESHOPTIMIZER_H
+
+#include <vector>
+
+#include "../Engine/Vertex.h"
+
+//import time reordering of indexed meshes for the post transform cache, overdraw and vertex fetch
+class MeshOptimizer {
+	public:
+		static void WeldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+		static void OptimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount);
+		static void OptimizeOverdraw(const std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, float threshold = 1.05f);
+		static void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, std::vector<std::vector<unsigned int>>& lods);
+
+		static float GetAcmr(const std::vector<unsigned int>& indices, unsigned int vertexCount);
+
+	private:
+		static const unsigned int _CacheSize;
+
+		static void _Tipsify(std::vector<unsigned int>& indices, unsigned int vertexCount, std::vector<unsigned int>* hardBoundaries);
+		static unsigned int _GetClusterMisses(const std::vector<unsigned int>& indices, unsigned int start, unsigned int end, std::vector<unsigned int>& cacheTimes, unsigned int& time);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,293 @@
+#include "MeshSimplifier.h"
+
+#include <iostream>
+#include <algorithm>
+#include <unordered_map>
+#include <cmath>
+
+#include "../Utility/AABB.h"
+
+const unsigned int MeshSimplifier::_MaxLodLevels = 3; //additional levels below the full resolution mesh
+const unsigned int MeshSimplifier::_MinLodTriangles = 64; //smaller meshes are not worth simplifying any further
+const float MeshSimplifier::_LodReduction = 0.5f; //every level aims for half the triangles of the previous one
+const float MeshSimplifier::_LodError = 0.01f; //allowed deviation relative to the mesh size, doubles every level
+const float MeshSimplifier::_MinLodGain = 0.85f; //stop generating levels once a level removes less than 15% of the triangles
+
+std::vector<unsigned int> MeshSimplifier::Simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, unsigned int targetIndexCount, float targetError) {
+	std::vector<unsigned int> result(indices);
+
+	if(result.size() <= targetIndexCount) return result;
+
+	unsigned int vertexCount = vertices.size();
+
+	//vertices on open edges stay in place, this includes uv seams and hard edges since their vertices are not shared
+	std::vector<bool> locked(vertexCount, false);
+	_FindBorderVertices(result, locked);
+
+	//accumulate the area weighted planes of all adjacent triangles
+	std::vector<Quadric> quadrics(vertexCount);
+	std::fill(quadrics.begin(), quadrics.end(), Quadric{ 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 });
+
+	AABB bounds;
+
+	for(unsigned int i = 0; i < result.size(); i += 3) {
+		glm::vec3 v0 = vertices[result[i]].position;
+		glm::vec3 v1 = vertices[result[i + 1]].position;
+		glm::vec3 v2 = vertices[result[i + 2]].position;
+
+		glm::vec3 normal = glm::cross(v1 - v0, v2 - v0);
+		float length = glm::length(normal);
+
+		bounds.expand(v0);
+		bounds.expand(v1);
+		bounds.expand(v2);
+
+		if(length <= 0.0f) continue;
+
+		normal /= length;
+
+		double area = length * 0.5;
+		double a = normal.x;
+		double b = normal.y;
+		double c = normal.z;
+		double d = -glm::dot(normal, v0);
+
+		Quadric plane = { a * a * area, a * b * area, a * c * area, a * d * area, b * b * area, b * c * area, b * d * area, c * c * area, c * d * area, d * d * area, area };
+
+		_AddQuadric(quadrics[result[i]], plane);
+		_AddQuadric(quadrics[result[i + 1]], plane);
+		_AddQuadric(quadrics[result[i + 2]], plane);
+	}
+
+	//the error is a squared distance, scale the allowed error with the mesh size
+	float maxError = targetError * glm::length(bounds.max - bounds.min);
+	maxError *= maxError;
+
+	std::vector<unsigned int> adjacencyOffsets(vertexCount + 1);
+	std::vector<unsigned int> adjacency;
+	std::vector<unsigned int> collapseTo(vertexCount);
+	std::vector<bool> touched(vertexCount);
+	std::vector<Collapse> collapses;
+
+	while(result.size() > targetIndexCount) {
+		//build the vertex to triangle adjacency of the current index buffer
+		std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+
+		for(unsigned int i = 0; i < result.size(); i++) {
+			adjacencyOffsets[result[i] + 1]++;
+		}
+
+		for(unsigned int i = 0; i < vertexCount; i++) {
+			adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+		}
+
+		adjacency.resize(result.size());
+		std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+		for(unsigned int i = 0; i < result.size(); i++) {
+			adjacency[fill[result[i]]++] = i / 3;
+		}
+
+		//find the cheapest collapse of every free vertex onto one of its neighbours
+		collapses.clear();
+
+		for(unsigned int from = 0; from < vertexCount; from++) {
+			if(locked[from] || adjacencyOffsets[from] == adjacencyOffsets[from + 1]) continue;
+
+			Collapse best = { from, from, 0.0f };
+
+			for(unsigned int i = adjacencyOffsets[from]; i < adjacencyOffsets[from + 1]; i++) {
+				unsigned int triangle = adjacency[i] * 3;
+
+				for(unsigned int j = 0; j < 3; j++) {
+					unsigned int to = result[triangle + j];
+					if(to == from) continue;
+
+					Quadric quadric = quadrics[from];
+					_AddQuadric(quadric, quadrics[to]);
+
+					float error = _GetError(quadric, vertices[to].position);
+
+					if(best.to == from || error < best.error) {
+						best.to = to;
+						best.error = error;
+					}
+				}
+			}
+
+			if(best.to != from && best.error <= maxError) collapses.push_back(best);
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+		//apply the cheapest collapses which do not share any triangles, so every flip test stays valid
+		for(unsigned int i = 0; i < vertexCount; i++) {
+			collapseTo[i] = i;
+		}
+
+		std::fill(touched.begin(), touched.end(), false);
+
+		unsigned int trianglesToRemove = (result.size() - targetIndexCount) / 3;
+		unsigned int removedTriangles = 0;
+		unsigned int collapseCount = 0;
+
+		for(unsigned int i = 0; i < collapses.size() && removedTriangles < trianglesToRemove; i++) {
+			Collapse& collapse = collapses[i];
+
+			if(touched[collapse.from] || touched[collapse.to]) continue;
+			if(_Flips(vertices, result, adjacency, adjacencyOffsets[collapse.from], adjacencyOffsets[collapse.from + 1], collapse.from, collapse.to)) continue;
+
+			collapseTo[collapse.from] = collapse.to;
+			_AddQuadric(quadrics[collapse.to], quadrics[collapse.from]);
+
+			for(unsigned int j = adjacencyOffsets[collapse.from]; j < adjacencyOffsets[collapse.from + 1]; j++) {
+				unsigned int triangle = adjacency[j] * 3;
+
+				bool shared = false;
+
+				for(unsigned int k = 0; k < 3; k++) {
+					touched[result[triangle + k]] = true;
+					if(result[triangle + k] == collapse.to) shared = true;
+				}
+
+				if(shared) removedTriangles++;
+			}
+
+			collapseCount++;
+		}
+
+		if(collapseCount == 0) break; //nothing left that stays within the error bounds
+
+		//remap the indices and drop the degenerate triangles
+		unsigned int writeIndex = 0;
+
+		for(unsigned int i = 0; i < result.size(); i += 3) {
+			unsigned int i0 = collapseTo[result[i]];
+			unsigned int i1 = collapseTo[result[i + 1]];
+			unsigned int i2 = collapseTo[result[i + 2]];
+
+			if(i0 == i1 || i1 == i2 || i0 == i2) continue;
+
+			result[writeIndex++] = i0;
+			result[writeIndex++] = i1;
+			result[writeIndex++] = i2;
+		}
+
+		result.resize(writeIndex);
+	}
+
+	return result;
+}
+
+std::vector<std::vector<unsigned int>> MeshSimplifier::GenerateLods(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
+	std::vector<std::vector<unsigned int>> lods;
+
+	float error = _LodError;
+
+	for(unsigned int i = 0; i < _MaxLodLevels; i++) {
+		//simplify the previous level, that is a lot cheaper than starting from the full mesh every time
+		const std::vector<unsigned int>& source = lods.empty() ? indices : lods.back();
+
+		if(source.size() / 3 < _MinLodTriangles) break;
+
+		unsigned int targetIndexCount = (unsigned int)(source.size() / 3 * _LodReduction) * 3;
+		std::vector<unsigned int> lod = Simplify(vertices, source, targetIndexCount, error);
+
+		if(lod.size() > source.size() * _MinLodGain) break;
+
+		lods.push_back(lod);
+		error *= 2.0f;
+	}
+
+	//a closed mesh has no locked vertices, so at least the first level has to succeed unless the mesh is already minimal
+	if(lods.empty() && indices.size() / 3 >= _MinLodTriangles) {
+		std::vector<bool> locked(vertices.size(), false);
+		_FindBorderVertices(indices, locked);
+
+		if(std::find(locked.begin(), locked.end(), true) == locked.end()) std::cout << "WARNING: Unable to generate detail levels for a closed mesh with " << indices.size() / 3 << " triangles" << std::endl;
+	}
+
+	return lods;
+}
+
+void MeshSimplifier::_FindBorderVertices(const std::vector<unsigned int>& indices, std::vector<bool>& locked) {
+	//count how many triangles use each undirected edge
+	std::unordered_map<unsigned long long, unsigned int> edges;
+
+	for(unsigned int i = 0; i < indices.size(); i += 3) {
+		for(unsigned int j = 0; j < 3; j++) {
+			unsigned long long a = indices[i + j];
+			unsigned long long b = indices[i + (j + 1) % 3];
+
+			edges[(std::min(a, b) << 32) | std::max(a, b)]++;
+		}
+	}
+
+	//edges which are not shared by exactly two triangles are borders or non-manifold
+	for(std::unordered_map<unsigned long long, unsigned int>::iterator it = edges.begin(); it != edges.end(); it++) {
+		if(it->second == 2) continue;
+
+		locked[(unsigned int)(it->first >> 32)] = true;
+		locked[(unsigned int)(it->first & 0xffffffff)] = true;
+	}
+}
+
+void MeshSimplifier::_AddQuadric(Quadric& target, const Quadric& source) {
+	target.a2 += source.a2;
+	target.ab += source.ab;
+	target.ac += source.ac;
+	target.ad += source.ad;
+	target.b2 += source.b2;
+	target.bc += source.bc;
+	target.bd += source.bd;
+	target.c2 += source.c2;
+	target.cd += source.cd;
+	target.d2 += source.d2;
+	target.weight += source.weight;
+}
+
+float MeshSimplifier::_GetError(const Quadric& quadric, const glm::vec3& point) {
+	double x = point.x;
+	double y = point.y;
+	double z = point.z;
+
+	//p^T * Q * p with p = (x, y, z, 1)
+	double error = quadric.a2 * x * x + 2.0 * quadric.ab * x * y + 2.0 * quadric.ac * x * z + 2.0 * quadric.ad * x
+		+ quadric.b2 * y * y + 2.0 * quadric.bc * y * z + 2.0 * quadric.bd * y
+		+ quadric.c2 * z * z + 2.0 * quadric.cd * z
+		+ quadric.d2;
+
+	if(quadric.weight > 0.0) error /= quadric.weight;
+
+	return (float)std::fabs(error);
+}
+
+bool MeshSimplifier::_Flips(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const std::vector<unsigned int>& adjacency, unsigned int start, unsigned int end, unsigned int from, unsigned int to) {
+	//moving the vertex must not turn any of the remaining triangles around
+	for(unsigned int i = start; i < end; i++) {
+		unsigned int triangle = adjacency[i] * 3;
+
+		unsigned int i0 = indices[triangle];
+		unsigned int i1 = indices[triangle + 1];
+		unsigned int i2 = indices[triangle + 2];
+
+		if(i0 == to || i1 == to || i2 == to) continue; //this triangle collapses
+
+		glm::vec3 v0 = vertices[i0].position;
+		glm::vec3 v1 = vertices[i1].position;
+		glm::vec3 v2 = vertices[i2].position;
+
+		glm::vec3 normal = glm::cross(v1 - v0, v2 - v0);
+
+		if(i0 == from) v0 = vertices[to].position;
+		else if(i1 == from) v1 = vertices[to].position;
+		else v2 = vertices[to].position;
+
+		glm::vec3 newNormal = glm::cross(v1 - v0, v2 - v0);
+
+		//also reject collapses which tilt a triangle too far, they produce slivers
+		if(glm::dot(normal, newNormal) <= 0.25f * glm::length(normal) * glm::length(newNormal)) return true;
+	}
+
+	return false;
+}
\ No newline at end of file
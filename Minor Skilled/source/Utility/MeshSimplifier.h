@@ -0,0 +1,41 @@
+#ifndef MESHSIMPLIFIER_H
+#define MESHSIMPLIFIER_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../Engine/Vertex.h"
+
+//reduces the triangle count of indexed meshes with quadric error metric edge collapses, the vertex buffer stays untouched
+class MeshSimplifier {
+	public:
+		static std::vector<unsigned int> Simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, unsigned int targetIndexCount, float targetError);
+		static std::vector<std::vector<unsigned int>> GenerateLods(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+
+	private:
+		//symmetric 4x4 matrix of the summed squared plane distances, normalized by the accumulated area
+		struct Quadric {
+			double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+			double weight;
+		};
+
+		struct Collapse {
+			unsigned int from;
+			unsigned int to;
+			float error;
+		};
+
+		static const unsigned int _MaxLodLevels;
+		static const unsigned int _MinLodTriangles;
+		static const float _LodReduction;
+		static const float _LodError;
+		static const float _MinLodGain;
+
+		static void _FindBorderVertices(const std::vector<unsigned int>& indices, std::vector<bool>& locked);
+		static void _AddQuadric(Quadric& target, const Quadric& source);
+		static float _GetError(const Quadric& quadric, const glm::vec3& point);
+		static bool _Flips(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const std::vector<unsigned int>& adjacency, unsigned int start, unsigned int end, unsigned int from, unsigned int to);
+};
+
+#endif
\ No newline at end of file
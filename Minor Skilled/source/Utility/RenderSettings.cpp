@@ -10,6 +10,13 @@ const unsigned int RenderSettings::Deferred = 1 << 5;
 const unsigned int RenderSettings::SSAO = 1 << 6; //deferred only
 const unsigned int RenderSettings::SSR = 1 << 7; //deferred only
 const unsigned int RenderSettings::PBR = 1 << 8; //deferred only
+const unsigned int RenderSettings::OcclusionCulling = 1 << 9;
+const unsigned int RenderSettings::GPUDriven = 1 << 10; //depth and directional shadow pass only
+const unsigned int RenderSettings::LevelOfDetail = 1 << 11;
+const unsigned int RenderSettings::CompressedVertices = 1 << 12;
+const unsigned int RenderSettings::TextureStreaming = 1 << 13; //cooked textures only
+const unsigned int RenderSettings::ProbeUpdates = 1 << 14; //recapture reflection probes whose surroundings changed
+const unsigned int RenderSettings::IrradianceVolume = 1 << 15; //pbr only, diffuse ambient from the probe grid instead of the reflection probes
 
 //active render modes
 unsigned int RenderSettings::Options = 0;
@@ -49,9 +56,8 @@ const unsigned int RenderSettings::SkyboxWidth = 1024;
 const unsigned int RenderSettings::EnvironmentHeight = 1024;
 const unsigned int RenderSettings::EnvironmentWidth = 1024;
 
-//irradiance cubemap configurations
-const unsigned int RenderSettings::IrradianceHeight = 128;
-const unsigned int RenderSettings::IrradianceWidth = 128;
+//irradiance harmonics configurations
+const unsigned int RenderSettings::IrradianceSampleSize = 32;
 
 //prefilter cubemap configurations
 const unsigned int RenderSettings::PrefilterHeight = 256;
@@ -59,6 +65,32 @@ const unsigned int RenderSettings::PrefilterWidth = 256;
 
 const unsigned int RenderSettings::MaxMipLevels = 5;
 
+const unsigned int RenderSettings::PrefilterLow = 32;
+const unsigned int RenderSettings::PrefilterMedium = 64;
+const unsigned int RenderSettings::PrefilterHigh = 256;
+const unsigned int RenderSettings::PrefilterReference = 1024; //plain importance sampling budget, used to measure the error of the others
+
+unsigned int RenderSettings::PrefilterQuality = PrefilterMedium;
+bool RenderSettings::MeasurePrefilterError = false; //compares every baked prefilter map against the reference quality
+const float RenderSettings::MaxPrefilterError = 0.05f; //relative rms error per level against the reference before the measurement warns
+
+//brdf lookup texture configurations
+const unsigned int RenderSettings::BrdfLUTSize = 512;
+const unsigned int RenderSettings::BrdfSampleCount = 1024;
+bool RenderSettings::MeasureBrdfError = false; //compares the shader integration against the cooked cpu one on every bake
+
+//reflection probe configurations
+const unsigned int RenderSettings::MaxReflectionProbes = 16; //size of the probe array in the material shaders
+float RenderSettings::ReflectionProbeSpacing = 10.0f; //grid size reflective objects are grouped by when a scene places no probes itself
+int RenderSettings::ProbeUpdateBudget = 2; //cube faces or prefilter levels of a changed probe rendered per frame
+bool RenderSettings::IncrementalProbeBaking = true; //probes missing from the cache are captured by the runtime updates after the scene is shown
+
+//irradiance volume configurations
+float RenderSettings::IrradianceVolumeSpacing = 4.0f; //distance between the grid probes, stretched if the scene needs more than the maximum
+const unsigned int RenderSettings::MaxIrradianceVolumeSize = 8; //probes per axis
+const unsigned int RenderSettings::IrradianceVolumeCaptureSize = 16;
+int RenderSettings::IrradianceVolumeBudget = 4; //grid probes around moved objects recaptured per frame
+
 //SSAO configurations
 const unsigned int RenderSettings::SsaoKernelSize = 64;
 
@@ -78,6 +110,22 @@ bool RenderSettings::SsrDebug = false;
 //lighting configurations
 const unsigned int RenderSettings::MaxLights = 16;
 
+//software occlusion culling configurations
+const unsigned int RenderSettings::OcclusionBufferWidth = 256; //multiple of the tile size
+const unsigned int RenderSettings::OcclusionBufferHeight = 128;
+unsigned int RenderSettings::OccluderMaxTriangles = 512; //only low poly models are rasterized as occluders
+
+//level of detail configurations
+float RenderSettings::LodScreenSize = 0.5f; //projected height relative to the screen below which the first reduced level is used, halves for every further level
+float RenderSettings::LodHysteresis = 0.1f; //relative margin around the thresholds to avoid flickering between levels
+int RenderSettings::ShadowLodBias = 1; //shadow maps use coarser levels than the camera
+int RenderSettings::EnvironmentLodBias = 1;
+
+//streaming configurations
+int RenderSettings::UploadBudget = 8192; //kilobytes streamed to the gpu per frame
+bool RenderSettings::CompressTextures = true; //cook textures into bc formats on load, only affects textures loaded afterwards
+int RenderSettings::TextureStreamingBudget = 256; //megabytes of streamed texture levels kept on the gpu
+
 //post-processing configurations
 unsigned int RenderSettings::BloomBlurAmount = 4;
 
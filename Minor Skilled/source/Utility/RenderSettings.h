@@ -15,6 +15,13 @@ class RenderSettings {
 		static const unsigned int SSAO;
 		static const unsigned int SSR;
 		static const unsigned int PBR;
+		static const unsigned int OcclusionCulling;
+		static const unsigned int GPUDriven;
+		static const unsigned int LevelOfDetail;
+		static const unsigned int CompressedVertices;
+		static const unsigned int TextureStreaming;
+		static const unsigned int ProbeUpdates;
+		static const unsigned int IrradianceVolume;
 
 		static unsigned int Options;
 
@@ -50,14 +57,37 @@ class RenderSettings {
 		static const unsigned int EnvironmentWidth;
 		static const unsigned int EnvironmentHeight;
 
-		static const unsigned int IrradianceWidth;
-		static const unsigned int IrradianceHeight;
+		static const unsigned int IrradianceSampleSize; //texels per face side projected into the spherical harmonics
 
 		static const unsigned int PrefilterWidth;
 		static const unsigned int PrefilterHeight;
 
 		static const unsigned int MaxMipLevels;
 
+		//prefilter quality options, samples per texel
+		static const unsigned int PrefilterLow;
+		static const unsigned int PrefilterMedium;
+		static const unsigned int PrefilterHigh;
+		static const unsigned int PrefilterReference;
+
+		static unsigned int PrefilterQuality;
+		static bool MeasurePrefilterError;
+		static const float MaxPrefilterError;
+
+		static const unsigned int BrdfLUTSize;
+		static const unsigned int BrdfSampleCount;
+		static bool MeasureBrdfError;
+
+		static const unsigned int MaxReflectionProbes;
+		static float ReflectionProbeSpacing;
+		static int ProbeUpdateBudget;
+		static bool IncrementalProbeBaking;
+
+		static float IrradianceVolumeSpacing;
+		static const unsigned int MaxIrradianceVolumeSize;
+		static const unsigned int IrradianceVolumeCaptureSize;
+		static int IrradianceVolumeBudget;
+
 		static const unsigned int SsaoKernelSize;
 
 		static int SsaoUsedSamples;
@@ -73,6 +103,19 @@ class RenderSettings {
 
 		static const unsigned int MaxLights;
 
+		static const unsigned int OcclusionBufferWidth;
+		static const unsigned int OcclusionBufferHeight;
+		static unsigned int OccluderMaxTriangles;
+
+		static float LodScreenSize;
+		static float LodHysteresis;
+		static int ShadowLodBias;
+		static int EnvironmentLodBias;
+
+		static int UploadBudget;
+		static bool CompressTextures;
+		static int TextureStreamingBudget;
+
 		static unsigned int BloomBlurAmount;
 
 		static float Gamma;
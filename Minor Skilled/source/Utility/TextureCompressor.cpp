@@ -0,0 +1,524 @@
+#include "TextureCompressor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+
+#include "../Engine/JobSystem.h"
+
+void TextureCompressor::Compress(const unsigned char* pixels, unsigned int width, unsigned int height, int components, bool sRGB, CompressedImage& image) {
+	image.format = ChooseFormat(pixels, width, height, components, sRGB);
+	image.sRGB = sRGB;
+	image.width = width;
+	image.height = height;
+	image.levels = 1;
+
+	while((std::max(width, height) >> image.levels) > 0) image.levels++;
+
+	//reserve the whole chain up front, the levels are encoded straight into it
+	image.data.resize(GetLevelOffset(image.format, width, height, image.levels));
+
+	//the mips are filtered from the uncompressed previous level, not from the decoded blocks
+	std::vector<unsigned char> level(pixels, pixels + width * height * 4);
+	std::vector<unsigned char> nextLevel;
+	unsigned int offset = 0;
+
+	for(unsigned int i = 0; i < image.levels; i++) {
+		_EncodeLevel(&level[0], width, height, image.format, &image.data[offset]);
+		offset += GetLevelSize(image.format, width, height);
+
+		if(i + 1 == image.levels) break;
+
+		_Downsample(level, width, height, nextLevel, sRGB, image.format == BC5);
+		level.swap(nextLevel);
+
+		width = std::max(width / 2, 1u);
+		height = std::max(height / 2, 1u);
+	}
+}
+
+BlockFormat TextureCompressor::ChooseFormat(const unsigned char* pixels, unsigned int width, unsigned int height, int components, bool sRGB) {
+	unsigned int pixelCount = width * height;
+	bool hasAlpha = _HasAlpha(pixels, pixelCount, components);
+
+	//color textures, bc4 and bc5 have no srgb variants
+	if(sRGB) return hasAlpha ? BC7 : BC1;
+
+	//metallic, roughness, ao, height and specular maps
+	if(!hasAlpha && _IsGrayscale(pixels, pixelCount, components)) return BC4;
+
+	//the shaders reconstruct the z component of normals
+	if(!hasAlpha && _IsNormalMap(pixels, pixelCount)) return BC5;
+
+	return hasAlpha ? BC3 : BC1;
+}
+
+unsigned int TextureCompressor::GetBlockSize(BlockFormat format) {
+	return (format == BC1 || format == BC4) ? 8 : 16;
+}
+
+unsigned int TextureCompressor::GetLevelSize(BlockFormat format, unsigned int width, unsigned int height) {
+	return ((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+}
+
+unsigned int TextureCompressor::GetLevelOffset(BlockFormat format, unsigned int width, unsigned int height, unsigned int level) {
+	unsigned int offset = 0;
+
+	for(unsigned int i = 0; i < level; i++) {
+		offset += GetLevelSize(format, std::max(width >> i, 1u), std::max(height >> i, 1u));
+	}
+
+	return offset;
+}
+
+bool TextureCompressor::_IsGrayscale(const unsigned char* pixels, unsigned int pixelCount, int components) {
+	if(components <= 2) return true;
+
+	//allow for some chroma noise of jpegs
+	for(unsigned int i = 0; i < pixelCount; i++) {
+		const unsigned char* pixel = pixels + i * 4;
+
+		if(std::abs(pixel[0] - pixel[1]) > 2 || std::abs(pixel[1] - pixel[2]) > 2) return false;
+	}
+
+	return true;
+}
+
+bool TextureCompressor::_IsNormalMap(const unsigned char* pixels, unsigned int pixelCount) {
+	//tangent space normal maps consist of unit vectors pointing away from the surface
+	unsigned int step = std::max(pixelCount / 4096, 1u);
+	unsigned int samples = 0;
+	unsigned int normals = 0;
+
+	for(unsigned int i = 0; i < pixelCount; i += step) {
+		const unsigned char* pixel = pixels + i * 4;
+
+		float x = pixel[0] / 127.5f - 1.0f;
+		float y = pixel[1] / 127.5f - 1.0f;
+		float z = pixel[2] / 127.5f - 1.0f;
+
+		if(z > 0.0f && std::abs(std::sqrt(x * x + y * y + z * z) - 1.0f) < 0.15f) normals++;
+		samples++;
+	}
+
+	return normals >= samples * 95 / 100;
+}
+
+bool TextureCompressor::_HasAlpha(const unsigned char* pixels, unsigned int pixelCount, int components) {
+	if(components != 2 && components != 4) return false;
+
+	for(unsigned int i = 0; i < pixelCount; i++) {
+		if(pixels[i * 4 + 3] < 255) return true;
+	}
+
+	return false;
+}
+
+void TextureCompressor::_Downsample(const std::vector<unsigned char>& source, unsigned int width, unsigned int height, std::vector<unsigned char>& destination, bool sRGB, bool normalMap) {
+	//2x2 box filter, odd sizes repeat their last row or column
+	unsigned int nextWidth = std::max(width / 2, 1u);
+	unsigned int nextHeight = std::max(height / 2, 1u);
+
+	destination.resize(nextWidth * nextHeight * 4);
+
+	for(unsigned int y = 0; y < nextHeight; y++) {
+		for(unsigned int x = 0; x < nextWidth; x++) {
+			const unsigned char* texels[4];
+			unsigned int x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+			unsigned int y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+
+			texels[0] = &source[(y0 * width + x0) * 4];
+			texels[1] = &source[(y0 * width + x1) * 4];
+			texels[2] = &source[(y1 * width + x0) * 4];
+			texels[3] = &source[(y1 * width + x1) * 4];
+
+			unsigned char* result = &destination[(y * nextWidth + x) * 4];
+			float color[3] = { 0.0f, 0.0f, 0.0f };
+			unsigned int alpha = 0;
+
+			for(unsigned int i = 0; i < 4; i++) {
+				for(unsigned int c = 0; c < 3; c++) {
+					if(normalMap) color[c] += texels[i][c] / 127.5f - 1.0f;
+					else if(sRGB) color[c] += _SrgbToLinear(texels[i][c]); //average in linear space, otherwise the mips get darker
+					else color[c] += texels[i][c];
+				}
+
+				alpha += texels[i][3];
+			}
+
+			if(normalMap) {
+				//keep the averaged normals unit length
+				float length = std::sqrt(color[0] * color[0] + color[1] * color[1] + color[2] * color[2]);
+				if(length > 0.0f) for(unsigned int c = 0; c < 3; c++) color[c] /= length;
+
+				for(unsigned int c = 0; c < 3; c++) result[c] = (unsigned char)std::min(std::max((color[c] + 1.0f) * 127.5f + 0.5f, 0.0f), 255.0f);
+			} else if(sRGB) {
+				for(unsigned int c = 0; c < 3; c++) result[c] = _LinearToSrgb(color[c] * 0.25f);
+			} else {
+				for(unsigned int c = 0; c < 3; c++) result[c] = (unsigned char)(color[c] * 0.25f + 0.5f);
+			}
+
+			result[3] = (unsigned char)((alpha + 2) / 4);
+		}
+	}
+}
+
+void TextureCompressor::_EncodeLevel(const unsigned char* pixels, unsigned int width, unsigned int height, BlockFormat format, unsigned char* output) {
+	unsigned int blocksX = (width + 3) / 4;
+	unsigned int blocksY = (height + 3) / 4;
+	unsigned int blockSize = GetBlockSize(format);
+
+	//every block is independent, so the rows of blocks are spread over the workers
+	JobSystem::ParallelFor(blocksY, 4, [&](unsigned int start, unsigned int end) {
+		unsigned char block[64];
+		unsigned char values[16];
+
+		for(unsigned int by = start; by < end; by++) {
+			for(unsigned int bx = 0; bx < blocksX; bx++) {
+				//gather the 4x4 block, blocks at the border repeat the last pixels
+				for(unsigned int y = 0; y < 4; y++) {
+					for(unsigned int x = 0; x < 4; x++) {
+						unsigned int px = std::min(bx * 4 + x, width - 1);
+						unsigned int py = std::min(by * 4 + y, height - 1);
+
+						std::memcpy(&block[(y * 4 + x) * 4], &pixels[(py * width + px) * 4], 4);
+					}
+				}
+
+				unsigned char* blockOutput = output + (by * blocksX + bx) * blockSize;
+
+				switch(format) {
+					case BC1:
+						_EncodeBC1(block, blockOutput);
+						break;
+
+					case BC3:
+						//alpha block followed by a color block
+						for(unsigned int i = 0; i < 16; i++) values[i] = block[i * 4 + 3];
+
+						_EncodeBC4(values, blockOutput);
+						_EncodeBC1(block, blockOutput + 8);
+						break;
+
+					case BC4:
+						for(unsigned int i = 0; i < 16; i++) values[i] = block[i * 4];
+
+						_EncodeBC4(values, blockOutput);
+						break;
+
+					case BC5:
+						//x and y of the normal in two separate channels
+						for(unsigned int i = 0; i < 16; i++) values[i] = block[i * 4];
+						_EncodeBC4(values, blockOutput);
+
+						for(unsigned int i = 0; i < 16; i++) values[i] = block[i * 4 + 1];
+						_EncodeBC4(values, blockOutput + 8);
+						break;
+
+					case BC7:
+						_EncodeBC7(block, blockOutput);
+						break;
+				}
+			}
+		}
+	});
+}
+
+void TextureCompressor::_EncodeBC1(const unsigned char* block, unsigned char* output) {
+	//use the extremes of the colors along their principal axis as endpoints
+	float mean[4];
+	float axis[4];
+	_GetPrincipalAxis(block, 3, mean, axis);
+
+	float minT = FLT_MAX;
+	float maxT = -FLT_MAX;
+
+	for(unsigned int i = 0; i < 16; i++) {
+		float t = 0.0f;
+		for(unsigned int c = 0; c < 3; c++) t += (block[i * 4 + c] - mean[c]) * axis[c];
+
+		minT = std::min(minT, t);
+		maxT = std::max(maxT, t);
+	}
+
+	//quantize both endpoints to 565
+	const unsigned int bits[3] = { 5, 6, 5 };
+	unsigned short colors[2] = { 0, 0 };
+
+	for(unsigned int c = 0; c < 3; c++) {
+		float maxValue = (float)((1 << bits[c]) - 1);
+		float endpoint0 = std::min(std::max(mean[c] + axis[c] * maxT, 0.0f), 255.0f);
+		float endpoint1 = std::min(std::max(mean[c] + axis[c] * minT, 0.0f), 255.0f);
+
+		colors[0] = (colors[0] << bits[c]) | (unsigned short)(endpoint0 * maxValue / 255.0f + 0.5f);
+		colors[1] = (colors[1] << bits[c]) | (unsigned short)(endpoint1 * maxValue / 255.0f + 0.5f);
+	}
+
+	//the first color has to be the larger one for the four color mode
+	if(colors[0] < colors[1]) std::swap(colors[0], colors[1]);
+
+	//decode the palette the way the hardware does
+	int palette[4][3];
+
+	for(unsigned int i = 0; i < 2; i++) {
+		int r = (colors[i] >> 11) & 31, g = (colors[i] >> 5) & 63, b = colors[i] & 31;
+
+		palette[i][0] = (r << 3) | (r >> 2);
+		palette[i][1] = (g << 2) | (g >> 4);
+		palette[i][2] = (b << 3) | (b >> 2);
+	}
+
+	for(unsigned int c = 0; c < 3; c++) {
+		palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+		palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+	}
+
+	unsigned int indices = 0;
+
+	if(colors[0] != colors[1]) {
+		for(unsigned int i = 0; i < 16; i++) {
+			unsigned int bestIndex = 0;
+			int bestError = 0x7fffffff;
+
+			for(unsigned int j = 0; j < 4; j++) {
+				int error = 0;
+
+				for(unsigned int c = 0; c < 3; c++) {
+					int difference = block[i * 4 + c] - palette[j][c];
+					error += difference * difference;
+				}
+
+				if(error < bestError) {
+					bestError = error;
+					bestIndex = j;
+				}
+			}
+
+			indices |= bestIndex << (i * 2);
+		}
+	}
+
+	output[0] = colors[0] & 0xff;
+	output[1] = colors[0] >> 8;
+	output[2] = colors[1] & 0xff;
+	output[3] = colors[1] >> 8;
+
+	for(unsigned int i = 0; i < 4; i++) output[4 + i] = (indices >> (i * 8)) & 0xff;
+}
+
+void TextureCompressor::_EncodeBC4(const unsigned char* values, unsigned char* output) {
+	//eight value mode between the smallest and the largest value
+	unsigned char minValue = *std::min_element(values, values + 16);
+	unsigned char maxValue = *std::max_element(values, values + 16);
+
+	int palette[8];
+	palette[0] = maxValue;
+	palette[1] = minValue;
+
+	for(unsigned int i = 2; i < 8; i++) {
+		palette[i] = ((8 - i) * maxValue + (i - 1) * minValue) / 7;
+	}
+
+	unsigned long long indices = 0;
+
+	if(minValue != maxValue) {
+		for(unsigned int i = 0; i < 16; i++) {
+			unsigned int bestIndex = 0;
+			int bestError = 256;
+
+			for(unsigned int j = 0; j < 8; j++) {
+				int error = std::abs(values[i] - palette[j]);
+
+				if(error < bestError) {
+					bestError = error;
+					bestIndex = j;
+				}
+			}
+
+			indices |= (unsigned long long)bestIndex << (i * 3);
+		}
+	}
+
+	output[0] = maxValue;
+	output[1] = minValue;
+
+	for(unsigned int i = 0; i < 6; i++) output[2 + i] = (indices >> (i * 8)) & 0xff;
+}
+
+void TextureCompressor::_EncodeBC7(const unsigned char* block, unsigned char* output) {
+	//mode 6 only, a single subset with rgba endpoints and 4 bit indices covers most color textures well
+	static const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	float mean[4];
+	float axis[4];
+	_GetPrincipalAxis(block, 4, mean, axis);
+
+	float minT = FLT_MAX;
+	float maxT = -FLT_MAX;
+
+	for(unsigned int i = 0; i < 16; i++) {
+		float t = 0.0f;
+		for(unsigned int c = 0; c < 4; c++) t += (block[i * 4 + c] - mean[c]) * axis[c];
+
+		minT = std::min(minT, t);
+		maxT = std::max(maxT, t);
+	}
+
+	//7 bit endpoints with a shared lowest bit per endpoint, pick the one that fits best
+	unsigned int quantized[2][4];
+	unsigned int pBits[2];
+	int endpoints[2][4];
+
+	for(unsigned int i = 0; i < 2; i++) {
+		float t = (i == 0) ? minT : maxT;
+		int bestError = 0x7fffffff;
+
+		for(unsigned int p = 0; p < 2; p++) {
+			unsigned int candidate[4];
+			int error = 0;
+
+			for(unsigned int c = 0; c < 4; c++) {
+				float value = std::min(std::max(mean[c] + axis[c] * t, 0.0f), 255.0f);
+
+				candidate[c] = (unsigned int)std::min(std::max((value - p) / 2.0f + 0.5f, 0.0f), 127.0f);
+
+				int difference = (int)((candidate[c] << 1) | p) - (int)(value + 0.5f);
+				error += difference * difference;
+			}
+
+			if(error < bestError) {
+				bestError = error;
+				pBits[i] = p;
+
+				for(unsigned int c = 0; c < 4; c++) {
+					quantized[i][c] = candidate[c];
+					endpoints[i][c] = (candidate[c] << 1) | p;
+				}
+			}
+		}
+	}
+
+	unsigned int indices[16];
+
+	for(unsigned int i = 0; i < 16; i++) {
+		int bestError = 0x7fffffff;
+
+		for(unsigned int j = 0; j < 16; j++) {
+			int error = 0;
+
+			for(unsigned int c = 0; c < 4; c++) {
+				int value = ((64 - weights[j]) * endpoints[0][c] + weights[j] * endpoints[1][c] + 32) >> 6;
+				int difference = block[i * 4 + c] - value;
+
+				error += difference * difference;
+			}
+
+			if(error < bestError) {
+				bestError = error;
+				indices[i] = j;
+			}
+		}
+	}
+
+	//the highest bit of the first index is implicitly zero, swap the endpoints otherwise
+	if(indices[0] & 8) {
+		for(unsigned int c = 0; c < 4; c++) std::swap(quantized[0][c], quantized[1][c]);
+		std::swap(pBits[0], pBits[1]);
+
+		for(unsigned int i = 0; i < 16; i++) indices[i] = 15 - indices[i];
+	}
+
+	//write the fields from the lowest bit on
+	std::memset(output, 0, 16);
+	unsigned int position = 0;
+
+	auto write = [&output, &position](unsigned int value, unsigned int count) {
+		for(unsigned int i = 0; i < count; i++, position++) {
+			if((value >> i) & 1) output[position / 8] |= 1 << (position % 8);
+		}
+	};
+
+	write(1 << 6, 7); //mode 6
+
+	for(unsigned int c = 0; c < 4; c++) {
+		write(quantized[0][c], 7);
+		write(quantized[1][c], 7);
+	}
+
+	write(pBits[0], 1);
+	write(pBits[1], 1);
+
+	write(indices[0], 3);
+	for(unsigned int i = 1; i < 16; i++) write(indices[i], 4);
+}
+
+void TextureCompressor::_GetPrincipalAxis(const unsigned char* block, unsigned int channels, float* mean, float* axis) {
+	for(unsigned int c = 0; c < channels; c++) {
+		mean[c] = 0.0f;
+		for(unsigned int i = 0; i < 16; i++) mean[c] += block[i * 4 + c];
+
+		mean[c] /= 16.0f;
+	}
+
+	float covariance[4][4] = {};
+
+	for(unsigned int i = 0; i < 16; i++) {
+		for(unsigned int a = 0; a < channels; a++) {
+			for(unsigned int b = 0; b < channels; b++) {
+				covariance[a][b] += (block[i * 4 + a] - mean[a]) * (block[i * 4 + b] - mean[b]);
+			}
+		}
+	}
+
+	//power iteration, converges to the direction of the largest variance, starting with the channel that varies the most
+	unsigned int largest = 0;
+
+	for(unsigned int c = 1; c < channels; c++) {
+		if(covariance[c][c] > covariance[largest][largest]) largest = c;
+	}
+
+	for(unsigned int c = 0; c < channels; c++) axis[c] = covariance[largest][c];
+
+	for(unsigned int iteration = 0; iteration < 8; iteration++) {
+		float next[4] = {};
+		float length = 0.0f;
+
+		for(unsigned int a = 0; a < channels; a++) {
+			for(unsigned int b = 0; b < channels; b++) next[a] += covariance[a][b] * axis[b];
+
+			length += next[a] * next[a];
+		}
+
+		length = std::sqrt(length);
+
+		if(length < FLT_EPSILON) {
+			//flat block, every pixel is the mean
+			for(unsigned int c = 0; c < channels; c++) axis[c] = 0.0f;
+			return;
+		}
+
+		for(unsigned int c = 0; c < channels; c++) axis[c] = next[c] / length;
+	}
+}
+
+float TextureCompressor::_SrgbToLinear(unsigned char value) {
+	static const std::vector<float> table = []() {
+		std::vector<float> values(256);
+
+		for(unsigned int i = 0; i < 256; i++) {
+			float color = i / 255.0f;
+			values[i] = (color <= 0.04045f) ? color / 12.92f : std::pow((color + 0.055f) / 1.055f, 2.4f);
+		}
+
+		return values;
+	}();
+
+	return table[value];
+}
+
+unsigned char TextureCompressor::_LinearToSrgb(float value) {
+	float color = (value <= 0.0031308f) ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+
+	return (unsigned char)std::min(std::max(color * 255.0f + 0.5f, 0.0f), 255.0f);
+}
\ No newline at end of file
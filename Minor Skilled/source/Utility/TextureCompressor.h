@@ -0,0 +1,49 @@
+#ifndef TEXTURECOMPRESSOR_H
+#define TEXTURECOMPRESSOR_H
+
+#include <vector>
+
+#include "../Utility/BlockFormat.h"
+
+//block compressed image with its whole mip chain, the levels are stored back to back starting with the largest one
+struct CompressedImage {
+	BlockFormat format;
+	bool sRGB;
+
+	unsigned int width;
+	unsigned int height;
+	unsigned int levels;
+
+	std::vector<unsigned char> data;
+};
+
+//cpu encoder for the bc formats, the blocks of each level are encoded on the job system workers
+class TextureCompressor {
+	public:
+		//pixels have to be rgba, components is the channel count of the source image
+		static void Compress(const unsigned char* pixels, unsigned int width, unsigned int height, int components, bool sRGB, CompressedImage& image);
+
+		static BlockFormat ChooseFormat(const unsigned char* pixels, unsigned int width, unsigned int height, int components, bool sRGB);
+
+		static unsigned int GetBlockSize(BlockFormat format);
+		static unsigned int GetLevelSize(BlockFormat format, unsigned int width, unsigned int height);
+		static unsigned int GetLevelOffset(BlockFormat format, unsigned int width, unsigned int height, unsigned int level); //size of all larger levels
+
+	private:
+		static bool _IsGrayscale(const unsigned char* pixels, unsigned int pixelCount, int components);
+		static bool _IsNormalMap(const unsigned char* pixels, unsigned int pixelCount);
+		static bool _HasAlpha(const unsigned char* pixels, unsigned int pixelCount, int components);
+
+		static void _Downsample(const std::vector<unsigned char>& source, unsigned int width, unsigned int height, std::vector<unsigned char>& destination, bool sRGB, bool normalMap);
+		static void _EncodeLevel(const unsigned char* pixels, unsigned int width, unsigned int height, BlockFormat format, unsigned char* output);
+
+		static void _EncodeBC1(const unsigned char* block, unsigned char* output);
+		static void _EncodeBC4(const unsigned char* values, unsigned char* output);
+		static void _EncodeBC7(const unsigned char* block, unsigned char* output);
+
+		static void _GetPrincipalAxis(const unsigned char* block, unsigned int channels, float* mean, float* axis);
+		static float _SrgbToLinear(unsigned char value);
+		static unsigned char _LinearToSrgb(float value);
+};
+
+#endif
\ No newline at end of file